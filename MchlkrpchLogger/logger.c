@@ -4,11 +4,7 @@
 #include <MchlkrpchLogger/logger.h>
 #include <stdarg.h>
 
-struct Logger logger = {1, 0, "", NULL};
-
-/// Main pointer to unique logger reference.
-extern struct Logger *logger_ptr;
-struct Logger *logger_ptr = &logger;
+_Thread_local struct Logger logger = {1, 0, chosen_group, NULL};
 
 /**
  * @brief set new value to tab_size for new change
@@ -31,30 +27,16 @@ void SetLogfile(FILE *f)
   logger_ptr->f = f;
 }
 
-/// @brief Increases 'logger_ptr->n_tabs'. 
-void tab_incr()
-{
-  for (uint64_t cur_sym = logger_ptr->tab_size * logger_ptr->n_tabs;
-    cur_sym < logger_ptr->tab_size * (logger_ptr->n_tabs + 1); ++cur_sym) {
-    logger_ptr->indent[cur_sym] = (cur_sym % kSpecialIndentSymbolMod == kSpecialIndentSymbolMod / 2)? '.' : ' ';
-  }
-
-  ++logger_ptr->n_tabs;
-}
-
-/// @brief Decreases 'logger_ptr->n_tabs'. 
-void tab_decr()
+/**
+ * @brief Sets groups of messages to print. Works
+ * only in debug builds: in release builds groups are
+ * fixed by (chosen_group).
+ * 
+ * @param groups   Mask of groups (D_* flags).
+ */
+void SetLogGroups(uint64_t groups)
 {
-  if (logger_ptr->n_tabs == 0) {
-    return;
-  }
-
-  for (uint64_t cur_sym = logger_ptr->tab_size * logger_ptr->n_tabs;
-    cur_sym > logger_ptr->tab_size * (logger_ptr->n_tabs - 1); --cur_sym) {
-    logger_ptr->indent[cur_sym - 1] = '\0';
-  }
-
-  --logger_ptr->n_tabs;
+  logger_ptr->groups = groups;
 }
 
 /**
@@ -126,6 +108,23 @@ void WriteStatusFile(const char style)
   }
 }
 
+/**
+ * @brief Writes message prefix and indent of
+ * current number of tabs. Indent has no length limit.
+ * 
+ * @param style   Style type (warning, error, common message).
+ */
+void WriteIndent(const char style)
+{
+  WriteStatusFile(style);
+
+  FILE *f = (logger_ptr->f != NULL)? logger_ptr->f : stdout;
+  uint64_t indent_len = logger_ptr->tab_size * logger_ptr->n_tabs;
+  for (uint64_t cur_sym = 0; cur_sym < indent_len; ++cur_sym) {
+    fputc((cur_sym % kSpecialIndentSymbolMod == kSpecialIndentSymbolMod / 2)? '.' : ' ', f);
+  }
+}
+
 /**
  * @brief Prints message 'msg' to logfile or
  * stdout if it's set.
@@ -26,34 +26,70 @@ struct Logger
   uint64_t tab_size;
   // Number of tabs in message.
   uint64_t n_tabs;
-   // Indent string to insert
-  // it before every message.
-  char indent[256];
+  // Groups of messages which are printed (debug builds only).
+  uint64_t groups;
   // Logger file.
   FILE *f;
 };
 
-extern struct Logger *logger_ptr;
+/*
+ * Every thread has it's own logger, so tabs and logfile
+ * of parsers in different threads don't mix.
+ */
+extern _Thread_local struct Logger logger;
+
+#define logger_ptr (&logger)
 
 void SetTabSize(uint64_t n_spaces);
 
 void SetLogfile(FILE *f);
 
-void tab_incr();
+void SetLogGroups(uint64_t groups);
+
+/*
+ * Indent is built only when message is printed,
+ * so tabs cost one counter update.
+ */
+static inline void tab_incr()
+{ ++logger_ptr->n_tabs; }
 
-void tab_decr();
+static inline void tab_decr()
+{ logger_ptr->n_tabs -= (logger_ptr->n_tabs > 0); }
 
 void WriteStatusConsole(const char style);
 
 void WriteStatusFile(const char style);
 
+void WriteIndent(const char style);
+
 void DebugPrint(const char style, char *fmt, ...);
 
+/*
+ * In release builds (NDEBUG) groups are chosen at compile time
+ * and message of not chosen group compiles to nothing.
+ * In debug builds groups can be changed with SetLogGroups().
+ */
+#ifdef NDEBUG
+#define LOG_ENABLED(msg_group_name) (((msg_group_name) & (chosen_group)) != 0x0)
+#else
+#define LOG_ENABLED(msg_group_name) (((msg_group_name) & logger_ptr->groups) != 0x0)
+#endif
+
 #define spt(msg_group_name)                                                                                                   \
-  for (size_t i = 0; i < 5; ++i) {                                                                                             \
-    DebugPrint(M,   ((msg_group_name & chosen_group) != 0x0) ? "\n" : NULL);                                                    \
-  }
+  do {                                                                                                                         \
+    if (LOG_ENABLED(msg_group_name)) {                                                                                         \
+      for (size_t i = 0; i < 5; ++i) {                                                                                         \
+        DebugPrint(M, "\n");                                                                                                   \
+      }                                                                                                                        \
+    }                                                                                                                          \
+  } while (0)
 
-#define msg(msg_group_name, msg_style, fmt, ...)                                                                                      \
-  DebugPrint(msg_style, ((msg_group_name & chosen_group) != 0x0 && msg_style != ' ') ? logger_ptr->indent : NULL, ##__VA_ARGS__);      \
-  DebugPrint(' ',       ((msg_group_name & chosen_group) != 0x0) ? fmt                : NULL, ##__VA_ARGS__);
+#define msg(msg_group_name, msg_style, fmt, ...)                                                                              \
+  do {                                                                                                                         \
+    if (LOG_ENABLED(msg_group_name)) {                                                                                         \
+      if ((msg_style) != ' ') {                                                                                                \
+        WriteIndent(msg_style);                                                                                                \
+      }                                                                                                                        \
+      DebugPrint(' ', fmt, ##__VA_ARGS__);                                                                                     \
+    }                                                                                                                          \
+  } while (0)
@@ -0,0 +1,461 @@
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <lib_GEN.h>
+
+/// Minimal time of run in baseline to check it (shorter times are noise).
+static const double kMinCheckedSeconds = 1e-3;
+
+/// Input of so many tokens is longer than lexer's window: tokens of it's first units are released.
+static const uint64_t kMinSlidingTokens = (uint64_t)1 << 16;
+
+/// Stack of parser's thread: recursive parser goes deep on long inputs.
+static const size_t kParserStackSize = (size_t)1 << 32;
+
+/**
+ * @brief Options of benchmark:
+ * ./bench --grammar=name --seed=file [--sizes=1K,1M,...]
+ *   [--repeat=N] [--out=file.json] [--baseline=file.json] [--threshold=percent] [--compress] [--intern] [--pipeline]
+ *   [--parallel=N]
+ */
+typedef struct BenchOptions
+{
+	const char *grammar;
+	// Input is made of copies of this file.
+	const char *seed;
+	const char *out;
+	const char *baseline;
+	// Allowed slowdown against baseline in percent.
+	double      threshold;
+	uint64_t    repeat;
+	uint64_t    sizes[64];
+	uint64_t    n_sizes;
+	// Parser builds compressed tree (GEN_Tree::compress).
+	bool        compress;
+	// Lexer interns texts of names and numbers (GEN_Interner).
+	bool        intern;
+	// Tokens are scanned by thread of pipelined lexer (GEN_LexerStartPipeline).
+	bool        pipeline;
+	// Ranges of %parallel_unit are parsed by so many threads (ParseSequenceParallel).
+	// Tokenizing is part of parse then. Grammar without %parallel_unit is parsed by ParseLexer.
+	uint32_t    parallel;
+} BenchOptions;
+
+/// Measurements for one size of input.
+typedef struct BenchResult
+{
+	uint64_t size;
+	uint64_t bytes;
+	uint64_t tokens;
+	uint64_t nodes;
+	double   tokenize_s;
+	double   parse_s;
+	long     peak_rss_kb;
+	// Capacity of lexer's window after parse and tokens released from it's start (0 without lexer).
+	uint64_t window;
+	uint64_t released;
+	bool     done;
+} BenchResult;
+
+/// Work of parser's thread.
+typedef struct BenchParse
+{
+	const char  *source;
+	uint64_t     len;
+	bool         compress;
+	bool         intern;
+	bool         pipeline;
+	uint32_t     parallel;
+	BenchResult *result;
+} BenchParse;
+
+static double Now()
+{
+	struct timespec ts = {0};
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Reads sizes like 1K, 64K, 16M, 1G.
+static uint64_t ReadSize(const char *txt, const char **end)
+{
+	char    *suffix = NULL;
+	uint64_t size   = strtoull(txt, &suffix, 10);
+	switch (*suffix) {
+		case 'K': size <<= 10; ++suffix; break;
+		case 'M': size <<= 20; ++suffix; break;
+		case 'G': size <<= 30; ++suffix; break;
+		default:                         break;
+	}
+	*end = suffix;
+	return size;
+}
+
+static bool ReadOptions(int argc, char *argv[], BenchOptions *options)
+{
+	for (int cur_arg = 1; cur_arg < argc; ++cur_arg) {
+		const char *arg = argv[cur_arg];
+		if (strncmp(arg, "--grammar=", 10) == 0) {
+			options->grammar = arg + 10;
+		} else if (strncmp(arg, "--seed=", 7) == 0) {
+			options->seed = arg + 7;
+		} else if (strncmp(arg, "--out=", 6) == 0) {
+			options->out = arg + 6;
+		} else if (strncmp(arg, "--baseline=", 11) == 0) {
+			options->baseline = (arg[11] != '\0')? arg + 11 : NULL;
+		} else if (strncmp(arg, "--threshold=", 12) == 0) {
+			options->threshold = strtod(arg + 12, NULL);
+		} else if (strncmp(arg, "--repeat=", 9) == 0) {
+			options->repeat = strtoull(arg + 9, NULL, 10);
+		} else if (strcmp(arg, "--compress") == 0) {
+			options->compress = true;
+		} else if (strcmp(arg, "--intern") == 0) {
+			options->intern = true;
+		} else if (strcmp(arg, "--pipeline") == 0) {
+			options->pipeline = true;
+		} else if (strncmp(arg, "--parallel=", 11) == 0) {
+			options->parallel = (uint32_t)strtoul(arg + 11, NULL, 10);
+		} else if (strncmp(arg, "--sizes=", 8) == 0) {
+			options->n_sizes = 0;
+			const char *cur = arg + 8;
+			while (*cur != '\0' && options->n_sizes < sizeof(options->sizes) / sizeof(uint64_t)) {
+				options->sizes[options->n_sizes++] = ReadSize(cur, &cur);
+				cur += (*cur == ',');
+			}
+		} else {
+			printf("Unknown option: %s\n", arg);
+			return false;
+		}
+	}
+	return options->seed != NULL && options->repeat > 0;
+}
+
+/**
+ * @brief Makes input of (size) bytes at least from copies of seed.
+ */
+static char *MakeInput(const char *seed, uint64_t size, uint64_t *bytes)
+{
+	FILE *f = fopen(seed, "r");
+	if (f == NULL) {
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	uint64_t seed_len = (uint64_t)ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	uint64_t n_copies = (size + seed_len) / (seed_len + 1);
+	n_copies = (n_copies == 0)? 1 : n_copies;
+	*bytes = n_copies * (seed_len + 1);
+
+	char *source = (char *)malloc(*bytes);
+	assert(source != NULL && "Null malloc allocation");
+	seed_len = fread(source, sizeof(char), seed_len, f);
+	fclose(f);
+	source[seed_len] = '\n';
+	for (uint64_t cur_copy = 1; cur_copy < n_copies; ++cur_copy) {
+		memcpy(source + cur_copy * (seed_len + 1), source, seed_len + 1);
+	}
+
+	return source;
+}
+
+// Counts nodes without recursion, so deep trees don't overflow stack.
+static uint64_t CountNodes(GEN_Node *root)
+{
+	if (root == NULL) {
+		return 0;
+	}
+
+	uint64_t   capacity = 256;
+	uint64_t   size     = 0;
+	GEN_Node **stack    = (GEN_Node **)malloc(capacity * sizeof(GEN_Node *));
+	assert(stack != NULL && "Null malloc allocation");
+
+	uint64_t n_nodes = 0;
+	stack[size++] = root;
+	while (size > 0) {
+		GEN_Node *n = stack[--size];
+		++n_nodes;
+		if (n->children == NULL) {
+			continue;
+		}
+		for (uint64_t cur_child = 0; cur_child < n->children->size; ++cur_child) {
+			if (size == capacity) {
+				capacity *= 2;
+				stack = (GEN_Node **)realloc(stack, capacity * sizeof(GEN_Node *));
+				assert(stack != NULL && "Null realloc allocation");
+			}
+			stack[size++] = GEN_GetChild(n, cur_child);
+		}
+	}
+
+	free(stack);
+	return n_nodes;
+}
+
+static void *ParseRoutine(void *arg)
+{
+	BenchParse *work = (BenchParse *)arg;
+
+	GEN_Tree t = {0};
+	t.compress = work->compress;
+	GEN_AddChild(&t, GEN_CreateNode(&t, &GEN_eof_token));
+	double start = Now();
+#ifdef GEN_PARALLEL
+	if (work->parallel > 0) {
+		uint64_t   n_tokens = 0;
+		GEN_Token *sequence = GEN_Tokenizer(work->source, work->len, &n_tokens);
+		ParseSequenceParallel(&t, sequence, (GEN_Context){0}, (int64_t)n_tokens, work->parallel);
+		free(sequence);
+	} else
+#endif
+	{
+		GEN_Lexer *lx = GEN_LexerCtor(work->source, work->len);
+		GEN_Interner *interner = (work->intern)? GEN_InternerCtor() : NULL;
+		lx->interner = interner;
+		if (work->pipeline) {
+			GEN_LexerStartPipeline(lx);
+		}
+		ParseLexer(&t, lx, (GEN_Context){0});
+		work->result->window   = lx->capacity;
+		work->result->released = lx->base;
+		GEN_LexerDtor(lx);
+		if (interner != NULL) {
+			GEN_InternerDtor(interner);
+		}
+	}
+	work->result->parse_s = Now() - start;
+
+	work->result->nodes = CountNodes(t.root);
+	GEN_TreeFree(&t);
+	return NULL;
+}
+
+/**
+ * @brief Measures tokenizer and parser on one size of input.
+ * Called in child process, so peak RSS belongs only to this size.
+ */
+static BenchResult RunSize(const BenchOptions *options, uint64_t size)
+{
+	BenchResult best = {0};
+	best.size = size;
+
+	char *source = MakeInput(options->seed, size, &best.bytes);
+	if (source == NULL) {
+		return best;
+	}
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, kParserStackSize);
+
+	for (uint64_t cur_run = 0; cur_run < options->repeat; ++cur_run) {
+		BenchResult run = best;
+
+		double start = Now();
+		GEN_Token *sequence = GEN_Tokenizer(source, best.bytes, &run.tokens);
+		run.tokenize_s = Now() - start;
+		free(sequence);
+
+		BenchParse work = {source, best.bytes, options->compress, options->intern, options->pipeline,
+			options->parallel, &run};
+		pthread_t  parser_thread;
+		if (pthread_create(&parser_thread, &attr, ParseRoutine, &work) != 0) {
+			break;
+		}
+		pthread_join(parser_thread, NULL);
+
+		if (!best.done || run.tokenize_s < best.tokenize_s) {
+			best.tokenize_s = run.tokenize_s;
+		}
+		if (!best.done || run.parse_s < best.parse_s) {
+			best.parse_s = run.parse_s;
+		}
+		best.tokens   = run.tokens;
+		best.nodes    = run.nodes;
+		best.window   = run.window;
+		best.released = run.released;
+		best.done     = true;
+	}
+
+	pthread_attr_destroy(&attr);
+	free(source);
+
+	struct rusage usage = {0};
+	getrusage(RUSAGE_SELF, &usage);
+	best.peak_rss_kb = usage.ru_maxrss;
+	return best;
+}
+
+// Runs one size in child process: crash or OOM of big input doesn't stop benchmark.
+static BenchResult RunSizeInChild(const BenchOptions *options, uint64_t size)
+{
+	BenchResult result = {0};
+	result.size = size;
+
+	int pipe_fds[2] = {0};
+	if (pipe(pipe_fds) != 0) {
+		return result;
+	}
+
+	fflush(stdout);
+	pid_t child = fork();
+	if (child == 0) {
+		close(pipe_fds[0]);
+		BenchResult child_result = RunSize(options, size);
+		ssize_t written = write(pipe_fds[1], &child_result, sizeof(BenchResult));
+		_exit((written == sizeof(BenchResult))? 0 : 1);
+	}
+
+	close(pipe_fds[1]);
+	if (child > 0 && read(pipe_fds[0], &result, sizeof(BenchResult)) != sizeof(BenchResult)) {
+		result.done = false;
+	}
+	close(pipe_fds[0]);
+	if (child > 0) {
+		waitpid(child, NULL, 0);
+	}
+	return result;
+}
+
+static double PerSecond(uint64_t n, double seconds)
+{
+	return (seconds > 0)? (double)n / seconds : 0;
+}
+
+static void WriteResults(FILE *f, const BenchOptions *options, const BenchResult *results)
+{
+	fprintf(f,
+		"{\n"
+		"  \"grammar\": \"%s\",\n"
+		"  \"results\": [\n",
+		(options->grammar != NULL)? options->grammar : "");
+	for (uint64_t cur_size = 0; cur_size < options->n_sizes; ++cur_size) {
+		const BenchResult *r = &results[cur_size];
+		fprintf(f,
+			"    {\"size\": %lu, \"bytes\": %lu, \"tokens\": %lu, \"nodes\": %lu, "
+			"\"tokenize_s\": %.6f, \"parse_s\": %.6f, \"tokens_per_s\": %.0f, \"nodes_per_s\": %.0f, "
+			"\"peak_rss_kb\": %ld, \"window\": %lu, \"done\": %s}%s\n",
+			r->size, r->bytes, r->tokens, r->nodes,
+			r->tokenize_s, r->parse_s, PerSecond(r->tokens, r->tokenize_s), PerSecond(r->nodes, r->parse_s),
+			r->peak_rss_kb, r->window, (r->done)? "true" : "false",
+			(cur_size + 1 < options->n_sizes)? "," : "");
+	}
+	fprintf(f,
+		"  ]\n"
+		"}\n");
+}
+
+static bool IsSlower(const char *name, uint64_t size, double base, double cur, double threshold)
+{
+	if (base < kMinCheckedSeconds || cur <= base * (1 + threshold / 100)) {
+		return false;
+	}
+	printf("REGRESSION %s at %lu bytes: %.6f s -> %.6f s (+%.1f%%)\n",
+		name, size, base, cur, (cur / base - 1) * 100);
+	return true;
+}
+
+/**
+ * @brief Checks that lexer releases tokens which parser doesn't need:
+ * memory of parse mustn't grow with long input.
+ *
+ * @returns   true if lexer kept the whole long input.
+ */
+static bool CheckWindow(const BenchOptions *options, const BenchResult *results)
+{
+	bool kept_all = false;
+	for (uint64_t cur_size = 0; cur_size < options->n_sizes; ++cur_size) {
+		const BenchResult *r = &results[cur_size];
+		if (r->done && r->window != 0 && r->tokens >= kMinSlidingTokens && r->released == 0) {
+			printf("Lexer's window doesn't slide on size %lu: %lu tokens are kept\n", r->size, r->window);
+			kept_all = true;
+		}
+	}
+	return kept_all;
+}
+
+/**
+ * @brief Compares results with baseline written by previous run (--out).
+ *
+ * @returns   true if some time is more than threshold slower.
+ */
+static bool CheckBaseline(const BenchOptions *options, const BenchResult *results)
+{
+	FILE *f = fopen(options->baseline, "r");
+	if (f == NULL) {
+		printf("Can't open baseline: %s\n", options->baseline);
+		return true;
+	}
+
+	bool has_regression = false;
+	char line[1024] = "";
+	while (fgets(line, sizeof(line), f) != NULL) {
+		BenchResult base = {0};
+		if (sscanf(line, " {\"size\": %lu, \"bytes\": %lu, \"tokens\": %lu, \"nodes\": %lu, "
+			"\"tokenize_s\": %lf, \"parse_s\": %lf",
+			&base.size, &base.bytes, &base.tokens, &base.nodes, &base.tokenize_s, &base.parse_s) != 6) {
+			continue;
+		}
+		for (uint64_t cur_size = 0; cur_size < options->n_sizes; ++cur_size) {
+			const BenchResult *r = &results[cur_size];
+			if (r->size != base.size || !r->done) {
+				continue;
+			}
+			has_regression |= IsSlower("tokenize", r->size, base.tokenize_s, r->tokenize_s, options->threshold);
+			has_regression |= IsSlower("parse",    r->size, base.parse_s,    r->parse_s,    options->threshold);
+		}
+	}
+
+	fclose(f);
+	return has_regression;
+}
+
+int main(int argc, char *argv[])
+{
+	BenchOptions options = {0};
+	options.threshold = 10;
+	options.repeat    = 3;
+	options.sizes[0]  = 1 << 10;
+	options.sizes[1]  = 1 << 20;
+	options.n_sizes   = 2;
+	if (!ReadOptions(argc, argv, &options)) {
+		printf("Usage: ./bench --seed=file [--grammar=name] [--sizes=1K,1M,1G] [--repeat=N]\n"
+			"\t[--out=file.json] [--baseline=file.json] [--threshold=percent]\n");
+		return 1;
+	}
+
+	BenchResult results[sizeof(options.sizes) / sizeof(uint64_t)] = {0};
+	printf("%-12s %12s %12s %11s %11s %13s %13s %12s %10s\n",
+		"size", "tokens", "nodes", "tokenize,s", "parse,s", "tokens/s", "nodes/s", "peak RSS,KB", "window");
+	for (uint64_t cur_size = 0; cur_size < options.n_sizes; ++cur_size) {
+		BenchResult *r = &results[cur_size];
+		*r = RunSizeInChild(&options, options.sizes[cur_size]);
+		if (!r->done) {
+			printf("%-12lu failed\n", r->size);
+			continue;
+		}
+		printf("%-12lu %12lu %12lu %11.6f %11.6f %13.0f %13.0f %12ld %10lu\n",
+			r->bytes, r->tokens, r->nodes, r->tokenize_s, r->parse_s,
+			PerSecond(r->tokens, r->tokenize_s), PerSecond(r->nodes, r->parse_s), r->peak_rss_kb, r->window);
+	}
+
+	if (options.out != NULL) {
+		FILE *f = fopen(options.out, "w");
+		if (f == NULL) {
+			printf("Can't write results: %s\n", options.out);
+			return 1;
+		}
+		WriteResults(f, &options, results);
+		fclose(f);
+	}
+
+	bool failed = CheckWindow(&options, results);
+	if (options.baseline != NULL && CheckBaseline(&options, results)) {
+		failed = true;
+	}
+	return (failed)? 1 : 0;
+}
@@ -0,0 +1,73 @@
+#include <lib_FN.h>
+#include <lib_OP.h>
+
+/**
+ * @brief Check of --prefix: libraries of function.rbc (--prefix=FN) and operators.rbc (--prefix=OP)
+ * are included in one translation unit and linked into one program, each of them parses it's example.
+ *
+ *   prefix function_example operators_example
+ */
+
+/// @returns   true if tree of (txt) has node of start rule over all it's tokens.
+static bool ParsedFN(const char *txt, uint64_t len)
+{
+	uint64_t  n_tokens = 0;
+	FN_Token *sequence = FN_Tokenizer(txt, len, &n_tokens);
+	free(sequence);
+
+	FN_Tree t = {0};
+	FN_AddChild(&t, FN_CreateNode(&t, &FN_eof_token));
+	FN_Lexer *lx = FN_LexerCtor(txt, len);
+	FN_ParseLexer(&t, lx, (FN_Context){0});
+	FN_LexerDtor(lx);
+
+	FN_Node *unit = (t.root->children != NULL && t.root->children->size > 0)? FN_GetChild(t.root, 0) : NULL;
+	bool parsed = unit != NULL && unit->token.type == FN_translation_unit && unit->n_tokens + 1 == n_tokens;
+	printf("%s: %s\n", FN_TranslateTokenType(FN_translation_unit), (parsed)? "parsed" : "failed");
+	FN_TreeFree(&t);
+	return parsed;
+}
+
+/// @returns   true if tree of (txt) has node of start rule over all it's tokens.
+static bool ParsedOP(const char *txt, uint64_t len)
+{
+	uint64_t  n_tokens = 0;
+	OP_Token *sequence = OP_Tokenizer(txt, len, &n_tokens);
+	free(sequence);
+
+	OP_Tree t = {0};
+	OP_AddChild(&t, OP_CreateNode(&t, &OP_eof_token));
+	OP_Lexer *lx = OP_LexerCtor(txt, len);
+	OP_ParseLexer(&t, lx, (OP_Context){0});
+	OP_LexerDtor(lx);
+
+	OP_Node *unit = (t.root->children != NULL && t.root->children->size > 0)? OP_GetChild(t.root, 0) : NULL;
+	bool parsed = unit != NULL && unit->token.type == OP_translation_unit && unit->n_tokens + 1 == n_tokens;
+	printf("%s: %s\n", OP_TranslateTokenType(OP_translation_unit), (parsed)? "parsed" : "failed");
+	OP_TreeFree(&t);
+	return parsed;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		printf("Usage: %s function_example operators_example\n", argv[0]);
+		return 1;
+	}
+
+	FN_Source *fn_source = FN_OpenSource(argv[1]);
+	OP_Source *op_source = OP_OpenSource(argv[2]);
+	bool ok = fn_source != NULL && op_source != NULL;
+	// Names of types of tokens aren't renamed: they are texts of grammar.
+	ok = ok && strcmp(FN_TranslateTokenType(FN_T_PLUS), "T_PLUS") == 0 && FN_kNumberOfTokenTypes != OP_kNumberOfTokenTypes;
+	ok = ok && ParsedFN(fn_source->txt, fn_source->len);
+	ok = ok && ParsedOP(op_source->txt, op_source->len);
+
+	if (fn_source != NULL) {
+		FN_CloseSource(fn_source);
+	}
+	if (op_source != NULL) {
+		OP_CloseSource(op_source);
+	}
+	return (ok)? 0 : 1;
+}
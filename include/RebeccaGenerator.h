@@ -10,8 +10,6 @@
 #include <include/Utilities.h>
 
 // Global entities --------------------------------------------------------------------------
-/// Maximal token length in characters.
-#define kTokenMaxLen 256
 /// Initial size of sequence of token sequence.
 static const uint64_t kInitSequenceSize = 1024;
 /// Name in table wasn't found index
@@ -42,6 +40,12 @@ typedef enum TokenType
   TOKEN_SEMICOLON,
   // Variable char data: (')
   TOKEN_SINGLE_QUOTE,
+  // Repetition of symbol zero or more times: (*)
+  TOKEN_STAR,
+  // Repetition of symbol one or more times: (+)
+  TOKEN_PLUS,
+  // Cut after symbol of option: (!)
+  TOKEN_BANG,
 
   // Auxilary token types for tree representation:
   TOKENIZER_TREE,
@@ -50,7 +54,18 @@ typedef enum TokenType
 
 char const *TranslateTokenType(TokenType type);
 
-char *GetSourceText(char const *name);
+/// Text of input file: mapped or read from pipe, it isn't terminated by any symbol.
+typedef struct
+{
+  const char *txt;
+  uint64_t    len;
+  // Text is mapped by mmap, else it's allocated.
+  bool        mapped;
+} SourceText;
+
+SourceText GetSourceText(char const *name);
+
+void FreeSourceText(SourceText *source);
 
 // Lexer part --------------------------------------------------------------------------------
 
@@ -92,6 +107,8 @@ static const char kSplitSymbols[] =
   '%',
   '|',
   '=',
+  '+',
+  '!',
   '\\',
   '\0'
 };
@@ -108,16 +125,80 @@ typedef enum PrsrNdType
    VAR_NAME_REFERENCE,
 } PrsrNdType;
 
+// Repetition of symbol in option of parser's rule.
+typedef enum SymbolRepeat
+{
+  // Symbol is parsed once.
+  REPEAT_ONCE,
+  // Symbol is repeated zero or more times: (symbol*).
+  REPEAT_STAR,
+  // Symbol is repeated one or more times: (symbol+).
+  REPEAT_PLUS,
+  // Reference to the rule at the end of option of list rule (rule : P rule | Q):
+  // option is repeated by loop instead of recursive call.
+  REPEAT_TAIL,
+} SymbolRepeat;
+
 typedef struct Token
 {
   // Type of token.
-  TokenType  type;
-  // Text representation of token.
-  char      *txt;
-  PrsrNdType parser_type;
+  TokenType    type;
+  // Text of token in source text (not null-terminated).
+  const char  *txt;
+  // Length of text.
+  size_t       len;
+  PrsrNdType   parser_type;
+  SymbolRepeat repeat;
+  // List rule can end after this symbol of any repetition of option.
+  bool         list_end;
+  // Cut after this symbol (symbol !): if option fails after it, rule fails
+  // without trying it's other options.
+  bool         cut;
 } Token;
 
-Token *Tokenizer(char const* const txt, uint64_t *n_tokens);
+Token *Tokenizer(char const* const txt, uint64_t len, uint64_t *n_tokens);
+
+// Lexer automaton part ----------------------------------------------------------------------
+
+/// State of lexer's automaton without way to any final state.
+static const uint32_t kLexerDeadState  = 0;
+/// Initial state of lexer's automaton.
+static const uint32_t kLexerStartState = 1;
+
+/**
+ * @brief One token definition of YACC-file
+ * which should be recognized by generated tokenizer.
+ */
+typedef struct LexerRule
+{
+  // Text of literal or regex-expression (not null-terminated).
+  const char *pattern;
+  // Length of pattern.
+  size_t      len;
+  // Pattern is regex-expression.
+  bool        is_regex;
+} LexerRule;
+
+/**
+ * @brief Minimized deterministic automaton of lexer.
+ * Bytes are grouped to classes with equal transitions
+ * so transition table has (n_states * n_classes) cells.
+ */
+typedef struct LexerDfa
+{
+  size_t    n_states;
+  size_t    n_classes;
+  // Class of each byte.
+  uint16_t  byte_class[256];
+  // Transitions: next[state * n_classes + class].
+  uint32_t *next;
+  // Index of accepted lexer's rule or (kUndefinedIdx).
+  int64_t  *accept;
+} LexerDfa;
+
+LexerDfa *BuildLexerDfa(const LexerRule *rules, size_t n_rules);
+
+void LexerDfaDtor(LexerDfa *dfa);
 
 // AST part ----------------------------------------------------------------------------------
 
@@ -129,7 +210,9 @@ typedef struct
 
 // Format of node to print it in graphviz.
 #define NODE_FMT                                             \
-  "\tn%lu [shape=\"%s\" color=\"%s\" label=\"(%s)\\n%s\"]\n"
+  "\tn%lu [shape=\"%s\" color=\"%s\" label=\"(%.*s)\\n%s\"]\n"
+// Arguments to print text of node with "%.*s".
+#define NODE_TXT(n) (int)GetLen(n), GetTxt(n)
 
 /**
  * @brief Node of abstract syntax tree
@@ -179,7 +262,15 @@ void Parent(Tree *t);
 
 TokenType GetType(Node *n);
 
-char *GetTxt(Node *n);
+const char *GetTxt(Node *n);
+
+size_t GetLen(Node *n);
+
+bool TxtEqual(Node *n, const char *txt);
+
+bool SameTxt(Node *first, Node *second);
+
+char *GetTxtCopy(Node *n);
 
 Node *GetChild(Node *n, uint64_t idx);
 
@@ -205,10 +296,78 @@ void DebugTree(Tree *t);
 
 // Parser's functions -----------------------------------------------------------------------
 
-void GenerateFiles(Token *sequence, uint64_t n_tokens);
+/**
+ * @brief Kind of generated parser (--backend=...).
+ */
+typedef enum ParserBackend
+{
+  // Recursive descent: one Try_<rule> function per rule and option.
+  BACKEND_RECURSIVE,
+  // Parse tables with one non-recursive driver.
+  BACKEND_TABLE,
+} ParserBackend;
 
+/**
+ * @brief Options of parser's generator
+ * which are set by command line arguments.
+ */
+typedef struct GeneratorOptions
+{
+  // Generated rules memoize their results at each token (--packrat).
+  bool          packrat;
+  // Kind of generated parser.
+  ParserBackend backend;
+  // Parser_GEN.c is generated without calls of logger (--no-trace).
+  bool          no_trace;
+  // Each Try_<rule> and Try_<rule>_<n> counts it's calls, failures,
+  // tokens and cycles, GEN_DumpProfile() prints them (--profile).
+  bool          profile;
+  // Library is one lib_<prefix>.c instead of Tokenizer, Tree and Parser files,
+  // functions used only inside of it are static (--amalgamate).
+  bool          amalgamate;
+  // Prefix of generated names and files instead of GEN (--prefix=...) or NULL.
+  const char   *prefix;
+  // Directory of generated files instead of ../out (--out-dir=...) or NULL.
+  const char   *out_dir;
+} GeneratorOptions;
+
+bool GenerateFiles(Token *sequence, uint64_t n_tokens, const GeneratorOptions *options);
+
+/**
+ * @brief Options of synthetic corpus: random program of grammar
+ * which is written instead of parser's files (--corpus=...).
+ */
+typedef struct CorpusOptions
+{
+  // File of generated program.
+  const char   *out;
+  // Program ends as soon as it has (size) bytes (--size=...) or (tokens) tokens (--tokens=...),
+  // only one of them is not 0.
+  uint64_t      size;
+  uint64_t      tokens;
+  // Seed of random choices: the same seed gives the same program (--seed=...).
+  uint64_t      seed;
+  // Maximal nesting of rules, rule which continues list isn't nested (--max-depth=...).
+  uint64_t      max_depth;
+  // Weights of options of rules "rule:w1,w2,..." (--weight=...), 1 by default.
+  const char  **weights;
+  size_t        n_weights;
+} CorpusOptions;
+
+bool GenerateCorpus(Token *sequence, uint64_t n_tokens, const CorpusOptions *options);
+
+/**
+ * @brief Table of names of grammar. Index of name in (names)
+ * is it's id: it's assigned once when name is added.
+ * Names are found by open addressing hash table (slots).
+ */
 typedef struct NameTable
 {
-  size_t size;
-  Node **names;
+  // Names in order of adding.
+  size_t   size;
+  size_t   capacity;
+  Node   **names;
+  // Ids of names or (kUndefinedIdx), number of slots is power of two.
+  int64_t *slots;
+  size_t   n_slots;
 } NameTable;
@@ -35,5 +35,3 @@ Array *ArrayCtor(uint64_t el_sz);
 void ArrayChangeCapacity(Array *a, uint64_t new_capacity);
 
 void ArrayAdd(Array *a, void *new_element);
-
-void FillEmptyStr(char **dest, const char *src);
@@ -1,11 +1,157 @@
+#include <ctype.h>
 #include <stdio.h>
 
 #include <include/RebeccaGenerator.h>
 #include <MchlkrpchLogger/logger.h>
 
+/**
+ * @brief Checks that (prefix) can start names of C:
+ * letters, digits and '_', not starting with digit.
+ */
+static bool IsPrefix(const char *prefix)
+{
+	if (!isalpha((unsigned char)prefix[0]) && prefix[0] != '_') {
+		return false;
+	}
+	for (const char *cur_symbol = prefix; *cur_symbol != '\0'; ++cur_symbol) {
+		if (!isalnum((unsigned char)*cur_symbol) && *cur_symbol != '_') {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Reads number with K, M or G suffix (1024 based).
+ *
+ * @param txt    Text of number.
+ * @param size   Output: number.
+ * @returns      false if text isn't number.
+ */
+static bool ReadSize(const char *txt, uint64_t *size)
+{
+	char *suffix = NULL;
+	*size = strtoull(txt, &suffix, 10);
+	if (suffix == txt || !isdigit((unsigned char)txt[0])) {
+		return false;
+	}
+	switch (*suffix) {
+		case 'K': *size <<= 10; ++suffix; break;
+		case 'M': *size <<= 20; ++suffix; break;
+		case 'G': *size <<= 30; ++suffix; break;
+		default:                          break;
+	}
+	return *suffix == '\0';
+}
+
+/**
+ * @brief Reads generator's options from command line
+ * arguments: ./rbc [options] grammar.rbc
+ *
+ * @param argc      Number of arguments.
+ * @param argv      Arguments.
+ * @param options   Output: options of generator.
+ * @param corpus    Output: options of synthetic corpus, (corpus->out) is set by --corpus.
+ * @returns         Name of YACC-similar file or NULL if arguments are wrong.
+ */
+static const char *ParseArguments(int argc, char *argv[], GeneratorOptions *options, CorpusOptions *corpus)
+{
+	assert(argv    != NULL && "Null param");
+	assert(options != NULL && "Null param");
+	assert(corpus  != NULL && "Null param");
+
+	const char *file_name   = NULL;
+	bool        corpus_only = false;
+	bool        sizes_ok    = true;
+	for (int cur_arg = 1; cur_arg < argc; ++cur_arg) {
+		if (strncmp(argv[cur_arg], "--corpus=", 9) == 0) {
+			corpus->out = argv[cur_arg] + 9;
+		} else if (strncmp(argv[cur_arg], "--size=", 7) == 0) {
+			sizes_ok = ReadSize(argv[cur_arg] + 7, &corpus->size) && sizes_ok;
+			corpus->tokens = 0;
+			corpus_only = true;
+		} else if (strncmp(argv[cur_arg], "--tokens=", 9) == 0) {
+			sizes_ok = ReadSize(argv[cur_arg] + 9, &corpus->tokens) && corpus->tokens > 0 && sizes_ok;
+			corpus_only = true;
+		} else if (strncmp(argv[cur_arg], "--seed=", 7) == 0) {
+			sizes_ok = ReadSize(argv[cur_arg] + 7, &corpus->seed) && sizes_ok;
+			corpus_only = true;
+		} else if (strncmp(argv[cur_arg], "--max-depth=", 12) == 0) {
+			sizes_ok = ReadSize(argv[cur_arg] + 12, &corpus->max_depth) && corpus->max_depth > 0 && sizes_ok;
+			corpus_only = true;
+		} else if (strncmp(argv[cur_arg], "--weight=", 9) == 0) {
+			corpus->weights[corpus->n_weights++] = argv[cur_arg] + 9;
+			corpus_only = true;
+		} else if (strcmp(argv[cur_arg], "--packrat") == 0) {
+			options->packrat = true;
+		} else if (strcmp(argv[cur_arg], "--no-trace") == 0) {
+			options->no_trace = true;
+		} else if (strcmp(argv[cur_arg], "--profile") == 0) {
+			options->profile = true;
+		} else if (strcmp(argv[cur_arg], "--backend=recursive") == 0) {
+			options->backend = BACKEND_RECURSIVE;
+		} else if (strcmp(argv[cur_arg], "--backend=table") == 0) {
+			options->backend = BACKEND_TABLE;
+		} else if (strcmp(argv[cur_arg], "--amalgamate") == 0) {
+			options->amalgamate = true;
+		} else if (strncmp(argv[cur_arg], "--prefix=", 9) == 0) {
+			options->prefix = argv[cur_arg] + 9;
+		} else if (strncmp(argv[cur_arg], "--out-dir=", 10) == 0) {
+			options->out_dir = argv[cur_arg] + 10;
+		} else if (strncmp(argv[cur_arg], "--", 2) == 0) {
+			printf("Unknown option: %s\n", argv[cur_arg]);
+			return NULL;
+		} else if (file_name == NULL) {
+			file_name = argv[cur_arg];
+		} else {
+			return NULL;
+		}
+	}
+
+	if (corpus_only && corpus->out == NULL) {
+		printf("--size, --tokens, --seed, --max-depth and --weight are options of --corpus\n");
+		return NULL;
+	}
+	if (!sizes_ok) {
+		printf("Sizes and seed of --corpus must be numbers (with K, M, G), --tokens and --max-depth more than 0\n");
+		return NULL;
+	}
+	if (corpus->out != NULL && corpus->out[0] == '\0') {
+		printf("--corpus must not be empty\n");
+		return NULL;
+	}
+	if (options->prefix != NULL && !IsPrefix(options->prefix)) {
+		printf("--prefix must be name of C: %s\n", options->prefix);
+		return NULL;
+	}
+	if (options->out_dir != NULL && options->out_dir[0] == '\0') {
+		printf("--out-dir must not be empty\n");
+		return NULL;
+	}
+	if (options->profile && options->backend == BACKEND_TABLE) {
+		printf("--profile works only with --backend=recursive\n");
+		return NULL;
+	}
+	return file_name;
+}
+
 int main(int argc, char *argv[]) {
-	if (argc != 2) {
-		printf("Pleace choose YACC-similar file!\n");
+	GeneratorOptions options = {0};
+	CorpusOptions    corpus  = {0};
+	corpus.size      = 1 << 20;
+	corpus.seed      = 1;
+	corpus.max_depth = 32;
+	corpus.weights   = (const char **)calloc((size_t)argc, sizeof(const char *));
+	assert(corpus.weights != NULL && "Null calloc allocation");
+	// for example: "../include/function.rbc".
+	const char *program_to_read = ParseArguments(argc, argv, &options, &corpus);
+	if (program_to_read == NULL) {
+		printf("Pleace choose YACC-similar file!\n"
+			"Usage: ./rbc [--packrat] [--no-trace] [--profile] [--backend=recursive|table]\n"
+			"             [--amalgamate] [--prefix=NAME] [--out-dir=DIR] grammar.rbc\n"
+			"       ./rbc --corpus=FILE [--size=BYTES|--tokens=N] [--seed=N] [--max-depth=N]\n"
+			"             [--weight=RULE:W1,W2,...]... grammar.rbc\n");
+		free(corpus.weights);
 		return 0;
 	}
 
@@ -13,20 +159,23 @@ int main(int argc, char *argv[]) {
 	msg(D_TOKENIZER, M,
 			"Start of tokenizer work.\n");
 
-	uint64_t n_tokens = 0;  
-	// for example: "../include/function.rbc".
-	const char *program_to_read = argv[1];
+	uint64_t n_tokens = 0;
 
-	char *source_text = GetSourceText(program_to_read);
-	assert(source_text != NULL && "Null source text or wrong path to file!");
+	SourceText source = GetSourceText(program_to_read);
+	if (source.txt == NULL) {
+		printf("Can't read grammar: %s\n", program_to_read);
+		free(corpus.weights);
+		return 1;
+	}
 
 	msg(D_TOKENIZER, M,
-			"Readen program(%s):\n%s\n",
+			"Readen program(%s):\n%.*s\n",
 			program_to_read,
-			source_text);
+			(int)source.len, source.txt);
 
-	Token *sequence = Tokenizer(source_text, &n_tokens);
-	free(source_text);
+	//  Tokens refer to source text so it's freed
+	// after generating files.
+	Token *sequence = Tokenizer(source.txt, source.len, &n_tokens);
 
 	spt(D_TOKENIZER);
 
@@ -35,14 +184,21 @@ int main(int argc, char *argv[]) {
 
 	for (uint64_t cur_token = 0; cur_token < n_tokens; ++cur_token) {
 		msg(D_TOKENIZER_OUTPUT, M,
-			"t(%zu)|%s -- %s\n",
+			"t(%zu)|%.*s -- %s\n",
 			cur_token,
-			sequence[cur_token].txt,
+			(int)sequence[cur_token].len, sequence[cur_token].txt,
 			TranslateTokenType(sequence[cur_token].type));
 	}
 	
 	spt(D_TOKENIZER_OUTPUT);
-	GenerateFiles(sequence, n_tokens);
+	bool written = (corpus.out != NULL)?
+		GenerateCorpus(sequence, n_tokens, &corpus) : GenerateFiles(sequence, n_tokens, &options);
+	free(sequence);
+	free(corpus.weights);
+	FreeSourceText(&source);
+	if (!written) {
+		return 1;
+	}
 	// End of parser-generator's work work.
 	msg(D_PARSER_GENERATING, M,
 		"End of generating parser's file\n");
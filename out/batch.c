@@ -0,0 +1,303 @@
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <lib_GEN.h>
+#include <batch.h>
+#include <../MchlkrpchLogger/logger.h>
+
+/// Files of batch.
+typedef struct BatchFiles
+{
+	BatchFile *data;
+	uint64_t   size;
+	uint64_t   capacity;
+} BatchFiles;
+
+/**
+ * @brief Files of one worker. Owner takes the largest
+ * files from head, other workers steal from tail.
+ */
+typedef struct BatchQueue
+{
+	pthread_mutex_t lock;
+	// Indexes of files in batch.
+	uint64_t       *files;
+	uint64_t        head;
+	uint64_t        tail;
+} BatchQueue;
+
+/// State of one thread of batch.
+typedef struct BatchWorker
+{
+	uint32_t    id;
+	uint32_t    n_workers;
+	BatchQueue *queues;
+	BatchFiles *files;
+} BatchWorker;
+
+static double Now()
+{
+	struct timespec ts = {0};
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void AddFile(BatchFiles *files, const char *name, uint64_t size)
+{
+	if (files->size == files->capacity) {
+		files->capacity = (files->capacity == 0)? 64 : files->capacity * 2;
+		files->data = (BatchFile *)realloc(files->data, files->capacity * sizeof(BatchFile));
+		assert(files->data != NULL && "Null realloc allocation");
+	}
+
+	BatchFile new_file = {0};
+	new_file.name = strdup(name);
+	new_file.size = size;
+	files->data[files->size++] = new_file;
+}
+
+/**
+ * @brief Adds file (path) or all the files of directory (path)
+ * and it's subdirectories to batch.
+ */
+static void CollectFiles(BatchFiles *files, const char *path)
+{
+	struct stat st = {0};
+	if (stat(path, &st) != 0) {
+		printf("Can't open: %s\n", path);
+		return;
+	}
+	if (!S_ISDIR(st.st_mode)) {
+		AddFile(files, path, (uint64_t)st.st_size);
+		return;
+	}
+
+	DIR *dir = opendir(path);
+	if (dir == NULL) {
+		printf("Can't open: %s\n", path);
+		return;
+	}
+	struct dirent *entry = NULL;
+	while ((entry = readdir(dir)) != NULL) {
+		if (entry->d_name[0] == '.') {
+			continue;
+		}
+		char *sub_path = (char *)calloc(strlen(path) + strlen(entry->d_name) + 2, sizeof(char));
+		assert(sub_path != NULL && "Null calloc allocation");
+		sprintf(sub_path, "%s/%s", path, entry->d_name);
+		CollectFiles(files, sub_path);
+		free(sub_path);
+	}
+	closedir(dir);
+}
+
+// Counts nodes without recursion, so deep trees don't overflow stack.
+static uint64_t CountNodes(GEN_Node *root)
+{
+	if (root == NULL) {
+		return 0;
+	}
+
+	uint64_t   capacity = 256;
+	uint64_t   size     = 0;
+	GEN_Node **stack    = (GEN_Node **)malloc(capacity * sizeof(GEN_Node *));
+	assert(stack != NULL && "Null malloc allocation");
+
+	uint64_t n_nodes = 0;
+	stack[size++] = root;
+	while (size > 0) {
+		GEN_Node *n = stack[--size];
+		++n_nodes;
+		if (n->children == NULL) {
+			continue;
+		}
+		for (uint64_t cur_child = 0; cur_child < n->children->size; ++cur_child) {
+			if (size == capacity) {
+				capacity *= 2;
+				stack = (GEN_Node **)realloc(stack, capacity * sizeof(GEN_Node *));
+				assert(stack != NULL && "Null realloc allocation");
+			}
+			stack[size++] = GEN_GetChild(n, cur_child);
+		}
+	}
+
+	free(stack);
+	return n_nodes;
+}
+
+/**
+ * @brief Gives next file to worker: from it's own queue
+ * or stolen from queue of other worker.
+ *
+ * @returns   false if all the files are taken.
+ */
+static bool TakeFile(BatchWorker *w, uint64_t *file_idx)
+{
+	for (uint32_t cur_queue = 0; cur_queue < w->n_workers; ++cur_queue) {
+		uint32_t    victim = (w->id + cur_queue) % w->n_workers;
+		BatchQueue *q      = &w->queues[victim];
+		bool        taken  = false;
+
+		pthread_mutex_lock(&q->lock);
+		if (q->head < q->tail) {
+			*file_idx = (victim == w->id)? q->files[q->head++] : q->files[--q->tail];
+			taken = true;
+		}
+		pthread_mutex_unlock(&q->lock);
+
+		if (taken) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void *WorkerRoutine(void *arg)
+{
+	BatchWorker *w = (BatchWorker *)arg;
+	// One tree per worker: arena keeps it's memory between files.
+	GEN_Tree t = {0};
+	t.compress = true;
+	uint64_t file_idx = 0;
+
+	while (TakeFile(w, &file_idx)) {
+		BatchFile *file  = &w->files->data[file_idx];
+		double     start = Now();
+		file->worker = w->id;
+
+		GEN_Source *source = GEN_OpenSource(file->name);
+		if (source == NULL) {
+			continue;
+		}
+		file->size = source->len;
+
+		GEN_TreeReset(&t);
+		GEN_AddChild(&t, GEN_CreateNode(&t, &GEN_eof_token));
+		GEN_Lexer *lx = GEN_LexerCtor(source->txt, source->len);
+		ParseLexer(&t, lx, (GEN_Context){0});
+		GEN_LexerDtor(lx);
+
+		file->n_nodes = CountNodes(t.root);
+		file->seconds = Now() - start;
+		file->parsed  = true;
+		GEN_CloseSource(source);
+	}
+
+	GEN_TreeFree(&t);
+	return NULL;
+}
+
+static int CompareSizes(const void *first, const void *second)
+{
+	uint64_t first_size  = (*(BatchFile *const *)first)->size;
+	uint64_t second_size = (*(BatchFile *const *)second)->size;
+	return (first_size < second_size) - (first_size > second_size);
+}
+
+static double MegabytesPerSecond(uint64_t size, double seconds)
+{
+	return (seconds > 0)? (double)size / 1e6 / seconds : 0;
+}
+
+/**
+ * @brief Parses list of files and directories by pool of threads:
+ * ./rbc --batch [--threads=N] file_or_dir...
+ * Prints throughput of each file and of the whole batch.
+ *
+ * @param argc   Number of arguments after --batch.
+ * @param argv   Arguments after --batch.
+ * @returns      Exit code of program.
+ */
+int RunBatch(int argc, char *argv[])
+{
+	long n_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	BatchFiles files = {0};
+	for (int cur_arg = 0; cur_arg < argc; ++cur_arg) {
+		if (strncmp(argv[cur_arg], "--threads=", 10) == 0) {
+			n_workers = strtol(argv[cur_arg] + 10, NULL, 10);
+		} else {
+			CollectFiles(&files, argv[cur_arg]);
+		}
+	}
+	if (files.size == 0) {
+		printf("Usage: ./rbc --batch [--threads=N] file_or_dir...\n");
+		return 1;
+	}
+	n_workers = (n_workers < 1)? 1 : n_workers;
+	n_workers = ((uint64_t)n_workers > files.size)? (long)files.size : n_workers;
+
+	// The largest files are started first and dealt to all the workers.
+	BatchFile **order = (BatchFile **)calloc(files.size, sizeof(BatchFile *));
+	assert(order != NULL && "Null calloc allocation");
+	for (uint64_t cur_file = 0; cur_file < files.size; ++cur_file) {
+		order[cur_file] = &files.data[cur_file];
+	}
+	qsort(order, files.size, sizeof(BatchFile *), CompareSizes);
+
+	BatchQueue  *queues  = (BatchQueue  *)calloc((size_t)n_workers, sizeof(BatchQueue));
+	BatchWorker *workers = (BatchWorker *)calloc((size_t)n_workers, sizeof(BatchWorker));
+	pthread_t   *threads = (pthread_t   *)calloc((size_t)n_workers, sizeof(pthread_t));
+	assert(queues != NULL && workers != NULL && threads != NULL && "Null calloc allocation");
+
+	for (long cur_worker = 0; cur_worker < n_workers; ++cur_worker) {
+		pthread_mutex_init(&queues[cur_worker].lock, NULL);
+		queues[cur_worker].files = (uint64_t *)calloc(files.size / (uint64_t)n_workers + 1, sizeof(uint64_t));
+		assert(queues[cur_worker].files != NULL && "Null calloc allocation");
+	}
+	for (uint64_t cur_file = 0; cur_file < files.size; ++cur_file) {
+		BatchQueue *q = &queues[cur_file % (uint64_t)n_workers];
+		q->files[q->tail++] = (uint64_t)(order[cur_file] - files.data);
+	}
+
+	double start = Now();
+	for (long cur_worker = 0; cur_worker < n_workers; ++cur_worker) {
+		workers[cur_worker] = (BatchWorker){(uint32_t)cur_worker, (uint32_t)n_workers, queues, &files};
+		pthread_create(&threads[cur_worker], NULL, WorkerRoutine, &workers[cur_worker]);
+	}
+	for (long cur_worker = 0; cur_worker < n_workers; ++cur_worker) {
+		pthread_join(threads[cur_worker], NULL);
+	}
+	double wall = Now() - start;
+
+	uint64_t total_size  = 0;
+	uint64_t total_nodes = 0;
+	uint64_t n_parsed    = 0;
+	double   cpu_seconds = 0;
+	for (uint64_t cur_file = 0; cur_file < files.size; ++cur_file) {
+		BatchFile *file = &files.data[cur_file];
+		if (!file->parsed) {
+			printf("%s: can't read\n", file->name);
+			continue;
+		}
+		printf("%s: %lu bytes, %lu nodes, %.3f ms, %.1f MB/s, worker %u\n",
+			file->name, file->size, file->n_nodes, file->seconds * 1e3,
+			MegabytesPerSecond(file->size, file->seconds), file->worker);
+		total_size  += file->size;
+		total_nodes += file->n_nodes;
+		cpu_seconds += file->seconds;
+		++n_parsed;
+	}
+	printf("\nTotal: %lu files, %lu bytes, %lu nodes, %ld threads\n"
+		"Wall: %.3f s, %.1f MB/s; sum of files: %.3f s, %.1f MB/s per thread\n",
+		n_parsed, total_size, total_nodes, n_workers,
+		wall, MegabytesPerSecond(total_size, wall),
+		cpu_seconds, MegabytesPerSecond(total_size, cpu_seconds));
+
+	for (long cur_worker = 0; cur_worker < n_workers; ++cur_worker) {
+		pthread_mutex_destroy(&queues[cur_worker].lock);
+		free(queues[cur_worker].files);
+	}
+	for (uint64_t cur_file = 0; cur_file < files.size; ++cur_file) {
+		free(files.data[cur_file].name);
+	}
+	free(files.data);
+	free(threads);
+	free(workers);
+	free(queues);
+	free(order);
+
+	return (n_parsed == files.size)? 0 : 1;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Result of parsing of one file in batch.
+typedef struct BatchFile
+{
+	// Name of parsed file.
+	char    *name;
+	// Size of file in bytes.
+	uint64_t size;
+	// Number of nodes in compressed AST.
+	uint64_t n_nodes;
+	// Time of reading and parsing in seconds.
+	double   seconds;
+	// Index of worker which parsed the file.
+	uint32_t worker;
+	// File was read and parsed.
+	bool     parsed;
+} BatchFile;
+
+int RunBatch(int argc, char *argv[]);
@@ -1,61 +1,146 @@
+#include <spawn.h>
 #include <stdio.h>
 
 #include <lib_GEN.h>
+#include <batch.h>
 #include <../MchlkrpchLogger/logger.h>
 
-char *GetSourceText(const char *name)
+extern char **environ;
+
+/// Options of tree export: ./rbc [--export=dot|jsonl|sexp] [--max-depth=N] [--max-nodes=N] [--out=FILE] [--render]
+/// [--parallel=N] file
+typedef struct
+{
+	GEN_ExportOptions export_options;
+	// File of tree, ../graph.<format> by default.
+	const char       *out;
+	// Graph is rendered to ../graph.png by dot in background.
+	bool              render;
+	// Ranges of %parallel_unit are parsed by so many threads, 0 is ParseLexer.
+	uint32_t          parallel;
+	const char       *source;
+} MainOptions;
+
+static bool ParseOptions(int argc, char *argv[], MainOptions *options)
+{
+	static const char *kFormats[] = {"dot", "jsonl", "sexp"};
+	for (int cur_arg = 1; cur_arg < argc; ++cur_arg) {
+		const char *arg = argv[cur_arg];
+		if (strncmp(arg, "--export=", 9) == 0) {
+			uint32_t format = 0;
+			while (format < 3 && strcmp(arg + 9, kFormats[format]) != 0) {
+				++format;
+			}
+			if (format == 3) {
+				return false;
+			}
+			options->export_options.format = (GEN_ExportFormat)format;
+		} else if (strncmp(arg, "--max-depth=", 12) == 0) {
+			options->export_options.max_depth = (uint32_t)strtoul(arg + 12, NULL, 10);
+		} else if (strncmp(arg, "--max-nodes=", 12) == 0) {
+			options->export_options.max_nodes = strtoull(arg + 12, NULL, 10);
+		} else if (strncmp(arg, "--out=", 6) == 0) {
+			options->out = arg + 6;
+		} else if (strcmp(arg, "--render") == 0) {
+			options->render = true;
+		} else if (strncmp(arg, "--parallel=", 11) == 0) {
+			options->parallel = (uint32_t)strtoul(arg + 11, NULL, 10);
+		} else if (options->source == NULL && (arg[0] != '-' || arg[1] == '\0')) {
+			options->source = arg;
+		} else {
+			return false;
+		}
+	}
+	return options->source != NULL;
+}
+
+/**
+ * @brief Writes tree to file of options. Graph is rendered by dot
+ * in it's own process if it's asked: caller doesn't wait for it.
+ *
+ * @returns   false if tree can't be written.
+ */
+static bool ExportTree(GEN_Tree *t, const MainOptions *options)
 {
-  assert(name != NULL && "nullptr param");
-  
-  tab_incr();
-
-  FILE *f = fopen(name, "r");
-  assert(f != NULL && "Open file error");
-
-  fseek(f, 0, SEEK_END);
-  /* Contains number of symbols wihtout EOF-symbol.
-  For example with file "abaEOF" n_symbols = 3.*/
-  size_t n_symbols = ftell(f);
-  msg(D_TOKENIZER, M, "mush be allocated:%zu\n", n_symbols);
-  fseek(f, 0, SEEK_SET);
-
-  char *source_text = (char *)calloc(n_symbols + 1, sizeof(char));
-  fread(source_text, sizeof(char), n_symbols, f);
-
-  /* Set last character as 'EOF' symbol
-  to terminate tokenizer's work*/
-  source_text[n_symbols] = EOF;
-  fclose(f);
-  tab_decr();
-
-  return source_text;
+	static const char *kDefaultOuts[] = {"../graph.dot", "../graph.jsonl", "../graph.sexp"};
+	const char *out = (options->out != NULL)? options->out : kDefaultOuts[options->export_options.format];
+
+	FILE *f = fopen(out, "w");
+	if (f == NULL) {
+		printf("Can't write: %s\n", out);
+		return false;
+	}
+	bool written = GEN_ExportTree(t->root, GEN_FileSink(f), &options->export_options);
+	written = (fclose(f) == 0) && written;
+	if (!written) {
+		printf("Can't write: %s\n", out);
+		return false;
+	}
+
+	if (options->render && options->export_options.format == GEN_EXPORT_DOT) {
+		char *dot_argv[] = {"dot", "-Tpng", (char *)out, "-o", "../graph.png", NULL};
+		pid_t pid = 0;
+		if (posix_spawnp(&pid, "dot", NULL, NULL, dot_argv, environ) != 0) {
+			printf("Can't run dot, graph isn't rendered\n");
+		}
+	}
+	return true;
 }
 
 int main(int argc, char *argv[]) {
-	if (argc != 2) {
-		printf("Pleace choose file to parse!\n");
+	if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+		return RunBatch(argc - 2, argv + 2);
+	}
+	MainOptions options = {0};
+	if (!ParseOptions(argc, argv, &options)) {
+		printf("Pleace choose file to parse!\n"
+			"Usage: ./rbc [--export=dot|jsonl|sexp] [--max-depth=N] [--max-nodes=N] [--out=FILE] [--render]\n"
+			"             [--parallel=N] file\n"
+			"       ./rbc - (stdin) | ./rbc --batch [--threads=N] file_or_dir...\n");
 		return 0;
 	}
 
 	uint64_t n_tokens2 = 0;
 	// For example: "../../examples/function.rbc"
-	char *source = GetSourceText(argv[1]);
-	GEN_Token *sequence2 = GEN_Tokenizer(source, &n_tokens2);
+	GEN_Source *source = GEN_OpenSource(options.source);
+	if (source == NULL) {
+		printf("Can't open: %s\n", options.source);
+		return 1;
+	}
+	GEN_Token *sequence2 = GEN_Tokenizer(source->txt, source->len, &n_tokens2);
 
 	for (uint64_t cur_token = 0; cur_token < n_tokens2; ++cur_token) {
-		printf("t(%zu)|%s -- %s\n",
+		printf("t(%zu)|%.*s -- %s\n",
 			cur_token,
-			sequence2[cur_token].txt,
+			(int)sequence2[cur_token].len, sequence2[cur_token].txt,
 			GEN_TranslateTokenType(sequence2[cur_token].type));
 	}
 
 	GEN_Tree t = {0};
 	GEN_Context ctx = {0};
-	GEN_AddChild(&t, GEN_CreateNode(&t, sequence2 + n_tokens2 - 1));
-	ParseSequence(&t, sequence2, ctx, n_tokens2);
-	GEN_CompressTree(&t, t.root);
+	// Rules with one child and symbols of %elide aren't nodes.
+	t.compress = true;
+	GEN_AddChild(&t, GEN_CreateNode(&t, &GEN_eof_token));
+#ifdef GEN_PARALLEL
+	if (options.parallel > 0) {
+		ParseSequenceParallel(&t, sequence2, ctx, (int64_t)n_tokens2, options.parallel);
+	} else
+#endif
+	{
+		// Parser pulls tokens from the source text by itself.
+		GEN_Lexer *lx = GEN_LexerCtor(source->txt, source->len);
+		ParseLexer(&t, lx, ctx);
+		GEN_LexerDtor(lx);
+	}
+
+	bool exported = ExportTree(&t, &options);
+#ifdef GEN_PROFILE
+	GEN_DumpProfile(stdout, false);
+#endif
 
-	GEN_DebugTree(&t);
+	GEN_TreeFree(&t);
+	free(sequence2);
+	GEN_CloseSource(source);
 
-	return 0;
+	return (exported)? 0 : 1;
 }
\ No newline at end of file
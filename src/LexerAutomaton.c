@@ -0,0 +1,950 @@
+/**
+ * @file LexerAutomaton.c
+ *
+ * Builds lexer's automaton at generation time.
+ * All literal tokens and regex-expressions of YACC-file are compiled
+ * to one nondeterministic automaton (Thompson's construction), which is
+ * converted to deterministic one (subset construction) and minimized.
+ * Generated tokenizer walks through the tables of this automaton and
+ * doesn't need any regex library at runtime.
+ */
+#include <include/RebeccaGenerator.h>
+#include <MchlkrpchLogger/logger.h>
+
+/// Number of possible values of one byte.
+#define kAlphabetSize 256
+/// Number of words in bitset of one byte set.
+#define kByteSetWords (kAlphabetSize / 64)
+
+/**
+ * @brief Types of states in nondeterministic automaton.
+ */
+typedef enum NfaStateType
+{
+	// Transition by set of bytes to (out).
+	NFA_BYTE_SET,
+	// Empty transition to (out).
+	NFA_EPSILON,
+	// Empty transitions to (out) and (out_alt).
+	NFA_SPLIT,
+	// Final state of lexer's rule.
+	NFA_ACCEPT,
+} NfaStateType;
+
+typedef struct NfaState
+{
+	NfaStateType type;
+	// Set of bytes for (NFA_BYTE_SET)-states.
+	uint64_t     set[kByteSetWords];
+	int64_t      out;
+	int64_t      out_alt;
+	// Index of lexer's rule for (NFA_ACCEPT)-states.
+	int64_t      rule;
+} NfaState;
+
+typedef struct Nfa
+{
+	size_t    size;
+	size_t    capacity;
+	NfaState *states;
+} Nfa;
+
+/**
+ * @brief Part of automaton with one entry and one exit.
+ * Exit is always (NFA_EPSILON)-state with not set (out).
+ */
+typedef struct NfaFragment
+{
+	int64_t start;
+	int64_t end;
+} NfaFragment;
+
+/**
+ * @brief State of regex-expression parser.
+ */
+typedef struct RegexParser
+{
+	const char *cursor;
+	const char *end;
+	Nfa        *nfa;
+} RegexParser;
+
+static inline __attribute__((always_inline))
+void ByteSetAdd(uint64_t *set, uint8_t c)
+{ set[c >> 6] |= (uint64_t)1 << (c & 63); }
+
+static inline __attribute__((always_inline))
+bool ByteSetHas(const uint64_t *set, uint8_t c)
+{ return (set[c >> 6] >> (c & 63)) & 1; }
+
+/**
+ * @brief Appends new state to automaton.
+ * @returns   Index of new state.
+ */
+static int64_t NfaAddState(Nfa *nfa, NfaStateType type)
+{
+	assert(nfa != NULL && "Null param");
+
+	if (nfa->size == nfa->capacity) {
+		nfa->capacity = (nfa->capacity == 0)? 64 : nfa->capacity << 1;
+		nfa->states = (NfaState *)realloc(nfa->states, nfa->capacity * sizeof(NfaState));
+		assert(nfa->states != NULL && "Null reallocation");
+	}
+
+	NfaState *state = nfa->states + nfa->size;
+	memset(state, 0, sizeof(NfaState));
+	state->type    = type;
+	state->out     = kUndefinedIdx;
+	state->out_alt = kUndefinedIdx;
+	state->rule    = kUndefinedIdx;
+
+	return (int64_t)nfa->size++;
+}
+
+/**
+ * @brief Creates fragment which accepts one byte from (set).
+ */
+static NfaFragment NfaByteSet(Nfa *nfa, const uint64_t *set)
+{
+	NfaFragment f = {0};
+
+	f.start = NfaAddState(nfa, NFA_BYTE_SET);
+	f.end   = NfaAddState(nfa, NFA_EPSILON);
+
+	memcpy(nfa->states[f.start].set, set, sizeof(nfa->states[f.start].set));
+	nfa->states[f.start].out = f.end;
+
+	return f;
+}
+
+/// Creates fragment which accepts empty string.
+static NfaFragment NfaEmpty(Nfa *nfa)
+{
+	NfaFragment f = {0};
+
+	f.start = NfaAddState(nfa, NFA_EPSILON);
+	f.end   = f.start;
+
+	return f;
+}
+
+/// Connects exit of (first) with entry of (second).
+static NfaFragment NfaConcat(Nfa *nfa, NfaFragment first, NfaFragment second)
+{
+	nfa->states[first.end].out = second.start;
+
+	NfaFragment f = {first.start, second.end};
+	return f;
+}
+
+/// Creates fragment which accepts (first) or (second).
+static NfaFragment NfaAlternate(Nfa *nfa, NfaFragment first, NfaFragment second)
+{
+	NfaFragment f = {0};
+
+	f.start = NfaAddState(nfa, NFA_SPLIT);
+	f.end   = NfaAddState(nfa, NFA_EPSILON);
+
+	nfa->states[f.start].out     = first.start;
+	nfa->states[f.start].out_alt = second.start;
+	nfa->states[first.end].out   = f.end;
+	nfa->states[second.end].out  = f.end;
+
+	return f;
+}
+
+/**
+ * @brief Creates repetition of (inner) fragment.
+ *
+ * @param min_one    (inner) has to be accepted at least once: (+).
+ * @param max_one    (inner) can be accepted only once: (?).
+ */
+static NfaFragment NfaRepeat(Nfa *nfa, NfaFragment inner, bool min_one, bool max_one)
+{
+	NfaFragment f = {0};
+
+	f.start = NfaAddState(nfa, NFA_SPLIT);
+	f.end   = NfaAddState(nfa, NFA_EPSILON);
+
+	nfa->states[f.start].out     = inner.start;
+	nfa->states[f.start].out_alt = f.end;
+
+	if (max_one) {
+		nfa->states[inner.end].out = f.end;
+	} else {
+		// Return to the beginning of fragment after each repetition.
+		nfa->states[inner.end].out = f.start;
+	}
+
+	if (min_one) {
+		f.start = inner.start;
+	}
+
+	return f;
+}
+
+/**
+ * @brief Translates escaped symbol (c) after (\\)-symbol.
+ * @returns   Meaning of escaped symbol.
+ */
+static char UnescapeSym(char c)
+{
+	switch (c) {
+		case 'n': { return '\n'; }
+		case 't': { return '\t'; }
+		case 'r': { return '\r'; }
+		case 'f': { return '\f'; }
+		case 'v': { return '\v'; }
+		case '0': { return '\0'; }
+
+		default: {
+			return c;
+		}
+	}
+}
+
+/**
+ * @brief Fills (set) with predefined class of symbols
+ * such as (\\d), (\\w), (\\s).
+ *
+ * @returns   true if (c) is name of predefined class.
+ */
+static bool ByteSetPredefined(uint64_t *set, char c)
+{
+	switch (c) {
+		case 'd': {
+			for (int sym = '0'; sym <= '9'; ++sym) { ByteSetAdd(set, sym); }
+			return true;
+		}
+		case 'w': {
+			for (int sym = 'a'; sym <= 'z'; ++sym) { ByteSetAdd(set, sym); }
+			for (int sym = 'A'; sym <= 'Z'; ++sym) { ByteSetAdd(set, sym); }
+			for (int sym = '0'; sym <= '9'; ++sym) { ByteSetAdd(set, sym); }
+			ByteSetAdd(set, '_');
+			return true;
+		}
+		case 's': {
+			ByteSetAdd(set, ' ');
+			ByteSetAdd(set, '\t');
+			ByteSetAdd(set, '\n');
+			ByteSetAdd(set, '\r');
+			ByteSetAdd(set, '\f');
+			ByteSetAdd(set, '\v');
+			return true;
+		}
+
+		default: {
+			return false;
+		}
+	}
+}
+
+static inline __attribute__((always_inline))
+bool RegexEnd(RegexParser *rp)
+{ return rp->cursor >= rp->end; }
+
+/**
+ * @brief Reads one (maybe escaped) symbol of regex-expression.
+ */
+static char RegexReadSym(RegexParser *rp)
+{
+	assert(!RegexEnd(rp) && "Unexpected end of regex-expression");
+
+	char c = *rp->cursor++;
+	if (c == kEscapeSym) {
+		assert(!RegexEnd(rp) && "Escape symbol at the end of regex-expression");
+		c = UnescapeSym(*rp->cursor++);
+	}
+
+	return c;
+}
+
+/**
+ * @brief Parses bracket expression: ([a-z_]) or ([^0-9]).
+ * Cursor is set after ([)-symbol.
+ */
+static NfaFragment RegexParseBrackets(RegexParser *rp)
+{
+	uint64_t set[kByteSetWords] = {0};
+
+	bool negate = false;
+	if (!RegexEnd(rp) && *rp->cursor == '^') {
+		negate = true;
+		++rp->cursor;
+	}
+
+	// (]) right after ([) or ([^) is common symbol.
+	bool first = true;
+	while (!RegexEnd(rp) && (*rp->cursor != ']' || first)) {
+		first = false;
+
+		if (*rp->cursor == kEscapeSym && rp->cursor + 1 < rp->end &&
+				ByteSetPredefined(set, *(rp->cursor + 1))) {
+			rp->cursor += 2;
+			continue;
+		}
+
+		uint8_t low = (uint8_t)RegexReadSym(rp);
+		uint8_t high = low;
+
+		if (rp->cursor + 1 < rp->end && *rp->cursor == '-' && *(rp->cursor + 1) != ']') {
+			++rp->cursor;
+			high = (uint8_t)RegexReadSym(rp);
+		}
+		assert(low <= high && "Wrong range in regex-expression");
+
+		for (unsigned sym = low; sym <= high; ++sym) {
+			ByteSetAdd(set, (uint8_t)sym);
+		}
+	}
+	assert(!RegexEnd(rp) && "Not closed bracket in regex-expression");
+	// Skip (]).
+	++rp->cursor;
+
+	if (negate) {
+		for (size_t word = 0; word < kByteSetWords; ++word) {
+			set[word] = ~set[word];
+		}
+	}
+
+	return NfaByteSet(rp->nfa, set);
+}
+
+static NfaFragment RegexParseAlternation(RegexParser *rp);
+
+/**
+ * @brief Parses one atom of regex-expression:
+ * symbol, class of symbols or expression in parenthesis.
+ */
+static NfaFragment RegexParseAtom(RegexParser *rp)
+{
+	uint64_t set[kByteSetWords] = {0};
+
+	char c = *rp->cursor;
+	switch (c) {
+		case '(': {
+			++rp->cursor;
+			NfaFragment inner = RegexParseAlternation(rp);
+			assert(!RegexEnd(rp) && *rp->cursor == ')' && "Not closed parenthesis in regex-expression");
+			++rp->cursor;
+			return inner;
+		}
+		case '[': {
+			++rp->cursor;
+			return RegexParseBrackets(rp);
+		}
+		case '.': {
+			++rp->cursor;
+			for (size_t word = 0; word < kByteSetWords; ++word) {
+				set[word] = ~(uint64_t)0;
+			}
+			set['\n' >> 6] &= ~((uint64_t)1 << ('\n' & 63));
+			return NfaByteSet(rp->nfa, set);
+		}
+
+		default: {
+			break;
+		}
+	}
+
+	if (c == kEscapeSym && rp->cursor + 1 < rp->end &&
+			ByteSetPredefined(set, *(rp->cursor + 1))) {
+		rp->cursor += 2;
+		return NfaByteSet(rp->nfa, set);
+	}
+
+	ByteSetAdd(set, (uint8_t)RegexReadSym(rp));
+	return NfaByteSet(rp->nfa, set);
+}
+
+/// Parses atom with all it's postfix operators: (*), (+), (?).
+static NfaFragment RegexParseRepeat(RegexParser *rp)
+{
+	NfaFragment f = RegexParseAtom(rp);
+
+	while (!RegexEnd(rp)) {
+		char c = *rp->cursor;
+		if (c == '*') {
+			f = NfaRepeat(rp->nfa, f, false, false);
+		} else if (c == '+') {
+			f = NfaRepeat(rp->nfa, f, true, false);
+		} else if (c == '?') {
+			f = NfaRepeat(rp->nfa, f, false, true);
+		} else {
+			break;
+		}
+		++rp->cursor;
+	}
+
+	return f;
+}
+
+/// Parses sequence of atoms.
+static NfaFragment RegexParseConcat(RegexParser *rp)
+{
+	NfaFragment f = NfaEmpty(rp->nfa);
+
+	while (!RegexEnd(rp) && *rp->cursor != '|' && *rp->cursor != ')') {
+		f = NfaConcat(rp->nfa, f, RegexParseRepeat(rp));
+	}
+
+	return f;
+}
+
+/// Parses options of regex-expression splitted by (|).
+static NfaFragment RegexParseAlternation(RegexParser *rp)
+{
+	NfaFragment f = RegexParseConcat(rp);
+
+	while (!RegexEnd(rp) && *rp->cursor == '|') {
+		++rp->cursor;
+		f = NfaAlternate(rp->nfa, f, RegexParseConcat(rp));
+	}
+
+	return f;
+}
+
+/**
+ * @brief Builds fragment of automaton for one lexer's rule.
+ * Literal rules accepts exactly their text,
+ * regex rules accepts their regex-expression.
+ */
+static NfaFragment NfaFromRule(Nfa *nfa, const LexerRule *rule)
+{
+	assert(nfa  != NULL && "Null param");
+	assert(rule != NULL && "Null param");
+
+	if (rule->is_regex) {
+		RegexParser rp = {rule->pattern, rule->pattern + rule->len, nfa};
+		NfaFragment f = RegexParseAlternation(&rp);
+		assert(RegexEnd(&rp) && "Unexpected symbol in regex-expression");
+
+		return f;
+	}
+
+	NfaFragment f = NfaEmpty(nfa);
+	const char *cursor = rule->pattern;
+	const char *end    = rule->pattern + rule->len;
+
+	while (cursor < end) {
+		char c = *cursor++;
+		if (c == kEscapeSym && cursor < end) {
+			c = UnescapeSym(*cursor++);
+		}
+
+		uint64_t set[kByteSetWords] = {0};
+		ByteSetAdd(set, (uint8_t)c);
+		f = NfaConcat(nfa, f, NfaByteSet(nfa, set));
+	}
+
+	return f;
+}
+
+// Subset construction ----------------------------------------------------------------------
+
+/**
+ * @brief Set of states of nondeterministic automaton which
+ * form one state of deterministic automaton.
+ */
+typedef struct StateSet
+{
+	uint64_t *bits;
+	uint64_t  hash;
+} StateSet;
+
+typedef struct SubsetBuilder
+{
+	const Nfa *nfa;
+	size_t     n_words;
+
+	// All found sets, index of set is index of dfa-state.
+	size_t     size;
+	size_t     capacity;
+	StateSet  *sets;
+
+	// Open addressing table of sets by their hash: index of set + 1, 0 is empty slot.
+	// Number of slots is power of two and at least twice the number of sets.
+	size_t     n_buckets;
+	size_t    *buckets;
+
+	// Stack to build epsilon-closures.
+	int64_t   *stack;
+} SubsetBuilder;
+
+static uint64_t StateSetHash(const uint64_t *bits, size_t n_words)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t word = 0; word < n_words; ++word) {
+		hash ^= bits[word];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Adds to (bits) all states reachable from states of (bits)
+ * by empty transitions.
+ */
+static void EpsilonClosure(SubsetBuilder *sb, uint64_t *bits)
+{
+	size_t top = 0;
+	for (size_t state = 0; state < sb->nfa->size; ++state) {
+		if ((bits[state >> 6] >> (state & 63)) & 1) {
+			sb->stack[top++] = (int64_t)state;
+		}
+	}
+
+	while (top > 0) {
+		const NfaState *state = sb->nfa->states + sb->stack[--top];
+		if (state->type != NFA_EPSILON && state->type != NFA_SPLIT) {
+			continue;
+		}
+
+		int64_t outs[2] = {state->out, state->out_alt};
+		for (size_t cur_out = 0; cur_out < 2; ++cur_out) {
+			int64_t out = outs[cur_out];
+			if (out == kUndefinedIdx || ((bits[out >> 6] >> (out & 63)) & 1)) {
+				continue;
+			}
+
+			bits[out >> 6] |= (uint64_t)1 << (out & 63);
+			sb->stack[top++] = out;
+		}
+	}
+}
+
+/**
+ * @brief Doubles table of buckets and places all the sets again.
+ */
+static void SubsetRehash(SubsetBuilder *sb)
+{
+	sb->n_buckets = (sb->n_buckets == 0)? 128 : sb->n_buckets << 1;
+	free(sb->buckets);
+	sb->buckets = (size_t *)calloc(sb->n_buckets, sizeof(size_t));
+	assert(sb->buckets != NULL && "Null calloc allocation");
+
+	for (size_t cur_set = 0; cur_set < sb->size; ++cur_set) {
+		size_t slot = sb->sets[cur_set].hash & (sb->n_buckets - 1);
+		while (sb->buckets[slot] != 0) {
+			slot = (slot + 1) & (sb->n_buckets - 1);
+		}
+		sb->buckets[slot] = cur_set + 1;
+	}
+}
+
+/**
+ * @brief Finds set (bits) among already built states or adds it.
+ * Only sets of the same bucket chain are compared.
+ * @returns   Index of dfa-state. Takes ownership of (bits) if it's new state.
+ */
+static size_t SubsetFindOrAdd(SubsetBuilder *sb, uint64_t *bits, bool *is_new)
+{
+	uint64_t hash = StateSetHash(bits, sb->n_words);
+
+	if (2 * (sb->size + 1) > sb->n_buckets) {
+		SubsetRehash(sb);
+	}
+
+	size_t slot = hash & (sb->n_buckets - 1);
+	for (; sb->buckets[slot] != 0; slot = (slot + 1) & (sb->n_buckets - 1)) {
+		size_t cur_set = sb->buckets[slot] - 1;
+		if (sb->sets[cur_set].hash == hash &&
+				memcmp(sb->sets[cur_set].bits, bits, sb->n_words * sizeof(uint64_t)) == 0) {
+			*is_new = false;
+			return cur_set;
+		}
+	}
+	sb->buckets[slot] = sb->size + 1;
+
+	if (sb->size == sb->capacity) {
+		sb->capacity = (sb->capacity == 0)? 64 : sb->capacity << 1;
+		sb->sets = (StateSet *)realloc(sb->sets, sb->capacity * sizeof(StateSet));
+		assert(sb->sets != NULL && "Null reallocation");
+	}
+
+	sb->sets[sb->size].bits = bits;
+	sb->sets[sb->size].hash = hash;
+	*is_new = true;
+
+	return sb->size++;
+}
+
+/**
+ * @brief Splits alphabet to classes of bytes. Bytes are in
+ * the same class if every (NFA_BYTE_SET)-state treats them equally.
+ *
+ * @returns   Number of classes.
+ */
+static size_t BuildByteClasses(const Nfa *nfa, uint16_t *byte_class, uint8_t *representative)
+{
+	size_t n_classes = 0;
+
+	for (unsigned c = 0; c < kAlphabetSize; ++c) {
+		byte_class[c] = UINT16_MAX;
+
+		for (size_t cur_class = 0; cur_class < n_classes && byte_class[c] == UINT16_MAX; ++cur_class) {
+			uint8_t other = representative[cur_class];
+			bool same = true;
+
+			for (size_t state = 0; state < nfa->size && same; ++state) {
+				if (nfa->states[state].type == NFA_BYTE_SET) {
+					same = ByteSetHas(nfa->states[state].set, (uint8_t)c) ==
+					       ByteSetHas(nfa->states[state].set, other);
+				}
+			}
+
+			if (same) {
+				byte_class[c] = (uint16_t)cur_class;
+			}
+		}
+
+		if (byte_class[c] == UINT16_MAX) {
+			representative[n_classes] = (uint8_t)c;
+			byte_class[c] = (uint16_t)n_classes++;
+		}
+	}
+
+	return n_classes;
+}
+
+/**
+ * @brief Rule accepted by set of nfa-states. If several rules
+ * are accepted then the rule with the least index wins.
+ */
+static int64_t SubsetAccept(const Nfa *nfa, const uint64_t *bits)
+{
+	int64_t accept = kUndefinedIdx;
+
+	for (size_t state = 0; state < nfa->size; ++state) {
+		if (((bits[state >> 6] >> (state & 63)) & 1) && nfa->states[state].type == NFA_ACCEPT) {
+			if (accept == kUndefinedIdx || nfa->states[state].rule < accept) {
+				accept = nfa->states[state].rule;
+			}
+		}
+	}
+
+	return accept;
+}
+
+// Minimization -----------------------------------------------------------------------------
+
+/**
+ * @brief Minimizes automaton by Moore's algorithm: states are
+ * splitted into groups with equal accepted rule and then groups are refined
+ * by groups of their transitions until nothing changes.
+ * Each round finds equal signatures by hash table, so it's linear in size of table
+ * of transitions. Groups are numbered in order of their first state.
+ *
+ * @param next         Transitions of not minimized automaton.
+ * @param accept       Accepted rules of not minimized automaton.
+ * @param group        Output: group of each state.
+ * @returns            Number of groups.
+ */
+static size_t MinimizeStates
+	(size_t n_states, size_t n_classes, const uint32_t *next, const int64_t *accept, uint32_t *group)
+{
+	// Signature of state: it's group and groups of all transitions.
+	size_t    sig_len    = n_classes + 1;
+	int64_t  *signatures = (int64_t *)calloc(n_states * sig_len, sizeof(int64_t));
+	int64_t  *new_group  = (int64_t *)calloc(n_states, sizeof(int64_t));
+	// Open addressing table of states with different signatures: state + 1, 0 is empty slot.
+	size_t    n_buckets  = 1;
+	while (n_buckets < 2 * n_states) {
+		n_buckets <<= 1;
+	}
+	size_t   *buckets    = (size_t *)calloc(n_buckets, sizeof(size_t));
+	assert(signatures != NULL && new_group != NULL && buckets != NULL && "Null calloc allocation");
+
+	// Initial partition: states that accept the same rule.
+	for (size_t state = 0; state < n_states; ++state) {
+		signatures[state * sig_len] = accept[state];
+	}
+
+	size_t n_groups = 0;
+	size_t prev_n_groups = 0;
+	size_t cur_len = 1;
+
+	while (true) {
+		n_groups = 0;
+		memset(buckets, 0, n_buckets * sizeof(size_t));
+		for (size_t state = 0; state < n_states; ++state) {
+			const int64_t *sig  = signatures + state * sig_len;
+			size_t         slot = StateSetHash((const uint64_t *)sig, cur_len) & (n_buckets - 1);
+
+			new_group[state] = kUndefinedIdx;
+			for (; buckets[slot] != 0; slot = (slot + 1) & (n_buckets - 1)) {
+				size_t other = buckets[slot] - 1;
+				if (memcmp(signatures + other * sig_len, sig, cur_len * sizeof(int64_t)) == 0) {
+					new_group[state] = new_group[other];
+					break;
+				}
+			}
+
+			if (new_group[state] == kUndefinedIdx) {
+				buckets[slot]    = state + 1;
+				new_group[state] = (int64_t)n_groups++;
+			}
+		}
+
+		if (n_groups == prev_n_groups) {
+			break;
+		}
+		prev_n_groups = n_groups;
+
+		for (size_t state = 0; state < n_states; ++state) {
+			int64_t *sig = signatures + state * sig_len;
+			sig[0] = new_group[state];
+			for (size_t cur_class = 0; cur_class < n_classes; ++cur_class) {
+				sig[cur_class + 1] = new_group[next[state * n_classes + cur_class]];
+			}
+		}
+		cur_len = sig_len;
+	}
+
+	for (size_t state = 0; state < n_states; ++state) {
+		group[state] = (uint32_t)new_group[state];
+	}
+
+	free(signatures);
+	free(new_group);
+	free(buckets);
+
+	return n_groups;
+}
+
+/**
+ * @brief Merges classes of bytes with equal columns
+ * in transition table of minimized automaton.
+ */
+static void MergeByteClasses(LexerDfa *dfa)
+{
+	uint16_t *new_class = (uint16_t *)calloc(dfa->n_classes, sizeof(uint16_t));
+	size_t   *old_of    = (size_t *)calloc(dfa->n_classes, sizeof(size_t));
+	assert(new_class != NULL && old_of != NULL && "Null calloc allocation");
+
+	size_t n_classes = 0;
+	for (size_t cur_class = 0; cur_class < dfa->n_classes; ++cur_class) {
+		new_class[cur_class] = UINT16_MAX;
+
+		for (size_t other = 0; other < n_classes && new_class[cur_class] == UINT16_MAX; ++other) {
+			bool same = true;
+			for (size_t state = 0; state < dfa->n_states && same; ++state) {
+				same = dfa->next[state * dfa->n_classes + cur_class] ==
+				       dfa->next[state * dfa->n_classes + old_of[other]];
+			}
+
+			if (same) {
+				new_class[cur_class] = (uint16_t)other;
+			}
+		}
+
+		if (new_class[cur_class] == UINT16_MAX) {
+			old_of[n_classes] = cur_class;
+			new_class[cur_class] = (uint16_t)n_classes++;
+		}
+	}
+
+	uint32_t *next = (uint32_t *)calloc(dfa->n_states * n_classes, sizeof(uint32_t));
+	assert(next != NULL && "Null calloc allocation");
+
+	for (size_t state = 0; state < dfa->n_states; ++state) {
+		for (size_t cur_class = 0; cur_class < n_classes; ++cur_class) {
+			next[state * n_classes + cur_class] = dfa->next[state * dfa->n_classes + old_of[cur_class]];
+		}
+	}
+
+	for (unsigned c = 0; c < kAlphabetSize; ++c) {
+		dfa->byte_class[c] = new_class[dfa->byte_class[c]];
+	}
+
+	free(dfa->next);
+	dfa->next      = next;
+	dfa->n_classes = n_classes;
+
+	free(new_class);
+	free(old_of);
+}
+
+/**
+ * @brief Compiles all the lexer's rules to one minimized
+ * deterministic automaton.
+ *
+ * State (kLexerDeadState) has no way to any final state,
+ * automaton starts from (kLexerStartState).
+ * Rule with less index has priority if several rules
+ * accept the same word.
+ *
+ * @param rules     Lexer's rules in order of priority.
+ * @param n_rules   Number of rules.
+ * @returns         Allocated automaton.
+ */
+LexerDfa *BuildLexerDfa(const LexerRule *rules, size_t n_rules)
+{
+	assert(rules != NULL && "Null param");
+
+	msg(D_PARSER_GENERATING, M,
+		"Start building lexer's automaton for %lu rules\n", n_rules);
+
+	Nfa nfa = {0};
+	int64_t nfa_start = NfaAddState(&nfa, NFA_SPLIT);
+	int64_t last_split = nfa_start;
+
+	for (size_t cur_rule = 0; cur_rule < n_rules; ++cur_rule) {
+		NfaFragment f = NfaFromRule(&nfa, rules + cur_rule);
+
+		int64_t accept = NfaAddState(&nfa, NFA_ACCEPT);
+		nfa.states[accept].rule = (int64_t)cur_rule;
+		nfa.states[f.end].out = accept;
+
+		//  Start state is chain of splits
+		// with entries to all rules.
+		int64_t split = NfaAddState(&nfa, NFA_SPLIT);
+		nfa.states[last_split].out_alt = split;
+		nfa.states[split].out = f.start;
+		last_split = split;
+	}
+
+	msg(D_PARSER_GENERATING, M,
+		"Nondeterministic automaton has %lu states\n", nfa.size);
+
+	uint16_t byte_class[kAlphabetSize] = {0};
+	uint8_t  representative[kAlphabetSize] = {0};
+	size_t   n_classes = BuildByteClasses(&nfa, byte_class, representative);
+
+	SubsetBuilder sb = {0};
+	sb.nfa     = &nfa;
+	sb.n_words = (nfa.size + 63) / 64;
+	sb.stack   = (int64_t *)calloc(nfa.size, sizeof(int64_t));
+	assert(sb.stack != NULL && "Null calloc allocation");
+
+	bool is_new = false;
+	// Dead state is empty set.
+	SubsetFindOrAdd(&sb, (uint64_t *)calloc(sb.n_words, sizeof(uint64_t)), &is_new);
+
+	uint64_t *start_bits = (uint64_t *)calloc(sb.n_words, sizeof(uint64_t));
+	assert(start_bits != NULL && "Null calloc allocation");
+	start_bits[nfa_start >> 6] |= (uint64_t)1 << (nfa_start & 63);
+	EpsilonClosure(&sb, start_bits);
+	SubsetFindOrAdd(&sb, start_bits, &is_new);
+
+	size_t    next_capacity = 64;
+	uint32_t *next = (uint32_t *)calloc(next_capacity * n_classes, sizeof(uint32_t));
+	assert(next != NULL && "Null calloc allocation");
+
+	// States are processed in order of their appearance.
+	for (size_t cur_state = 0; cur_state < sb.size; ++cur_state) {
+		for (size_t cur_class = 0; cur_class < n_classes; ++cur_class) {
+			uint64_t *bits = (uint64_t *)calloc(sb.n_words, sizeof(uint64_t));
+			assert(bits != NULL && "Null calloc allocation");
+
+			const uint64_t *from = sb.sets[cur_state].bits;
+			for (size_t state = 0; state < nfa.size; ++state) {
+				if (((from[state >> 6] >> (state & 63)) & 1) &&
+						nfa.states[state].type == NFA_BYTE_SET &&
+						ByteSetHas(nfa.states[state].set, representative[cur_class])) {
+					int64_t out = nfa.states[state].out;
+					bits[out >> 6] |= (uint64_t)1 << (out & 63);
+				}
+			}
+			EpsilonClosure(&sb, bits);
+
+			size_t target = SubsetFindOrAdd(&sb, bits, &is_new);
+			if (!is_new) {
+				free(bits);
+			}
+
+			if (cur_state >= next_capacity) {
+				next_capacity <<= 1;
+				next = (uint32_t *)realloc(next, next_capacity * n_classes * sizeof(uint32_t));
+				assert(next != NULL && "Null reallocation");
+			}
+			next[cur_state * n_classes + cur_class] = (uint32_t)target;
+		}
+	}
+
+	size_t   n_states = sb.size;
+	int64_t *accept   = (int64_t *)calloc(n_states, sizeof(int64_t));
+	assert(accept != NULL && "Null calloc allocation");
+
+	for (size_t state = 0; state < n_states; ++state) {
+		accept[state] = SubsetAccept(&nfa, sb.sets[state].bits);
+	}
+
+	msg(D_PARSER_GENERATING, M,
+		"Deterministic automaton has %lu states and %lu classes of bytes\n",
+		n_states, n_classes);
+
+	uint32_t *group = (uint32_t *)calloc(n_states, sizeof(uint32_t));
+	assert(group != NULL && "Null calloc allocation");
+	size_t n_groups = MinimizeStates(n_states, n_classes, next, accept, group);
+
+	//  Groups are numbered in order of their first state and
+	// dead and start states are first states of subset construction
+	// so they keep their indices. Only if automaton accepts no word at all
+	// (grammar has no tokens) start state is equal to dead state:
+	// then it gets it's own copy of dead state's row after it.
+	assert(group[kLexerDeadState] == kLexerDeadState && "Dead state isn't the first group");
+	bool start_is_dead = (group[kLexerStartState] == group[kLexerDeadState]);
+	assert((start_is_dead || group[kLexerStartState] == kLexerStartState) && "Start state isn't the second group");
+	if (start_is_dead) {
+		for (size_t state = 0; state < n_states; ++state) {
+			group[state] += (group[state] != kLexerDeadState);
+		}
+		++n_groups;
+	}
+
+	LexerDfa *dfa = (LexerDfa *)calloc(1, sizeof(LexerDfa));
+	assert(dfa != NULL && "Null calloc allocation");
+
+	dfa->n_states  = n_groups;
+	dfa->n_classes = n_classes;
+	dfa->next      = (uint32_t *)calloc(n_groups * n_classes, sizeof(uint32_t));
+	dfa->accept    = (int64_t *)calloc(n_groups, sizeof(int64_t));
+	assert(dfa->next != NULL && dfa->accept != NULL && "Null calloc allocation");
+
+	for (size_t state = 0; state < n_states; ++state) {
+		uint32_t row = (start_is_dead && state == kLexerStartState)? kLexerStartState : group[state];
+		dfa->accept[row] = accept[state];
+		for (size_t cur_class = 0; cur_class < n_classes; ++cur_class) {
+			dfa->next[row * n_classes + cur_class] = group[next[state * n_classes + cur_class]];
+		}
+	}
+	for (unsigned c = 0; c < kAlphabetSize; ++c) {
+		dfa->byte_class[c] = byte_class[c];
+	}
+
+	MergeByteClasses(dfa);
+
+	msg(D_PARSER_GENERATING, M,
+		"Minimized automaton has %lu states and %lu classes of bytes\n",
+		dfa->n_states, dfa->n_classes);
+
+	for (size_t cur_set = 0; cur_set < sb.size; ++cur_set) {
+		free(sb.sets[cur_set].bits);
+	}
+	free(sb.sets);
+	free(sb.buckets);
+	free(sb.stack);
+	free(next);
+	free(accept);
+	free(group);
+	free(nfa.states);
+
+	return dfa;
+}
+
+/// Frees lexer's automaton.
+void LexerDfaDtor(LexerDfa *dfa)
+{
+	if (dfa == NULL) {
+		return;
+	}
+
+	free(dfa->next);
+	free(dfa->accept);
+	free(dfa);
+}
+
+#undef kAlphabetSize
+#undef kByteSetWords
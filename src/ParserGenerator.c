@@ -1,9 +1,33 @@
+#include <ctype.h>
+#include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include <include/RebeccaGenerator.h>
 #include <MchlkrpchLogger/logger.h>
 
+/// Maximal depth of tabs in generated functions.
+#define kMaxTabsLen 256
+/// Maximal number of byte ranges in run which generated lexer skips by SIMD.
+#define kMaxRunRanges 4
+/// Maximal number of different runs of generated lexer (index of run is one byte).
+#define kMaxLexerRuns 255
+/// Maximal length of word of regex-expression in synthetic corpus which is chosen at random.
+#define kMaxCorpusWordLen 8
+/// Number of tries to synthesize word which is separated from the next token by white space.
+#define kMaxCorpusWordTries 16
+/// Length of line of synthetic corpus after which tokens are separated by new line.
+#define kCorpusLineLen 80
+
+/// Set of bytes as ranges [lo, lo + last].
+typedef struct ByteRun
+{
+	uint8_t n_ranges;
+	uint8_t lo[kMaxRunRanges];
+	uint8_t last[kMaxRunRanges];
+} ByteRun;
+
 /**
  * @brief Adds to t->current new child 's['idx']'and
  * increments 'current_token_idx'.
@@ -24,7 +48,8 @@ static void WorkOutToken(Tree *t, Token *s, uint64_t *idx)
 
 /**
  * @brief Checks if the txt data of current node in nametable
- * contain phony variable such as (splitters), (start), (white_space).
+ * contain phony variable such as (splitters), (start), (white_space), (elide)
+ * levels of precedence (left), (right), (nonassoc) and (parallel_unit).
  * 
  * @param tokenizer_table    Name tokenizer_table of current node.
  * @param cur_el   Index of curren node in (tokenizer_table).
@@ -33,9 +58,14 @@ static void WorkOutToken(Tree *t, Token *s, uint64_t *idx)
 bool PhonyVariables(NameTable *tokenizer_table, uint64_t cur_el)
 {
 	return
-		strcmp(GetTxt(tokenizer_table->names[cur_el]), "splitters")   == 0 ||
-		strcmp(GetTxt(tokenizer_table->names[cur_el]), "start")       == 0 ||
-		strcmp(GetTxt(tokenizer_table->names[cur_el]), "white_space") == 0;
+		TxtEqual(tokenizer_table->names[cur_el], "splitters")   ||
+		TxtEqual(tokenizer_table->names[cur_el], "start")       ||
+		TxtEqual(tokenizer_table->names[cur_el], "white_space") ||
+		TxtEqual(tokenizer_table->names[cur_el], "elide")       ||
+		TxtEqual(tokenizer_table->names[cur_el], "left")        ||
+		TxtEqual(tokenizer_table->names[cur_el], "right")       ||
+		TxtEqual(tokenizer_table->names[cur_el], "nonassoc")    ||
+		TxtEqual(tokenizer_table->names[cur_el], "parallel_unit");
 }
 
 /**
@@ -61,8 +91,8 @@ static void GenerateTrees(Tree *parser_tree, Tree *tokenizer_tree, Token *s, uin
 	for (; token_idx < n_tokens; ++token_idx) {
 		if (s[token_idx].type == TOKEN_PERCENT) {
 			msg(D_PARSER_GENERATING, M,
-				"Current token in s:(%s)\n",
-				s[token_idx].txt);
+				"Current token in s:(%.*s)\n",
+				(int)s[token_idx].len, s[token_idx].txt);
 			//  Skip this token
 			// And next tokens will be: NAME, EQ, char-data.
 			++token_idx;
@@ -118,6 +148,24 @@ static void GenerateTrees(Tree *parser_tree, Tree *tokenizer_tree, Token *s, uin
 						break;
 					}
 
+					// (*) and (+) are repetitions of previous symbol of option.
+					if (
+							s[token_idx].type == TOKEN_STAR ||
+							s[token_idx].type == TOKEN_PLUS) {
+						assert(parser_tree->current != parent && "Repetition without symbol");
+						parser_tree->current->token->repeat =
+							(s[token_idx].type == TOKEN_STAR)? REPEAT_STAR : REPEAT_PLUS;
+						++token_idx;
+						continue;
+					}
+					// (!) is cut after previous symbol of option.
+					if (s[token_idx].type == TOKEN_BANG) {
+						assert(parser_tree->current != parent && "Cut without symbol");
+						parser_tree->current->token->cut = true;
+						++token_idx;
+						continue;
+					}
+
 					WorkOutToken(parser_tree, s, &token_idx);
 				}
 
@@ -138,6 +186,60 @@ static void GenerateTrees(Tree *parser_tree, Tree *tokenizer_tree, Token *s, uin
 	}
 }
 
+/// Hash of text (FNV-1a) for table of names.
+static uint64_t TxtHash(const char *txt, size_t len)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t cur_sym = 0; cur_sym < len; ++cur_sym) {
+		hash = (hash ^ (uint8_t)txt[cur_sym]) * 1099511628211ull;
+	}
+	return hash ^ (hash >> 32);
+}
+
+/// @returns   Empty table of names.
+static NameTable *NameTableCtor()
+{
+	NameTable *table = (NameTable *)calloc(1, sizeof(NameTable));
+	assert(table != NULL && "Null calloc allocation");
+
+	table->capacity = kInitSizeNamesArray;
+	table->names    = (Node **)calloc(table->capacity, sizeof(Node *));
+	table->n_slots  = 2 * kInitSizeNamesArray;
+	table->slots    = (int64_t *)malloc(table->n_slots * sizeof(int64_t));
+	assert(table->names != NULL && table->slots != NULL && "Null calloc allocation");
+	for (size_t cur_slot = 0; cur_slot < table->n_slots; ++cur_slot) {
+		table->slots[cur_slot] = kUndefinedIdx;
+	}
+
+	return table;
+}
+
+static void NameTableDtor(NameTable *table)
+{
+	assert(table != NULL && "Null param");
+
+	free(table->names);
+	free(table->slots);
+	free(table);
+}
+
+/**
+ * @returns   Slot of name with text (txt) or empty slot
+ * where this name should be added.
+ */
+static size_t FindSlot(NameTable *table, const char *txt, size_t len)
+{
+	size_t slot = TxtHash(txt, len) & (table->n_slots - 1);
+	while (table->slots[slot] != kUndefinedIdx) {
+		Node *name = table->names[table->slots[slot]];
+		if (GetLen(name) == len && memcmp(GetTxt(name), txt, len) == 0) {
+			break;
+		}
+		slot = (slot + 1) & (table->n_slots - 1);
+	}
+	return slot;
+}
+
 /**
  * @return
  * Index of token with the same text-data as in (n).
@@ -148,24 +250,29 @@ static int64_t SearchInTable(Node *n, NameTable *tokenizer_table)
 	assert(n     != NULL && "Null parametr\n");
 	assert(tokenizer_table != NULL && "Null parametr\n");
 
-	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
-		//  Search node in nametable with
-		// the same data as in (n).
-		if (strcmp(GetTxt(tokenizer_table->names[cur_el]), GetTxt(n)) == 0) {
-			msg(D_NAMETABLE, M,
-				"Already exists\n");
-
-			return cur_el;
-		}
+	int64_t idx = tokenizer_table->slots[FindSlot(tokenizer_table, GetTxt(n), GetLen(n))];
+	if (idx != kUndefinedIdx) {
+		msg(D_NAMETABLE, M,
+			"Already exists\n");
 	}
 
-	return kUndefinedIdx;
+	return idx;
+}
+
+/// @returns   Index of name (txt) in (table) or (kUndefinedIdx).
+static int64_t FindName(NameTable *table, const char *txt)
+{
+	assert(table != NULL && "Null param");
+	assert(txt   != NULL && "Null param");
+
+	return table->slots[FindSlot(table, txt, strlen(txt))];
 }
 
 /**
  * @brief If node (n) is already in nametable
  * doesn't make any changes. If node (n) not in tokenizer_table
- * add's it to nametable.
+ * add's it to nametable. Array of names and hash table
+ * are doubled when they are full.
  * 
  * @return   true if node (n) wasn't in the tokenizer_table.
  */
@@ -180,8 +287,29 @@ static bool AddName(NameTable *tokenizer_table, Node *n)
 		return false;
 	}
 
+	if (tokenizer_table->size == tokenizer_table->capacity) {
+		tokenizer_table->capacity *= 2;
+		tokenizer_table->names = (Node **)realloc(tokenizer_table->names, tokenizer_table->capacity * sizeof(Node *));
+		assert(tokenizer_table->names != NULL && "Null realloc allocation");
+	}
+	// Load factor of hash table is kept under 1/2.
+	if (2 * (tokenizer_table->size + 1) > tokenizer_table->n_slots) {
+		free(tokenizer_table->slots);
+		tokenizer_table->n_slots *= 2;
+		tokenizer_table->slots = (int64_t *)malloc(tokenizer_table->n_slots * sizeof(int64_t));
+		assert(tokenizer_table->slots != NULL && "Null malloc allocation");
+		for (size_t cur_slot = 0; cur_slot < tokenizer_table->n_slots; ++cur_slot) {
+			tokenizer_table->slots[cur_slot] = kUndefinedIdx;
+		}
+		for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
+			Node *name = tokenizer_table->names[cur_el];
+			tokenizer_table->slots[FindSlot(tokenizer_table, GetTxt(name), GetLen(name))] = (int64_t)cur_el;
+		}
+	}
+
 	// Append tokenizer_table with new node.
-	memcpy(tokenizer_table->names + tokenizer_table->size, &n, sizeof(Node*));
+	tokenizer_table->slots[FindSlot(tokenizer_table, GetTxt(n), GetLen(n))] = (int64_t)tokenizer_table->size;
+	tokenizer_table->names[tokenizer_table->size] = n;
 	msg(D_NAMETABLE, M,
 		"Name was inserted\n");
 
@@ -262,11 +390,7 @@ static NameTable *ScanTokenizerNames(Tree *t)
 {
 	assert(t != NULL && "Null parametr\n");
 	// Allocate name tokenizer_table for searching familiar names
-	NameTable *tokenizer_table = (NameTable*)calloc(1, sizeof(NameTable));
-	assert(tokenizer_table != NULL && "Null calloc allocation\n");
-	// Allocate array of names.
-	tokenizer_table->names = (Node**)calloc(kInitSizeNamesArray, sizeof(Node*));
-	assert(tokenizer_table != NULL && "Null calloc allocation\n");
+	NameTable *tokenizer_table = NameTableCtor();
 
 	tab_incr();
 	SearchTokenizerNamesInBrance(t->root, tokenizer_table);
@@ -283,17 +407,27 @@ static void GenerateConstants(FILE *lib_header, NameTable *tokenizer_table)
 {
 	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
 		if (
-				strcmp(GetTxt(tokenizer_table->names[cur_el]), "splitters")   == 0 ||
-				strcmp(GetTxt(tokenizer_table->names[cur_el]), "white_space") == 0) {
+				TxtEqual(tokenizer_table->names[cur_el], "splitters") ||
+				TxtEqual(tokenizer_table->names[cur_el], "white_space")) {
 			// Print common c-constant.
 			fprintf(lib_header,
-				"static const char *GEN_%s = \"%s\";\n",
-				GetTxt(tokenizer_table->names[cur_el]),
-				GetTxt(GetChild(GetChild(tokenizer_table->names[cur_el]->parent, 1), 0)));
+				"static const char *GEN_%.*s = \"%.*s\";\n",
+				NODE_TXT(tokenizer_table->names[cur_el]),
+				NODE_TXT(GetChild(GetChild(tokenizer_table->names[cur_el]->parent, 1), 0)));
 		}
 	}
+}
 
-	fprintf(lib_header, "static const int64_t kUndefinedStableWordIdx = -1;\n\n");
+/// @returns   Number of types of tokens: default_token and tokens of grammar.
+static uint64_t NumberOfTokenTypes(NameTable *tokenizer_table)
+{
+	uint64_t n_types = 1;
+	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
+		if (!PhonyVariables(tokenizer_table, cur_el)) {
+			++n_types;
+		}
+	}
+	return n_types;
 }
 
 /**
@@ -318,8 +452,8 @@ static void GenerateEnumOfTokens
 		}
 
 		fprintf(lib_header,
-			"\t%s,\n",
-			GetTxt(tokenizer_table->names[cur_el]));
+			"\t%.*s,\n",
+			NODE_TXT(tokenizer_table->names[cur_el]));
 	}
 	for (size_t cur_el = 0; cur_el < parser_table->size; ++cur_el) {
 		if (PhonyVariables(parser_table, cur_el)) {
@@ -327,10 +461,10 @@ static void GenerateEnumOfTokens
 		}
 
 		Node *in_parser_tree = parser_table->names[cur_el];
-		fprintf(lib_header, "\t%s,\n", GetTxt(in_parser_tree));
+		fprintf(lib_header, "\t%.*s,\n", NODE_TXT(in_parser_tree));
 
 		for (size_t cur_child = 0; cur_child < GetChild(in_parser_tree, 0)->children->size; ++cur_child) {
-			fprintf(lib_header, "\t%s_%ld,\n", GetTxt(in_parser_tree), cur_child + 1);
+			fprintf(lib_header, "\t%.*s_%ld,\n", NODE_TXT(in_parser_tree), cur_child + 1);
 		}
 	}
 
@@ -338,295 +472,1250 @@ static void GenerateEnumOfTokens
 		"} GEN_TokenType;\n\n");
 
 	fprintf(lib_header,
+		"// Types of tokens are less than it, types of rules and their options aren't.\n"
+		"static const uint32_t kNumberOfTokenTypes = %lu;\n\n",
+		NumberOfTokenTypes(tokenizer_table));
+
+	fprintf(lib_header,
+		"// Symbol of token whose text isn't interned.\n"
+		"static const uint32_t kNoSymbol = 0;\n\n"
+
 		"typedef struct\n"
 		"{\n"
 		"\t// Type of token.\n"
-		"\tGEN_TokenType  type;\n"
-		"\t// Text representation of token.\n"
-		"\tchar      *txt;\n"
-		"\tGEN_PrsrNdType parser_type;\n"
+		"\tGEN_TokenType   type;\n"
+		"\tGEN_PrsrNdType  parser_type;\n"
+		"\t// Text of token in source text (not null-terminated).\n"
+		"\tconst char     *txt;\n"
+		"\t// Length of text.\n"
+		"\tuint32_t        len;\n"
+		"\t// Symbol of interned text (GEN_Interner) or kNoSymbol.\n"
+		"\tuint32_t        symbol;\n"
 		"} GEN_Token;\n\n");
 }
 
 /**
- * @brief Prints array of keywords in library header.
- * Prints special structure (GEN_StableWord) and array of this structure.
- * It will contain all stable words to parser.
- * 
- * @param lib_header   Library header file.
- * @param tokenizer_table        Tokenizer's name tokenizer_table.
+ * @returns   Node with value of variable (name) in tokenizer's tree.
+ * Tokenizer's tree is built in a way that value of variable is
+ * 		name->parent->child[1]->child[0].
+ */
+static inline __attribute__((always_inline))
+Node *VariableValue(Node *name)
+{ return GetChild(GetChild(name->parent, 1), 0); }
+
+/**
+ * @returns   true if variable (name) is regex-expression: it's name ends with '_'.
+ */
+static inline __attribute__((always_inline))
+bool IsRegexVariable(Node *name)
+{ return GetTxt(name)[GetLen(name) - 1] == '_'; }
+
+/**
+ * @brief Collects lexer's rules from tokenizer's name table.
+ * Literal tokens go first to have priority over regex-expressions:
+ * so word "if" will be keyword and not name matched by "[a-z]+".
+ *
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param types             Output: token type node of each rule.
+ * @param n_rules           Output: number of rules.
+ * @returns                 Allocated array of rules.
  */
-static void GenerateArrayOfKeywords(FILE *lib_header, NameTable *tokenizer_table)
+static LexerRule *CollectLexerRules(NameTable *tokenizer_table, Node ***types, size_t *n_rules)
 {
-	fprintf(lib_header,
-		"typedef struct {\n"
-		"\t// Text representation of token.\n"
-		"\tconst char *txt;\n"
-		"\t// Length of token.\n"
-		"\tsize_t      len;\n"
-		"\t// Token logic type.\n"
-		"\tGEN_TokenType   type;\n"
-		"} GEN_StableWord;\n\n");
+	assert(tokenizer_table != NULL && "Null param");
+	assert(types           != NULL && "Null param");
+	assert(n_rules         != NULL && "Null param");
+
+	LexerRule *rules = (LexerRule *)calloc(tokenizer_table->size + 1, sizeof(LexerRule));
+	*types = (Node **)calloc(tokenizer_table->size + 1, sizeof(Node *));
+	assert(rules != NULL && *types != NULL && "Null calloc allocation");
+
+	*n_rules = 0;
+	for (int pass = 0; pass < 2; ++pass) {
+		bool regex_pass = (pass == 1);
+
+		for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
+			Node *name = tokenizer_table->names[cur_el];
+			if (PhonyVariables(tokenizer_table, cur_el) || IsRegexVariable(name) != regex_pass) {
+				continue;
+			}
 
-	fprintf(lib_header,
-		"static GEN_StableWord GEN_stable_words[] = {\n");
+			rules[*n_rules].pattern  = GetTxt(VariableValue(name));
+			rules[*n_rules].len      = GetLen(VariableValue(name));
+			rules[*n_rules].is_regex = regex_pass;
+			(*types)[*n_rules] = name;
+			++(*n_rules);
+		}
+	}
 
-	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
-		if (PhonyVariables(tokenizer_table, cur_el)) {
+	return rules;
+}
+
+/**
+ * @brief Fills (set) by symbols of phony variable (name), e.g. (white_space).
+ * Escapes of YACC-file (\\t, \\n, ...) are replaced by their symbols.
+ *
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param name              Name of phony variable.
+ * @param set               Output: set of symbols.
+ */
+static void PhonySymbols(NameTable *tokenizer_table, const char *name, bool set[256])
+{
+	memset(set, 0, 256 * sizeof(bool));
+	int64_t idx = FindName(tokenizer_table, name);
+	if (idx == kUndefinedIdx) {
+		return;
+	}
+
+	Node       *value = GetChild(GetChild(tokenizer_table->names[idx]->parent, 1), 0);
+	const char *txt   = GetTxt(value);
+	size_t      len   = GetLen(value);
+	for (size_t cur_sym = 0; cur_sym < len; ++cur_sym) {
+		unsigned char c = (unsigned char)txt[cur_sym];
+		if (c == '\\' && cur_sym + 1 < len) {
+			c = (unsigned char)txt[++cur_sym];
+			switch (c) {
+				case 't': { c = '\t'; break; }
+				case 'n': { c = '\n'; break; }
+				case 'r': { c = '\r'; break; }
+				case 'v': { c = '\v'; break; }
+				case 'f': { c = '\f'; break; }
+				case '0': { c = '\0'; break; }
+				default:  { break; }
+			}
+		}
+		set[c] = true;
+	}
+}
+
+/**
+ * @brief Splits set of bytes to ranges.
+ *
+ * @param set   Set of bytes.
+ * @param run   Output: ranges of (set).
+ * @returns     false if (set) is empty or has more than (kMaxRunRanges) ranges.
+ */
+static bool RunOfSet(const bool set[256], ByteRun *run)
+{
+	memset(run, 0, sizeof(ByteRun));
+	for (size_t c = 0; c < 256; ++c) {
+		if (!set[c] || (c > 0 && set[c - 1])) {
 			continue;
 		}
+		if (run->n_ranges == kMaxRunRanges) {
+			return false;
+		}
+
+		size_t last = c;
+		while (last + 1 < 256 && set[last + 1]) {
+			++last;
+		}
+		run->lo[run->n_ranges]   = (uint8_t)c;
+		run->last[run->n_ranges] = (uint8_t)(last - c);
+		++run->n_ranges;
+	}
+	return run->n_ranges > 0;
+}
 
-		//  Regex expressions shouldn't be
-		// considered as common text-values of token.
-		char *label = GetTxt(tokenizer_table->names[cur_el]);
-		if (label[strlen(label) - 1] == '_') {
+/**
+ * @brief Prints runs of bytes which generated lexer skips at once:
+ * white space (run 0) and loops of automaton's states. Bytes of state's loop
+ * don't change state, so whole run of them is skipped by one SIMD kernel.
+ *
+ * @param tokenizer_c       Tokenizer's c file.
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param dfa               Automaton of lexer.
+ */
+static void GenerateLexerRuns(FILE *tokenizer_c, NameTable *tokenizer_table, const LexerDfa *dfa)
+{
+	ByteRun runs[kMaxLexerRuns] = {0};
+	bool    set[256]            = {0};
+	PhonySymbols(tokenizer_table, "white_space", set);
+	// White space which can't be run is skipped by table of classes.
+	RunOfSet(set, &runs[0]);
+	size_t n_runs = 1;
+
+	uint8_t *state_run = (uint8_t *)calloc(dfa->n_states, sizeof(uint8_t));
+	assert(state_run != NULL && "Null calloc allocation");
+	for (size_t state = 0; state < dfa->n_states; ++state) {
+		state_run[state] = kMaxLexerRuns;
+		if (state == kLexerDeadState) {
 			continue;
 		}
 
-		fprintf(lib_header,
-			"\t{\"%s\", %ld, %s},\n",
-			GetTxt(GetChild(GetChild(tokenizer_table->names[cur_el]->parent, 1), 0)),
-			strlen(GetTxt(GetChild(GetChild(tokenizer_table->names[cur_el]->parent, 1), 0))),
-			GetTxt(tokenizer_table->names[cur_el]));
+		for (size_t c = 0; c < 256; ++c) {
+			set[c] = (dfa->next[state * dfa->n_classes + dfa->byte_class[c]] == state);
+		}
+		ByteRun run = {0};
+		if (!RunOfSet(set, &run)) {
+			continue;
+		}
+
+		size_t cur_run = 1;
+		while (cur_run < n_runs && memcmp(&runs[cur_run], &run, sizeof(ByteRun)) != 0) {
+			++cur_run;
+		}
+		if (cur_run == n_runs && n_runs < kMaxLexerRuns) {
+			runs[n_runs++] = run;
+		}
+		if (cur_run < n_runs) {
+			state_run[state] = (uint8_t)cur_run;
+		}
 	}
 
-	fprintf(lib_header,
-		"};\n\n");
+	fprintf(tokenizer_c,
+		"// Set of bytes as ranges [lo, lo + last].\n"
+		"typedef struct\n"
+		"{\n"
+		"\tuint8_t n_ranges;\n"
+		"\tuint8_t lo[%d];\n"
+		"\tuint8_t last[%d];\n"
+		"} GEN_ByteRun;\n\n"
 
-	fprintf(lib_header,
-		"static GEN_StableWord GEN_stable_regex_words[] = {\n");
+		"static const uint8_t kLexerNoRun = %d;\n\n",
+		kMaxRunRanges, kMaxRunRanges, kMaxLexerRuns);
 
-	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
-		if (PhonyVariables(tokenizer_table, cur_el)) {
-			continue;
+	fprintf(tokenizer_c,
+		"static const GEN_ByteRun GEN_lexer_runs[%zu] = {\n",
+		n_runs);
+	for (size_t cur_run = 0; cur_run < n_runs; ++cur_run) {
+		fprintf(tokenizer_c, "\t{%u, {", runs[cur_run].n_ranges);
+		for (size_t cur_range = 0; cur_range < kMaxRunRanges; ++cur_range) {
+			fprintf(tokenizer_c, "%s%u", (cur_range == 0)? "" : ", ", runs[cur_run].lo[cur_range]);
+		}
+		fprintf(tokenizer_c, "}, {");
+		for (size_t cur_range = 0; cur_range < kMaxRunRanges; ++cur_range) {
+			fprintf(tokenizer_c, "%s%u", (cur_range == 0)? "" : ", ", runs[cur_run].last[cur_range]);
+		}
+		fprintf(tokenizer_c, "}},\n");
+	}
+	fprintf(tokenizer_c, "};\n\n");
+
+	fprintf(tokenizer_c,
+		"static const uint8_t GEN_lexer_run[%zu] = {",
+		dfa->n_states);
+	for (size_t state = 0; state < dfa->n_states; ++state) {
+		fprintf(tokenizer_c, "%s%u,", (state % 16 == 0)? "\n\t" : " ", state_run[state]);
+	}
+	fprintf(tokenizer_c, "\n};\n\n");
+
+	free(state_run);
+}
+
+/**
+ * @brief Prints tables of lexer's automaton to tokenizer's file:
+ * class of each byte, transitions and accepted token type of each state.
+ *
+ * @param tokenizer_c       Tokenizer's c file.
+ * @param tokenizer_table   Tokenizer's name table.
+ */
+static void GenerateLexerTables(FILE *tokenizer_c, NameTable *tokenizer_table)
+{
+	Node **types = NULL;
+	size_t n_rules = 0;
+	LexerRule *rules = CollectLexerRules(tokenizer_table, &types, &n_rules);
+
+	LexerDfa *dfa = BuildLexerDfa(rules, n_rules);
+
+	const char *state_type = (dfa->n_states <= UINT16_MAX)? "uint16_t" : "uint32_t";
+
+	fprintf(tokenizer_c,
+		"static const uint32_t kLexerDeadState  = %u;\n"
+		"static const uint32_t kLexerStartState = %u;\n\n",
+		kLexerDeadState, kLexerStartState);
+
+	fprintf(tokenizer_c,
+		"static const uint8_t GEN_lexer_byte_class[256] = {");
+	for (size_t c = 0; c < 256; ++c) {
+		fprintf(tokenizer_c, "%s%u,", (c % 16 == 0)? "\n\t" : " ", dfa->byte_class[c]);
+	}
+	fprintf(tokenizer_c, "\n};\n\n");
+
+	fprintf(tokenizer_c,
+		"static const %s GEN_lexer_next[%lu][%lu] = {\n",
+		state_type, dfa->n_states, dfa->n_classes);
+	for (size_t state = 0; state < dfa->n_states; ++state) {
+		fprintf(tokenizer_c, "\t{");
+		for (size_t cur_class = 0; cur_class < dfa->n_classes; ++cur_class) {
+			fprintf(tokenizer_c, "%s%u", (cur_class == 0)? "" : ", ",
+				dfa->next[state * dfa->n_classes + cur_class]);
 		}
+		fprintf(tokenizer_c, "},\n");
+	}
+	fprintf(tokenizer_c, "};\n\n");
 
-		char *label = tokenizer_table->names[cur_el]->token->txt;
-		if (label[strlen(label) - 1] == '_') {
-			fprintf(lib_header, "\t{\"%s\", %ld, %s},\n",
-				GetTxt(GetChild(GetChild(tokenizer_table->names[cur_el]->parent, 1), 0)),
-				strlen(GetTxt(GetChild(GetChild(tokenizer_table->names[cur_el]->parent, 1), 0))),
-				GetTxt(tokenizer_table->names[cur_el]));
+	fprintf(tokenizer_c,
+		"static const GEN_TokenType GEN_lexer_accept[%lu] = {\n",
+		dfa->n_states);
+	for (size_t state = 0; state < dfa->n_states; ++state) {
+		if (dfa->accept[state] == kUndefinedIdx) {
+			fprintf(tokenizer_c, "\tdefault_token,\n");
+		} else {
+			fprintf(tokenizer_c, "\t%.*s,\n", NODE_TXT(types[dfa->accept[state]]));
 		}
+	}
+	fprintf(tokenizer_c, "};\n\n");
 
+	GenerateLexerRuns(tokenizer_c, tokenizer_table, dfa);
+
+	LexerDfaDtor(dfa);
+	free(rules);
+	free(types);
+}
+
+/**
+ * @returns   Name of token type with text "EOF" or NULL
+ * if YACC-file doesn't define it.
+ */
+static Node *EofTokenType(NameTable *tokenizer_table)
+{
+	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
+		Node *name = tokenizer_table->names[cur_el];
+		if (!PhonyVariables(tokenizer_table, cur_el) && !IsRegexVariable(name) &&
+				TxtEqual(VariableValue(name), "EOF")) {
+			return name;
+		}
 	}
 
-	fprintf(lib_header,
-		"};\n\n");
+	return NULL;
 }
 
 /**
- * @brief Print's common tokenizer's commands.
+ * @brief Prints SIMD kernels of lexer which skip runs of bytes
+ * (GEN_ByteRun): white space and loops of automaton's states.
+ * Kernel is chosen once by GEN_DetectSimd(): AVX2 (by runtime check of CPU),
+ * SSE2 or NEON by target of compiler, scalar loop otherwise.
+ *
  * @param tokenizer_c   Tokenizer's c file.
  */
-static void GenerateCommonCommands(FILE *tokenizer_c)
+static void GenerateSimdCmds(FILE *tokenizer_c)
 {
 	fprintf(tokenizer_c,
-		"int64_t GEN_IdentifyToken(char *cur_word)\n"
+		"static inline __attribute__((always_inline))\n"
+		"bool GEN_InRun(const GEN_ByteRun *run, const char c)\n"
 		"{\n"
-		"\tassert(cur_word != NULL && \"nullptr param\");\n"
-		"\tfor (size_t idx = 0; idx < sizeof(GEN_stable_words) / sizeof(GEN_StableWord); ++idx) {\n"
-		"\t\tif (strcmp(GEN_stable_words[idx].txt, cur_word) == 0) {\n"
-		"\t\t\treturn idx;\n"
-		"\t\t}\n"
-		"\t}\n\n"
-		"\treturn kUndefinedStableWordIdx;\n"
+		"\tbool in = false;\n"
+		"\tfor (uint8_t cur_range = 0; cur_range < run->n_ranges; ++cur_range) {\n"
+		"\t\tin |= ((uint8_t)((uint8_t)c - run->lo[cur_range]) <= run->last[cur_range]);\n"
+		"\t}\n"
+		"\treturn in;\n"
 		"}\n\n"
 
-		"bool GEN_CanBeAppended(char *cur_word, char *cursor, uint64_t cur_token_len)\n"
+		"static const char *GEN_SkipRunScalar(const char *cursor, const char *end, const GEN_ByteRun *run)\n"
 		"{\n"
-		"\tchar *copy = (char *)calloc(kTokenMaxLen, sizeof(char));\n"
-		"\tassert(copy != NULL && \"Null calloc allocation\");\n"
-		"\tstrcpy(copy, cur_word);\n"
-		"\tcopy[cur_token_len] = *cursor;\n"
-		"\tif (GEN_IdentifyToken(copy) == kUndefinedStableWordIdx) {\n"
-		"\t\treturn false;\n"
-		"\t} else {\n"
-		"\t\treturn true;\n"
+		"\twhile (cursor < end && GEN_InRun(run, *cursor)) {\n"
+		"\t\t++cursor;\n"
 		"\t}\n"
-		"}\n\n"
+		"\treturn cursor;\n"
+		"}\n\n");
 
-		"GEN_Token GEN_ConstructToken(uint64_t idx)\n"
+	fprintf(tokenizer_c,
+		"#if defined(__SSE2__)\n"
+		"static const char *GEN_SkipRunSse2(const char *cursor, const char *end, const GEN_ByteRun *run)\n"
 		"{\n"
-		"\tGEN_Token token = {0};\n"
-		"\ttoken.txt = (char *)calloc(kTokenMaxLen, sizeof(char));\n"
-		"\tassert(token.txt != NULL && \"Null calloc allocation\");\n"
-		"\ttoken.type = GEN_stable_words[idx].type;\n"
-		"\tstrcpy(token.txt, GEN_stable_words[idx].txt);\n"
-		"\treturn token;\n"
+		"\twhile (end - cursor >= 16) {\n"
+		"\t\t__m128i block = _mm_loadu_si128((const __m128i *)cursor);\n"
+		"\t\t__m128i in    = _mm_setzero_si128();\n"
+		"\t\tfor (uint8_t cur_range = 0; cur_range < run->n_ranges; ++cur_range) {\n"
+		"\t\t\t// Byte is in range if (byte - lo) <= last as unsigned.\n"
+		"\t\t\t__m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8((char)run->lo[cur_range]));\n"
+		"\t\t\t__m128i bounded = _mm_min_epu8(shifted, _mm_set1_epi8((char)run->last[cur_range]));\n"
+		"\t\t\tin = _mm_or_si128(in, _mm_cmpeq_epi8(bounded, shifted));\n"
+		"\t\t}\n"
+		"\t\tuint32_t out = (uint32_t)_mm_movemask_epi8(in) ^ 0xFFFFu;\n"
+		"\t\tif (out != 0) {\n"
+		"\t\t\treturn cursor + __builtin_ctz(out);\n"
+		"\t\t}\n"
+		"\t\tcursor += 16;\n"
+		"\t}\n"
+		"\treturn GEN_SkipRunScalar(cursor, end, run);\n"
 		"}\n\n"
 
-		"GEN_Token GEN_FillToken(const char *txt)\n"
+		"__attribute__((target(\"avx2\")))\n"
+		"static const char *GEN_SkipRunAvx2(const char *cursor, const char *end, const GEN_ByteRun *run)\n"
 		"{\n"
-		"\tGEN_Token token = {0};\n"
-		"\ttoken.txt = (char *)calloc(kTokenMaxLen, sizeof(char));\n"
-		"\tassert(token.txt != NULL && \"Null calloc allocation\");\n"
-		"\ttoken.type = 0;\n"
-		"\tstrcpy(token.txt, txt);\n"
-		"\treturn token;\n"
-		"}\n\n"
-		
-		"void GEN_PushToken(GEN_Token *token, GEN_Token *sequence, uint64_t *sequence_size)\n"
+		"\twhile (end - cursor >= 32) {\n"
+		"\t\t__m256i block = _mm256_loadu_si256((const __m256i *)cursor);\n"
+		"\t\t__m256i in    = _mm256_setzero_si256();\n"
+		"\t\tfor (uint8_t cur_range = 0; cur_range < run->n_ranges; ++cur_range) {\n"
+		"\t\t\t__m256i shifted = _mm256_sub_epi8(block, _mm256_set1_epi8((char)run->lo[cur_range]));\n"
+		"\t\t\t__m256i bounded = _mm256_min_epu8(shifted, _mm256_set1_epi8((char)run->last[cur_range]));\n"
+		"\t\t\tin = _mm256_or_si256(in, _mm256_cmpeq_epi8(bounded, shifted));\n"
+		"\t\t}\n"
+		"\t\tuint32_t out = ~(uint32_t)_mm256_movemask_epi8(in);\n"
+		"\t\tif (out != 0) {\n"
+		"\t\t\treturn cursor + __builtin_ctz(out);\n"
+		"\t\t}\n"
+		"\t\tcursor += 32;\n"
+		"\t}\n"
+		"\treturn GEN_SkipRunSse2(cursor, end, run);\n"
+		"}\n"
+		"#elif defined(__ARM_NEON)\n"
+		"static const char *GEN_SkipRunNeon(const char *cursor, const char *end, const GEN_ByteRun *run)\n"
 		"{\n"
-		"\tsequence[*sequence_size] = *token;\n"
-		"\t++(*sequence_size);\n"
+		"\twhile (end - cursor >= 16) {\n"
+		"\t\tuint8x16_t block = vld1q_u8((const uint8_t *)cursor);\n"
+		"\t\tuint8x16_t in    = vdupq_n_u8(0);\n"
+		"\t\tfor (uint8_t cur_range = 0; cur_range < run->n_ranges; ++cur_range) {\n"
+		"\t\t\tuint8x16_t shifted = vsubq_u8(block, vdupq_n_u8(run->lo[cur_range]));\n"
+		"\t\t\tin = vorrq_u8(in, vcleq_u8(shifted, vdupq_n_u8(run->last[cur_range])));\n"
+		"\t\t}\n"
+		"\t\t// Four bits of mask per byte.\n"
+		"\t\tuint64_t out = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(in), 4)), 0);\n"
+		"\t\tif (out != 0) {\n"
+		"\t\t\treturn cursor + (__builtin_ctzll(out) >> 2);\n"
+		"\t\t}\n"
+		"\t\tcursor += 16;\n"
+		"\t}\n"
+		"\treturn GEN_SkipRunScalar(cursor, end, run);\n"
+		"}\n"
+		"#endif\n\n");
+
+	fprintf(tokenizer_c,
+		"/*\n"
+		" * Chooses the widest kernel of this CPU. (GEN_SIMD) environment\n"
+		" * variable (scalar, sse2, avx2, neon) can choose narrower one.\n"
+		" */\n"
+		"GEN_SimdLevel GEN_DetectSimd(void)\n"
+		"{\n"
+		"\tGEN_SimdLevel level = GEN_SIMD_SCALAR;\n"
+		"#if defined(__SSE2__)\n"
+		"\tlevel = (__builtin_cpu_supports(\"avx2\"))? GEN_SIMD_AVX2 : GEN_SIMD_SSE2;\n"
+		"#elif defined(__ARM_NEON)\n"
+		"\tlevel = GEN_SIMD_NEON;\n"
+		"#endif\n"
+		"\tconst char *wanted = getenv(\"GEN_SIMD\");\n"
+		"\tif (wanted == NULL) {\n"
+		"\t\treturn level;\n"
+		"\t}\n"
+		"\tif (strcmp(wanted, \"scalar\") == 0) {\n"
+		"\t\treturn GEN_SIMD_SCALAR;\n"
+		"\t}\n"
+		"\tif (strcmp(wanted, \"sse2\") == 0 && level == GEN_SIMD_AVX2) {\n"
+		"\t\treturn GEN_SIMD_SSE2;\n"
+		"\t}\n"
+		"\treturn level;\n"
 		"}\n\n"
-		
-		"void GEN_TryPushToken(\n"
-		"\tuint64_t *cur_token_len, char *cur_word, GEN_Token *sequence, uint64_t *sequence_size)\n"
+
+		"static const int64_t kScalarRunPrefix = 8;\n\n"
+
+		"/*\n"
+		" * Skips bytes of (run). Most of runs (names, indents) are short,\n"
+		" * so first (kScalarRunPrefix) bytes are checked before any SIMD load.\n"
+		" */\n"
+		"static inline __attribute__((always_inline))\n"
+		"const char *GEN_SkipRun(const char *cursor, const char *end, const GEN_ByteRun *run, GEN_SimdLevel simd)\n"
 		"{\n"
-		"\tif (*cur_token_len > 0) {\n"
-		"\t\tint64_t idx = GEN_IdentifyToken(cur_word);\n"
-		"\t\tGEN_Token token = {0};\n"
-		"\t\tif (idx != kUndefinedStableWordIdx) {\n"
-		"\t\t\ttoken = GEN_ConstructToken(idx);\n"
-		"\t\t} else {\n"
-		"\t\t\tbool is_regex = false;\n"
-		"\t\t\tregex_t regex;\n"
-		"\t\t\tfor (size_t idx = 0; idx < sizeof(GEN_stable_regex_words) / sizeof(GEN_StableWord); ++idx) {\n"
-		"\t\t\t\tint reti = regcomp(&regex, GEN_stable_regex_words[idx].txt, REG_EXTENDED | REG_NOSUB);\n"
-		"\t\t\t\tif (reti == 0) {\n"
-		"\t\t\t\t\tint res = regexec(&regex, cur_word, 0, NULL, 0);\n"
-		"\t\t\t\t\tif (res == 0) {\n"
-		"\t\t\t\t\t\ttoken.txt = (char *)calloc(kTokenMaxLen, sizeof(char));\n"
-		"\t\t\t\t\t\tassert(token.txt != NULL && \"Null calloc allocation\");\n"
-		"\t\t\t\t\t\ttoken.type = GEN_stable_regex_words[idx].type;\n"
-		"\t\t\t\t\t\tstrcpy(token.txt, cur_word);\n"
-		"\t\t\t\t\t\tis_regex = true;\n"
-		"\t\t\t\t\t}\n"
-		"\t\t\t\t}\n"
-		"\t\t\t}\n"
-		"\t\t\tif (!is_regex) {\n"
-		"\t\t\t	token = GEN_FillToken(cur_word);\n"
-		"\t\t\t}\n"
+		"\tconst char *prefix_end = cursor + ((end - cursor < kScalarRunPrefix)? end - cursor : kScalarRunPrefix);\n"
+		"\tfor (; cursor < prefix_end; ++cursor) {\n"
+		"\t\tif (!GEN_InRun(run, *cursor)) {\n"
+		"\t\t\treturn cursor;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tif (cursor == end) {\n"
+		"\t\treturn cursor;\n"
+		"\t}\n"
+		"\tswitch (simd) {\n"
+		"#if defined(__SSE2__)\n"
+		"\t\tcase GEN_SIMD_AVX2: { return GEN_SkipRunAvx2(cursor, end, run); }\n"
+		"\t\tcase GEN_SIMD_SSE2: { return GEN_SkipRunSse2(cursor, end, run); }\n"
+		"#elif defined(__ARM_NEON)\n"
+		"\t\tcase GEN_SIMD_NEON: { return GEN_SkipRunNeon(cursor, end, run); }\n"
+		"#endif\n"
+		"\t\tdefault: {\n"
+		"\t\t\treturn GEN_SkipRunScalar(cursor, end, run);\n"
 		"\t\t}\n"
-		"\t\tGEN_PushToken(&token, sequence, sequence_size);\n"
-		"\t\t*cur_token_len = 0;\n"
-		"\t\tmemset(cur_word, \'\\0\', kTokenMaxLen);\n"
 		"\t}\n"
 		"}\n\n"
 
-		"void GEN_PushEof(uint64_t *cur_token_len, char *cur_word, GEN_Token *sequence, uint64_t *n_tokens)\n"
+		"// Skips white space: by kernel if it's run of ranges, else by classes of bytes.\n"
+		"static inline __attribute__((always_inline))\n"
+		"const char *GEN_SkipWhiteSpace(const char *cursor, const char *end, GEN_SimdLevel simd)\n"
 		"{\n"
-		"\t*cur_token_len = 3;\n"
-		"\tmemset(cur_word, \'\\0\', kTokenMaxLen);\n"
-		"\tstrcpy(cur_word, \"EOF\");\n"
-		"\tGEN_TryPushToken(cur_token_len, cur_word, sequence, n_tokens);\n"
-		"}\n\n"
-		);
+		"\tif (GEN_lexer_runs[0].n_ranges > 0) {\n"
+		"\t\treturn GEN_SkipRun(cursor, end, &GEN_lexer_runs[0], simd);\n"
+		"\t}\n"
+		"\twhile (cursor < end && GEN_IsWhiteSpace(*cursor)) {\n"
+		"\t\t++cursor;\n"
+		"\t}\n"
+		"\treturn cursor;\n"
+		"}\n\n");
 }
 
 /**
- * @brief Generates splitter commands which can find
- * split symbols or whitespace symbols for generated library.
- * 
- * @param tokenizer_c   Tokenizer's c-file.
- * @param tokenizer_table         Tokenizer's name tokenizer_table.
+ * @brief Print's common tokenizer's commands.
+ * @param tokenizer_c       Tokenizer's c file.
+ * @param tokenizer_table   Tokenizer's name table.
  */
-static void GenerateSplittersCommands(FILE *tokenizer_c, NameTable *tokenizer_table)
+static void GenerateCommonCommands(FILE *tokenizer_c, NameTable *tokenizer_table)
 {
-	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
-		if (strcmp(tokenizer_table->names[cur_el]->token->txt, "splitters") == 0) {
-			fprintf(tokenizer_c,
-				"static inline __attribute__((always_inline))\n"
-				"bool GEN_IsSplit(const char c)\n"
-				"{ return strchr(GEN_splitters, c) != NULL; }\n\n");
-			break;
-		}
-	}
+	GenerateLexerTables(tokenizer_c, tokenizer_table);
+	GenerateSimdCmds(tokenizer_c);
 
-	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
-		if (strcmp(tokenizer_table->names[cur_el]->token->txt, "white_space") == 0) {
-			fprintf(tokenizer_c,
-				"static inline __attribute__((always_inline))\n"
-				"bool GEN_IsWhiteSpace(const char c)\n"
-				"{ return strchr(GEN_white_space, c) != NULL; }\n\n");
-			break;
-		}
-	}
-}
-
-/**
- * @brief Prints tokenizer's main command.
- * @param tokenizer_c   Tokenizer's c file.
- */
-static void GenerateTokenizerCmd(FILE *tokenizer_c)
-{
 	fprintf(tokenizer_c,
-		"GEN_Token *GEN_Tokenizer(char *source_text, uint64_t *n_tokens)\n"
+		"static uint64_t GEN_MatchToken(const char *cursor, const char *end, GEN_TokenType *type, GEN_SimdLevel simd)\n"
 		"{\n"
-		"\tassert(source_text != NULL && \"nullptr param\");\n"
-		"\tassert(n_tokens    != NULL && \"nullptr param\");\n\n"
-
-		"\tchar *cursor = source_text;\n"
-		"\tGEN_Token *sequence = (GEN_Token *)calloc(kInitSequenceSize, sizeof(GEN_Token));\n"
-		"\tassert(sequence != NULL && \"Null calloc allocation\");\n"
-		
-		"\tuint64_t cur_token_len = 0;\n"
-		"\tchar cur_word[kTokenMaxLen] = \"\";\n"
-		
-		"\twhile (*cursor != EOF) {\n"
-		"\t\tif (GEN_IsWhiteSpace(*cursor)) {\n"
-		"\t\t\twhile (GEN_IsWhiteSpace(*cursor) && *cursor != EOF) {\n"
-		"\t\t\t\t++cursor;\n"
-		"\t\t\t}\n"
-		"\t\t\tGEN_TryPushToken(&cur_token_len, cur_word, sequence, n_tokens);\n"
-		"\t\t\tcontinue;\n"
+		"\tuint32_t state   = kLexerStartState;\n"
+		"\tuint64_t len     = 0;\n"
+		"\tuint64_t matched = 0;\n"
+		"\t*type = default_token;\n"
+		"\twhile (cursor + len < end) {\n"
+		"\t\tstate = GEN_lexer_next[state][GEN_lexer_byte_class[(unsigned char)cursor[len]]];\n"
+		"\t\tif (state == kLexerDeadState) {\n"
+		"\t\t\tbreak;\n"
 		"\t\t}\n"
-		"\t\tif (GEN_IsSplit(*cursor)) {\n"
-		"\t\t\tGEN_TryPushToken(&cur_token_len, cur_word, sequence, n_tokens);\n"
-		"\t\t\twhile (GEN_IsSplit(*cursor)  && *cursor != EOF) {\n"
-		"\t\t\t\tcur_word[cur_token_len] = *cursor;\n"
-		"\t\t\t\t++cur_token_len;\n"
-		"\t\t\t\t++cursor;\n"
-		"\t\t\t\tif (GEN_CanBeAppended(cur_word, cursor, cur_token_len)) {\n"
-		"\t\t\t\t\tcontinue;\n"
-		"\t\t\t\t} else {\n"
-		"\t\t\t\t\tbreak;\n"
-		"\t\t\t\t}\n"
-		"\t\t\t}\n"
-		"\t\t\tGEN_TryPushToken(&cur_token_len, cur_word, sequence, n_tokens);\n"
-		"\t\t\tcontinue;\n"
+		"\t\t++len;\n"
+		"\t\t// Bytes of state's loop don't change state: skip all of them at once.\n"
+		"\t\tif (GEN_lexer_run[state] != kLexerNoRun) {\n"
+		"\t\t\tlen = (uint64_t)(GEN_SkipRun(cursor + len, end, &GEN_lexer_runs[GEN_lexer_run[state]], simd) - cursor);\n"
+		"\t\t}\n"
+		"\t\tif (GEN_lexer_accept[state] != default_token) {\n"
+		"\t\t\tmatched = len;\n"
+		"\t\t\t*type   = GEN_lexer_accept[state];\n"
 		"\t\t}\n"
-		"\t\tcur_word[cur_token_len] = *cursor;\n"
-		"\t\t++cur_token_len;\n"
-		"\t\t++cursor;\n"
 		"\t}\n"
-		
-		"\tGEN_TryPushToken(&cur_token_len, cur_word, sequence, n_tokens);\n"
-		"\tGEN_PushEof(&cur_token_len, cur_word, sequence, n_tokens);\n"
-		"\tfree(source_text);\n\n"
-		
-		"\treturn sequence;\n"
+		"\treturn matched;\n"
+		"}\n\n"
+
+		"static uint64_t GEN_SkipUnknown(const char *cursor, const char *end)\n"
+		"{\n"
+		"\tuint64_t len = 1;\n"
+		"\twhile (cursor + len < end && !GEN_IsWhiteSpace(cursor[len]) && !GEN_IsSplit(cursor[len])) {\n"
+		"\t\t++len;\n"
+		"\t}\n"
+		"\treturn len;\n"
+		"}\n\n"
+
+		"static GEN_Token GEN_FillToken(const char *txt, uint64_t len, GEN_TokenType type)\n"
+		"{\n"
+		"\tGEN_Token token = {0};\n"
+		"\ttoken.type = type;\n"
+		"\ttoken.txt  = txt;\n"
+		"\ttoken.len  = (uint32_t)len;\n"
+		"\treturn token;\n"
 		"}\n\n");
+
+	Node *eof_type = EofTokenType(tokenizer_table);
+	fprintf(tokenizer_c,
+		"const GEN_Token GEN_eof_token = {%.*s, GEN_NOT_SPECIAL, \"EOF\", 3, 0};\n\n",
+		(eof_type == NULL)? (int)strlen("default_token") : (int)GetLen(eof_type),
+		(eof_type == NULL)? "default_token" : GetTxt(eof_type));
 }
 
 /**
- * @brief Prints trainslation command: token_type -> txt.
- * This command can be used in (GEN_DebugTree)-function to create graph of
- * AST of the program.
- * 
+ * @brief Prints interner of texts of tokens. Lexer with interner gives
+ * each token of regex-expression symbol of it's text: equal texts have
+ * equal symbols, so names are compared by one integer. Texts of symbols
+ * are copied to arena of interner once.
+ *
  * @param tokenizer_c       Tokenizer's c file.
- * @param tokenizer_table   Tokenizer's name table
- * @param parser_table      Name table of parser.
+ * @param tokenizer_table   Tokenizer's name table.
  */
-static void GenerateTranslationCommand
-	(FILE *tokenizer_c, NameTable *tokenizer_table, NameTable *parser_table)
+static void GenerateInternCmds(FILE *tokenizer_c, NameTable *tokenizer_table)
 {
 	fprintf(tokenizer_c,
-		"const char *GEN_TranslateTokenType(GEN_TokenType type)\n"
+		"// Tokens of regex-expressions: lexer with interner gives symbols to them.\n"
+		"static const bool GEN_lexer_interned[] =\n"
 		"{\n"
-		"\tswitch (type) {\n");
-
+		"\tfalse, // default_token\n");
 	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
 		if (PhonyVariables(tokenizer_table, cur_el)) {
 			continue;
 		}
-
+		fprintf(tokenizer_c, "\t%s, // %.*s\n",
+			(IsRegexVariable(tokenizer_table->names[cur_el]))? "true " : "false",
+			NODE_TXT(tokenizer_table->names[cur_el]));
+	}
+	fprintf(tokenizer_c,
+		"};\n\n");
+
+	fprintf(tokenizer_c,
+		"struct GEN_Interner\n"
+		"{\n"
+		"\t// Open addressing table of symbols: (n_slots) is power of two.\n"
+		"\tuint32_t    *slots;\n"
+		"\tuint64_t     n_slots;\n"
+		"\t// Text, length and hash of symbol (i). Symbol 0 is kNoSymbol.\n"
+		"\tconst char **txts;\n"
+		"\tuint32_t    *lens;\n"
+		"\tuint32_t    *hashes;\n"
+		"\tuint32_t     size;\n"
+		"\tuint32_t     capacity;\n"
+		"\t// Copies of texts: symbols don't depend on source text.\n"
+		"\tGEN_Arena   *pool;\n"
+		"};\n\n"
+
+		"static const uint64_t kInitInternSlots = 1024;\n\n"
+
+		"GEN_Interner *GEN_InternerCtor(void)\n"
+		"{\n"
+		"\tGEN_Interner *in = (GEN_Interner *)calloc(1, sizeof(GEN_Interner));\n"
+		"\tassert(in != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tin->n_slots  = kInitInternSlots;\n"
+		"\tin->slots    = (uint32_t *)calloc(in->n_slots, sizeof(uint32_t));\n"
+		"\tin->capacity = (uint32_t)(kInitInternSlots / 2);\n"
+		"\tin->txts     = (const char **)calloc(in->capacity, sizeof(const char *));\n"
+		"\tin->lens     = (uint32_t *)calloc(in->capacity, sizeof(uint32_t));\n"
+		"\tin->hashes   = (uint32_t *)calloc(in->capacity, sizeof(uint32_t));\n"
+		"\tassert(in->slots != NULL && in->txts != NULL && in->lens != NULL && in->hashes != NULL &&\n"
+		"\t\t\"Null calloc allocation\");\n"
+		"\tin->size = 1;\n"
+		"\tin->pool = GEN_ArenaCtor();\n"
+		"\treturn in;\n"
+		"}\n\n"
+
+		"void GEN_InternerDtor(GEN_Interner *in)\n"
+		"{\n"
+		"\tassert(in != NULL && \"nullptr param\");\n\n"
+
+		"\tGEN_ArenaDtor(in->pool);\n"
+		"\tfree(in->slots);\n"
+		"\tfree(in->txts);\n"
+		"\tfree(in->lens);\n"
+		"\tfree(in->hashes);\n"
+		"\tfree(in);\n"
+		"}\n");
+
+	fprintf(tokenizer_c,
+		"static inline __attribute__((always_inline))\n"
+		"uint32_t GEN_InternHash(const char *txt, uint64_t len)\n"
+		"{\n"
+		"\tuint32_t hash = 2166136261u;\n"
+		"\tfor (uint64_t cur_sym = 0; cur_sym < len; ++cur_sym) {\n"
+		"\t\thash = (hash ^ (uint8_t)txt[cur_sym]) * 16777619u;\n"
+		"\t}\n"
+		"\treturn hash ^ (hash >> 16);\n"
+		"}\n\n"
+
+		"// Table is twice larger: symbols are placed again by their hashes.\n"
+		"static void GEN_InternGrow(GEN_Interner *in)\n"
+		"{\n"
+		"\tfree(in->slots);\n"
+		"\tin->n_slots <<= 1;\n"
+		"\tin->slots = (uint32_t *)calloc(in->n_slots, sizeof(uint32_t));\n"
+		"\tassert(in->slots != NULL && \"Null calloc allocation\");\n"
+		"\tfor (uint32_t symbol = 1; symbol < in->size; ++symbol) {\n"
+		"\t\tuint64_t slot = in->hashes[symbol] & (in->n_slots - 1);\n"
+		"\t\twhile (in->slots[slot] != kNoSymbol) {\n"
+		"\t\t\tslot = (slot + 1) & (in->n_slots - 1);\n"
+		"\t\t}\n"
+		"\t\tin->slots[slot] = symbol;\n"
+		"\t}\n\n"
+
+		"\tin->capacity = (uint32_t)(in->n_slots / 2);\n"
+		"\tin->txts   = (const char **)realloc(in->txts, in->capacity * sizeof(const char *));\n"
+		"\tin->lens   = (uint32_t *)realloc(in->lens, in->capacity * sizeof(uint32_t));\n"
+		"\tin->hashes = (uint32_t *)realloc(in->hashes, in->capacity * sizeof(uint32_t));\n"
+		"\tassert(in->txts != NULL && in->lens != NULL && in->hashes != NULL && \"Null realloc allocation\");\n"
+		"}\n\n"
+
+		"/*\n"
+		" * Returns symbol of text: equal texts have equal symbols, so they are\n"
+		" * compared by symbols. Text is copied to pool only when it's new.\n"
+		" */\n"
+		"uint32_t GEN_Intern(GEN_Interner *in, const char *txt, uint64_t len)\n"
+		"{\n"
+		"\tassert(in  != NULL && \"nullptr param\");\n"
+		"\tassert(txt != NULL && \"nullptr param\");\n\n"
+
+		"\tuint32_t hash = GEN_InternHash(txt, len);\n"
+		"\tuint64_t slot = hash & (in->n_slots - 1);\n"
+		"\twhile (in->slots[slot] != kNoSymbol) {\n"
+		"\t\tuint32_t symbol = in->slots[slot];\n"
+		"\t\tif (in->hashes[symbol] == hash && in->lens[symbol] == len && memcmp(in->txts[symbol], txt, len) == 0) {\n"
+		"\t\t\treturn symbol;\n"
+		"\t\t}\n"
+		"\t\tslot = (slot + 1) & (in->n_slots - 1);\n"
+		"\t}\n\n"
+
+		"\tif (in->size == in->capacity) {\n"
+		"\t\tGEN_InternGrow(in);\n"
+		"\t\tslot = hash & (in->n_slots - 1);\n"
+		"\t\twhile (in->slots[slot] != kNoSymbol) {\n"
+		"\t\t\tslot = (slot + 1) & (in->n_slots - 1);\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tchar *copy = (char *)GEN_ArenaAlloc(in->pool, len + 1);\n"
+		"\tmemcpy(copy, txt, len);\n\n"
+
+		"\tuint32_t symbol = in->size++;\n"
+		"\tin->slots[slot]     = symbol;\n"
+		"\tin->txts[symbol]    = copy;\n"
+		"\tin->lens[symbol]    = (uint32_t)len;\n"
+		"\tin->hashes[symbol]  = hash;\n"
+		"\treturn symbol;\n"
+		"}\n\n"
+
+		"// Null-terminated text of symbol in pool of interner.\n"
+		"const char *GEN_SymbolTxt(const GEN_Interner *in, uint32_t symbol, uint32_t *len)\n"
+		"{\n"
+		"\tassert(in != NULL                                && \"nullptr param\");\n"
+		"\tassert(symbol != kNoSymbol && symbol < in->size && \"Unknown symbol\");\n"
+		"\tif (len != NULL) {\n"
+		"\t\t*len = in->lens[symbol];\n"
+		"\t}\n"
+		"\treturn in->txts[symbol];\n"
+		"}\n\n"
+
+		"// Number of symbols, kNoSymbol included: symbols are [1, size).\n"
+		"uint32_t GEN_InternerSize(const GEN_Interner *in)\n"
+		"{\n"
+		"\tassert(in != NULL && \"nullptr param\");\n"
+		"\treturn in->size;\n"
+		"}\n\n"
+
+		"// Gives symbols to tokens of array (GEN_Tokenizer or GEN_Reparse) which are interned by lexer.\n"
+		"void GEN_InternTokens(GEN_Interner *in, GEN_Token *tokens, uint64_t n_tokens)\n"
+		"{\n"
+		"\tassert(in     != NULL && \"nullptr param\");\n"
+		"\tassert(tokens != NULL && \"nullptr param\");\n"
+		"\tfor (uint64_t cur_token = 0; cur_token < n_tokens; ++cur_token) {\n"
+		"\t\tif (GEN_lexer_interned[tokens[cur_token].type]) {\n"
+		"\t\t\ttokens[cur_token].symbol = GEN_Intern(in, tokens[cur_token].txt, tokens[cur_token].len);\n"
+		"\t\t}\n"
+		"\t}\n"
+		"}\n");
+}
+
+/**
+ * @brief Generates splitter commands which can find
+ * split symbols or whitespace symbols for generated library.
+ * 
+ * @param tokenizer_c   Tokenizer's c-file.
+ * @param tokenizer_table         Tokenizer's name tokenizer_table.
+ */
+static void GenerateSplittersCommands(FILE *tokenizer_c, NameTable *tokenizer_table)
+{
+	bool white_space[256] = {0};
+	bool splitters[256]   = {0};
+	PhonySymbols(tokenizer_table, "white_space", white_space);
+	PhonySymbols(tokenizer_table, "splitters", splitters);
+
+	fprintf(tokenizer_c,
+		"static const uint8_t kCharWhiteSpace = 1;\n"
+		"static const uint8_t kCharSplit      = 2;\n\n"
+
+		"// Classes of bytes: white space and split symbols of grammar.\n"
+		"static const uint8_t GEN_char_class[256] = {");
+	for (size_t c = 0; c < 256; ++c) {
+		fprintf(tokenizer_c, "%s%d,", (c % 16 == 0)? "\n\t" : " ",
+			(white_space[c]? 1 : 0) | (splitters[c]? 2 : 0));
+	}
+	fprintf(tokenizer_c,
+		"\n};\n\n"
+
+		"static inline __attribute__((always_inline))\n"
+		"bool GEN_IsSplit(const char c)\n"
+		"{ return (GEN_char_class[(unsigned char)c] & kCharSplit) != 0; }\n\n"
+
+		"static inline __attribute__((always_inline))\n"
+		"bool GEN_IsWhiteSpace(const char c)\n"
+		"{ return (GEN_char_class[(unsigned char)c] & kCharWhiteSpace) != 0; }\n\n");
+}
+
+/**
+ * @brief Prints pipelined mode of lexer: tokenizer thread scans tokens
+ * to ring of batches while parser thread parses tokens of older batches.
+ * Ring is lock-free: it has one writer and one reader. Tokenizer thread waits
+ * when ring is full, so it's never more than ring ahead of parser, and
+ * parser's window still keeps tokens from oldest mark.
+ *
+ * @param tokenizer_c   Tokenizer's c file.
+ */
+static void GeneratePipelineCmds(FILE *tokenizer_c)
+{
+	fprintf(tokenizer_c,
+		"// Tokenizer thread of pipelined lexer gives tokens by batches.\n"
+		"static const uint64_t kPipeBatchSize = 1024;\n"
+		"// Batches in ring: tokenizer thread is at most so many batches ahead of parser.\n"
+		"static const uint64_t kPipeBatches   = 64;\n"
+		"// While parser has tokens to read, tokenizer thread is at most so many batches\n"
+		"// ahead of the oldest token parser can return to (GEN_LexerOldest).\n"
+		"static const uint64_t kPipeAhead     = 32;\n"
+		"// Waiting thread spins so many times before it gives up it's core.\n"
+		"static const uint32_t kPipeSpins     = 256;\n"
+		"// Then it yields so many times before it sleeps.\n"
+		"static const uint32_t kPipeYields    = 64;\n"
+		"// Sleep of waiting thread doubles from 1 us up to this time.\n"
+		"static const long     kPipeMaxSleep  = 100000;\n\n"
+
+		"/*\n"
+		" * Single-producer single-consumer ring of batches of tokens. Tokenizer thread\n"
+		" * writes batch (head %% kPipeBatches) and publishes it by incrementing (head),\n"
+		" * parser thread reads batch (tail %% kPipeBatches) and frees it by incrementing (tail).\n"
+		" */\n"
+		"struct GEN_Pipe\n"
+		"{\n"
+		"\tGEN_Token        *tokens;\n"
+		"\tuint64_t         *sizes;\n"
+		"\t// Batch ends with EOF token.\n"
+		"\tbool             *last;\n"
+		"\t_Atomic uint64_t  head;\n"
+		"\t_Atomic uint64_t  tail;\n"
+		"\t// Oldest token of parser's window, it's published with each freed batch.\n"
+		"\t_Atomic uint64_t  oldest;\n"
+		"\t// Parser doesn't need more tokens: tokenizer thread stops.\n"
+		"\t_Atomic bool      stop;\n"
+		"\t// Next token of batch (tail) which parser reads.\n"
+		"\tuint64_t          read_pos;\n"
+		"\t// State of scanning which belongs to tokenizer thread.\n"
+		"\tGEN_Lexer         scanner;\n"
+		"\tpthread_t         thread;\n"
+		"};\n\n"
+
+		"// Backoff of waiting thread: it spins, then yields, then sleeps longer and longer.\n"
+		"static void GEN_PipeWait(uint32_t *spins)\n"
+		"{\n"
+		"\tuint32_t waits = (*spins)++;\n"
+		"\tif (waits < kPipeSpins) {\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\tif (waits < kPipeSpins + kPipeYields) {\n"
+		"\t\tsched_yield();\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\tuint32_t        shift = waits - kPipeSpins - kPipeYields;\n"
+		"\tlong            nsec  = (shift < 17)? (1000L << shift) : kPipeMaxSleep;\n"
+		"\tstruct timespec delay = {0, (nsec < kPipeMaxSleep)? nsec : kPipeMaxSleep};\n"
+		"\tnanosleep(&delay, NULL);\n"
+		"}\n\n"
+
+		"static void *GEN_PipeRoutine(void *arg)\n"
+		"{\n"
+		"\tGEN_Pipe  *pipe    = (GEN_Pipe *)arg;\n"
+		"\tGEN_Lexer *scanner = &pipe->scanner;\n"
+		"\t// Parser which stopped early isn't waited for the rest of source: stop is checked once per batch.\n"
+		"\twhile (!scanner->finished && !atomic_load_explicit(&pipe->stop, memory_order_relaxed)) {\n"
+		"\t\tuint64_t head  = atomic_load_explicit(&pipe->head, memory_order_relaxed);\n"
+		"\t\tuint32_t spins = 0;\n"
+		"\t\t// Ring is full: parser is kPipeBatches batches behind. Or parser keeps old tokens\n"
+		"\t\t// for backtracking and has batches to read: it's window isn't grown by tokens it doesn't need yet.\n"
+		"\t\twhile (true) {\n"
+		"\t\t\tuint64_t tail   = atomic_load_explicit(&pipe->tail, memory_order_acquire);\n"
+		"\t\t\tuint64_t oldest = atomic_load_explicit(&pipe->oldest, memory_order_relaxed) / kPipeBatchSize;\n"
+		"\t\t\tif (head - tail < kPipeBatches && (head == tail || head < oldest + kPipeAhead)) {\n"
+		"\t\t\t\tbreak;\n"
+		"\t\t\t}\n"
+		"\t\t\tif (atomic_load_explicit(&pipe->stop, memory_order_relaxed)) {\n"
+		"\t\t\t\treturn NULL;\n"
+		"\t\t\t}\n"
+		"\t\t\tGEN_PipeWait(&spins);\n"
+		"\t\t}\n\n"
+
+		"\t\tuint64_t   batch  = head %% kPipeBatches;\n"
+		"\t\tGEN_Token *tokens = pipe->tokens + batch * kPipeBatchSize;\n"
+		"\t\tuint64_t   size   = 0;\n"
+		"\t\twhile (size < kPipeBatchSize && !scanner->finished) {\n"
+		"\t\t\ttokens[size++] = GEN_ScanToken(scanner);\n"
+		"\t\t}\n"
+		"\t\tpipe->sizes[batch] = size;\n"
+		"\t\tpipe->last[batch]  = scanner->finished;\n"
+		"\t\tatomic_store_explicit(&pipe->head, head + 1, memory_order_release);\n"
+		"\t}\n"
+		"\treturn NULL;\n"
+		"}\n");
+
+	fprintf(tokenizer_c,
+		"/*\n"
+		" * Starts tokenizer thread of lexer which hasn't scanned tokens yet: then parser\n"
+		" * takes tokens from ring instead of scanning them. Interner of lexer is used\n"
+		" * only by tokenizer thread. Returns false if thread can't be started,\n"
+		" * lexer scans tokens by itself then.\n"
+		" */\n"
+		"bool GEN_LexerStartPipeline(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tassert(lx != NULL                                && \"nullptr param\");\n"
+		"\tassert(lx->pipe == NULL && lx->owns_window       && \"Lexer is already pipelined or has sequence\");\n"
+		"\tassert(lx->base + lx->size == 0 && !lx->finished && \"Lexer already scanned tokens\");\n\n"
+
+		"\tGEN_Pipe *pipe = (GEN_Pipe *)calloc(1, sizeof(GEN_Pipe));\n"
+		"\tassert(pipe != NULL && \"Null calloc allocation\");\n"
+		"\tpipe->tokens = (GEN_Token *)calloc(kPipeBatches * kPipeBatchSize, sizeof(GEN_Token));\n"
+		"\tpipe->sizes  = (uint64_t *)calloc(kPipeBatches, sizeof(uint64_t));\n"
+		"\tpipe->last   = (bool *)calloc(kPipeBatches, sizeof(bool));\n"
+		"\tassert(pipe->tokens != NULL && pipe->sizes != NULL && pipe->last != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tatomic_init(&pipe->head, 0);\n"
+		"\tatomic_init(&pipe->tail, 0);\n"
+		"\tatomic_init(&pipe->oldest, 0);\n"
+		"\tatomic_init(&pipe->stop, false);\n"
+		"\tpipe->scanner.cursor   = lx->cursor;\n"
+		"\tpipe->scanner.end      = lx->end;\n"
+		"\tpipe->scanner.simd     = lx->simd;\n"
+		"\tpipe->scanner.interner = lx->interner;\n\n"
+
+		"\tif (pthread_create(&pipe->thread, NULL, GEN_PipeRoutine, pipe) != 0) {\n"
+		"\t\tfree(pipe->tokens);\n"
+		"\t\tfree(pipe->sizes);\n"
+		"\t\tfree(pipe->last);\n"
+		"\t\tfree(pipe);\n"
+		"\t\treturn false;\n"
+		"\t}\n"
+		"\tlx->pipe = pipe;\n"
+		"\treturn true;\n"
+		"}\n\n"
+
+		"// Stops tokenizer thread even if it waits for free batch.\n"
+		"static void GEN_PipeDtor(GEN_Pipe *pipe)\n"
+		"{\n"
+		"\tatomic_store_explicit(&pipe->stop, true, memory_order_relaxed);\n"
+		"\tpthread_join(pipe->thread, NULL);\n"
+		"\tfree(pipe->tokens);\n"
+		"\tfree(pipe->sizes);\n"
+		"\tfree(pipe->last);\n"
+		"\tfree(pipe);\n"
+		"}\n\n"
+
+		"// Next token of ring, parser waits for it if tokenizer thread is behind.\n"
+		"static GEN_Token GEN_PipeTake(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tGEN_Pipe *pipe  = lx->pipe;\n"
+		"\tuint64_t  tail  = atomic_load_explicit(&pipe->tail, memory_order_relaxed);\n"
+		"\tuint32_t  spins = 0;\n"
+		"\twhile (atomic_load_explicit(&pipe->head, memory_order_acquire) == tail) {\n"
+		"\t\tGEN_PipeWait(&spins);\n"
+		"\t}\n\n"
+
+		"\tuint64_t  batch = tail %% kPipeBatches;\n"
+		"\tGEN_Token token = pipe->tokens[batch * kPipeBatchSize + pipe->read_pos++];\n"
+		"\tif (pipe->read_pos == pipe->sizes[batch]) {\n"
+		"\t\tlx->finished   = pipe->last[batch];\n"
+		"\t\tpipe->read_pos = 0;\n"
+		"\t\tatomic_store_explicit(&pipe->oldest, GEN_LexerOldest(lx), memory_order_relaxed);\n"
+		"\t\tatomic_store_explicit(&pipe->tail, tail + 1, memory_order_release);\n"
+		"\t}\n"
+		"\treturn token;\n"
+		"}\n");
+}
+
+/**
+ * @brief Prints pull-based lexer's commands.
+ * Lexer tokenizes source text lazily: token is scanned only when parser
+ * peeks it. Scanned tokens are kept in the window which starts at the oldest
+ * token parser can return to (oldest mark or current position), so
+ * older tokens are released while window is moved.
+ * Tokens point to (source_text) so it should live as long as tokens.
+ *
+ * @param tokenizer_c   Tokenizer's c file.
+ */
+static void GenerateLexerCmds(FILE *tokenizer_c)
+{
+	fprintf(tokenizer_c,
+		"GEN_Lexer *GEN_LexerCtor(const char *source_text, uint64_t len)\n"
+		"{\n"
+		"\tassert(source_text != NULL && \"nullptr param\");\n\n"
+
+		"\tGEN_Lexer *lx = (GEN_Lexer *)calloc(1, sizeof(GEN_Lexer));\n"
+		"\tassert(lx != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tlx->cursor      = source_text;\n"
+		"\tlx->end         = source_text + len;\n"
+		"\tlx->capacity    = kInitWindowSize;\n"
+		"\tlx->owns_window = true;\n"
+		"\tlx->simd        = GEN_DetectSimd();\n"
+		"\tlx->window      = (GEN_Token *)calloc(lx->capacity, sizeof(GEN_Token));\n"
+		"\tassert(lx->window != NULL && \"Null calloc allocation\");\n\n"
+
+		"\treturn lx;\n"
+		"}\n\n"
+
+		"GEN_Lexer *GEN_SequenceLexerCtor(GEN_Token *sequence, uint64_t n_tokens)\n"
+		"{\n"
+		"\tassert(sequence != NULL && \"nullptr param\");\n"
+		"\tassert(n_tokens > 0     && \"Sequence without EOF token\");\n\n"
+
+		"\tGEN_Lexer *lx = (GEN_Lexer *)calloc(1, sizeof(GEN_Lexer));\n"
+		"\tassert(lx != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tlx->window   = sequence;\n"
+		"\tlx->size     = n_tokens;\n"
+		"\tlx->capacity = n_tokens;\n"
+		"\tlx->finished = true;\n\n"
+
+		"\treturn lx;\n"
+		"}\n\n"
+
+		"static GEN_Token GEN_ScanToken(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tlx->cursor = GEN_SkipWhiteSpace(lx->cursor, lx->end, lx->simd);\n"
+		"\tif (lx->cursor == lx->end) {\n"
+		"\t\tlx->finished = true;\n"
+		"\t\treturn GEN_eof_token;\n"
+		"\t}\n\n"
+
+		"\tGEN_TokenType type = default_token;\n"
+		"\tuint64_t len = GEN_MatchToken(lx->cursor, lx->end, &type, lx->simd);\n"
+		"\tif (len == 0) {\n"
+		"\t\tlen = GEN_SkipUnknown(lx->cursor, lx->end);\n"
+		"\t}\n"
+		"\tGEN_Token token = GEN_FillToken(lx->cursor, len, type);\n"
+		"\tif (lx->interner != NULL && GEN_lexer_interned[type]) {\n"
+		"\t\ttoken.symbol = GEN_Intern(lx->interner, lx->cursor, len);\n"
+		"\t}\n"
+		"\tlx->cursor += len;\n"
+		"\treturn token;\n"
+		"}\n\n"
+
+		"uint64_t GEN_LexerOldest(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tassert(lx != NULL && \"nullptr param\");\n"
+		"\treturn (lx->n_marks > 0 && lx->marks[0] < lx->position)? lx->marks[0] : lx->position;\n"
+		"}\n\n");
+
+	GeneratePipelineCmds(tokenizer_c);
+
+	fprintf(tokenizer_c,
+		"void GEN_LexerDtor(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tassert(lx != NULL && \"nullptr param\");\n\n"
+
+		"\tif (lx->pipe != NULL) {\n"
+		"\t\tGEN_PipeDtor(lx->pipe);\n"
+		"\t}\n"
+		"\tif (lx->owns_window) {\n"
+		"\t\tfree(lx->window);\n"
+		"\t}\n"
+		"\tfree(lx->marks);\n"
+		"\tfree(lx);\n"
+		"}\n\n"
+
+		"static void GEN_LexerFill(GEN_Lexer *lx, uint64_t idx)\n"
+		"{\n"
+		"\twhile (!lx->finished && lx->base + lx->size <= idx) {\n"
+		"\t\tif (lx->size == lx->capacity) {\n"
+		"\t\t\t// Tokens before oldest mark can't be requested again.\n"
+		"\t\t\tuint64_t oldest = GEN_LexerOldest(lx);\n"
+		"\t\t\tuint64_t n_released = (oldest < lx->base + lx->size)? oldest - lx->base : lx->size;\n\n"
+
+		"\t\t\tif (n_released >= lx->capacity / 2) {\n"
+		"\t\t\t\tmemmove(lx->window, lx->window + n_released, (lx->size - n_released) * sizeof(GEN_Token));\n"
+		"\t\t\t\tlx->base += n_released;\n"
+		"\t\t\t\tlx->size -= n_released;\n"
+		"\t\t\t} else {\n"
+		"\t\t\t\tlx->capacity <<= 1;\n"
+		"\t\t\t\tlx->window = (GEN_Token *)realloc(lx->window, lx->capacity * sizeof(GEN_Token));\n"
+		"\t\t\t\tassert(lx->window != NULL && \"Null realloc allocation\");\n"
+		"\t\t\t}\n"
+		"\t\t}\n"
+		"\t\tlx->window[lx->size++] = (lx->pipe != NULL)? GEN_PipeTake(lx) : GEN_ScanToken(lx);\n"
+		"\t}\n"
+		"}\n\n"
+
+		"GEN_Token *GEN_PeekToken(GEN_Lexer *lx, uint64_t k)\n"
+		"{\n"
+		"\tassert(lx != NULL && \"nullptr param\");\n\n"
+
+		"\tuint64_t idx = lx->position + k;\n"
+		"\tassert(idx >= lx->base && \"Token was released from lexer's window\");\n\n"
+
+		"\tGEN_LexerFill(lx, idx);\n"
+		"\t// Everything after the end of text is EOF token.\n"
+		"\tif (idx >= lx->base + lx->size) {\n"
+		"\t\treturn lx->window + lx->size - 1;\n"
+		"\t}\n"
+		"\treturn lx->window + (idx - lx->base);\n"
+		"}\n\n"
+
+		"GEN_Token *GEN_NextToken(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tGEN_Token *token = GEN_PeekToken(lx, 0);\n"
+		"\t++lx->position;\n"
+		"\treturn token;\n"
+		"}\n\n"
+
+		"void GEN_LexerSeek(GEN_Lexer *lx, uint64_t idx)\n"
+		"{\n"
+		"\tassert(lx != NULL     && \"nullptr param\");\n"
+		"\tassert(idx >= lx->base && \"Token was released from lexer's window\");\n\n"
+
+		"\tlx->position = idx;\n"
+		"}\n\n"
+
+		"void GEN_LexerPushMark(GEN_Lexer *lx, uint64_t idx)\n"
+		"{\n"
+		"\tassert(lx != NULL && \"nullptr param\");\n\n"
+
+		"\tif (lx->n_marks == lx->marks_capacity) {\n"
+		"\t\tlx->marks_capacity = (lx->marks_capacity == 0)? kMaxScopeDepth : lx->marks_capacity << 1;\n"
+		"\t\tlx->marks = (uint64_t *)realloc(lx->marks, lx->marks_capacity * sizeof(uint64_t));\n"
+		"\t\tassert(lx->marks != NULL && \"Null realloc allocation\");\n"
+		"\t}\n"
+		"\tlx->marks[lx->n_marks++] = idx;\n"
+		"}\n\n"
+
+		"void GEN_LexerPopMark(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tassert(lx != NULL      && \"nullptr param\");\n"
+		"\tassert(lx->n_marks > 0 && \"Pop from empty mark stack\");\n\n"
+
+		"\t--lx->n_marks;\n"
+		"}\n\n"
+
+		"// Rule can't go back before (idx) anymore: tokens before it can be released.\n"
+		"void GEN_LexerMoveMark(GEN_Lexer *lx, uint64_t idx)\n"
+		"{\n"
+		"\tassert(lx != NULL      && \"nullptr param\");\n"
+		"\tassert(lx->n_marks > 0 && \"Move of empty mark stack\");\n"
+		"\tassert(idx >= lx->marks[lx->n_marks - 1] && \"Mark can't move back\");\n\n"
+
+		"\tlx->marks[lx->n_marks - 1] = idx;\n"
+		"}\n\n");
+}
+
+/**
+ * @brief Prints tokenizer's main command.
+ * It's thin wrapper around lexer which collects
+ * all the tokens to the growable array.
+ *
+ * @param tokenizer_c   Tokenizer's c file.
+ */
+static void GenerateTokenizerCmd(FILE *tokenizer_c)
+{
+	fprintf(tokenizer_c,
+		"GEN_Token *GEN_Tokenizer(const char *source_text, uint64_t len, uint64_t *n_tokens)\n"
+		"{\n"
+		"\tassert(source_text != NULL && \"nullptr param\");\n"
+		"\tassert(n_tokens    != NULL && \"nullptr param\");\n\n"
+
+		"\tuint64_t capacity = kInitSequenceSize;\n"
+		"\tGEN_Token *sequence = (GEN_Token *)calloc(capacity, sizeof(GEN_Token));\n"
+		"\tassert(sequence != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tGEN_Lexer *lx = GEN_LexerCtor(source_text, len);\n"
+		"\t*n_tokens = 0;\n"
+		"\tdo {\n"
+		"\t\tif (*n_tokens == capacity) {\n"
+		"\t\t\tcapacity <<= 1;\n"
+		"\t\t\tsequence = (GEN_Token *)realloc(sequence, capacity * sizeof(GEN_Token));\n"
+		"\t\t\tassert(sequence != NULL && \"Null realloc allocation\");\n"
+		"\t\t}\n"
+		"\t\tsequence[(*n_tokens)++] = *GEN_NextToken(lx);\n"
+		"\t} while (!lx->finished || lx->position < lx->base + lx->size);\n"
+		"\tGEN_LexerDtor(lx);\n\n"
+
+		"\treturn sequence;\n"
+		"}\n\n");
+}
+
+/**
+ * @brief Prints input layer of generated library: regular files are
+ * mapped by mmap, pipes and stdin are read by chunks. Text isn't
+ * terminated by any symbol, so lexer works on (pointer, length).
+ *
+ * @param tokenizer_c   Tokenizer's c file.
+ */
+static void GenerateSourceCmds(FILE *tokenizer_c)
+{
+	fprintf(tokenizer_c,
+		"static const uint64_t kSourceChunkSize = 1 << 16;\n\n"
+
+		"// Reads the whole (fd) by chunks: pipes and stdin can't be mapped.\n"
+		"static char *GEN_ReadChunks(int fd, uint64_t *len)\n"
+		"{\n"
+		"\tuint64_t capacity = kSourceChunkSize;\n"
+		"\tchar    *txt      = (char *)malloc(capacity);\n"
+		"\tassert(txt != NULL && \"Null malloc allocation\");\n\n"
+
+		"\t*len = 0;\n"
+		"\twhile (true) {\n"
+		"\t\tif (*len == capacity) {\n"
+		"\t\t\tcapacity <<= 1;\n"
+		"\t\t\ttxt = (char *)realloc(txt, capacity);\n"
+		"\t\t\tassert(txt != NULL && \"Null realloc allocation\");\n"
+		"\t\t}\n"
+		"\t\tssize_t n_read = read(fd, txt + *len, capacity - *len);\n"
+		"\t\tif (n_read < 0) {\n"
+		"\t\t\tfree(txt);\n"
+		"\t\t\treturn NULL;\n"
+		"\t\t}\n"
+		"\t\tif (n_read == 0) {\n"
+		"\t\t\treturn txt;\n"
+		"\t\t}\n"
+		"\t\t*len += (uint64_t)n_read;\n"
+		"\t}\n"
+		"}\n\n"
+
+		"/*\n"
+		" * Opens input (name) or stdin if (name) is \"-\". Regular file is mapped\n"
+		" * read-only, so it isn't copied. Text is valid until GEN_CloseSource.\n"
+		" *\n"
+		" * @returns   Source or NULL if input can't be read.\n"
+		" */\n"
+		"GEN_Source *GEN_OpenSource(const char *name)\n"
+		"{\n"
+		"\tassert(name != NULL && \"Null param\");\n"
+		"\tbool is_stdin = (strcmp(name, \"-\") == 0);\n"
+		"\tint  fd       = (is_stdin)? STDIN_FILENO : open(name, O_RDONLY);\n"
+		"\tif (fd < 0) {\n"
+		"\t\treturn NULL;\n"
+		"\t}\n\n"
+
+		"\tGEN_Source *source = (GEN_Source *)calloc(1, sizeof(GEN_Source));\n"
+		"\tassert(source != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tstruct stat st = {0};\n"
+		"\tif (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {\n"
+		"\t\tvoid *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);\n"
+		"\t\tif (data != MAP_FAILED) {\n"
+		"\t\t\t// Tokens are scanned from begin to end of text.\n"
+		"\t\t\tmadvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);\n"
+		"\t\t\tsource->txt    = (const char *)data;\n"
+		"\t\t\tsource->len    = (uint64_t)st.st_size;\n"
+		"\t\t\tsource->mapped = true;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tif (!source->mapped) {\n"
+		"\t\tsource->txt = GEN_ReadChunks(fd, &source->len);\n"
+		"\t}\n"
+		"\tif (!is_stdin) {\n"
+		"\t\tclose(fd);\n"
+		"\t}\n"
+		"\tif (source->txt == NULL) {\n"
+		"\t\tfree(source);\n"
+		"\t\treturn NULL;\n"
+		"\t}\n"
+		"\treturn source;\n"
+		"}\n\n"
+
+		"void GEN_CloseSource(GEN_Source *source)\n"
+		"{\n"
+		"\tassert(source != NULL && \"Null param\");\n"
+		"\tif (source->mapped) {\n"
+		"\t\tmunmap((void *)source->txt, source->len);\n"
+		"\t} else {\n"
+		"\t\tfree((void *)source->txt);\n"
+		"\t}\n"
+		"\tfree(source);\n"
+		"}\n\n");
+}
+
+/**
+ * @brief Prints trainslation command: token_type -> txt.
+ * This command can be used in (GEN_DebugTree)-function to create graph of
+ * AST of the program.
+ * 
+ * @param tokenizer_c       Tokenizer's c file.
+ * @param tokenizer_table   Tokenizer's name table
+ * @param parser_table      Name table of parser.
+ */
+static void GenerateTranslationCommand
+	(FILE *tokenizer_c, NameTable *tokenizer_table, NameTable *parser_table)
+{
+	fprintf(tokenizer_c,
+		"const char *GEN_TranslateTokenType(GEN_TokenType type)\n"
+		"{\n"
+		"\tswitch (type) {\n");
+
+	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
+		if (PhonyVariables(tokenizer_table, cur_el)) {
+			continue;
+		}
+
 		fprintf(tokenizer_c,
-			"\t\tcase %s: { return \"%s\"; }\n",
-			GetTxt(tokenizer_table->names[cur_el]),
-			GetTxt(tokenizer_table->names[cur_el])
+			"\t\tcase %.*s: { return \"%.*s\"; }\n",
+			NODE_TXT(tokenizer_table->names[cur_el]),
+			NODE_TXT(tokenizer_table->names[cur_el])
 			);
 	}
 
@@ -637,16 +1726,16 @@ static void GenerateTranslationCommand
 
 		Node *in_parser_tree = parser_table->names[cur_el];
 		fprintf(tokenizer_c,
-			"\t\tcase %s: { return \"%s\"; }\n",
-			GetTxt(parser_table->names[cur_el]),
-			GetTxt(parser_table->names[cur_el])
+			"\t\tcase %.*s: { return \"%.*s\"; }\n",
+			NODE_TXT(parser_table->names[cur_el]),
+			NODE_TXT(parser_table->names[cur_el])
 			);
 
 		for (size_t cur_child = 0; cur_child < GetChild(in_parser_tree, 0)->children->size; ++cur_child) {
 			fprintf(tokenizer_c,
-				"\t\tcase %s_%lu: { return \"%s_%lu\"; }\n",
-				in_parser_tree->token->txt, cur_child + 1,
-				in_parser_tree->token->txt, cur_child + 1
+				"\t\tcase %.*s_%lu: { return \"%.*s_%lu\"; }\n",
+				NODE_TXT(in_parser_tree), cur_child + 1,
+				NODE_TXT(in_parser_tree), cur_child + 1
 				);
 		}
 	}
@@ -667,16 +1756,16 @@ static void GenerateTranslationCommand
  * @param tokenizer_tree    Tokenizer's tree.
  * @param tokenizer_table   Tokenizer's name table.
  * @param lib_header        Header of library.
+ * @param tokenizer_c       Text of Tokenizer_GEN.c.
  * @param parser_table      Parser's name table.
  */
 static void GenerateTokenizerFile
-	(Tree *tokenizer_tree, NameTable *tokenizer_table, FILE *lib_header, NameTable *parser_table)
+	(Tree *tokenizer_tree, NameTable *tokenizer_table, FILE *lib_header, FILE *tokenizer_c, NameTable *parser_table)
 {
 	assert(tokenizer_table          != NULL && "Null param");
 	assert(tokenizer_tree != NULL && "Null param");
 	assert(parser_table   != NULL && "Null param");
-
-	FILE *tokenizer_c = fopen("../out/Tokenizer_GEN.c", "w");
+	assert(tokenizer_c    != NULL && "Null param");
 
 	fprintf(lib_header,
 		"#pragma once\n\n"
@@ -685,14 +1774,20 @@ static void GenerateTokenizerFile
 		"#include <stdio.h>\n"
 		"#include <string.h>\n"
 		"#include <stdint.h>\n"
-		"#include <regex.h>\n"
 		"#include <stdlib.h>\n\n"
 
+		"// Linkage of functions which are called only inside of library:\n"
+		"// amalgamated library (rbc --amalgamate) defines it as static.\n"
+		"#ifndef GEN_INTERNAL\n"
+		"#define GEN_INTERNAL\n"
+		"#endif\n\n"
+
 		"#pragma GCC diagnostic push\n"
 		"#pragma GCC diagnostic ignored \"-Wunused-variable\"\n"
 
 		"static const uint64_t kMaxScopeDepth = 256;\n"
-		"static const uint64_t kInitSequenceSize = 1024;\n\n"
+		"static const uint64_t kInitSequenceSize = 1024;\n"
+		"static const uint64_t kInitWindowSize   = 256;\n\n"
 	
 		"typedef enum\n"
 		"{\n"
@@ -715,830 +1810,6123 @@ static void GenerateTokenizerFile
 		"} GEN_Context;\n\n"
 		);
 
-	GenerateArrayOfKeywords(lib_header, tokenizer_table);
 	fprintf(lib_header,
-		"GEN_Token *GEN_Tokenizer(char *name, uint64_t *n_tokens);\n");
+		"// Table of interned texts: equal texts of tokens have equal symbols.\n"
+		"typedef struct GEN_Interner GEN_Interner;\n"
+		"// Ring of tokens which tokenizer thread of pipelined lexer fills.\n"
+		"typedef struct GEN_Pipe GEN_Pipe;\n\n"
+
+		"// Kernel which lexer uses to skip runs of bytes.\n"
+		"typedef enum\n"
+		"{\n"
+		"\tGEN_SIMD_SCALAR,\n"
+		"\tGEN_SIMD_SSE2,\n"
+		"\tGEN_SIMD_AVX2,\n"
+		"\tGEN_SIMD_NEON,\n"
+		"} GEN_SimdLevel;\n\n"
+		);
+
+	fprintf(lib_header,
+		"/*\n"
+		" * Pull-based lexer. Tokens are scanned lazily and kept in the window\n"
+		" * [base, base + size) which starts at the oldest active mark or at\n"
+		" * current position. Token pointers are valid until next lexer call.\n"
+		" */\n"
+		"typedef struct\n"
+		"{\n"
+		"\tconst char *cursor;\n"
+		"\t// End of source text: it isn't terminated by any symbol.\n"
+		"\tconst char *end;\n"
+		"\tbool        finished;\n"
+		"\tbool        owns_window;\n"
+		"\tGEN_SimdLevel simd;\n\n"
+
+		"\tGEN_Token  *window;\n"
+		"\tuint64_t    base;\n"
+		"\tuint64_t    size;\n"
+		"\tuint64_t    capacity;\n"
+		"\tuint64_t    position;\n\n"
+
+		"\tuint64_t   *marks;\n"
+		"\tuint64_t    n_marks;\n"
+		"\tuint64_t    marks_capacity;\n\n"
+
+		"\t// Interner of texts of regex-expressions or NULL. It isn't owned by lexer.\n"
+		"\tGEN_Interner *interner;\n"
+		"\t// Ring of tokenizer thread (GEN_LexerStartPipeline) or NULL.\n"
+		"\tGEN_Pipe     *pipe;\n"
+		"} GEN_Lexer;\n\n"
+		);
+
+	fprintf(lib_header,
+		"extern const GEN_Token GEN_eof_token;\n\n"
+
+		"GEN_Lexer *GEN_LexerCtor(const char *source_text, uint64_t len);\n"
+		"GEN_Lexer *GEN_SequenceLexerCtor(GEN_Token *sequence, uint64_t n_tokens);\n"
+		"bool GEN_LexerStartPipeline(GEN_Lexer *lx);\n"
+		"void GEN_LexerDtor(GEN_Lexer *lx);\n"
+		"GEN_Token *GEN_PeekToken(GEN_Lexer *lx, uint64_t k);\n"
+		"GEN_Token *GEN_NextToken(GEN_Lexer *lx);\n"
+		"void GEN_LexerSeek(GEN_Lexer *lx, uint64_t idx);\n"
+		"uint64_t GEN_LexerOldest(GEN_Lexer *lx);\n"
+		"void GEN_LexerPushMark(GEN_Lexer *lx, uint64_t idx);\n"
+		"void GEN_LexerPopMark(GEN_Lexer *lx);\n"
+		"void GEN_LexerMoveMark(GEN_Lexer *lx, uint64_t idx);\n\n"
+
+		"GEN_Token *GEN_Tokenizer(const char *source_text, uint64_t len, uint64_t *n_tokens);\n"
+		"GEN_SimdLevel GEN_DetectSimd(void);\n\n"
+
+		"GEN_Interner *GEN_InternerCtor(void);\n"
+		"void GEN_InternerDtor(GEN_Interner *in);\n"
+		"uint32_t GEN_Intern(GEN_Interner *in, const char *txt, uint64_t len);\n"
+		"const char *GEN_SymbolTxt(const GEN_Interner *in, uint32_t symbol, uint32_t *len);\n"
+		"uint32_t GEN_InternerSize(const GEN_Interner *in);\n"
+		"void GEN_InternTokens(GEN_Interner *in, GEN_Token *tokens, uint64_t n_tokens);\n\n"
+
+		"// Text of input: mapped file or text read from pipe. It isn't terminated by any symbol.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tconst char *txt;\n"
+		"\tuint64_t    len;\n"
+		"\tbool        mapped;\n"
+		"} GEN_Source;\n\n"
+
+		"GEN_Source *GEN_OpenSource(const char *name);\n"
+		"void GEN_CloseSource(GEN_Source *source);\n");
 
 	fprintf(lib_header,
 		"const char *GEN_TranslateTokenType(GEN_TokenType type);\n");
 
 	fprintf(tokenizer_c,
-		"#include <lib_GEN.h>\n\n");
+		"#include <lib_GEN.h>\n"
+		"#include <fcntl.h>\n"
+		"#include <pthread.h>\n"
+		"#include <sched.h>\n"
+		"#include <stdatomic.h>\n"
+		"#include <sys/mman.h>\n"
+		"#include <sys/stat.h>\n"
+		"#include <time.h>\n"
+		"#include <unistd.h>\n"
+		"#if defined(__SSE2__)\n"
+		"#include <immintrin.h>\n"
+		"#elif defined(__ARM_NEON)\n"
+		"#include <arm_neon.h>\n"
+		"#endif\n\n");
 
 	GenerateSplittersCommands(tokenizer_c, tokenizer_table);
-	GenerateCommonCommands(tokenizer_c);
+	GenerateCommonCommands(tokenizer_c, tokenizer_table);
+	GenerateInternCmds(tokenizer_c, tokenizer_table);
 
 	GenerateTranslationCommand(tokenizer_c, tokenizer_table, parser_table);
 
+	GenerateLexerCmds(tokenizer_c);
 	GenerateTokenizerCmd(tokenizer_c);
-
-	fclose(tokenizer_c);
+	GenerateSourceCmds(tokenizer_c);
 }
 
-// Generation parser file. -------------------------------------------------------------
+// FIRST sets of parser's rules. --------------------------------------------------------
 
 /**
- * @brief Writes prefix of current functino of particular
- * rule of file.
- * 
- * @param lib_header     Header file of library.
- * @param parser_c       Parser's c file.
- * @param name_of_rule   Name of current rule.
+ * @brief FIRST sets of parser's rules: tokens which can
+ * start each rule. Options of rules can't be empty so FIRST set of
+ * option is FIRST set of it's first chain and FOLLOW sets aren't needed.
  */
-static void WritePrefixOfParserFunction(FILE *lib_header, FILE *parser_c, const char *name_of_rule)
+typedef struct FirstSets
 {
-	assert(lib_header  != NULL && "Null parametr\n");
-	assert(name_of_rule != NULL && "Null parametr\n");
-
-	fprintf(lib_header,
-		"GEN_Context Try_%s(GEN_Tree *t, GEN_Token *sequence, GEN_Context ctx, uint64_t n_tokens);\n\n",
-		name_of_rule
-		);
+	NameTable *tokenizer_table;
+	NameTable *parser_table;
+	// has_token[rule * tokenizer_table->size + token]: rule can start with token.
+	bool      *has_token;
+	// Rule can start with any token: it's option starts with unknown node.
+	bool      *any_token;
+} FirstSets;
 
-	fprintf(parser_c, "GEN_Context Try_%s(GEN_Tree *t, GEN_Token *sequence, GEN_Context ctx, uint64_t n_tokens)\n{\n"
-		"\tGEN_Context try_ctx = ctx;\n"
-		"\tGEN_Tree %s_tree = {0};\n\n",
-		name_of_rule,
-		name_of_rule
-		);
+/**
+ * @brief Adds FIRST set of one symbol (chain) to FIRST
+ * set of rule (rule_idx).
+ *
+ * @returns   true if FIRST set of rule was changed.
+ */
+static bool AddSymbolFirst(FirstSets *first, uint64_t rule_idx, Node *chain)
+{
+	uint64_t n_tokens = first->tokenizer_table->size;
+	bool *rule_tokens = first->has_token + rule_idx * n_tokens;
+	bool changed = false;
+
+	int64_t chain_idx = kUndefinedIdx;
+	if (chain->token->parser_type == VAR_NAME_REFERENCE) {
+		chain_idx = SearchInTable(chain, first->tokenizer_table);
+		changed = !rule_tokens[chain_idx];
+		rule_tokens[chain_idx] = true;
+	} else if (chain->token->parser_type == RULE_NAME_REFERENCE &&
+			(chain_idx = SearchInTable(chain, first->parser_table)) != kUndefinedIdx) {
+		bool *chain_tokens = first->has_token + chain_idx * n_tokens;
+		for (uint64_t cur_token = 0; cur_token < n_tokens; ++cur_token) {
+			changed |= chain_tokens[cur_token] && !rule_tokens[cur_token];
+			rule_tokens[cur_token] |= chain_tokens[cur_token];
+		}
+		changed |= first->any_token[chain_idx] && !first->any_token[rule_idx];
+		first->any_token[rule_idx] |= first->any_token[chain_idx];
+	} else {
+		changed = !first->any_token[rule_idx];
+		first->any_token[rule_idx] = true;
+	}
 
-	fprintf(parser_c,
-		"\tGEN_AddChild(&%s_tree, GEN_CreateNodeByType(&%s_tree, %s));\n"
-		"\tGEN_Context new_ctx = {0};\n\n",
-		name_of_rule,
-		name_of_rule,
-		name_of_rule
-		);
+	return changed;
 }
 
-static void WriteReferenceToOtherRules(FILE *lib_header, char *tabs, uint64_t cur_child, uint64_t *n_tabs, char *name_of_rule)
+/**
+ * @returns   Next chain of option if option can start after (chain):
+ * (chain) is repeated zero or more times. NULL otherwise.
+ */
+static Node *NextStartChain(Node *chain)
 {
-	tabs[(*n_tabs)++] = '\t';
-
-	fprintf(lib_header,
-		"%snew_ctx = Try_%s_%lu(&%s_tree, sequence, try_ctx, n_tokens);\n",
-		tabs, name_of_rule, cur_child + 1, name_of_rule);
-
-	fprintf(lib_header,
-		"%sif (memcmp(&new_ctx, &try_ctx, sizeof(GEN_Context)) == 0) {\n",
-		tabs);
+	if (chain->token->repeat != REPEAT_STAR || chain->children == NULL) {
+		return NULL;
+	}
+	return GetChild(chain, 0);
 }
 
 /**
- * @brief Prints all obvious command to parser's file
- * 
- * @param lib_header        Header of library.
- * @param parser_c          Parser's c file
- * @param tokenizer_table   Tokenizer's name table.
+ * @brief Adds FIRST set of option which starts with (chain)
+ * to FIRST set of rule (rule_idx).
+ *
+ * @returns   true if FIRST set of rule was changed.
  */
-static void WriteObviousCommands(FILE *lib_header, FILE *parser_c, NameTable *tokenizer_table)
+static bool AddChainFirst(FirstSets *first, uint64_t rule_idx, Node *chain)
 {
-	fprintf(lib_header,
-		"GEN_Context GEN_TryToken(GEN_Tree *t, GEN_Token *sequence, GEN_TokenType expected_type, GEN_Context ctx, uint64_t n_tokens);\n");
-
-	fprintf(parser_c,
-		"GEN_Context GEN_TryToken(GEN_Tree *t, GEN_Token *sequence, GEN_TokenType expected_type, GEN_Context ctx, uint64_t n_tokens)\n"
-		"{\n"
-		"\tmsg(D_PARSER_WORK, M, \"TryToken start t(%%s|idx:%%lu)\\n\", sequence[ctx.cur_token_idx].txt, ctx.cur_token_idx);\n"
-		"\tGEN_Tree try_token_tree = {0};\n"
-		"\tGEN_AddChild(&try_token_tree, GEN_CreateNode(&try_token_tree, sequence + n_tokens - 1));\n"
-		"\tif (sequence[ctx.cur_token_idx].type == expected_type) {\n"
-		"\t\tGEN_AddChild(&try_token_tree, GEN_CreateNode(&try_token_tree, sequence + ctx.cur_token_idx));\n"
-		"\t\t++ctx.n_parsed;\n"
-		"\t\t++ctx.cur_token_idx;\n"
-		"\t} else { return ctx; }\n\n"
-		"\tGEN_Parent(&try_token_tree);\n"
-		"\tGEN_AppendTree(t, &try_token_tree);\n"
-		"\tmsg(D_PARSER_WORK, M, \"END of TryToken\\n\");\n"
-		"\treturn ctx;\n"
-		"}\n\n");
-
-	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
-		if (strcmp(tokenizer_table->names[cur_el]->token->txt, "start") == 0) {
-			fprintf(parser_c,
-				"GEN_Tree *ParseSequence(GEN_Tree *t, GEN_Token *s, GEN_Context ctx, int64_t n_tokens) {\n"
-				"\tTry_%s(t, s, ctx, n_tokens);\n"
-				"\treturn t;\n"
-				"}\n\n",
-				GetTxt(GetChild(GetChild(tokenizer_table->names[cur_el]->parent, 1), 0))
-				);
-
-			fprintf(lib_header,
-				"GEN_Tree *ParseSequence(GEN_Tree *t, GEN_Token *s, GEN_Context ctx, int64_t n_tokens);\n");
-			break;
-		}
+	bool changed = false;
+	for (; chain != NULL; chain = NextStartChain(chain)) {
+		changed |= AddSymbolFirst(first, rule_idx, chain);
+	}
+	return changed;
+}
 
+/// @returns   Index of rule which starts with (chain) or (kUndefinedIdx) if chain isn't rule.
+static int64_t ChainRule(NameTable *parser_table, Node *chain)
+{
+	if (chain->token->parser_type != RULE_NAME_REFERENCE) {
+		return kUndefinedIdx;
 	}
+	return SearchInTable(chain, parser_table);
 }
 
 /**
- * @brief Prints one chain in sequence of tokence in line
- * of YACC-rule line.
- * 
- * @param parser_c       Parser's c file.
- * @param chain          Current node in parser's AST.
- * @param tabs           Number of tabs to print before each line.
- * @param cur_child      Index of current child (=line index of current rule).
- * @param name_of_rule   Name of current rule in parser's AST.
+ * @brief Computes FIRST sets of all the rules by worklist: rule is processed
+ * again only when FIRST set of rule which starts one of it's options is changed,
+ * so long chains of rules don't need pass over all the rules for each rule in chain.
+ *
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param parser_table      Parser's name table.
+ * @returns                 FIRST sets of all the rules.
  */
-static void WriteChain
-	(FILE *parser_c, Node *chain, char *tabs, uint64_t cur_child, char *name_of_rule)
+static FirstSets *FirstSetsCtor(NameTable *tokenizer_table, NameTable *parser_table)
 {
-	msg(D_FILE_PRINT, M,
-		"Current node in line:%s\n", chain->token->txt);
+	assert(tokenizer_table != NULL && "Null param");
+	assert(parser_table    != NULL && "Null param");
+
+	FirstSets *first = (FirstSets *)calloc(1, sizeof(FirstSets));
+	assert(first != NULL && "Null calloc allocation");
+
+	first->tokenizer_table = tokenizer_table;
+	first->parser_table    = parser_table;
+	first->has_token = (bool *)calloc(parser_table->size * tokenizer_table->size + 1, sizeof(bool));
+	first->any_token = (bool *)calloc(parser_table->size + 1, sizeof(bool));
+	assert(first->has_token != NULL && "Null calloc allocation");
+	assert(first->any_token != NULL && "Null calloc allocation");
+
+	uint64_t n_rules = parser_table->size;
+	// Users of rule: rules which have option starting with it,
+	// users of (rule) are users[users_start[rule], users_start[rule + 1]).
+	uint64_t *users       = NULL;
+	uint64_t *users_start = (uint64_t *)calloc(n_rules + 2, sizeof(uint64_t));
+	assert(users_start != NULL && "Null calloc allocation");
+	for (int pass = 0; pass < 2; ++pass) {
+		for (uint64_t cur_rule = 0; cur_rule < n_rules; ++cur_rule) {
+			Node *fork = GetChild(parser_table->names[cur_rule], 0);
+			for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+				Node *chain = GetChild(fork, cur_option);
+				for (; chain != NULL; chain = NextStartChain(chain)) {
+					int64_t chain_idx = ChainRule(parser_table, chain);
+					if (chain_idx == kUndefinedIdx) {
+						continue;
+					}
+					// First pass counts users, second one fills them.
+					if (pass == 0) {
+						++users_start[chain_idx + 2];
+					} else {
+						users[users_start[chain_idx + 1]++] = cur_rule;
+					}
+				}
+			}
+		}
+		if (pass == 0) {
+			for (uint64_t cur_rule = 0; cur_rule < n_rules; ++cur_rule) {
+				users_start[cur_rule + 2] += users_start[cur_rule + 1];
+			}
+			users = (uint64_t *)calloc(users_start[n_rules + 1] + 1, sizeof(uint64_t));
+			assert(users != NULL && "Null calloc allocation");
+		}
+	}
 
-	fprintf(parser_c,
-		"%stab_incr();\n"
-		"%smsg(D_PARSER_WORK, M, \"new chain in option\\n\");\n"
-		"%stab_incr();\n",
-		tabs, tabs, tabs);
+	// Circular queue of rules to process, each rule is in it at most once.
+	uint64_t *queue    = (uint64_t *)calloc(n_rules + 1, sizeof(uint64_t));
+	bool     *in_queue = (bool *)calloc(n_rules + 1, sizeof(bool));
+	assert(queue != NULL && in_queue != NULL && "Null calloc allocation");
+
+	//  Rules are queued in postorder of DFS by first chains of options,
+	// so rule goes after rules it starts with (if they aren't in cycle).
+	uint64_t *stack       = (uint64_t *)calloc(n_rules + 1, sizeof(uint64_t));
+	uint64_t *next_option = (uint64_t *)calloc(n_rules + 1, sizeof(uint64_t));
+	assert(stack != NULL && next_option != NULL && "Null calloc allocation");
+	uint64_t n_ordered = 0;
+	for (uint64_t root = 0; root < n_rules; ++root) {
+		if (in_queue[root]) {
+			continue;
+		}
+		uint64_t depth = 0;
+		in_queue[root] = true;
+		stack[depth++] = root;
+		while (depth > 0) {
+			uint64_t cur_rule = stack[depth - 1];
+			Node    *fork     = GetChild(parser_table->names[cur_rule], 0);
+			if (next_option[cur_rule] == fork->children->size) {
+				queue[n_ordered++] = cur_rule;
+				--depth;
+				continue;
+			}
 
-	if (chain->token->parser_type == NOT_SPECIAL) {
-		fprintf(parser_c,
-			"%snew_ctx = GEN_TryToken(&%s_%lu_tree, sequence, %s, try_ctx, n_tokens);\n",
-			tabs, name_of_rule, cur_child + 1, TranslateTokenType(GetType(chain)));
+			int64_t chain_idx = ChainRule(parser_table, GetChild(fork, next_option[cur_rule]++));
+			if (chain_idx != kUndefinedIdx && !in_queue[chain_idx]) {
+				in_queue[chain_idx] = true;
+				stack[depth++] = (uint64_t)chain_idx;
+			}
+		}
+	}
+	free(next_option);
+	free(stack);
+
+	uint64_t head     = 0;
+	uint64_t n_queued = n_rules;
+	while (n_queued > 0) {
+		uint64_t cur_rule = queue[head];
+		head = (head + 1) % n_rules;
+		--n_queued;
+		in_queue[cur_rule] = false;
+
+		bool  changed = false;
+		Node *fork    = GetChild(parser_table->names[cur_rule], 0);
+		for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+			changed |= AddChainFirst(first, cur_rule, GetChild(fork, cur_option));
+		}
+		if (!changed) {
+			continue;
+		}
 
-	} else if (chain->token->parser_type == RULE_NAME_REFERENCE) {
-		fprintf(parser_c,
-			"%snew_ctx = Try_%s(&%s_%lu_tree, sequence, try_ctx, n_tokens);\n",
-			tabs, chain->token->txt, name_of_rule, cur_child + 1);
-	} else if (chain->token->parser_type == VAR_NAME_REFERENCE) {
-		fprintf(parser_c,
-			"%snew_ctx = GEN_TryToken(&%s_%lu_tree, sequence, %s, try_ctx, n_tokens);\n",
-			tabs, name_of_rule, cur_child + 1, chain->token->txt);
+		for (uint64_t cur_user = users_start[cur_rule]; cur_user < users_start[cur_rule + 1]; ++cur_user) {
+			uint64_t user = users[cur_user];
+			if (!in_queue[user]) {
+				queue[(head + n_queued) % n_rules] = user;
+				in_queue[user] = true;
+				++n_queued;
+			}
+		}
 	}
 
-	fprintf(parser_c,
-		"%stab_decr();\n",
-		tabs);
+	free(in_queue);
+	free(queue);
+	free(users_start);
+	free(users);
+	return first;
+}
 
-	fprintf(parser_c,
-		"%sif (memcmp(&new_ctx, &try_ctx, sizeof(GEN_Context)) == 0) {\n"
-		"%s\tmsg(D_PARSER_WORK, M, \"NOT NEEDED OPTION: Try_%s_%lu\\n\");\n"
-		"%s\ttab_decr();\n"
-		"%s\treturn ctx;\n"
-		"%s}\n"
-		"%stry_ctx = new_ctx;\n",
-		tabs, tabs, name_of_rule, cur_child + 1, tabs, tabs, tabs, tabs);
+static void FirstSetsDtor(FirstSets *first)
+{
+	assert(first != NULL && "Null param");
 
-	fprintf(parser_c,
-		"%smsg(D_PARSER_WORK, M, \"END chain in option\\n\");\n"
-		"%stab_decr();\n\n",
-		tabs, tabs);
+	free(first->has_token);
+	free(first->any_token);
+	free(first);
 }
 
 /**
- * @brief Prints one parser's command using parser's AST tree.
- * 
- * @param lib_header   Header of library.
- * @param parser_c     Parser's c file.
- * @param n            Current node in parser's tree
+ * @brief Checks if symbol (chain) can start with
+ * token (token_idx) of tokenizer's table.
+ * Token (kUndefinedIdx) means token which isn't in FIRST sets.
  */
-static void GenerateCommand(FILE *lib_header, FILE *parser_c, Node *n)
+static bool SymbolCanStartWith(const FirstSets *first, Node *chain, int64_t token_idx)
 {
-	assert(lib_header != NULL && "Null parametr\n");
-	assert(n           != NULL && "Null parametr\n");
-	assert(n->children != NULL && "Null parametr\n");
+	int64_t chain_idx = kUndefinedIdx;
+	if (chain->token->parser_type == VAR_NAME_REFERENCE) {
+		return SearchInTable(chain, first->tokenizer_table) == token_idx;
+	} else if (chain->token->parser_type == RULE_NAME_REFERENCE &&
+			(chain_idx = SearchInTable(chain, first->parser_table)) != kUndefinedIdx) {
+		return first->any_token[chain_idx] ||
+			(token_idx != kUndefinedIdx &&
+			first->has_token[chain_idx * first->tokenizer_table->size + token_idx]);
+	}
+	return true;
+}
 
-	/* Name of current name
-	Of rule to use it as part of names of variables
-	or names of parser functions.*/
-	char *name_of_rule = n->token->txt;
+/**
+ * @brief Checks if option which starts with (chain) can
+ * start with token (token_idx): with it's first symbol or with
+ * symbol after first symbols which can be repeated zero times.
+ */
+static bool ChainCanStartWith(const FirstSets *first, Node *chain, int64_t token_idx)
+{
+	for (; chain != NULL; chain = NextStartChain(chain)) {
+		if (SymbolCanStartWith(first, chain, token_idx)) {
+			return true;
+		}
+	}
+	return false;
+}
 
-	/* To generate more beautiful code
-	Function use tabs and '\n'-symbols*/
-	char tabs[kTokenMaxLen] = "";
-	uint64_t n_tabs = 0;
+// Precedence of operators. ------------------------------------------------------------
 
-	Node *fork = GetChild(n, 0);
+/// Associativity of operators of %left, %right and %nonassoc.
+typedef enum Assoc
+{
+	ASSOC_LEFT,
+	ASSOC_RIGHT,
+	ASSOC_NONASSOC,
+} Assoc;
 
-	for (uint64_t cur_child = 0; cur_child < fork->children->size; ++cur_child) {
-		fprintf(lib_header,
-			"GEN_Context Try_%s_%ld(GEN_Tree *t, GEN_Token *sequence, GEN_Context ctx, uint64_t n_tokens);\n\n",
-			name_of_rule, cur_child + 1);
-		// Firstly we will write all the options of this rule to the parser file.
-		fprintf(parser_c,
-			"GEN_Context Try_%s_%ld(GEN_Tree *t, GEN_Token *sequence, GEN_Context ctx, uint64_t n_tokens)\n{\n",
-			name_of_rule, cur_child + 1);
+/// Levels of operators and rules which are parsed by precedence climbing.
+typedef struct Precedence
+{
+	NameTable *tokenizer_table;
+	NameTable *parser_table;
+	// Level of each token of tokenizer's table (0 if it isn't operator) and it's associativity.
+	uint64_t  *levels;
+	Assoc     *assoc;
+	uint64_t   n_levels;
+	// operators[rule * tokenizer_table->size + token]: token is binary operator of rule.
+	bool      *operators;
+	bool      *climbs;
+	uint64_t   n_climbing;
+} Precedence;
+
+static void PrecedenceDtor(Precedence *precedence)
+{
+	assert(precedence != NULL && "Null param");
 
-		tabs[n_tabs++] = '\t';
+	free(precedence->levels);
+	free(precedence->assoc);
+	free(precedence->operators);
+	free(precedence->climbs);
+	free(precedence);
+}
 
-		fprintf(parser_c,
-			"%smsg(D_PARSER_WORK, M, \"%s\\n\");\n",
-			tabs, name_of_rule);
+/**
+ * @brief Reads levels of operators: each of %left, %right and %nonassoc
+ * in order of YACC-file is next level, later levels bind tighter.
+ *
+ * @returns   false if some operator is unknown or has two levels.
+ */
+static bool ReadPrecedenceLevels(Precedence *precedence, Tree *tokenizer_tree)
+{
+	static const struct { const char *name; Assoc assoc; } kDirectives[] = {
+		{"left", ASSOC_LEFT}, {"right", ASSOC_RIGHT}, {"nonassoc", ASSOC_NONASSOC},
+	};
+	NameTable *tokenizer_table = precedence->tokenizer_table;
+
+	Node *root = tokenizer_tree->root;
+	for (uint64_t cur_var = 0; root->children != NULL && cur_var < root->children->size; ++cur_var) {
+		// Each variable is (name = value) node.
+		Node *eq   = GetChild(root, cur_var);
+		Node *name = GetChild(eq, 0);
+		size_t directive = 0;
+		while (directive < sizeof(kDirectives) / sizeof(kDirectives[0]) &&
+				!TxtEqual(name, kDirectives[directive].name)) {
+			++directive;
+		}
+		if (directive == sizeof(kDirectives) / sizeof(kDirectives[0])) {
+			continue;
+		}
+		if (eq->children->size < 2 || GetChild(eq, 1)->children == NULL) {
+			printf("%%%s should be string of tokens\n", kDirectives[directive].name);
+			return false;
+		}
 
-		fprintf(parser_c,
-			"%sGEN_Context try_ctx = ctx;\n"
-			"%sGEN_Tree %s_%ld_tree = {0};\n",
-			tabs, tabs, name_of_rule, cur_child + 1);
+		uint64_t    level   = ++precedence->n_levels;
+		Node       *value   = GetChild(GetChild(eq, 1), 0);
+		const char *txt     = GetTxt(value);
+		size_t      len     = GetLen(value);
+		size_t      cur_sym = 0;
+		while (cur_sym < len) {
+			if (isspace((unsigned char)txt[cur_sym])) {
+				++cur_sym;
+				continue;
+			}
+			size_t name_len = 0;
+			while (cur_sym + name_len < len && !isspace((unsigned char)txt[cur_sym + name_len])) {
+				++name_len;
+			}
 
-		fprintf(parser_c,
-			"%sGEN_AddChild(&%s_%lu_tree, GEN_CreateNodeByType(&%s_%lu_tree, %s_%lu));\n"
-			"%sGEN_Context new_ctx = {0};\n\n",
-			tabs, name_of_rule, cur_child + 1,
-			name_of_rule, cur_child + 1,
-			name_of_rule, cur_child + 1,
-			tabs);
+			int64_t token = tokenizer_table->slots[FindSlot(tokenizer_table, txt + cur_sym, name_len)];
+			if (token == kUndefinedIdx || PhonyVariables(tokenizer_table, (uint64_t)token)) {
+				printf("Unknown token in %%%s: %.*s\n", kDirectives[directive].name, (int)name_len, txt + cur_sym);
+				return false;
+			}
+			if (precedence->levels[token] != 0) {
+				printf("Token %.*s has two levels of precedence\n", (int)name_len, txt + cur_sym);
+				return false;
+			}
+			precedence->levels[token] = level;
+			precedence->assoc[token]  = kDirectives[directive].assoc;
+			cur_sym += name_len;
+		}
+	}
+	return true;
+}
 
-		Node *chain = GetChild(fork, cur_child);
-		tab_incr();
-		while (chain->children != NULL) {
-			WriteChain(parser_c, chain, tabs, cur_child, name_of_rule);
-			chain = GetChild(chain, 0);
+/**
+ * @returns   Token of operator if option is (rule operator rule) without repetitions
+ * and cuts and operator has level of precedence, else (kUndefinedIdx).
+ */
+static int64_t BinaryOperator(const Precedence *precedence, Node *rule, Node *option)
+{
+	Node *symbols[3] = {option, NULL, NULL};
+	for (size_t cur_symbol = 0; cur_symbol < 3; ++cur_symbol) {
+		Node *symbol = symbols[cur_symbol];
+		if (symbol == NULL || symbol->token->repeat != REPEAT_ONCE || symbol->token->cut ||
+				(cur_symbol == 2) != (symbol->children == NULL)) {
+			return kUndefinedIdx;
 		}
-		// 	Write last chain in sequence in particular
-		// line in rule.
-		WriteChain(parser_c, chain, tabs, cur_child, name_of_rule);
-		fprintf(parser_c,
-			"\tGEN_AppendTree(t, &%s_%lu_tree);\n",
-			name_of_rule, cur_child + 1);
+		if (cur_symbol < 2) {
+			symbols[cur_symbol + 1] = GetChild(symbol, 0);
+		}
+	}
 
-		tab_decr();
-		msg(D_FILE_PRINT, M,
-					"end of line\n");
+	Node *left     = symbols[0];
+	Node *operator = symbols[1];
+	Node *right    = symbols[2];
+	if (left->token->parser_type  != RULE_NAME_REFERENCE || !SameTxt(left, rule) ||
+			right->token->parser_type != RULE_NAME_REFERENCE || !SameTxt(right, rule) ||
+			operator->token->parser_type != VAR_NAME_REFERENCE) {
+		return kUndefinedIdx;
+	}
+	int64_t token = SearchInTable(operator, precedence->tokenizer_table);
+	return (token != kUndefinedIdx && precedence->levels[token] != 0)? token : kUndefinedIdx;
+}
 
-		fprintf(parser_c,
-			"%smsg(D_PARSER_WORK, M, \"EXACTLY Try_%s_%lu\\n\");\n",
-			tabs, name_of_rule, cur_child + 1);
+/**
+ * @brief Finds rules which are parsed by precedence climbing: rules with
+ * option (rule operator rule) whose operator has level of precedence.
+ * Such options are removed from rule: it's other options are operands
+ * and binary options are parsed by one loop over operators.
+ * Result is the same as derivation of binary options: node of rule
+ * with left operand, operator and right operand.
+ *
+ * @param tokenizer_tree    Tokenizer's tree.
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param parser_table      Parser's name table.
+ * @returns                 Precedence of operators or NULL if grammar is wrong.
+ */
+static Precedence *ScanPrecedence(Tree *tokenizer_tree, NameTable *tokenizer_table, NameTable *parser_table)
+{
+	assert(tokenizer_tree  != NULL && "Null param");
+	assert(tokenizer_table != NULL && "Null param");
+	assert(parser_table    != NULL && "Null param");
+
+	Precedence *precedence = (Precedence *)calloc(1, sizeof(Precedence));
+	assert(precedence != NULL && "Null calloc allocation");
+	precedence->tokenizer_table = tokenizer_table;
+	precedence->parser_table    = parser_table;
+	precedence->levels    = (uint64_t *)calloc(tokenizer_table->size + 1, sizeof(uint64_t));
+	precedence->assoc     = (Assoc *)calloc(tokenizer_table->size + 1, sizeof(Assoc));
+	precedence->operators = (bool *)calloc(parser_table->size * tokenizer_table->size + 1, sizeof(bool));
+	precedence->climbs    = (bool *)calloc(parser_table->size + 1, sizeof(bool));
+	assert(precedence->levels    != NULL && "Null calloc allocation");
+	assert(precedence->assoc     != NULL && "Null calloc allocation");
+	assert(precedence->operators != NULL && "Null calloc allocation");
+	assert(precedence->climbs    != NULL && "Null calloc allocation");
+
+	if (!ReadPrecedenceLevels(precedence, tokenizer_tree)) {
+		PrecedenceDtor(precedence);
+		return NULL;
+	}
 
-		fprintf(parser_c,
-			"%sGEN_InsertParent(t, GEN_CreateNode(t, sequence + n_tokens - 1));\n",
-			tabs);
+	for (uint64_t cur_rule = 0; precedence->n_levels > 0 && cur_rule < parser_table->size; ++cur_rule) {
+		Node  *rule       = parser_table->names[cur_rule];
+		Node  *fork       = GetChild(rule, 0);
+		Node **options    = (Node **)fork->children->data;
+		bool  *operators  = precedence->operators + cur_rule * tokenizer_table->size;
+		uint64_t n_operands = 0;
+		for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+			int64_t token = BinaryOperator(precedence, rule, options[cur_option]);
+			if (token != kUndefinedIdx) {
+				operators[token] = true;
+				precedence->climbs[cur_rule] = true;
+			} else {
+				options[n_operands++] = options[cur_option];
+			}
+		}
+		if (!precedence->climbs[cur_rule]) {
+			continue;
+		}
 
-		--n_tabs;
-		tabs[n_tabs] = '\0';
+		for (uint64_t cur_option = 0; cur_option < n_operands; ++cur_option) {
+			Node *first_symbol = options[cur_option];
+			if (first_symbol->token->parser_type == RULE_NAME_REFERENCE && SameTxt(first_symbol, rule)) {
+				printf("Rule (%.*s) is left recursive: it's options should be operands or"
+					" (%.*s operator %.*s) with operator of %%left, %%right or %%nonassoc\n",
+					NODE_TXT(rule), NODE_TXT(rule), NODE_TXT(rule));
+				PrecedenceDtor(precedence);
+				return NULL;
+			}
+		}
+		if (n_operands == 0) {
+			printf("Rule (%.*s) has operators but no operands\n", NODE_TXT(rule));
+			PrecedenceDtor(precedence);
+			return NULL;
+		}
 
-		fprintf(parser_c, "\treturn try_ctx;\n");
-		fprintf(parser_c, "}\n\n");
+		msg(D_PARSER_GENERATING, M,
+			"Rule (%.*s) is parsed by precedence climbing\n", NODE_TXT(rule));
+		fork->children->size = n_operands;
+		++precedence->n_climbing;
 	}
+	return precedence;
+}
 
-	/* Secondly print prefix of parser
-	function that contains local GEN_context - if that function
-	can be applied to the current place in sequence of token
-	this GEN_context will commit it and contain local progress
-	in parsing sequence.*/
-	WritePrefixOfParserFunction(lib_header, parser_c, name_of_rule);
-
-	msg(D_PARSER_GENERATING, M,
-		"Not tabs:\"%s\"(%lu)\n",
-		tabs, n_tabs);
+// Parallel units. --------------------------------------------------------------------
 
-	msg(D_PARSER_GENERATING, M,
-		"Current rule has (%lu) options\n",
-		fork->children->size);
+/// Rule of %parallel_unit: ranges of it's repetitions in %start rule are parsed by threads.
+typedef struct ParallelUnit
+{
+	NameTable *tokenizer_table;
+	NameTable *parser_table;
+	// Rule of %parallel_unit (kUndefinedIdx without it) and %start rule.
+	int64_t    unit_rule;
+	int64_t    start_rule;
+	// last[token]: unit can end with token of tokenizer's table.
+	bool      *last;
+	// Change of depth of brackets after token: +1 after "(", "[", "{" and -1 after ")", "]", "}".
+	int       *nesting;
+} ParallelUnit;
+
+static void ParallelUnitDtor(ParallelUnit *parallel)
+{
+	assert(parallel != NULL && "Null param");
 
-	for (uint64_t cur_child = 0; cur_child < fork->children->size; ++cur_child) {
-		WriteReferenceToOtherRules(parser_c, tabs, cur_child, &n_tabs, name_of_rule);
-	}
+	free(parallel->last);
+	free(parallel->nesting);
+	free(parallel);
+}
 
-	/* If all rules can't be applied to the sequence that was wrong rule
-	to parse current place in token sequence so we return original contest.*/
-	fprintf(parser_c, "%s\ttab_decr();\n", tabs);
-	fprintf(parser_c, "%s\treturn ctx;\n", tabs);
+static void AddRuleLast(ParallelUnit *parallel, uint64_t rule_idx, bool *visited);
 
-	// Write all close-braces for all ifs.
-	for (uint64_t cur_child = 0; cur_child < fork->children->size; ++cur_child) {
-		fprintf(parser_c,
-			"%s}\n",
-			tabs);
+/**
+ * @brief Adds tokens which can end (chain) to LAST set of unit.
+ * Symbols after (chain) are added first: symbol which can be
+ * skipped (symbol* or tail of list) needs LAST set of it's previous symbol.
+ *
+ * @returns   true if end of (chain) can be before (chain): previous symbol is needed.
+ */
+static bool AddChainLast(ParallelUnit *parallel, Node *chain, bool *visited)
+{
+	if (chain->children != NULL && !AddChainLast(parallel, GetChild(chain, 0), visited)) {
+		return false;
+	}
+	if (chain->token->repeat == REPEAT_TAIL) {
+		// List can end after previous repetition.
+		return true;
+	}
 
-		--n_tabs;
-		tabs[n_tabs] = '\0';
+	int64_t rule = ChainRule(parallel->parser_table, chain);
+	if (rule != kUndefinedIdx) {
+		AddRuleLast(parallel, (uint64_t)rule, visited);
+	} else {
+		int64_t token = SearchInTable(chain, parallel->tokenizer_table);
+		if (token != kUndefinedIdx) {
+			parallel->last[token] = true;
+		}
 	}
+	return chain->token->repeat == REPEAT_STAR;
+}
 
-	/* If one rule-option can be applied to the token sequence
-	we can add it's tree that was build by this option to the parent tree.*/
-	fprintf(parser_c,
-		"\n\tGEN_AppendTree(t, &%s_tree);\n"
-		"\treturn new_ctx;\n", name_of_rule);
+/// Adds tokens which can end options of rule (rule_idx) to LAST set of unit.
+static void AddRuleLast(ParallelUnit *parallel, uint64_t rule_idx, bool *visited)
+{
+	if (visited[rule_idx]) {
+		return;
+	}
+	visited[rule_idx] = true;
 
-	fprintf(parser_c, "}\n\n");
+	Node *fork = GetChild(parallel->parser_table->names[rule_idx], 0);
+	for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+		AddChainLast(parallel, GetChild(fork, cur_option), visited);
+	}
 }
 
 /**
- * @brief Prints all the parser's commands recursively.
- * 
- * @param lib_header   Header of library.
- * @param parser_c     Parser's c file.
- * @param n            Current node in parser's tree.
+ * @returns   true if %start rule (start) is list of (unit): it's only option is
+ * (unit start) folded to loop by FoldListRules, (unit+) or (unit*).
  */
-static void GenerateCommands(FILE *lib_header, FILE *parser_c, Node *n)
+static bool IsListOfUnits(Node *start, Node *unit)
 {
-	assert(lib_header != NULL && "Null parametr\n");
-	assert(parser_c   != NULL && "Null parametr\n");
-	assert(n          != NULL && "Null parametr\n");
-
-	if (n->token->parser_type == RULE_NAME) {
-		// Check if it's rule root node.
-		msg(D_FILE_PRINT, M,
-			"Found rule-node:\"%s\"\n",
-			n->token->txt);
-		//  If that's rule name we will
-		// generate function text and print it
-		// to the parser file.
-		tab_incr();
-		GenerateCommand(lib_header, parser_c, n);
-		tab_decr();
-	} else {
-		if (n->children != NULL) {
-			/*If that node is not a rule-root node, maybe it
-			contains rule-node in it's children so we will check
-			nodes one by one.*/
-			for (uint64_t cur_child = 0; cur_child < n->children->size; ++cur_child) {
-				msg(D_FILE_PRINT, M,
-					"This node NOT rule:\"%s\"\n",
-					n->token->txt);
-				msg(D_FILE_PRINT, M,
-					"Start to check childs nodes\n");
-				tab_incr();
-				GenerateCommands(lib_header, parser_c, GetChild(n, cur_child));
-				tab_decr();
-				msg(D_FILE_PRINT, M,
-					"End of parsing children\n");
-			}
-		}
-	}
-}
+	Node *fork = GetChild(start, 0);
+	if (fork->children->size != 1) {
+		return false;
+	}
+	Node *symbol = GetChild(fork, 0);
+	if (symbol->token->parser_type != RULE_NAME_REFERENCE || !SameTxt(symbol, unit) || symbol->token->cut) {
+		return false;
+	}
+	if (symbol->children == NULL) {
+		return symbol->token->repeat == REPEAT_PLUS || symbol->token->repeat == REPEAT_STAR;
+	}
+	Node *tail = GetChild(symbol, 0);
+	return symbol->token->repeat == REPEAT_ONCE && tail->children == NULL && tail->token->repeat == REPEAT_TAIL;
+}
 
 /**
- * @brief Searches all other (not rule-names) in parser's AST
- * And add's it's parser's type to that node.
- * Work's recursively.
- * 
- * @param n                 Current node in parser's AST.
+ * @brief Reads %parallel_unit: rule whose repetitions are the whole %start rule.
+ * Input can be split after token which can end unit (LAST set of rule) when this
+ * token isn't inside of brackets. Brackets are tokens which are literal
+ * "(", ")", "[", "]", "{" and "}". Split which is wrong is found by parser,
+ * so LAST set is only hint: symbols which can be empty are skipped by it.
+ *
  * @param tokenizer_table   Tokenizer's name table.
- * @param parser_table      Parser's name table
+ * @param parser_table      Parser's name table.
+ * @returns                 Parallel unit (unit_rule is kUndefinedIdx without
+ *                          %parallel_unit) or NULL if grammar is wrong.
  */
-static void SearchNamesInBranceParser
-	(Node *n, NameTable *tokenizer_table, NameTable *parser_table)
+static ParallelUnit *ScanParallelUnit(NameTable *tokenizer_table, NameTable *parser_table)
 {
-	assert(n     != NULL && "Null parametr\n");
-	assert(tokenizer_table != NULL && "Null parametr\n");
-
-	bool is_ref = false;
-	if (GetType(n) == TOKEN_NAME) {
-		if (SearchInTable(n, tokenizer_table) != -1) {
-			n->token->parser_type = VAR_NAME_REFERENCE;
-			is_ref = true;
-		}
-
-		if (!is_ref) {
-			if (GetType(n) == TOKEN_NAME &&
-					n->children != NULL &&
-					GetType(GetChild(n,0)) == TOKEN_COLON) {
-				n->token->parser_type = RULE_NAME;
-			} else {
-				n->token->parser_type = RULE_NAME_REFERENCE;
-			}
-		}
+	assert(tokenizer_table != NULL && "Null param");
+	assert(parser_table    != NULL && "Null param");
+
+	static const struct { const char *txt; int delta; } kBrackets[] = {
+		{"(", 1}, {"[", 1}, {"{", 1}, {")", -1}, {"]", -1}, {"}", -1},
+	};
+
+	ParallelUnit *parallel = (ParallelUnit *)calloc(1, sizeof(ParallelUnit));
+	assert(parallel != NULL && "Null calloc allocation");
+	parallel->tokenizer_table = tokenizer_table;
+	parallel->parser_table    = parser_table;
+	parallel->unit_rule       = kUndefinedIdx;
+	parallel->start_rule      = kUndefinedIdx;
+
+	int64_t unit = FindName(tokenizer_table, "parallel_unit");
+	if (unit == kUndefinedIdx) {
+		return parallel;
 	}
-
-	if (n->children != NULL) {
-		for (size_t cur_child_idx = 0; cur_child_idx < n->children->size; ++cur_child_idx) {
-			Node *cur_child = GetChild(n, cur_child_idx);
-			tab_incr();
-			SearchNamesInBranceParser(cur_child, tokenizer_table, parser_table);
-			tab_decr();
-			msg(D_NAMETABLE, M,
-				"End this child\n");
-		}
+	parallel->unit_rule = SearchInTable(VariableValue(tokenizer_table->names[unit]), parser_table);
+	if (parallel->unit_rule == kUndefinedIdx) {
+		printf("%%parallel_unit should be rule: %.*s\n", NODE_TXT(VariableValue(tokenizer_table->names[unit])));
+		ParallelUnitDtor(parallel);
+		return NULL;
 	}
-}
-
-/**
- * @brief Finds all names in parser's tree by
- * searching for situation: current node is node with
- * type (TOKEN_NAME) and it has only one child: (TOKEN_COLON).
- */
-static void AddRuleNames(Node *n, NameTable *parser_table)
-{
-	if (GetType(n) == TOKEN_NAME &&
-			n->children != NULL &&
-			GetType(GetChild(n,0)) == TOKEN_COLON) {
-		// Add new rule name in (parser_table).
-		AddName(parser_table, n);
+	int64_t start = FindName(tokenizer_table, "start");
+	if (start != kUndefinedIdx) {
+		parallel->start_rule = SearchInTable(VariableValue(tokenizer_table->names[start]), parser_table);
+	}
+	Node *unit_rule = parser_table->names[parallel->unit_rule];
+	if (parallel->start_rule == kUndefinedIdx ||
+			!IsListOfUnits(parser_table->names[parallel->start_rule], unit_rule)) {
+		printf("%%start rule should be list of %%parallel_unit: (%.*s %%start | %.*s) or %.*s+\n",
+			NODE_TXT(unit_rule), NODE_TXT(unit_rule), NODE_TXT(unit_rule));
+		ParallelUnitDtor(parallel);
+		return NULL;
 	}
 
-	// Call this fuction recursively for all children.
-	if (n->children != NULL) {
-		for (size_t cur_child = 0; cur_child < n->children->size; ++cur_child) {
-			AddRuleNames(GetChild(n, cur_child), parser_table);
+	parallel->last    = (bool *)calloc(tokenizer_table->size + 1, sizeof(bool));
+	parallel->nesting = (int *)calloc(tokenizer_table->size + 1, sizeof(int));
+	bool *visited     = (bool *)calloc(parser_table->size + 1, sizeof(bool));
+	assert(parallel->last    != NULL && "Null calloc allocation");
+	assert(parallel->nesting != NULL && "Null calloc allocation");
+	assert(visited           != NULL && "Null calloc allocation");
+	AddRuleLast(parallel, (uint64_t)parallel->unit_rule, visited);
+	free(visited);
+
+	for (uint64_t cur_token = 0; cur_token < tokenizer_table->size; ++cur_token) {
+		Node *name = tokenizer_table->names[cur_token];
+		if (PhonyVariables(tokenizer_table, cur_token) || IsRegexVariable(name)) {
+			continue;
+		}
+		for (size_t cur_bracket = 0; cur_bracket < sizeof(kBrackets) / sizeof(kBrackets[0]); ++cur_bracket) {
+			if (TxtEqual(VariableValue(name), kBrackets[cur_bracket].txt)) {
+				parallel->nesting[cur_token] = kBrackets[cur_bracket].delta;
+			}
 		}
 	}
-}
-
-/**
- * @brief Search all parser's
- * names and set's all parser's types for two pass. First pass is for searching all
- * the rule names. It is needed to make recursive descent.
- * Second pass sets all other parser's types.
- * 
- * @param parser_tree       Parser's tree to scan for names
- * @param tokenizer_table   Tokenizer's tokenizer_table to extract name
- * and meanings of it's variables.
- * @return                  Created parser's tokenizer_table
- */
-NameTable *ScanParserNames(Tree *parser_tree, NameTable *tokenizer_table)
-{
-	assert(parser_tree != NULL && "Null parametr\n");
-	assert(tokenizer_table       != NULL && "Null parametr\n");
-	// Allocate name tokenizer_table for searching familiar names
-	NameTable *parser_table = (NameTable*)calloc(1, sizeof(NameTable));
-	assert(parser_table != NULL && "Null calloc allocation\n");
-	// Allocate array of names.
-	parser_table->names = (Node**)calloc(kInitSizeNamesArray, sizeof(Node*));
-	assert(parser_table != NULL && "Null calloc allocation\n");
-
-	AddRuleNames(parser_tree->root, parser_table);
-
-	tab_incr();
-	SearchNamesInBranceParser(parser_tree->root, tokenizer_table, parser_table);
-	tab_decr();
 
-	return parser_table;
+	msg(D_PARSER_GENERATING, M,
+		"Rule (%.*s) is parallel unit\n", NODE_TXT(unit_rule));
+	return parallel;
 }
 
+// Generation parser file. -------------------------------------------------------------
+
 /**
- * @brief Prints the whole parser's file.
- * 
- * @param parser_tree       AST tree of parser
- * @param tokenizer_table   Tokenizer's table.
- * @param lib_header        Header of library.
+ * @brief Prints line of parser's tracing (msg, tab_incr, tab_decr)
+ * to parser's file. Nothing is printed with --no-trace.
+ *
+ * @param parser_c   Parser's c file.
+ * @param options    Options of generator.
+ * @param format     Format of printed line.
  */
-static void GenerateParserFile
-	(Tree *parser_tree, NameTable *tokenizer_table, FILE *lib_header)
+static void WriteTrace(FILE *parser_c, const GeneratorOptions *options, const char *format, ...)
 {
-	FILE *parser_c = fopen("../out/Parser_GEN.c", "w");
-
-	fprintf(parser_c,
-		"#include <../MchlkrpchLogger/logger.h>\n\n"
-		"#include <lib_GEN.h>\n\n"
-		);
+	assert(parser_c != NULL && "Null param");
+	assert(options  != NULL && "Null param");
 
-	// Print common commands.
-	WriteObviousCommands(lib_header, parser_c, tokenizer_table);
-
-	// Add all parser's command to (parser_c)-file.
-	tab_incr();
-	GenerateCommands(lib_header, parser_c, parser_tree->root);
-	tab_decr();
+	if (options->no_trace) {
+		return;
+	}
 
-	fclose(parser_c);
+	va_list args;
+	va_start(args, format);
+	vfprintf(parser_c, format, args);
+	va_end(args);
 }
 
 /**
- * @brief Prints the whole Tree_GEN.c file and add's it's
- * commands to (lib_header)-file.
- * 
- * @param lib_header   Header file of library.
+ * @brief Prints counters of profile (--profile): one entry for each
+ * Try_<rule> and Try_<rule>_<n>, functions to count them and GEN_DumpProfile.
+ *
+ * @param lib_header     Header of library.
+ * @param parser_c       Parser's c file.
+ * @param parser_table   Parser's table.
  */
-static void GenerateTreeFile(FILE *lib_header)
+static void WriteProfile(FILE *lib_header, FILE *parser_c, NameTable *parser_table)
 {
-	FILE *c_file = fopen("../out/Tree_GEN.c", "w");
+	assert(lib_header   != NULL && "Null param");
+	assert(parser_c     != NULL && "Null param");
+	assert(parser_table != NULL && "Null param");
 
 	fprintf(lib_header,
-		"#pragma once\n\n"
-		"#define NODE_FMT                                        \\\n"
-  	"\t\"\\tn%%lu [shape=\\\"%%s\\\" color=\\\"%%s\\\" label=\\\"(%%s)\\\\n%%s\\\"]\\n\"\n\n"
-  	"#define kTokenMaxLen 256\n"
-		"typedef struct\n"
-		"{\n"
-		"	uint64_t size;\n"
-		"	uint64_t capacity;\n"
-		"	uint64_t element_size;\n"
-		"	void *data;\n"
-		"} GEN_Array;\n\n"
+		"#define GEN_PROFILE\n\n"
+		"// Prints counters of current thread sorted by cycles (or as JSON).\n"
+		"void GEN_DumpProfile(FILE *f, bool json);\n\n"
+		"void GEN_ResetProfile();\n\n");
+
+	fprintf(parser_c, "enum\n{\n");
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		Node *rule = parser_table->names[cur_rule];
+		fprintf(parser_c, "\tGEN_PROFILE_%.*s,\n", NODE_TXT(rule));
+		for (uint64_t cur_option = 0; cur_option < GetChild(rule, 0)->children->size; ++cur_option) {
+			fprintf(parser_c, "\tGEN_PROFILE_%.*s_%lu,\n", NODE_TXT(rule), cur_option + 1);
+		}
+	}
+	fprintf(parser_c, "\tkProfileSize,\n};\n\n");
+
+	fprintf(parser_c, "static const char *const GEN_profile_names[kProfileSize] =\n{\n");
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		Node *rule = parser_table->names[cur_rule];
+		fprintf(parser_c, "\t\"Try_%.*s\",\n", NODE_TXT(rule));
+		for (uint64_t cur_option = 0; cur_option < GetChild(rule, 0)->children->size; ++cur_option) {
+			fprintf(parser_c, "\t\"Try_%.*s_%lu\",\n", NODE_TXT(rule), cur_option + 1);
+		}
+	}
+	fprintf(parser_c, "};\n\n");
 
-		"typedef struct GEN_Node\n"
-		"{\n"
-		"\t// Children of particular GEN_node.\n"
-		"\tGEN_Array           *children;\n"
-		"\t// Token of current cell in AST.\n"
-		"\tGEN_Token       *token;\n"
-		"\t// Numbered-id for each GEN_node.\n"
-		"\tuint64_t     id;\n"
-		"\t// Parent GEN_node for current one.\n"
-		"\tstruct GEN_Node *parent;\n"
-		"\t// bool         rule_name;\n"
-		"\t// Type of GEN_node in parser generating.\n"
-		"} GEN_Node;\n"
+	fprintf(parser_c,
 		"typedef struct\n"
 		"{\n"
-		"\tGEN_Node   *root;\n"
-		"\tGEN_Node   *current;\n"
-		"\tsize_t      size;\n"
-		"\tconst char *data;\n"
-		"} GEN_Tree;\n"
-		"GEN_Node *GEN_NodeCtor();\n\n"
-		"GEN_Tree *GEN_TreeCtor(GEN_TokenType type);\n\n"
-		"GEN_Node *GEN_AddChild(GEN_Tree *t, GEN_Node *new_child);\n\n"
-		"void GEN_InsertParent(GEN_Tree *t, GEN_Node *n);\n\n"
-		"const char *GEN_CellBordersFormat(GEN_TokenType t);\n\n"
-		"const char *GEN_CheckIfRuleName(GEN_PrsrNdType type);\n\n"
-		"GEN_TokenType GEN_Ttype(GEN_Node *n);\n\n"
-		"void GEN_PrintNode(FILE *f, GEN_Node *n);\n\n"
-		"void GEN_ConnectNode(FILE *f, GEN_Node *n);\n\n"
-		"void GEN_DebugTree(GEN_Tree *t);\n\n"
-		"void GEN_Parent(GEN_Tree *t);\n\n"
-		"GEN_Node *GEN_GetChild(GEN_Node *n, uint64_t idx);\n\n"
-		"void GEN_AppendTree(GEN_Tree *first, GEN_Tree *second);\n\n"
-		"GEN_Node *GEN_CreateNodeByType(GEN_Tree *t, GEN_TokenType type);\n\n"
-		"GEN_Node *GEN_CreateNode(GEN_Tree *t, GEN_Token *token);\n\n"
-
-		"GEN_Array *GEN_ArrayCtor(uint64_t el_sz);\n"
-		"void GEN_ArrayChangeCapacity(GEN_Array *a, uint64_t new_capacity);\n"
-		"void GEN_ArrayAdd(GEN_Array *a, void *new_element);\n"
-		"void GEN_FillEmptyStr(char **dest, const char *src);\n"
-		);
-
-	fprintf(lib_header,
-		"void GEN_CompressTree(GEN_Tree *t, GEN_Node *n);\n\n");
-
-	fprintf(c_file,
-		"#include <lib_GEN.h>\n"
-		"#include <assert.h>\n"
-		"#include <MchlkrpchLogger/logger.h>\n\n");
-
-	fprintf(c_file,
-		"GEN_Node *GEN_NodeCtor()\n"
-		"{\n"
-		"\tGEN_Node *n = (GEN_Node *)calloc(1, sizeof(GEN_Node));\n"
-		"\tn->token = (GEN_Token *)calloc(1, sizeof(GEN_Token));\n"
-		"\treturn n;\n"
-		"}\n\n"
-
-		"GEN_Tree *GEN_TreeCtor(GEN_TokenType type)\n"
+		"\tuint64_t calls;\n"
+		"\t// Calls which weren't applied: parser backtracked.\n"
+		"\tuint64_t failed;\n"
+		"\t// Tokens consumed by applied calls.\n"
+		"\tuint64_t tokens;\n"
+		"\tuint64_t cycles;\n"
+		"\t// Recursive calls are inside of outer one: only it counts cycles.\n"
+		"\tuint64_t depth;\n"
+		"} GEN_ProfileEntry;\n\n"
+
+		"static _Thread_local GEN_ProfileEntry GEN_profile[kProfileSize];\n\n"
+
+		"#if defined(__x86_64__) || defined(__i386__)\n"
+		"#include <x86intrin.h>\n"
+		"static inline uint64_t GEN_ProfileClock()\n"
+		"{ return __rdtsc(); }\n"
+		"#else\n"
+		"#include <time.h>\n"
+		"// Nanoseconds instead of cycles.\n"
+		"static inline uint64_t GEN_ProfileClock()\n"
 		"{\n"
-		"\tGEN_Tree *new_tree = (GEN_Tree *)calloc(1, sizeof(GEN_Tree));\n"
-		"\tassert(new_tree != NULL && \"Null calloc allocation\");\n"
-		"\tGEN_AddChild(new_tree, GEN_CreateNodeByType(new_tree, type));\n"
-		"\treturn new_tree;\n"
-		"}\n\n"
+		"\tstruct timespec ts = {0};\n"
+		"\tclock_gettime(CLOCK_MONOTONIC, &ts);\n"
+		"\treturn (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;\n"
+		"}\n"
+		"#endif\n\n"
 
-		"GEN_Node *GEN_AddChild(GEN_Tree *t, GEN_Node *new_child)\n"
+		"static inline uint64_t GEN_ProfileEnter(uint32_t idx)\n"
 		"{\n"
-		"\tif (t->current == NULL) {\n"
-		"\t\tt->root    = new_child;\n"
-		"\t\tt->current = t->root;\n"
-		"\t\t} else {\n"
-		"\t\tif (t->current->children == NULL) {\n"
-		"\t\t	t->current->children = GEN_ArrayCtor(sizeof(GEN_Node*));\n"
-		"\t\t}\n"
-		"\t\tGEN_ArrayAdd(t->current->children, new_child);\n"
-		"\t\tGEN_GetChild(t->current, t->current->children->size - 1)->parent = (struct GEN_Node *)t->current;\n"
-		"\t\tt->current = new_child;\n"
-		"\t}\n"
-		"\treturn t->current;\n"
+		"\t++GEN_profile[idx].calls;\n"
+		"\t++GEN_profile[idx].depth;\n"
+		"\treturn GEN_ProfileClock();\n"
 		"}\n\n"
-		);
 
-	fprintf(c_file,
-		"void GEN_InsertParent(GEN_Tree *t, GEN_Node *n)\n"
+		"static inline GEN_Context GEN_ProfileLeave(uint32_t idx, uint64_t start, GEN_Context ctx, GEN_Context new_ctx)\n"
 		"{\n"
-		"\tGEN_Node *old_current = t->current;\n"
-		"\tif (t->current->parent != NULL) {\n"
-		"\t\tGEN_Node *parent = t->current->parent;\n"
-		"\t\tmemcpy((GEN_Node **)parent->children->data + parent->children->size - 1, &n, sizeof(GEN_Node*));\n"
-		"\t\tn->parent = parent;\n"
+		"\tGEN_ProfileEntry *entry = GEN_profile + idx;\n"
+		"\tif (--entry->depth == 0) {\n"
+		"\t\tentry->cycles += GEN_ProfileClock() - start;\n"
 		"\t}\n"
-		"\tt->current = n;\n"
-		"\tGEN_AddChild(t, old_current);\n"
-		"\told_current->parent = (struct GEN_Node *)n;\n"
-		"\tGEN_Parent(t);\n"
-		"\tif\t(old_current == t->root) {\n"
-		"\t\tt->root = n;\n"
+		"\tif (memcmp(&new_ctx, &ctx, sizeof(GEN_Context)) == 0) {\n"
+		"\t\t++entry->failed;\n"
+		"\t} else {\n"
+		"\t\tentry->tokens += new_ctx.n_parsed - ctx.n_parsed;\n"
 		"\t}\n"
+		"\treturn new_ctx;\n"
 		"}\n\n"
 
-		"const char *GEN_CellBordersFormat(GEN_TokenType t)\n"
-		"{\n"
-		"\tswitch (t) {\n"
-		"\t\tdefault: {\n"
-		"\t\t\treturn 	\"rectangle\";\n"
-		"\t\t}\n"
-		"\t}\n"
-		"}\n\n"
+		"void GEN_ResetProfile()\n"
+		"{ memset(GEN_profile, 0, sizeof(GEN_profile)); }\n\n"
 
-		"const char *GEN_CheckIfRuleName(GEN_PrsrNdType type)\n"
+		"static int GEN_CompareProfileCycles(const void *first, const void *second)\n"
 		"{\n"
-		"\tswitch (type) {\n"
-		"\t\tcase            GEN_VAR_NAME: { return \"yellow\"; }\n"
-		"\t\tcase           GEN_RULE_NAME: { return \"cyan\"; }\n"
-		"\t\tcase GEN_RULE_NAME_REFERENCE: { return \"red\"; }\n"
-		"\t\tcase  GEN_VAR_NAME_REFERENCE: { return \"green\"; }\n"
-		"\t\tdefault: {return \"black\"; }\n"
-		"\t}\n"
+		"\tuint64_t first_cycles  = GEN_profile[*(const uint32_t *)first].cycles;\n"
+		"\tuint64_t second_cycles = GEN_profile[*(const uint32_t *)second].cycles;\n"
+		"\treturn (first_cycles < second_cycles) - (first_cycles > second_cycles);\n"
 		"}\n\n"
 
-		"GEN_TokenType GEN_Ttype(GEN_Node *n)\n"
-		"{ return n->token->type; }\n\n"
-
-		"void GEN_PrintNode(FILE *f, GEN_Node *n)\n"
+		"void GEN_DumpProfile(FILE *f, bool json)\n"
 		"{\n"
-		"\tassert(f != NULL && \"Null param\");\n"
-		"\tassert(n != NULL && \"Null param\");\n"
-		"\tif (strcmp(n->token->txt, GEN_TranslateTokenType(n->token->type)) == 0) {\n"
-		"\t\tfprintf(f, NODE_FMT,\n"
-		"\t\tn->id,\n"
-		"\t\tGEN_CellBordersFormat(n->token->type),\n"
-		"\t\tGEN_CheckIfRuleName(n->token->parser_type),\n"
-		"\t\tn->token->txt,\n"
-		"\t\t\"\");\n"
-		"\t} else {\n"
-		"\t\tfprintf(f, NODE_FMT,\n"
-		"\t\t\tn->id,\n"
-		"\t\t\tGEN_CellBordersFormat(n->token->type),\n"
-		"\t\t\tGEN_CheckIfRuleName(n->token->parser_type),\n"
-		"\t\t\tn->token->txt,\n"
-		"\t\t\tGEN_TranslateTokenType(n->token->type));\n"
+		"\tassert(f != NULL && \"Null param\");\n\n"
+		"\tuint32_t order[kProfileSize] = {0};\n"
+		"\tfor (uint32_t cur_entry = 0; cur_entry < kProfileSize; ++cur_entry) {\n"
+		"\t\torder[cur_entry] = cur_entry;\n"
 		"\t}\n"
-		"\tif (n->children != NULL) {\n"
-		"\t	for (size_t cur_child = 0; cur_child < n->children->size; ++cur_child) {\n"
-		"\t		GEN_PrintNode(f, GEN_GetChild(n, cur_child));\n"
-		"\t	}\n"
+		"\tqsort(order, kProfileSize, sizeof(uint32_t), GEN_CompareProfileCycles);\n\n"
+		"\tif (json) {\n"
+		"\t\tfprintf(f, \"[\\n\");\n"
+		"\t} else {\n"
+		"\t\tfprintf(f, \"%%-32s %%12s %%12s %%12s %%16s\\n\", \"function\", \"calls\", \"failed\", \"tokens\", \"cycles\");\n"
 		"\t}\n"
-		"}\n\n"
-
-		"void GEN_ConnectNode(FILE *f, GEN_Node *n)\n"
-		"{\n"
-		"\tassert(f != NULL && \"Null param\");\n"
-		"\tassert(n != NULL && \"Null param\");\n"
-		"\tif (n->children != NULL) {\n"
-		"\t\tfor (size_t cur_child = 0; cur_child < n->children->size; ++cur_child) {\n"
-		"\t\t\tfprintf(f, \"\\tn%%ld -> n%%ld\\n\", n->id, GEN_GetChild(n, cur_child)->id);\n"
+		"\tfor (uint32_t cur_entry = 0; cur_entry < kProfileSize; ++cur_entry) {\n"
+		"\t\tconst GEN_ProfileEntry *entry = GEN_profile + order[cur_entry];\n"
+		"\t\tif (json) {\n"
+		"\t\t\tfprintf(f, \"  {\\\"function\\\": \\\"%%s\\\", \\\"calls\\\": %%lu, \\\"failed\\\": %%lu, \\\"tokens\\\": %%lu, \\\"cycles\\\": %%lu}%%s\\n\",\n"
+		"\t\t\t\tGEN_profile_names[order[cur_entry]], entry->calls, entry->failed, entry->tokens, entry->cycles,\n"
+		"\t\t\t\t(cur_entry + 1 < kProfileSize)? \",\" : \"\");\n"
+		"\t\t} else if (entry->calls > 0) {\n"
+		"\t\t\tfprintf(f, \"%%-32s %%12lu %%12lu %%12lu %%16lu\\n\",\n"
+		"\t\t\t\tGEN_profile_names[order[cur_entry]], entry->calls, entry->failed, entry->tokens, entry->cycles);\n"
 		"\t\t}\n"
 		"\t}\n"
-		"\tif (n->children != NULL) {\n"
-		"\t\tfor (size_t cur_child = 0; cur_child < n->children->size; ++cur_child) {\n"
-		"\t\t\tGEN_ConnectNode(f, GEN_GetChild(n, cur_child));\n"
-		"\t\t}\n"
+		"\tif (json) {\n"
+		"\t\tfprintf(f, \"]\\n\");\n"
 		"\t}\n"
-		"}\n\n"
+		"}\n\n");
+}
 
-		"void GEN_DebugTree(GEN_Tree *t)\n"
+/**
+ * @brief Prints Try_<function_name> (--profile) which counts calls of
+ * static Try_<function_name>_Body, so body is generated as usual.
+ *
+ * @param parser_c        Parser's c file.
+ * @param function_name   Name of rule or <rule>_<n> of option.
+ */
+static void WriteProfileWrapper(FILE *parser_c, const char *function_name)
+{
+	fprintf(parser_c,
+		"GEN_INTERNAL GEN_Context Try_%s(GEN_Parser *p, GEN_Context ctx)\n"
 		"{\n"
-		"\tassert(t != NULL && \"Null param\");\n"
-		"\tFILE *f = fopen(\"../graph.dot\", \"w\");\n"
-		"\tassert(f != NULL && \"Reading file error\");\n"
-		"\tfprintf(f, \"digraph G{\\n\");\n"
-		"\tfprintf(f, \"\\tlabel=\\\"AST of file\\\"\\n\"\n);"
-		"\tfprintf(f, \"\tgraph [dpi=50];\\n\\n\");\n"
-		"\tGEN_PrintNode(f, t->root);\n"
-		"\tfprintf(f, \"\\n\");\n"
-		"\tGEN_ConnectNode(f, t->root);\n"
-		"\tfprintf(f, \"}\\n\");\n"
-		"\tfclose(f);\n"
-		"\tsystem(\"dot -Tpng ../graph.dot -o ../graph.png\");\n"
-		"}\n\n"
-		);
+		"\tuint64_t start = GEN_ProfileEnter(GEN_PROFILE_%s);\n"
+		"\treturn GEN_ProfileLeave(GEN_PROFILE_%s, start, ctx, Try_%s_Body(p, ctx));\n"
+		"}\n\n",
+		function_name, function_name, function_name, function_name);
+}
 
-	fprintf(c_file,
-		"void GEN_Parent(GEN_Tree *t)\n"
-		"{ t->current = (GEN_Node *)t->current->parent; }\n\n"
+/**
+ * @brief Writes prefix of current functino of particular
+ * rule of file.
+ * 
+ * @param lib_header     Header file of library.
+ * @param parser_c       Parser's c file.
+ * @param name_of_rule   Name of current rule.
+ * @param options        Options of generator.
+ */
+static void WritePrefixOfParserFunction
+	(FILE *lib_header, FILE *parser_c, const char *name_of_rule, const GeneratorOptions *options)
+{
+	assert(lib_header  != NULL && "Null parametr\n");
+	assert(name_of_rule != NULL && "Null parametr\n");
+	assert(options      != NULL && "Null parametr\n");
 
-		"inline __attribute__((always_inline))\n"
-		"GEN_Node *GEN_GetChild(GEN_Node *n, uint64_t idx)\n"
-		"{ return (*(GEN_Node **)((char *)n->children->data + idx * sizeof(GEN_Node*))); }\n\n"
+	fprintf(lib_header,
+		"GEN_INTERNAL GEN_Context Try_%s(GEN_Parser *p, GEN_Context ctx);\n\n",
+		name_of_rule
+		);
 
-		"void GEN_AppendTree(GEN_Tree *first, GEN_Tree *second)\n"
+	fprintf(parser_c, "%sGEN_Context Try_%s%s(GEN_Parser *p, GEN_Context ctx)\n{\n"
+		"\tGEN_Context try_ctx = ctx;\n\n",
+		(options->profile)? "static " : "GEN_INTERNAL ",
+		name_of_rule,
+		(options->profile)? "_Body" : ""
+		);
+
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\tGEN_MemoEntry *memo = GEN_MemoLookup(p, %s, ctx.cur_token_idx);\n"
+			"\tif (memo != NULL) {\n",
+			name_of_rule
+			);
+		WriteTrace(parser_c, options,
+			"\t\tmsg(D_PARSER_WORK, M, \"MEMOIZED Try_%s\\n\");\n",
+			name_of_rule
+			);
+		fprintf(parser_c,
+			"\t\treturn GEN_MemoReplay(p, memo, ctx);\n"
+			"\t}\n\n"
+			);
+	}
+
+	fprintf(parser_c,
+		"\tif (p->reuse != NULL) {\n"
+		"\t\tGEN_Node *reused = GEN_ReuseLookup(p, %s, ctx.cur_token_idx);\n"
+		"\t\tif (reused != NULL) {\n"
+		"\t\t\treturn GEN_ReuseReplay(p, reused, ctx);\n"
+		"\t\t}\n"
+		"\t}\n\n"
+
+		"\tGEN_Context new_ctx = ctx;\n"
+		"\tGEN_Mark    mark    = GEN_RuleMark(p, ctx.cur_token_idx);\n"
+		"\t// Options are tried from here so lexer keeps this token.\n"
+		"\tGEN_LexerPushMark(p->lexer, ctx.cur_token_idx);\n"
+		"\tGEN_LexerSeek(p->lexer, ctx.cur_token_idx);\n\n",
+		name_of_rule
+		);
+}
+
+/// @returns   true if option (chain) has cut.
+static bool ChainHasCut(Node *chain)
+{
+	for (; chain != NULL; chain = (chain->children != NULL)? GetChild(chain, 0) : NULL) {
+		if (chain->token->cut) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Prints options of rule which can start with token (token_idx)
+ * in order of grammar. Next option is tried only if previous failed
+ * before it's cut.
+ */
+static void WriteViableOptions
+	(FILE *parser_c, const FirstSets *first, Node *fork, int64_t token_idx, const char *name_of_rule)
+{
+	bool is_first_option = true;
+	// Some of tried options can fail after cut.
+	bool cut_before      = false;
+	for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+		Node *option = GetChild(fork, cur_option);
+		if (!ChainCanStartWith(first, option, token_idx)) {
+			continue;
+		}
+
+		if (is_first_option) {
+			fprintf(parser_c,
+				"\t\t\tnew_ctx = Try_%s_%lu(p, try_ctx);\n",
+				name_of_rule, cur_option + 1);
+		} else {
+			fprintf(parser_c,
+				"\t\t\tif (memcmp(&new_ctx, &try_ctx, sizeof(GEN_Context)) == 0%s) {\n"
+				"\t\t\t\tnew_ctx = Try_%s_%lu(p, try_ctx);\n"
+				"\t\t\t}\n",
+				(cut_before)? " && !p->cut" : "", name_of_rule, cur_option + 1);
+		}
+		is_first_option = false;
+		cut_before     |= ChainHasCut(option);
+	}
+	fprintf(parser_c, "\t\t\tbreak;\n");
+}
+
+/**
+ * @brief Prints switch on current token which calls only options
+ * with this token in their FIRST sets. Tokens with the same
+ * set of viable options share one case.
+ *
+ * @param parser_c       Parser's c file.
+ * @param first          FIRST sets of parser's rules.
+ * @param fork           Node with all the options of rule.
+ * @param name_of_rule   Name of current rule.
+ * @param options        Options of generator.
+ */
+static void WriteDispatch
+	(FILE *parser_c, const FirstSets *first, Node *fork, const char *name_of_rule, const GeneratorOptions *options)
+{
+	NameTable *tokenizer_table = first->tokenizer_table;
+	uint64_t   n_options = fork->children->size;
+
+	// viable[token * n_options + option]: option can start with token.
+	bool *viable  = (bool *)calloc((tokenizer_table->size + 1) * n_options, sizeof(bool));
+	bool *printed = (bool *)calloc(tokenizer_table->size + 1, sizeof(bool));
+	assert(viable  != NULL && "Null calloc allocation");
+	assert(printed != NULL && "Null calloc allocation");
+
+	for (uint64_t cur_token = 0; cur_token < tokenizer_table->size; ++cur_token) {
+		for (uint64_t cur_option = 0; cur_option < n_options; ++cur_option) {
+			viable[cur_token * n_options + cur_option] =
+				ChainCanStartWith(first, GetChild(fork, cur_option), (int64_t)cur_token);
+		}
+	}
+	// Options which can start with unknown token
+	// are tried for every other token in default case.
+	bool *viable_default = viable + tokenizer_table->size * n_options;
+	bool  has_default    = false;
+	for (uint64_t cur_option = 0; cur_option < n_options; ++cur_option) {
+		viable_default[cur_option] = ChainCanStartWith(first, GetChild(fork, cur_option), kUndefinedIdx);
+		has_default |= viable_default[cur_option];
+	}
+
+	fprintf(parser_c,
+		"\tswitch (GEN_PeekToken(p->lexer, 0)->type) {\n");
+
+	for (uint64_t cur_token = 0; cur_token < tokenizer_table->size; ++cur_token) {
+		bool *token_options = viable + cur_token * n_options;
+		if (printed[cur_token] || PhonyVariables(tokenizer_table, cur_token) ||
+				memcmp(token_options, viable_default, n_options * sizeof(bool)) == 0) {
+			continue;
+		}
+
+		for (uint64_t same_token = cur_token; same_token < tokenizer_table->size; ++same_token) {
+			if (!printed[same_token] && !PhonyVariables(tokenizer_table, same_token) &&
+					memcmp(token_options, viable + same_token * n_options, n_options * sizeof(bool)) == 0) {
+				fprintf(parser_c,
+					"\t\tcase %.*s:\n",
+					NODE_TXT(tokenizer_table->names[same_token]));
+				printed[same_token] = true;
+			}
+		}
+		fprintf(parser_c, "\t\t{\n");
+		WriteViableOptions(parser_c, first, fork, (int64_t)cur_token, name_of_rule);
+		fprintf(parser_c, "\t\t}\n");
+	}
+
+	fprintf(parser_c, "\t\tdefault: {\n");
+	if (has_default) {
+		WriteViableOptions(parser_c, first, fork, kUndefinedIdx, name_of_rule);
+	} else {
+		WriteTrace(parser_c, options,
+			"\t\t\tmsg(D_PARSER_WORK, M, \"NO OPTION FOR TOKEN: Try_%s\\n\");\n",
+			name_of_rule);
+		fprintf(parser_c, "\t\t\tbreak;\n");
+	}
+	fprintf(parser_c,
+		"\t\t}\n"
+		"\t}\n\n");
+
+	free(viable);
+	free(printed);
+}
+
+/**
+ * @brief Prints lookup of subtrees of old tree for GEN_Reparse.
+ * Rule's node is reused when all the tokens rule looked at (n_examined)
+ * are the same in new sequence, so rule would build the same node.
+ *
+ * @param parser_c   Parser's c file.
+ */
+static void WriteReuse(FILE *parser_c)
+{
+	fprintf(parser_c,
+		"// Index of token in old sequence or UINT64_MAX if token is new.\n"
+		"static uint64_t GEN_ReuseOldIdx(const GEN_Reuse *r, uint64_t token_idx)\n"
 		"{\n"
-		"\tGEN_Node  *second_cur = second->current;\n"
-		"\tGEN_Node **children   = (GEN_Node **)calloc(second_cur->children->size, sizeof(GEN_Node*));\n"
-		"\tfor (size_t cur_child = 0; cur_child < second_cur->children->size; ++cur_child) {\n"
-		"\t\tGEN_Node *child = GEN_GetChild(second_cur, cur_child);\n"
-		"\t\tmemcpy(children, &child, sizeof(GEN_Node*));\n"
+		"\tif (token_idx < r->edit_first) {\n"
+		"\t\treturn token_idx;\n"
 		"\t}\n"
-		"\tfor (size_t cur_child = 0; cur_child < second_cur->children->size; ++cur_child) {\n"
-		"\t\tGEN_AddChild(first, GEN_GetChild(second_cur, cur_child));\n"
-		"\t\tGEN_Parent(first);\n"
-		"\t\tGEN_GetChild(first->current, cur_child)->parent = first->current;\n"
+		"\tif (token_idx < r->new_edit_end) {\n"
+		"\t\treturn UINT64_MAX;\n"
 		"\t}\n"
-		"\tsecond->current =  first->current;\n"
+		"\treturn token_idx - r->new_edit_end + r->edit_end;\n"
 		"}\n\n"
 
-		"GEN_Node *GEN_CreateNodeByType(GEN_Tree *t, GEN_TokenType type)\n"
+		"static GEN_ReuseFrame *GEN_ReusePush(GEN_Reuse *r, GEN_Node *node, uint64_t first_token)\n"
 		"{\n"
-		"\tGEN_Node *new_node = GEN_NodeCtor();\n"
-		"\tGEN_FillEmptyStr(&new_node->token->txt, GEN_TranslateTokenType(type));\n"
-		"\tnew_node->token->type = type;\n"
-		"\tnew_node->id = (uint64_t)new_node;\n"
-		"\t++t->size;\n"
-		"\treturn new_node;\n"
+		"\tif (r->depth == r->capacity) {\n"
+		"\t\tr->capacity = (r->capacity == 0)? kMaxScopeDepth : r->capacity << 1;\n"
+		"\t\tr->frames = (GEN_ReuseFrame *)realloc(r->frames, r->capacity * sizeof(GEN_ReuseFrame));\n"
+		"\t\tassert(r->frames != NULL && \"Null realloc allocation\");\n"
+		"\t}\n"
+		"\tGEN_ReuseFrame *frame = r->frames + r->depth++;\n"
+		"\tframe->node        = node;\n"
+		"\tframe->first_token = first_token;\n"
+		"\tframe->next_child  = 0;\n"
+		"\tframe->child_first = first_token;\n"
+		"\treturn frame;\n"
 		"}\n\n"
 
-		"GEN_Node *GEN_CreateNode(GEN_Tree *t, GEN_Token *token)\n"
+		"/*\n"
+		" * Gives node of old tree which rule built at the same tokens or NULL.\n"
+		" * Node can be reused if rule looked only at tokens which weren't changed.\n"
+		" * Cursor in old tree follows parser, so lookups near previous are cheap.\n"
+		" * Starts of children are summed from (n_tokens): (offset) of reused node\n"
+		" * is already changed by it's new parent.\n"
+		" */\n"
+		"GEN_INTERNAL GEN_Node *GEN_ReuseLookup(GEN_Parser *p, GEN_TokenType rule, uint64_t token_idx)\n"
 		"{\n"
-		"\tGEN_Node *new_node = GEN_NodeCtor();\n"
-		"\tGEN_FillEmptyStr(&new_node->token->txt, token->txt);\n"
-		"\tnew_node->token->type = token->type;\n"
-		"\tnew_node->id = ((uint64_t)new_node);\n"
-		"\t++t->size;\n"
-		"\treturn new_node;\n"
+		"\tGEN_Reuse *r = p->reuse;\n"
+		"\tuint64_t old_idx = GEN_ReuseOldIdx(r, token_idx);\n"
+		"\tif (old_idx == UINT64_MAX || r->depth == 0) {\n"
+		"\t\treturn NULL;\n"
+		"\t}\n\n"
+
+		"\t// Root of old tree covers all the tokens.\n"
+		"\tGEN_ReuseFrame *frame = r->frames + r->depth - 1;\n"
+		"\twhile (r->depth > 1 && (old_idx < frame->first_token || old_idx >= frame->first_token + frame->node->n_tokens)) {\n"
+		"\t\t--r->depth;\n"
+		"\t\t--frame;\n"
+		"\t}\n\n"
+
+		"\twhile (frame->node->children != NULL && frame->node->children->size > 0) {\n"
+		"\t\tGEN_Node *node = frame->node;\n"
+		"\t\tuint64_t n_children = node->children->size;\n"
+		"\t\tif (frame->next_child >= n_children) {\n"
+		"\t\t\t--frame->next_child;\n"
+		"\t\t\tframe->child_first -= GEN_GetChild(node, frame->next_child)->n_tokens;\n"
+		"\t\t}\n"
+		"\t\twhile (frame->next_child > 0 && frame->child_first > old_idx) {\n"
+		"\t\t\t--frame->next_child;\n"
+		"\t\t\tframe->child_first -= GEN_GetChild(node, frame->next_child)->n_tokens;\n"
+		"\t\t}\n"
+		"\t\twhile (frame->next_child < n_children &&\n"
+		"\t\t\tframe->child_first + GEN_GetChild(node, frame->next_child)->n_tokens <= old_idx) {\n"
+		"\t\t\tframe->child_first += GEN_GetChild(node, frame->next_child)->n_tokens;\n"
+		"\t\t\t++frame->next_child;\n"
+		"\t\t}\n"
+		"\t\tif (frame->next_child == n_children || frame->child_first > old_idx) {\n"
+		"\t\t\treturn NULL;\n"
+		"\t\t}\n\n"
+
+		"\t\tGEN_Node *child = GEN_GetChild(node, frame->next_child);\n"
+		"\t\tuint64_t  first = frame->child_first;\n"
+		"\t\tif (child->children == NULL) {\n"
+		"\t\t\treturn NULL;\n"
+		"\t\t}\n"
+		"\t\tbool unchanged = (first + child->n_examined <= r->edit_first || first >= r->edit_end);\n"
+		"\t\tif (first == old_idx && child->token.type == rule && unchanged) {\n"
+		"\t\t\t++r->n_reused;\n"
+		"\t\t\treturn child;\n"
+		"\t\t}\n"
+		"\t\tframe = GEN_ReusePush(r, child, first);\n"
+		"\t}\n"
+		"\treturn NULL;\n"
 		"}\n\n"
 
-		"GEN_Array *GEN_ArrayCtor(uint64_t el_sz)\n"
+		"// Gives reused node to rule's caller like memoized result.\n"
+		"GEN_INTERNAL GEN_Context GEN_ReuseReplay(GEN_Parser *p, GEN_Node *node, GEN_Context ctx)\n"
 		"{\n"
-		"\tGEN_Array *a = (GEN_Array *)calloc(1, sizeof(GEN_Array));\n"
-		"\tassert(a != NULL && \"Null calloc allocation\");\n"
-		"\ta->size         = 0;\n"
-		"\ta->capacity     = 1;\n"
-		"\ta->element_size = el_sz;\n"
-		"\ta->data = calloc(1, el_sz * sizeof(char));\n"
-		"\tassert(a->data != NULL && \"Null calloc allocation\");\n"
-		"\treturn a;\n"
+		"\tGEN_Event result = {0};\n"
+		"\tresult.kind = GEN_EVENT_NODE;\n"
+		"\tresult.node = node;\n"
+		"\tGEN_EventsPush(&p->pending, &result);\n"
+		"\tif (ctx.cur_token_idx + node->n_examined > p->peek_end) {\n"
+		"\t\tp->peek_end = ctx.cur_token_idx + node->n_examined;\n"
+		"\t}\n"
+		"\tctx.n_parsed      += node->n_tokens;\n"
+		"\tctx.cur_token_idx += node->n_tokens;\n"
+		"\treturn ctx;\n"
+		"}\n\n");
+}
+
+/**
+ * @brief Prints table (GEN_elided) of names of %elide (tokens and rules
+ * separated by white space) indexed by GEN_TokenType. Values of GEN_TokenType
+ * go in order of enum: default_token, tokens, each rule with it's options.
+ *
+ * @param parser_c          Parser's c file.
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param parser_table      Parser's name table.
+ */
+static void WriteElidedSymbols(FILE *parser_c, NameTable *tokenizer_table, NameTable *parser_table)
+{
+	uint64_t *token_values = (uint64_t *)calloc(tokenizer_table->size + 1, sizeof(uint64_t));
+	uint64_t *rule_values  = (uint64_t *)calloc(parser_table->size + 1, sizeof(uint64_t));
+	assert(token_values != NULL && rule_values != NULL && "Null calloc allocation");
+
+	uint64_t n_types = 1;
+	for (size_t cur_el = 0; cur_el < tokenizer_table->size; ++cur_el) {
+		if (!PhonyVariables(tokenizer_table, cur_el)) {
+			token_values[cur_el] = n_types++;
+		}
+	}
+	for (size_t cur_el = 0; cur_el < parser_table->size; ++cur_el) {
+		if (!PhonyVariables(parser_table, cur_el)) {
+			rule_values[cur_el] = n_types;
+			n_types += 1 + GetChild(parser_table->names[cur_el], 0)->children->size;
+		}
+	}
+
+	bool *elided = (bool *)calloc(n_types, sizeof(bool));
+	assert(elided != NULL && "Null calloc allocation");
+	int64_t elide = FindName(tokenizer_table, "elide");
+	if (elide != kUndefinedIdx) {
+		Node       *value = VariableValue(tokenizer_table->names[elide]);
+		const char *txt   = GetTxt(value);
+		size_t      len   = GetLen(value);
+		size_t      cur_sym = 0;
+		while (cur_sym < len) {
+			if (isspace((unsigned char)txt[cur_sym])) {
+				++cur_sym;
+				continue;
+			}
+			size_t name_len = 0;
+			while (cur_sym + name_len < len && !isspace((unsigned char)txt[cur_sym + name_len])) {
+				++name_len;
+			}
+
+			int64_t token = tokenizer_table->slots[FindSlot(tokenizer_table, txt + cur_sym, name_len)];
+			int64_t rule  = parser_table->slots[FindSlot(parser_table, txt + cur_sym, name_len)];
+			if (token != kUndefinedIdx && token_values[token] != 0) {
+				elided[token_values[token]] = true;
+			} else if (rule != kUndefinedIdx && rule_values[rule] != 0) {
+				elided[rule_values[rule]] = true;
+			} else {
+				printf("Unknown name in %%elide: %.*s\n", (int)name_len, txt + cur_sym);
+			}
+			cur_sym += name_len;
+		}
+	}
+
+	fprintf(parser_c,
+		"// Symbols of %%elide: compressed parse doesn't make nodes of them.\n"
+		"static const bool GEN_elided[] =\n"
+		"{");
+	for (uint64_t cur_type = 0; cur_type < n_types; ++cur_type) {
+		fprintf(parser_c, "%s%d,", (cur_type % 32 == 0)? "\n\t" : " ", elided[cur_type]);
+	}
+	fprintf(parser_c,
+		"\n};\n\n");
+
+	free(elided);
+	free(rule_values);
+	free(token_values);
+}
+
+/**
+ * @brief Prints parser's state: lexer, pending symbols and memo table of packrat parser.
+ *
+ * Parsed symbols aren't put to the tree at once: tokens and results of rules
+ * are pushed to (pending) stack. Option which fails just rolls (pending) back
+ * to it's mark, so failed options don't allocate anything. When rule is
+ * applied, it's pending symbols become one node (or one range of events
+ * if parser gives events to GEN_Handler instead of building tree).
+ * Compressed parse (GEN_Tree::compress) leaves symbols of rule with one child
+ * and of %elide rule in pending, so their parent takes them, and tokens
+ * of %elide are pushed as GEN_EVENT_SKIP which only moves offsets.
+ *
+ * Memo is keyed by (rule, index of first token) and stores number
+ * of parsed tokens and result of rule (node, token or range of events).
+ * Result is shared between memoized calls: the same rule at the same token
+ * can't be twice in one tree, so older copy is always in failed option.
+ * Entries before oldest lexer's mark can't be requested again
+ * so they are dropped when table grows.
+ *
+ * @param lib_header        Header of library.
+ * @param parser_c          Parser's c file.
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param parser_table      Parser's name table.
+ * @param options           Options of generator.
+ */
+static void WriteParserState(FILE *lib_header, FILE *parser_c,
+	NameTable *tokenizer_table, NameTable *parser_table, const GeneratorOptions *options)
+{
+	fprintf(lib_header,
+		"static const uint64_t kInitMemoSize   = 1024;\n"
+		"static const uint64_t kInitEventsSize = 256;\n\n"
+
+		"typedef enum\n"
+		"{\n"
+		"\tGEN_EVENT_NONE,\n"
+		"\t// Rule (token.type) starts or ends.\n"
+		"\tGEN_EVENT_ENTER,\n"
+		"\tGEN_EVENT_LEAVE,\n"
+		"\tGEN_EVENT_TOKEN,\n"
+		"\t// Built node of applied rule.\n"
+		"\tGEN_EVENT_NODE,\n"
+		"\t// Events [first, first + size) of applied rule.\n"
+		"\tGEN_EVENT_SPLICE,\n"
+		"\t// Token of %%elide: it isn't in tree, but it's in span of rule.\n"
+		"\tGEN_EVENT_SKIP,\n"
+		"} GEN_EventKind;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_EventKind kind;\n"
+		"\tunion\n"
+		"\t{\n"
+		"\t\t// GEN_EVENT_ENTER, GEN_EVENT_LEAVE (token.type is rule) and GEN_EVENT_TOKEN.\n"
+		"\t\tGEN_Token token;\n"
+		"\t\tGEN_Node *node;\n"
+		"\t\tstruct\n"
+		"\t\t{\n"
+		"\t\t\tuint64_t first;\n"
+		"\t\t\tuint64_t size;\n"
+		"\t\t\t// Children which range gives to node of parent.\n"
+		"\t\t\tuint64_t n_children;\n"
+		"\t\t} range;\n"
+		"\t};\n"
+		"} GEN_Event;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_Event *data;\n"
+		"\tuint64_t   size;\n"
+		"\tuint64_t   capacity;\n"
+		"} GEN_Events;\n\n"
+
+		"// Place in parse where option starts.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tuint64_t pending;\n"
+		"\tuint64_t events;\n"
+		"\t// Rule's mark (GEN_RuleMark): first token of rule and lookahead of caller.\n"
+		"\tuint64_t token_idx;\n"
+		"\tuint64_t peek_end;\n"
+		"} GEN_Mark;\n\n"
+
+		"// SAX-like callbacks: parser calls them instead of building tree. Any of them can be NULL.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tvoid (*enter)(void *data, GEN_TokenType rule);\n"
+		"\tvoid (*leave)(void *data, GEN_TokenType rule);\n"
+		"\tvoid (*token)(void *data, const GEN_Token *token);\n"
+		"\tvoid  *data;\n"
+		"\t// Events of compressed tree (see GEN_Tree::compress).\n"
+		"\tbool   compress;\n"
+		"} GEN_Handler;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_TokenType rule;\n"
+		"\tuint64_t      token_idx;\n"
+		"\tbool          used;\n"
+		"\tbool          applied;\n"
+		"\tuint64_t      n_parsed;\n"
+		"\t// Result of rule: node, token or range of events.\n"
+		"\tGEN_Event     result;\n"
+		"\t// End of tokens rule looked at.\n"
+		"\tuint64_t      peek_end;\n"
+		"} GEN_MemoEntry;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_Node *node;\n"
+		"\tuint64_t  first_token;\n"
+		"\t// Child which contains last looked up token and it's first token.\n"
+		"\tuint64_t  next_child;\n"
+		"\tuint64_t  child_first;\n"
+		"} GEN_ReuseFrame;\n\n"
+
+		"// Old tree which GEN_Reparse takes subtrees from.\n"
+		"typedef struct\n"
+		"{\n"
+		"\t// Old tokens [0, edit_first) and [edit_end, ...) are in new sequence too:\n"
+		"\t// new ones are [edit_first, new_edit_end).\n"
+		"\tuint64_t        edit_first;\n"
+		"\tuint64_t        edit_end;\n"
+		"\tuint64_t        new_edit_end;\n"
+		"\t// Path of cursor in old tree from it's root.\n"
+		"\tGEN_ReuseFrame *frames;\n"
+		"\tuint64_t        depth;\n"
+		"\tuint64_t        capacity;\n"
+		"\tuint64_t        n_reused;\n"
+		"} GEN_Reuse;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_MemoEntry *entries;\n"
+		"\tuint64_t       size;\n"
+		"\tuint64_t       capacity;\n"
+		"} GEN_Memo;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_Lexer         *lexer;\n"
+		"\tGEN_Memo           memo;\n"
+		"\t// Tree which gets nodes of applied rules.\n"
+		"\tGEN_Tree          *tree;\n"
+		"\t// Parsed symbols which aren't in tree yet.\n"
+		"\tGEN_Events         pending;\n"
+		"\t// Events of applied rules if parser works with (handler).\n"
+		"\tGEN_Events         events;\n"
+		"\tconst GEN_Handler *handler;\n"
+		"\t// End of tokens current rule looked at.\n"
+		"\tuint64_t           peek_end;\n"
+		"\t// Old tree of incremental reparse or NULL.\n"
+		"\tGEN_Reuse         *reuse;\n"
+		"\t// Option failed after cut: rule fails without trying it's next options.\n"
+		"\tbool               cut;\n"
+		"} GEN_Parser;\n\n"
+
+		"GEN_Parser *GEN_ParserCtor(GEN_Lexer *lx);\n"
+		"void GEN_ParserDtor(GEN_Parser *p);\n"
+		"void GEN_ParserSetHandler(GEN_Parser *p, const GEN_Handler *handler);\n"
+		"GEN_Mark GEN_ParserMark(const GEN_Parser *p);\n"
+		"GEN_INTERNAL void GEN_ParserRollback(GEN_Parser *p, GEN_Mark mark);\n"
+		"GEN_INTERNAL void GEN_PushToken(GEN_Parser *p, const GEN_Token *token);\n"
+		"GEN_INTERNAL GEN_Event GEN_CommitRule(GEN_Parser *p, GEN_TokenType rule, GEN_Mark mark);\n"
+		"GEN_INTERNAL GEN_Mark GEN_RuleMark(GEN_Parser *p, uint64_t token_idx);\n"
+		"GEN_INTERNAL void GEN_RuleLeave(GEN_Parser *p, GEN_Mark mark);\n"
+		"GEN_INTERNAL GEN_Node *GEN_ReuseLookup(GEN_Parser *p, GEN_TokenType rule, uint64_t token_idx);\n"
+		"GEN_INTERNAL GEN_Context GEN_ReuseReplay(GEN_Parser *p, GEN_Node *node, GEN_Context ctx);\n"
+		"GEN_INTERNAL void GEN_ParserFinish(GEN_Parser *p);\n\n");
+
+	WriteElidedSymbols(parser_c, tokenizer_table, parser_table);
+	fprintf(parser_c,
+		"GEN_Parser *GEN_ParserCtor(GEN_Lexer *lx)\n"
+		"{\n"
+		"\tassert(lx != NULL && \"Null param\");\n"
+		"\tGEN_Parser *p = (GEN_Parser *)calloc(1, sizeof(GEN_Parser));\n"
+		"\tassert(p != NULL && \"Null calloc allocation\");\n"
+		"\tp->lexer = lx;\n"
+		"\treturn p;\n"
 		"}\n\n"
 
-		"void GEN_FillEmptyStr(char **dest, const char *src)\n"
+		"void GEN_ParserDtor(GEN_Parser *p)\n"
 		"{\n"
-		"\tassert(src  != NULL && \"Null param\");\n"
-		"\t(*dest) = (char *)calloc(kTokenMaxLen, sizeof(char));\n"
-		"\tassert(dest != NULL && \"Null calloc allocation\");\n"
-		"\tstrcpy(*dest, src);\n"
+		"\tassert(p != NULL && \"Null param\");\n"
+		"\tfree(p->memo.entries);\n"
+		"\tfree(p->pending.data);\n"
+		"\tfree(p->events.data);\n"
+		"\tfree(p);\n"
 		"}\n\n"
 
-		"void GEN_ArrayChangeCapacity(GEN_Array *a, uint64_t new_capacity)\n"
+		"void GEN_ParserSetHandler(GEN_Parser *p, const GEN_Handler *handler)\n"
 		"{\n"
-		"\tassert(a != NULL && \"Null param\");\n"
-		"\ta->data = realloc(a->data, a->element_size * new_capacity * sizeof(char));\n"
-		"\tassert(a->data != NULL && \"Null reallocation\");\n"
-		"\ta->capacity = new_capacity;\n"
+		"\tassert(p != NULL && \"Null param\");\n"
+		"\tp->handler = handler;\n"
 		"}\n\n"
 
-		"void GEN_ArrayAdd(GEN_Array *a, void *new_element)\n"
+		"static void GEN_EventsPush(GEN_Events *events, const GEN_Event *event)\n"
 		"{\n"
-		"\tif (a->size == a->capacity) {\n"
-		"\t\tGEN_ArrayChangeCapacity(a, a->capacity << 1);\n"
+		"\tif (events->size == events->capacity) {\n"
+		"\t\tevents->capacity = (events->capacity == 0)? kInitEventsSize : events->capacity << 1;\n"
+		"\t\tevents->data = (GEN_Event *)realloc(events->data, events->capacity * sizeof(GEN_Event));\n"
+		"\t\tassert(events->data != NULL && \"Null realloc allocation\");\n"
 		"\t}\n"
-		"\tvoid *ptr = (char *)a->data + a->size * a->element_size;\n"
-		"\tmemcpy(ptr, &new_element, a->element_size);\n"
-		"\t++a->size;\n"
+		"\tevents->data[events->size++] = *event;\n"
 		"}\n\n"
 
-		"void GEN_CompressTree(GEN_Tree *t, GEN_Node *n)\n"
+		"GEN_Mark GEN_ParserMark(const GEN_Parser *p)\n"
 		"{\n"
-		"\tt->current = n;\n"
-		"\tint n_changes = 0;\n"
-		"\twhile(true) {\n"
-		"\tif (n->children != NULL) {\n"
-		"\t\tGEN_Node *save_cur = n;\n"
-		"\t\tfor (size_t cur_child = 0; cur_child < n->children->size; ++cur_child) {\n"
-		"\t\t\tGEN_Node *child = GEN_GetChild(n, cur_child);\n"
-		"\t\t\tif (child->children != NULL && child->children->size == 1) {\n"
-		"\t\t\t\tGEN_Node *grandson = GEN_GetChild(child, 0);\n"
-		"\t\t\t\tgrandson->parent = n;\n\n"
-		"\t\t\t\t++n_changes;\n"
-		"\t\t\t\tmemcpy((GEN_Node**)n->children->data + cur_child, &grandson, sizeof(GEN_Node*));\n"
-		"\t\t\t}\n"
-		"\t\t}\n"
+		"\tGEN_Mark mark = {p->pending.size, p->events.size, 0, 0};\n"
+		"\treturn mark;\n"
+		"}\n\n"
+
+		"// Mark of rule: rule looks at least at it's first token.\n"
+		"GEN_INTERNAL GEN_Mark GEN_RuleMark(GEN_Parser *p, uint64_t token_idx)\n"
+		"{\n"
+		"\tGEN_Mark mark  = {p->pending.size, p->events.size, token_idx, p->peek_end};\n"
+		"\tp->peek_end    = token_idx + 1;\n"
+		"\treturn mark;\n"
+		"}\n\n"
+
+		"// Caller of rule depends on all tokens rule looked at.\n"
+		"GEN_INTERNAL void GEN_RuleLeave(GEN_Parser *p, GEN_Mark mark)\n"
+		"{\n"
+		"\tif (mark.peek_end > p->peek_end) {\n"
+		"\t\tp->peek_end = mark.peek_end;\n"
+		"\t}\n"
+		"}\n\n"
+
+		"// Drops everything failed option has parsed.\n"
+		"GEN_INTERNAL void GEN_ParserRollback(GEN_Parser *p, GEN_Mark mark)\n"
+		"{\n"
+		"\tassert(mark.pending <= p->pending.size && \"Rollback forward\");\n"
+		"\tp->pending.size = mark.pending;\n");
+	if (!options->packrat) {
+		// Without memo nothing refers to events of rules applied in failed option.
+		fprintf(parser_c,
+			"\tp->events.size  = mark.events;\n");
+	}
+	fprintf(parser_c,
+		"}\n\n"
+
+		"GEN_INTERNAL void GEN_PushToken(GEN_Parser *p, const GEN_Token *token)\n"
+		"{\n"
+		"\tGEN_Event event = {.kind = GEN_EVENT_TOKEN, .token = *token};\n"
+		"\tif (p->tree->compress && GEN_elided[token->type]) {\n"
+		"\t\tevent.kind = GEN_EVENT_SKIP;\n"
 		"\t}\n"
-		"\tif (n_changes == 0) {\n"
-		"\t\tbreak;\n"
+		"\tGEN_EventsPush(&p->pending, &event);\n"
+		"}\n\n"
+
+		"static GEN_Node *GEN_TokenNode(GEN_Parser *p, const GEN_Token *token)\n"
+		"{\n"
+		"\tGEN_Node *node = GEN_CreateNode(p->tree, token);\n"
+		"\tnode->n_tokens   = 1;\n"
+		"\tnode->n_examined = 1;\n"
+		"\treturn node;\n"
+		"}\n\n");
+
+	fprintf(parser_c,
+		"// Number of children which (symbols) give to node of rule.\n"
+		"static uint64_t GEN_CountChildren(const GEN_Event *symbols, uint64_t n_symbols)\n"
+		"{\n"
+		"\tuint64_t n_children = 0;\n"
+		"\tfor (uint64_t cur_symbol = 0; cur_symbol < n_symbols; ++cur_symbol) {\n"
+		"\t\tswitch (symbols[cur_symbol].kind) {\n"
+		"\t\t\tcase GEN_EVENT_SKIP:   { break; }\n"
+		"\t\t\tcase GEN_EVENT_SPLICE: { n_children += symbols[cur_symbol].range.n_children; break; }\n"
+		"\t\t\tdefault:               { ++n_children; break; }\n"
+		"\t\t}\n"
 		"\t}\n"
-		"\tn_changes = 0;\n"
+		"\treturn n_children;\n"
+		"}\n\n"
+
+		"// Adds node of pending (symbol) to children of (node). Splices of tree are flat.\n"
+		"static void GEN_AppendSymbol(GEN_Parser *p, GEN_Node *node, const GEN_Event *symbol, uint32_t *n_tokens)\n"
+		"{\n"
+		"\tif (symbol->kind == GEN_EVENT_SKIP) {\n"
+		"\t\t++*n_tokens;\n"
+		"\t\treturn;\n"
 		"\t}\n"
-		"\tif (n->children != NULL) {\n"
-		"\t\tfor (size_t cur_child = 0; cur_child < n->children->size; ++cur_child) {\n"
-		"\t\t\tGEN_CompressTree(t, GEN_GetChild(n, cur_child));\n"
+		"\tif (symbol->kind == GEN_EVENT_SPLICE) {\n"
+		"\t\tfor (uint64_t cur_event = 0; cur_event < symbol->range.size; ++cur_event) {\n"
+		"\t\t\tGEN_AppendSymbol(p, node, p->events.data + symbol->range.first + cur_event, n_tokens);\n"
 		"\t\t}\n"
+		"\t\treturn;\n"
 		"\t}\n"
-		"}\n"
-		);
+		"\tGEN_Node *child = (symbol->kind == GEN_EVENT_NODE)? symbol->node : GEN_TokenNode(p, &symbol->token);\n"
+		"\tGEN_ArrayAdd(node->children, child);\n"
+		"\tchild->parent = node;\n"
+		"\tchild->offset = *n_tokens;\n"
+		"\t*n_tokens    += child->n_tokens;\n"
+		"}\n\n");
 
-	fclose(c_file);
-}
+	if (options->packrat) {
+		// Memo keeps result of spliced rule, so it can't be left in pending.
+		fprintf(parser_c,
+			"// Result of rule which isn't node: it's symbols are copied to events.\n"
+			"// Splices of nested rules are copied by their symbols, so splices of tree are flat.\n"
+			"static GEN_Event GEN_SpliceRule(GEN_Parser *p, GEN_Mark mark, uint64_t n_children)\n"
+			"{\n"
+			"\tif (p->pending.size - mark.pending == 1) {\n"
+			"\t\treturn p->pending.data[mark.pending];\n"
+			"\t}\n"
+			"\tGEN_Event result = {.kind = GEN_EVENT_SPLICE};\n"
+			"\tresult.range.first      = p->events.size;\n"
+			"\tresult.range.n_children = n_children;\n"
+			"\tfor (uint64_t cur_symbol = mark.pending; cur_symbol < p->pending.size; ++cur_symbol) {\n"
+			"\t\tGEN_Event symbol = p->pending.data[cur_symbol];\n"
+			"\t\tif (symbol.kind != GEN_EVENT_SPLICE || p->handler != NULL) {\n"
+			"\t\t\tGEN_EventsPush(&p->events, &symbol);\n"
+			"\t\t\tcontinue;\n"
+			"\t\t}\n"
+			"\t\tfor (uint64_t cur_event = 0; cur_event < symbol.range.size; ++cur_event) {\n"
+			"\t\t\tGEN_Event event = p->events.data[symbol.range.first + cur_event];\n"
+			"\t\t\tGEN_EventsPush(&p->events, &event);\n"
+			"\t\t}\n"
+			"\t}\n"
+			"\tresult.range.size = p->events.size - result.range.first;\n\n"
+
+			"\tp->pending.size = mark.pending;\n"
+			"\tGEN_EventsPush(&p->pending, &result);\n"
+			"\treturn result;\n"
+			"}\n\n");
+	}
 
-/**
- * @brief Main function to generate
- * parser's files to parser the program.
- * 
- * @param s          Sequence of tokens.
- * @param n_tokens   Number of tokens in token's sequence
- * collected from tokenizer of YACC-file.
- */
-void GenerateFiles(Token *s, uint64_t n_tokens)
-{
-	assert(s != NULL && "Null param");
+	fprintf(parser_c,
+		"// Replaces pending symbols of applied rule (after mark) with one result.\n"
+		"GEN_INTERNAL GEN_Event GEN_CommitRule(GEN_Parser *p, GEN_TokenType rule, GEN_Mark mark)\n"
+		"{\n"
+		"\tGEN_Event *symbols    = p->pending.data + mark.pending;\n"
+		"\tuint64_t   n_symbols  = p->pending.size - mark.pending;\n"
+		"\t// Only compressed parse pushes skips and splices to tree.\n"
+		"\tuint64_t   n_children = (p->tree->compress)? GEN_CountChildren(symbols, n_symbols) : n_symbols;\n"
+		"\tGEN_Event  result     = {0};\n\n"
+
+		"\tif (p->tree->compress && (n_children == 1 || GEN_elided[rule])) {\n");
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\t\treturn GEN_SpliceRule(p, mark, n_children);\n");
+	} else {
+		fprintf(parser_c,
+			"\t\t// Symbols stay in pending: parent of rule takes them.\n"
+			"\t\treturn result;\n");
+	}
+	fprintf(parser_c,
+		"\t}\n\n"
 
-	// Create trees with fictive root-node.
-	Tree *tokenizer_tree = TreeCtor(TOKENIZER_TREE);
-	Tree *parser_tree    = TreeCtor(PARSER_TREE);
+		"\tif (p->handler != NULL) {\n"
+		"\t\tGEN_Event enter = {.kind = GEN_EVENT_ENTER, .token = GEN_eof_token};\n"
+		"\t\tenter.token.type = rule;\n"
+		"\t\tGEN_Event leave = enter;\n"
+		"\t\tleave.kind = GEN_EVENT_LEAVE;\n\n"
+
+		"\t\tresult.kind             = GEN_EVENT_SPLICE;\n"
+		"\t\tresult.range.first      = p->events.size;\n"
+		"\t\tresult.range.n_children = 1;\n"
+		"\t\tGEN_EventsPush(&p->events, &enter);\n"
+		"\t\tfor (uint64_t cur_symbol = 0; cur_symbol < n_symbols; ++cur_symbol) {\n"
+		"\t\t\tGEN_EventsPush(&p->events, symbols + cur_symbol);\n"
+		"\t\t}\n"
+		"\t\tGEN_EventsPush(&p->events, &leave);\n"
+		"\t\tresult.range.size = p->events.size - result.range.first;\n"
+		"\t} else {\n"
+		"\t\tresult.kind = GEN_EVENT_NODE;\n"
+		"\t\tresult.node = GEN_CreateNodeByType(p->tree, rule);\n"
+		"\t\tif (n_children > 0) {\n"
+		"\t\t\tresult.node->children = GEN_ArrayCtor(GEN_TreeArena(p->tree), sizeof(GEN_Node*), n_children);\n"
+		"\t\t}\n"
+		"\t\tuint32_t n_tokens = 0;\n"
+		"\t\tfor (uint64_t cur_symbol = 0; cur_symbol < n_symbols; ++cur_symbol) {\n"
+		"\t\t\tGEN_AppendSymbol(p, result.node, symbols + cur_symbol, &n_tokens);\n"
+		"\t\t}\n"
+		"\t\tresult.node->n_tokens   = n_tokens;\n"
+		"\t\tresult.node->n_examined = (uint32_t)(p->peek_end - mark.token_idx);\n"
+		"\t}\n\n"
 
-	// Generate tokenizer's and parser's tree.
-	GenerateTrees(parser_tree, tokenizer_tree, s, n_tokens);
+		"\tp->pending.size = mark.pending;\n"
+		"\tGEN_EventsPush(&p->pending, &result);\n"
+		"\treturn result;\n"
+		"}\n\n");
+
+	fprintf(parser_c,
+		"// Calls handler for events of range and of all ranges spliced into it.\n"
+		"static void GEN_DeliverEvents(GEN_Parser *p, uint64_t first, uint64_t size)\n"
+		"{\n"
+		"\tuint64_t  capacity = kMaxScopeDepth;\n"
+		"\tuint64_t  depth    = 0;\n"
+		"\tuint64_t *ranges   = (uint64_t *)calloc(2 * capacity, sizeof(uint64_t));\n"
+		"\tassert(ranges != NULL && \"Null calloc allocation\");\n"
+		"\tranges[depth++] = first;\n"
+		"\tranges[depth++] = first + size;\n\n"
+
+		"\tconst GEN_Handler *h = p->handler;\n"
+		"\twhile (depth > 0) {\n"
+		"\t\tif (ranges[depth - 2] == ranges[depth - 1]) {\n"
+		"\t\t\tdepth -= 2;\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tconst GEN_Event *event = p->events.data + ranges[depth - 2]++;\n"
+		"\t\tswitch (event->kind) {\n"
+		"\t\t\tcase GEN_EVENT_ENTER: { if (h->enter != NULL) { h->enter(h->data, event->token.type); } break; }\n"
+		"\t\t\tcase GEN_EVENT_LEAVE: { if (h->leave != NULL) { h->leave(h->data, event->token.type); } break; }\n"
+		"\t\t\tcase GEN_EVENT_TOKEN: { if (h->token != NULL) { h->token(h->data, &event->token); } break; }\n"
+		"\t\t\tcase GEN_EVENT_SKIP:  { break; }\n"
+		"\t\t\tcase GEN_EVENT_SPLICE:\n"
+		"\t\t\t{\n"
+		"\t\t\t\tif (depth == 2 * capacity) {\n"
+		"\t\t\t\t\tcapacity <<= 1;\n"
+		"\t\t\t\t\tranges = (uint64_t *)realloc(ranges, 2 * capacity * sizeof(uint64_t));\n"
+		"\t\t\t\t\tassert(ranges != NULL && \"Null realloc allocation\");\n"
+		"\t\t\t\t}\n"
+		"\t\t\t\tranges[depth++] = event->range.first;\n"
+		"\t\t\t\tranges[depth++] = event->range.first + event->range.size;\n"
+		"\t\t\t\tbreak;\n"
+		"\t\t\t}\n"
+		"\t\t\tdefault: {\n"
+		"\t\t\t\tassert(false && \"Not an event of handler\");\n"
+		"\t\t\t\tbreak;\n"
+		"\t\t\t}\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tfree(ranges);\n"
+		"}\n\n"
+
+		"// Adds node of finished (symbol) to current node of tree.\n"
+		"static void GEN_FinishSymbol(GEN_Parser *p, const GEN_Event *symbol, uint32_t *n_tokens)\n"
+		"{\n"
+		"\tif (symbol->kind == GEN_EVENT_SKIP) {\n"
+		"\t\t++*n_tokens;\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\tGEN_Node *child = GEN_AddChild(p->tree, (symbol->kind == GEN_EVENT_NODE)?\n"
+		"\t\tsymbol->node : GEN_TokenNode(p, &symbol->token));\n"
+		"\tchild->offset = *n_tokens;\n"
+		"\t*n_tokens    += child->n_tokens;\n"
+		"\tGEN_Parent(p->tree);\n"
+		"}\n\n"
+
+		"// Gives parsed symbols to current node of tree or to handler.\n"
+		"GEN_INTERNAL void GEN_ParserFinish(GEN_Parser *p)\n"
+		"{\n"
+		"\tuint32_t n_tokens = 0;\n"
+		"\tfor (uint64_t cur_symbol = 0; cur_symbol < p->pending.size; ++cur_symbol) {\n"
+		"\t\tconst GEN_Event *symbol = p->pending.data + cur_symbol;\n"
+		"\t\tif (p->handler != NULL) {\n"
+		"\t\t\tif (symbol->kind == GEN_EVENT_SPLICE) {\n"
+		"\t\t\t\tGEN_DeliverEvents(p, symbol->range.first, symbol->range.size);\n"
+		"\t\t\t} else if (symbol->kind == GEN_EVENT_TOKEN && p->handler->token != NULL) {\n"
+		"\t\t\t\tp->handler->token(p->handler->data, &symbol->token);\n"
+		"\t\t\t}\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tif (symbol->kind != GEN_EVENT_SPLICE) {\n"
+		"\t\t\tGEN_FinishSymbol(p, symbol, &n_tokens);\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tfor (uint64_t cur_event = 0; cur_event < symbol->range.size; ++cur_event) {\n"
+		"\t\t\tGEN_FinishSymbol(p, p->events.data + symbol->range.first + cur_event, &n_tokens);\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tif (p->handler == NULL && p->tree->current != NULL) {\n"
+		"\t\tp->tree->current->n_tokens   = n_tokens;\n"
+		"\t\tp->tree->current->n_examined = n_tokens;\n"
+		"\t}\n"
+		"\tp->pending.size = 0;\n"
+		"\tp->events.size  = 0;\n"
+		"}\n\n");
+
+	WriteReuse(parser_c);
+
+	if (!options->packrat) {
+		return;
+	}
+
+	fprintf(lib_header,
+		"GEN_MemoEntry *GEN_MemoLookup(GEN_Parser *p, GEN_TokenType rule, uint64_t token_idx);\n"
+		"void GEN_MemoStore(GEN_Parser *p, GEN_TokenType rule, GEN_Context ctx, GEN_Context new_ctx, const GEN_Event *result);\n"
+		"GEN_Context GEN_MemoReplay(GEN_Parser *p, const GEN_MemoEntry *entry, GEN_Context ctx);\n\n");
+
+	fprintf(parser_c,
+		"static GEN_MemoEntry *GEN_MemoSlot(GEN_Memo *memo, GEN_TokenType rule, uint64_t token_idx)\n"
+		"{\n"
+		"\tuint64_t mask = memo->capacity - 1;\n"
+		"\tuint64_t idx  = (token_idx * 0x9E3779B97F4A7C15ull ^ (uint64_t)rule * 0xC2B2AE3D27D4EB4Full) & mask;\n"
+		"\twhile (memo->entries[idx].used &&\n"
+		"\t\t\t(memo->entries[idx].rule != rule || memo->entries[idx].token_idx != token_idx)) {\n"
+		"\t\tidx = (idx + 1) & mask;\n"
+		"\t}\n"
+		"\treturn memo->entries + idx;\n"
+		"}\n\n"
+
+		"static void GEN_MemoRehash(GEN_Memo *memo, uint64_t new_capacity, uint64_t oldest)\n"
+		"{\n"
+		"\tGEN_MemoEntry *old_entries  = memo->entries;\n"
+		"\tuint64_t       old_capacity = memo->capacity;\n\n"
+
+		"\tmemo->entries  = (GEN_MemoEntry *)calloc(new_capacity, sizeof(GEN_MemoEntry));\n"
+		"\tassert(memo->entries != NULL && \"Null calloc allocation\");\n"
+		"\tmemo->capacity = new_capacity;\n"
+		"\tmemo->size     = 0;\n"
+		"\tfor (uint64_t cur_entry = 0; cur_entry < old_capacity; ++cur_entry) {\n"
+		"\t\tif (old_entries[cur_entry].used && old_entries[cur_entry].token_idx >= oldest) {\n"
+		"\t\t\t*GEN_MemoSlot(memo, old_entries[cur_entry].rule, old_entries[cur_entry].token_idx) = old_entries[cur_entry];\n"
+		"\t\t\t++memo->size;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tfree(old_entries);\n"
+		"}\n\n"
+
+		"GEN_MemoEntry *GEN_MemoLookup(GEN_Parser *p, GEN_TokenType rule, uint64_t token_idx)\n"
+		"{\n"
+		"\tif (p->memo.capacity == 0) {\n"
+		"\t\treturn NULL;\n"
+		"\t}\n"
+		"\tGEN_MemoEntry *entry = GEN_MemoSlot(&p->memo, rule, token_idx);\n"
+		"\treturn (entry->used)? entry : NULL;\n"
+		"}\n\n"
+
+		"void GEN_MemoStore(GEN_Parser *p, GEN_TokenType rule, GEN_Context ctx, GEN_Context new_ctx, const GEN_Event *result)\n"
+		"{\n"
+		"\tGEN_Memo *memo = &p->memo;\n"
+		"\tif (memo->capacity == 0) {\n"
+		"\t\tGEN_MemoRehash(memo, kInitMemoSize, 0);\n"
+		"\t} else if (2 * (memo->size + 1) > memo->capacity) {\n"
+		"\t\tuint64_t oldest = GEN_LexerOldest(p->lexer);\n"
+		"\t\tuint64_t n_alive = 0;\n"
+		"\t\tfor (uint64_t cur_entry = 0; cur_entry < memo->capacity; ++cur_entry) {\n"
+		"\t\t\tn_alive += (memo->entries[cur_entry].used && memo->entries[cur_entry].token_idx >= oldest);\n"
+		"\t\t}\n"
+		"\t\t// Grow only if table is still more than quarter full, shrink if it's less than 1/16 full:\n"
+		"\t\t// entries before oldest mark are released with tokens of lexer.\n"
+		"\t\tuint64_t new_capacity = memo->capacity;\n"
+		"\t\tif (4 * (n_alive + 1) > memo->capacity) {\n"
+		"\t\t\tnew_capacity <<= 1;\n"
+		"\t\t} else if (16 * (n_alive + 1) <= memo->capacity && memo->capacity > kInitMemoSize) {\n"
+		"\t\t\tnew_capacity >>= 1;\n"
+		"\t\t}\n"
+		"\t\tGEN_MemoRehash(memo, new_capacity, oldest);\n"
+		"\t}\n\n"
+
+		"\tGEN_MemoEntry *entry = GEN_MemoSlot(memo, rule, ctx.cur_token_idx);\n"
+		"\tif (!entry->used) {\n"
+		"\t\t++memo->size;\n"
+		"\t}\n"
+		"\tentry->rule      = rule;\n"
+		"\tentry->token_idx = ctx.cur_token_idx;\n"
+		"\tentry->used      = true;\n"
+		"\tentry->n_parsed  = new_ctx.cur_token_idx - ctx.cur_token_idx;\n"
+		"\tentry->applied   = (result != NULL);\n"
+		"\tentry->peek_end  = p->peek_end;\n"
+		"\tif (result != NULL) {\n"
+		"\t\tentry->result = *result;\n"
+		"\t}\n"
+		"}\n\n"
+
+		"GEN_Context GEN_MemoReplay(GEN_Parser *p, const GEN_MemoEntry *entry, GEN_Context ctx)\n"
+		"{\n"
+		"\t// Success and failure both depend on tokens rule looked at.\n"
+		"\tif (entry->peek_end > p->peek_end) {\n"
+		"\t\tp->peek_end = entry->peek_end;\n"
+		"\t}\n"
+		"\tif (!entry->applied) {\n"
+		"\t\treturn ctx;\n"
+		"\t}\n"
+		"\tGEN_EventsPush(&p->pending, &entry->result);\n"
+		"\tctx.n_parsed      += entry->n_parsed;\n"
+		"\tctx.cur_token_idx += entry->n_parsed;\n"
+		"\treturn ctx;\n"
+		"}\n\n");
+}
+
+/**
+ * @brief Prints parse functions which are built on
+ * top of (GEN_RunParser) of any backend.
+ *
+ * @param lib_header   Header of library.
+ * @param parser_c     Parser's c file.
+ */
+static void WriteParseWrappers(FILE *lib_header, FILE *parser_c)
+{
+	fprintf(parser_c,
+		"GEN_Tree *ParseLexer(GEN_Tree *t, GEN_Lexer *lx, GEN_Context ctx) {\n"
+		"\tGEN_Parser *p = GEN_ParserCtor(lx);\n"
+		"\tGEN_RunParser(t, p, ctx);\n"
+		"\tGEN_ParserDtor(p);\n"
+		"\treturn t;\n"
+		"}\n\n"
+
+		"GEN_Tree *ParseSequence(GEN_Tree *t, GEN_Token *s, GEN_Context ctx, int64_t n_tokens) {\n"
+		"\tGEN_Lexer *lx = GEN_SequenceLexerCtor(s, n_tokens);\n"
+		"\tParseLexer(t, lx, ctx);\n"
+		"\tGEN_LexerDtor(lx);\n"
+		"\treturn t;\n"
+		"}\n\n"
+
+		"// Parses without tree: handler gets events after the whole parse.\n"
+		"void ParseLexerEvents(GEN_Lexer *lx, const GEN_Handler *handler, GEN_Context ctx) {\n"
+		"\tassert(handler != NULL && \"Null param\");\n"
+		"\tGEN_Tree    t = {0};\n"
+		"\tt.compress = handler->compress;\n"
+		"\tGEN_Parser *p = GEN_ParserCtor(lx);\n"
+		"\tGEN_ParserSetHandler(p, handler);\n"
+		"\tGEN_RunParser(&t, p, ctx);\n"
+		"\tGEN_ParserDtor(p);\n"
+		"\tGEN_TreeFree(&t);\n"
+		"}\n\n"
+
+		"// Parses straight to flat tree (ft) without GEN_Node's.\n"
+		"void ParseLexerFlat(GEN_FlatTree *ft, GEN_Lexer *lx, GEN_Context ctx) {\n"
+		"\tGEN_FlatBuilder b = {0};\n"
+		"\tGEN_FlatBuilderCtor(&b, ft);\n"
+		"\tGEN_Handler handler = {GEN_FlatEnter, GEN_FlatLeave, GEN_FlatToken, &b, false};\n"
+		"\tParseLexerEvents(lx, &handler, ctx);\n"
+		"\tGEN_FlatBuilderDtor(&b);\n"
+		"}\n\n");
+
+	fprintf(parser_c,
+		"// Builds text of (old_source) after edit.\n"
+		"char *GEN_EditSource(const char *old_source, uint64_t old_len, const GEN_Edit *edit, uint64_t *new_len)\n"
+		"{\n"
+		"\tassert(old_source != NULL && \"Null param\");\n"
+		"\tassert(edit       != NULL && \"Null param\");\n"
+		"\tassert(new_len    != NULL && \"Null param\");\n"
+		"\tassert(edit->offset + edit->n_removed <= old_len && \"Edit out of source\");\n\n"
+
+		"\t*new_len = old_len - edit->n_removed + edit->n_inserted;\n"
+		"\tchar *new_source = (char *)calloc(*new_len + 1, sizeof(char));\n"
+		"\tassert(new_source != NULL && \"Null calloc allocation\");\n"
+		"\tmemcpy(new_source, old_source, edit->offset);\n"
+		"\tmemcpy(new_source + edit->offset, edit->inserted, edit->n_inserted);\n"
+		"\tmemcpy(new_source + edit->offset + edit->n_inserted, old_source + edit->offset + edit->n_removed,\n"
+		"\t\told_len - edit->offset - edit->n_removed);\n"
+		"\treturn new_source;\n"
+		"}\n\n"
+
+		"static uint64_t GEN_TokenStart(const GEN_Token *token, const char *source, uint64_t len)\n"
+		"{\n"
+		"\treturn (token->txt == GEN_eof_token.txt)? len : (uint64_t)(token->txt - source);\n"
+		"}\n\n"
+
+		"// Moves texts of reused tokens (they point to old source) to new source.\n"
+		"// Node can be reused inside of subtree which was reused later as a whole,\n"
+		"// so parents and offsets of reused nodes are set again too.\n"
+		"static void GEN_ReparseFixTree(GEN_Node *root, const char *old_source, uint64_t old_len,\n"
+		"\tconst char *new_source, const GEN_Edit *edit)\n"
+		"{\n"
+		"\tuint64_t   capacity = kMaxScopeDepth;\n"
+		"\tuint64_t   size     = 0;\n"
+		"\tGEN_Node **stack    = (GEN_Node **)malloc(capacity * sizeof(GEN_Node *));\n"
+		"\tassert(stack != NULL && \"Null malloc allocation\");\n\n"
+
+		"\tuintptr_t old_begin = (uintptr_t)old_source;\n"
+		"\tstack[size++] = root;\n"
+		"\twhile (size > 0) {\n"
+		"\t\tGEN_Node *n = stack[--size];\n"
+		"\t\tif (n->children == NULL) {\n"
+		"\t\t\tuintptr_t txt = (uintptr_t)n->token.txt;\n"
+		"\t\t\tif (txt >= old_begin && txt <= old_begin + old_len) {\n"
+		"\t\t\t\tuint64_t pos = (uint64_t)(txt - old_begin);\n"
+		"\t\t\t\tpos = (pos < edit->offset)? pos : pos - edit->n_removed + edit->n_inserted;\n"
+		"\t\t\t\tn->token.txt = new_source + pos;\n"
+		"\t\t\t}\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tuint32_t offset = 0;\n"
+		"\t\tfor (uint64_t cur_child = 0; cur_child < n->children->size; ++cur_child) {\n"
+		"\t\t\tif (size == capacity) {\n"
+		"\t\t\t\tcapacity <<= 1;\n"
+		"\t\t\t\tstack = (GEN_Node **)realloc(stack, capacity * sizeof(GEN_Node *));\n"
+		"\t\t\t\tassert(stack != NULL && \"Null realloc allocation\");\n"
+		"\t\t\t}\n"
+		"\t\t\tGEN_Node *child = GEN_GetChild(n, cur_child);\n"
+		"\t\t\tchild->parent  = n;\n"
+		"\t\t\tchild->offset  = offset;\n"
+		"\t\t\toffset        += child->n_tokens;\n"
+		"\t\t\tstack[size++]  = child;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tfree(stack);\n"
+		"}\n\n");
+
+	fprintf(parser_c,
+		"/*\n"
+		" * Reparses tree (t) of tokens (*tokens) of (old_source) after (edit):\n"
+		" * tokens near edit are lexed again and subtrees of old tree\n"
+		" * which rules built from unchanged tokens are reused.\n"
+		" * Tree must be parsed by ParseSequence from (*tokens) and not compressed.\n"
+		" * Old source isn't used after return. Nodes of old tree stay in arena of (t).\n"
+		" *\n"
+		" * @returns   Number of reused subtrees.\n"
+		" */\n"
+		"uint64_t GEN_Reparse(GEN_Tree *t, GEN_Token **tokens, uint64_t *n_tokens,\n"
+		"\tconst char *old_source, uint64_t old_len, const char *new_source, GEN_Edit edit)\n"
+		"{\n"
+		"\tassert(t          != NULL && \"Null param\");\n"
+		"\tassert(tokens     != NULL && \"Null param\");\n"
+		"\tassert(n_tokens   != NULL && \"Null param\");\n"
+		"\tassert(old_source != NULL && \"Null param\");\n"
+		"\tassert(new_source != NULL && \"Null param\");\n"
+		"\tassert(!t->compress && \"Compressed tree can't be reparsed\");\n\n"
+
+		"\tGEN_Token *old_tokens = *tokens;\n"
+		"\tuint64_t   n_old      = *n_tokens;\n"
+		"\tint64_t    shift      = (int64_t)edit.n_inserted - (int64_t)edit.n_removed;\n\n"
+
+		"\t// Token before changed one is lexed again too: edit can join them.\n"
+		"\tuint64_t edit_first = 0;\n"
+		"\twhile (edit_first + 1 < n_old &&\n"
+		"\t\tGEN_TokenStart(old_tokens + edit_first, old_source, old_len) + old_tokens[edit_first].len < edit.offset) {\n"
+		"\t\t++edit_first;\n"
+		"\t}\n"
+		"\tedit_first = (edit_first > 0)? edit_first - 1 : 0;\n\n");
+
+	fprintf(parser_c,
+		"\t// Lexer is stateless between tokens: lexing is stopped\n"
+		"\t// when it comes to start of old token after edit.\n"
+		"\tuint64_t   new_capacity = n_old + kInitSequenceSize;\n"
+		"\tGEN_Token *new_tokens   = (GEN_Token *)calloc(new_capacity, sizeof(GEN_Token));\n"
+		"\tassert(new_tokens != NULL && \"Null calloc allocation\");\n"
+		"\tuint64_t n_new    = edit_first;\n"
+		"\tuint64_t edit_end = n_old - 1;\n"
+		"\tuint64_t old_idx  = edit_first;\n"
+		"\tuint64_t start    = GEN_TokenStart(old_tokens + edit_first, old_source, old_len);\n"
+		"\tuint64_t   new_len = old_len - edit.n_removed + edit.n_inserted;\n"
+		"\tstart = (start < edit.offset)? start : edit.offset;\n"
+		"\tGEN_Lexer *lx = GEN_LexerCtor(new_source + start, new_len - start);\n"
+		"\twhile (true) {\n"
+		"\t\tGEN_Token token = *GEN_NextToken(lx);\n"
+		"\t\tif (token.txt == GEN_eof_token.txt) {\n"
+		"\t\t\tbreak;\n"
+		"\t\t}\n"
+		"\t\tuint64_t token_start = (uint64_t)(token.txt - new_source);\n"
+		"\t\tif (token_start >= edit.offset + edit.n_inserted) {\n"
+		"\t\t\tuint64_t old_start = (uint64_t)((int64_t)token_start - shift);\n"
+		"\t\t\twhile (old_idx + 1 < n_old && GEN_TokenStart(old_tokens + old_idx, old_source, old_len) < old_start) {\n"
+		"\t\t\t\t++old_idx;\n"
+		"\t\t\t}\n"
+		"\t\t\tif (old_idx + 1 < n_old && GEN_TokenStart(old_tokens + old_idx, old_source, old_len) == old_start) {\n"
+		"\t\t\t\tedit_end = old_idx;\n"
+		"\t\t\t\tbreak;\n"
+		"\t\t\t}\n"
+		"\t\t}\n"
+		"\t\tif (n_new == new_capacity) {\n"
+		"\t\t\tnew_capacity <<= 1;\n"
+		"\t\t\tnew_tokens = (GEN_Token *)realloc(new_tokens, new_capacity * sizeof(GEN_Token));\n"
+		"\t\t\tassert(new_tokens != NULL && \"Null realloc allocation\");\n"
+		"\t\t}\n"
+		"\t\tnew_tokens[n_new++] = token;\n"
+		"\t}\n"
+		"\tGEN_LexerDtor(lx);\n\n");
+
+	fprintf(parser_c,
+		"\tuint64_t new_edit_end = n_new;\n"
+		"\tuint64_t n_result     = n_new + n_old - edit_end;\n"
+		"\tif (n_result > new_capacity) {\n"
+		"\t\tnew_tokens = (GEN_Token *)realloc(new_tokens, n_result * sizeof(GEN_Token));\n"
+		"\t\tassert(new_tokens != NULL && \"Null realloc allocation\");\n"
+		"\t}\n"
+		"\tfor (uint64_t cur_token = 0; cur_token < edit_first; ++cur_token) {\n"
+		"\t\tnew_tokens[cur_token]     = old_tokens[cur_token];\n"
+		"\t\tnew_tokens[cur_token].txt = new_source + (old_tokens[cur_token].txt - old_source);\n"
+		"\t}\n"
+		"\tfor (uint64_t cur_token = edit_end; cur_token < n_old; ++cur_token) {\n"
+		"\t\tGEN_Token *token = new_tokens + n_new++;\n"
+		"\t\t*token = old_tokens[cur_token];\n"
+		"\t\tif (token->txt != GEN_eof_token.txt) {\n"
+		"\t\t\ttoken->txt = new_source + (token->txt - old_source) + shift;\n"
+		"\t\t}\n"
+		"\t}\n\n"
+
+		"\tGEN_Reuse reuse = {0};\n"
+		"\treuse.edit_first   = edit_first;\n"
+		"\treuse.edit_end     = edit_end;\n"
+		"\treuse.new_edit_end = new_edit_end;\n"
+		"\tGEN_ReusePush(&reuse, t->root, 0);\n\n"
+
+		"\t// Old root is kept by (reuse), new tree grows in the same arena.\n"
+		"\tt->root    = NULL;\n"
+		"\tt->current = NULL;\n"
+		"\tGEN_AddChild(t, GEN_CreateNode(t, &GEN_eof_token));\n"
+		"\tGEN_Lexer  *seq_lx = GEN_SequenceLexerCtor(new_tokens, n_new);\n"
+		"\tGEN_Parser *p      = GEN_ParserCtor(seq_lx);\n"
+		"\tp->reuse = &reuse;\n"
+		"\tGEN_RunParser(t, p, (GEN_Context){0});\n"
+		"\tGEN_ParserDtor(p);\n"
+		"\tGEN_LexerDtor(seq_lx);\n"
+		"\tGEN_ReparseFixTree(t->root, old_source, old_len, new_source, &edit);\n\n"
+
+		"\tfree(reuse.frames);\n"
+		"\tfree(old_tokens);\n"
+		"\t*tokens   = new_tokens;\n"
+		"\t*n_tokens = n_new;\n"
+		"\treturn reuse.n_reused;\n"
+		"}\n\n");
+
+	fprintf(lib_header,
+		"GEN_Tree *GEN_RunParser(GEN_Tree *t, GEN_Parser *p, GEN_Context ctx);\n"
+		"GEN_Tree *ParseLexer(GEN_Tree *t, GEN_Lexer *lx, GEN_Context ctx);\n"
+		"GEN_Tree *ParseSequence(GEN_Tree *t, GEN_Token *s, GEN_Context ctx, int64_t n_tokens);\n"
+		"void ParseLexerEvents(GEN_Lexer *lx, const GEN_Handler *handler, GEN_Context ctx);\n"
+		"void ParseLexerFlat(GEN_FlatTree *ft, GEN_Lexer *lx, GEN_Context ctx);\n\n"
+
+		"// Change of source: (n_removed) bytes at (offset) are replaced by (inserted).\n"
+		"typedef struct\n"
+		"{\n"
+		"\tuint64_t    offset;\n"
+		"\tuint64_t    n_removed;\n"
+		"\tconst char *inserted;\n"
+		"\tuint64_t    n_inserted;\n"
+		"} GEN_Edit;\n\n"
+
+		"char *GEN_EditSource(const char *old_source, uint64_t old_len, const GEN_Edit *edit, uint64_t *new_len);\n"
+		"uint64_t GEN_Reparse(GEN_Tree *t, GEN_Token **tokens, uint64_t *n_tokens,\n"
+		"\tconst char *old_source, uint64_t old_len, const char *new_source, GEN_Edit edit);\n");
+}
+
+/**
+ * @brief Prints all obvious command to parser's file
+ * 
+ * @param lib_header        Header of library.
+ * @param parser_c          Parser's c file
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param options           Options of generator.
+ */
+static void WriteObviousCommands
+	(FILE *lib_header, FILE *parser_c, NameTable *tokenizer_table, const GeneratorOptions *options)
+{
+	if (options->backend == BACKEND_TABLE) {
+		// Table driver has it's own GEN_RunParser and doesn't use GEN_TryToken.
+		WriteParseWrappers(lib_header, parser_c);
+		return;
+	}
+
+	fprintf(lib_header,
+		"GEN_INTERNAL GEN_Context GEN_TryToken(GEN_Parser *p, GEN_TokenType expected_type, GEN_Context ctx);\n");
+
+	fprintf(parser_c,
+		"GEN_INTERNAL GEN_Context GEN_TryToken(GEN_Parser *p, GEN_TokenType expected_type, GEN_Context ctx)\n"
+		"{\n"
+		"\tGEN_LexerSeek(p->lexer, ctx.cur_token_idx);\n"
+		"\tGEN_Token *token = GEN_PeekToken(p->lexer, 0);\n"
+		"\tif (ctx.cur_token_idx >= p->peek_end) {\n"
+		"\t\tp->peek_end = ctx.cur_token_idx + 1;\n"
+		"\t}\n");
+	WriteTrace(parser_c, options,
+		"\tmsg(D_PARSER_WORK, M, \"TryToken start t(%%.*s|idx:%%lu)\\n\", (int)token->len, token->txt, ctx.cur_token_idx);\n");
+	fprintf(parser_c,
+		"\tif (token->type != expected_type) {\n"
+		"\t\treturn ctx;\n"
+		"\t}\n"
+		"\tGEN_PushToken(p, token);\n"
+		"\t++ctx.n_parsed;\n"
+		"\t++ctx.cur_token_idx;\n");
+	WriteTrace(parser_c, options,
+		"\tmsg(D_PARSER_WORK, M, \"END of TryToken\\n\");\n");
+	fprintf(parser_c,
+		"\treturn ctx;\n"
+		"}\n\n");
+
+	int64_t start = FindName(tokenizer_table, "start");
+	if (start != kUndefinedIdx) {
+		fprintf(parser_c,
+			"GEN_Tree *GEN_RunParser(GEN_Tree *t, GEN_Parser *p, GEN_Context ctx) {\n"
+			"\tp->tree = t;\n"
+			"\tTry_%.*s(p, ctx);\n"
+			"\tGEN_ParserFinish(p);\n"
+			"\treturn t;\n"
+			"}\n\n",
+			NODE_TXT(VariableValue(tokenizer_table->names[start]))
+			);
+		WriteParseWrappers(lib_header, parser_c);
+	}
+}
+
+/**
+ * @brief Prints ParseSequenceParallel if grammar has %parallel_unit. Sequence is split
+ * to ranges after tokens which can end unit outside of brackets, each range is parsed
+ * by it's own thread to it's own tree as if it was the whole sequence. Units of ranges
+ * are joined under one node of %start rule, so tree is the same as of ParseSequence.
+ * Range is parsed as if EOF was after it: last unit of range which looked at EOF
+ * could be other unit in the whole sequence, so such split is wrong too.
+ * After wrong split the whole sequence is parsed again by ParseSequence.
+ *
+ * @param lib_header   Header of library.
+ * @param parser_c     Parser's c file.
+ * @param parallel     Parallel unit of grammar.
+ */
+static void WriteParallelParse(FILE *lib_header, FILE *parser_c, const ParallelUnit *parallel)
+{
+	if (parallel->unit_rule == kUndefinedIdx) {
+		return;
+	}
+	NameTable *tokenizer_table = parallel->tokenizer_table;
+	Node      *unit            = parallel->parser_table->names[parallel->unit_rule];
+	Node      *start           = parallel->parser_table->names[parallel->start_rule];
+
+	fprintf(lib_header,
+		"#define GEN_PARALLEL\n\n"
+		"// Parses like ParseSequence, ranges of %%parallel_unit are parsed by (n_workers) threads.\n"
+		"GEN_Tree *ParseSequenceParallel(GEN_Tree *t, GEN_Token *s, GEN_Context ctx, int64_t n_tokens, uint32_t n_workers);\n\n");
+
+	fprintf(parser_c,
+		"// Tokens which can end %%parallel_unit (%.*s).\n"
+		"static const bool GEN_unit_last[%lu] =\n"
+		"{\n",
+		NODE_TXT(unit), NumberOfTokenTypes(tokenizer_table));
+	for (uint64_t cur_token = 0; cur_token < tokenizer_table->size; ++cur_token) {
+		if (parallel->last[cur_token] && !PhonyVariables(tokenizer_table, cur_token)) {
+			fprintf(parser_c, "\t[%.*s] = true,\n", NODE_TXT(tokenizer_table->names[cur_token]));
+		}
+	}
+	fprintf(parser_c,
+		"};\n\n"
+		"// Change of depth of brackets after token: range can end only at depth 0.\n"
+		"static const int8_t GEN_unit_nesting[%lu] =\n"
+		"{\n",
+		NumberOfTokenTypes(tokenizer_table));
+	for (uint64_t cur_token = 0; cur_token < tokenizer_table->size; ++cur_token) {
+		if (parallel->nesting[cur_token] != 0) {
+			fprintf(parser_c, "\t[%.*s] = %d,\n", NODE_TXT(tokenizer_table->names[cur_token]), parallel->nesting[cur_token]);
+		}
+	}
+	fprintf(parser_c,
+		"};\n\n"
+
+		"// Ranges have at least so many tokens: smaller sequence is parsed by one thread.\n"
+		"static const uint64_t kParallelMinTokens = 1 << 10;\n"
+		"// Stack of worker: recursive parser goes deep into nested units.\n"
+		"static const size_t   kParallelStackSize = (size_t)1 << 26;\n\n"
+
+		"// Range of sequence which one worker parses to it's own tree.\n"
+		"typedef struct\n"
+		"{\n"
+		"\t// Copy of range with EOF token after it.\n"
+		"\tGEN_Token *tokens;\n"
+		"\tuint64_t   first;\n"
+		"\tuint64_t   n_tokens;\n"
+		"\tGEN_Tree   tree;\n"
+		"\tpthread_t  thread;\n"
+		"\tbool       started;\n"
+		"} GEN_UnitRange;\n\n"
+
+		"// Units of all ranges in order of sequence.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_Node **data;\n"
+		"\tuint64_t   size;\n"
+		"\tuint64_t   capacity;\n"
+		"\t// End of tokens which node of %%start rule looked at.\n"
+		"\tuint64_t   examined;\n"
+		"} GEN_Units;\n\n"
+
+		"static void *GEN_UnitRoutine(void *arg)\n"
+		"{\n"
+		"\tGEN_UnitRange *range = (GEN_UnitRange *)arg;\n"
+		"\tGEN_AddChild(&range->tree, GEN_CreateNode(&range->tree, &GEN_eof_token));\n"
+		"\tParseSequence(&range->tree, range->tokens, (GEN_Context){0}, (int64_t)range->n_tokens + 1);\n"
+		"\treturn NULL;\n"
+		"}\n\n"
+
+		"/*\n"
+		" * Splits tokens [0, n_tokens) to at most (n_ranges) nearly equal ranges:\n"
+		" * range ends after token which can end unit and isn't inside of brackets.\n"
+		" * @returns   Number of ranges, (ends) are their ends.\n"
+		" */\n"
+		"static uint64_t GEN_SplitUnits(const GEN_Token *s, uint64_t n_tokens, uint64_t n_ranges, uint64_t *ends)\n"
+		"{\n"
+		"\tuint64_t n_ends = 0;\n"
+		"\tint64_t  depth  = 0;\n"
+		"\tfor (uint64_t cur_token = 0; cur_token + 1 < n_tokens && n_ends + 1 < n_ranges; ++cur_token) {\n"
+		"\t\tdepth += GEN_unit_nesting[s[cur_token].type];\n"
+		"\t\tif (depth == 0 && GEN_unit_last[s[cur_token].type] &&\n"
+		"\t\t\t\tcur_token + 1 >= (n_ends + 1) * (n_tokens / n_ranges)) {\n"
+		"\t\t\tends[n_ends++] = cur_token + 1;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tends[n_ends++] = n_tokens;\n"
+		"\treturn n_ends;\n"
+		"}\n\n");
+
+	fprintf(parser_c,
+		"// Adds (unit) which starts (offset) tokens after start of sequence.\n"
+		"static bool GEN_AddUnit(GEN_Units *units, GEN_Node *unit, uint64_t offset)\n"
+		"{\n"
+		"\tif (unit->token.type != %.*s) {\n"
+		"\t\treturn false;\n"
+		"\t}\n"
+		"\tif (units->size == units->capacity) {\n"
+		"\t\tunits->capacity = (units->capacity == 0)? kMaxScopeDepth : units->capacity << 1;\n"
+		"\t\tunits->data = (GEN_Node **)realloc(units->data, units->capacity * sizeof(GEN_Node *));\n"
+		"\t\tassert(units->data != NULL && \"Null realloc allocation\");\n"
+		"\t}\n"
+		"\tunit->offset = (uint32_t)offset;\n"
+		"\tunits->data[units->size++] = unit;\n"
+		"\tif (offset + unit->n_examined > units->examined) {\n"
+		"\t\tunits->examined = offset + unit->n_examined;\n"
+		"\t}\n"
+		"\treturn true;\n"
+		"}\n\n"
+
+		"/*\n"
+		" * Adds units of tree of (range): children of node of %%start rule or of root\n"
+		" * if it was compressed. Offsets of units are moved to start of sequence.\n"
+		" * @returns   false if range isn't parsed as whole units: split was wrong.\n"
+		" */\n"
+		"static bool GEN_CollectUnits(GEN_Units *units, const GEN_UnitRange *range, bool is_last)\n"
+		"{\n"
+		"\tGEN_Node *root = range->tree.root;\n"
+		"\tif (root->n_tokens != range->n_tokens || root->children == NULL) {\n"
+		"\t\treturn false;\n"
+		"\t}\n"
+		"\tuint64_t first_unit = units->size;\n"
+		"\tfor (uint64_t cur_child = 0; cur_child < root->children->size; ++cur_child) {\n"
+		"\t\tGEN_Node *child  = GEN_GetChild(root, cur_child);\n"
+		"\t\tuint64_t  offset = range->first + child->offset;\n"
+		"\t\tif (child->token.type != %.*s || child->children == NULL) {\n"
+		"\t\t\tif (!GEN_AddUnit(units, child, offset)) {\n"
+		"\t\t\t\treturn false;\n"
+		"\t\t\t}\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tif (offset + child->n_examined > units->examined) {\n"
+		"\t\t\tunits->examined = offset + child->n_examined;\n"
+		"\t\t}\n"
+		"\t\tfor (uint64_t cur_unit = 0; cur_unit < child->children->size; ++cur_unit) {\n"
+		"\t\t\tGEN_Node *unit = GEN_GetChild(child, cur_unit);\n"
+		"\t\t\tif (!GEN_AddUnit(units, unit, offset + unit->offset)) {\n"
+		"\t\t\t\treturn false;\n"
+		"\t\t\t}\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tif (units->size == first_unit) {\n"
+		"\t\treturn false;\n"
+		"\t}\n"
+		"\t// Unit which looked at EOF of range could be other unit in the whole sequence.\n"
+		"\tGEN_Node *last = units->data[units->size - 1];\n"
+		"\treturn is_last || last->n_examined <= last->n_tokens;\n"
+		"}\n\n",
+		NODE_TXT(unit), NODE_TXT(start));
+
+	fprintf(parser_c,
+		"// Puts units under current node of tree like GEN_ParserFinish puts result of %%start rule.\n"
+		"static void GEN_JoinUnits(GEN_Tree *t, const GEN_Units *units, uint64_t n_tokens)\n"
+		"{\n"
+		"\tGEN_Node *root = t->current;\n"
+		"\tif (t->compress && (units->size == 1 || GEN_elided[%.*s])) {\n"
+		"\t\tfor (uint64_t cur_unit = 0; cur_unit < units->size; ++cur_unit) {\n"
+		"\t\t\tGEN_AddChild(t, units->data[cur_unit]);\n"
+		"\t\t\tGEN_Parent(t);\n"
+		"\t\t}\n"
+		"\t} else {\n"
+		"\t\tGEN_Node *node = GEN_CreateNodeByType(t, %.*s);\n"
+		"\t\tnode->children = GEN_ArrayCtor(GEN_TreeArena(t), sizeof(GEN_Node*), units->size);\n"
+		"\t\tfor (uint64_t cur_unit = 0; cur_unit < units->size; ++cur_unit) {\n"
+		"\t\t\tGEN_ArrayAdd(node->children, units->data[cur_unit]);\n"
+		"\t\t\tunits->data[cur_unit]->parent = node;\n"
+		"\t\t}\n"
+		"\t\tnode->n_tokens   = (uint32_t)n_tokens;\n"
+		"\t\tnode->n_examined = (uint32_t)units->examined;\n"
+		"\t\tGEN_AddChild(t, node);\n"
+		"\t\tGEN_Parent(t);\n"
+		"\t}\n"
+		"\troot->n_tokens   = (uint32_t)n_tokens;\n"
+		"\troot->n_examined = (uint32_t)n_tokens;\n"
+		"}\n\n",
+		NODE_TXT(start), NODE_TXT(start));
+
+	fprintf(parser_c,
+		"/*\n"
+		" * Parses sequence (s) of (n_tokens) tokens with EOF like ParseSequence, but ranges\n"
+		" * of %%parallel_unit are parsed by (n_workers) threads, each to it's own arena.\n"
+		" * Arenas of workers go to arena of (t). If some range isn't parsed as whole\n"
+		" * units, the whole sequence is parsed by ParseSequence.\n"
+		" */\n"
+		"GEN_Tree *ParseSequenceParallel(GEN_Tree *t, GEN_Token *s, GEN_Context ctx, int64_t n_tokens, uint32_t n_workers)\n"
+		"{\n"
+		"\tassert(t != NULL && \"Null param\");\n"
+		"\tassert(s != NULL && \"Null param\");\n\n"
+
+		"\t// Tokens before EOF.\n"
+		"\tuint64_t n_body   = (n_tokens > 0)? (uint64_t)n_tokens - 1 : 0;\n"
+		"\tuint64_t n_ranges = n_body / kParallelMinTokens;\n"
+		"\tn_ranges = (n_workers < n_ranges)? n_workers : n_ranges;\n"
+		"\tif (n_ranges < 2 || ctx.cur_token_idx != 0 || ctx.n_parsed != 0 || t->current == NULL) {\n"
+		"\t\treturn ParseSequence(t, s, ctx, n_tokens);\n"
+		"\t}\n\n"
+
+		"\tuint64_t *ends = (uint64_t *)calloc(n_ranges, sizeof(uint64_t));\n"
+		"\tassert(ends != NULL && \"Null calloc allocation\");\n"
+		"\tn_ranges = GEN_SplitUnits(s, n_body, n_ranges, ends);\n"
+		"\tGEN_UnitRange *ranges = (GEN_UnitRange *)calloc(n_ranges, sizeof(GEN_UnitRange));\n"
+		"\tassert(ranges != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tpthread_attr_t attr;\n"
+		"\tpthread_attr_init(&attr);\n"
+		"\tpthread_attr_setstacksize(&attr, kParallelStackSize);\n"
+		"\tfor (uint64_t cur_range = 0; cur_range < n_ranges; ++cur_range) {\n"
+		"\t\tGEN_UnitRange *range = ranges + cur_range;\n"
+		"\t\trange->first    = (cur_range > 0)? ends[cur_range - 1] : 0;\n"
+		"\t\trange->n_tokens = ends[cur_range] - range->first;\n"
+		"\t\trange->tokens   = (GEN_Token *)malloc((range->n_tokens + 1) * sizeof(GEN_Token));\n"
+		"\t\tassert(range->tokens != NULL && \"Null malloc allocation\");\n"
+		"\t\tmemcpy(range->tokens, s + range->first, range->n_tokens * sizeof(GEN_Token));\n"
+		"\t\trange->tokens[range->n_tokens] = s[n_body];\n"
+		"\t\trange->tree.compress = t->compress;\n"
+		"\t\t// First range and ranges whose worker can't be started are parsed by this thread.\n"
+		"\t\trange->started = (cur_range > 0 && pthread_create(&range->thread, &attr, GEN_UnitRoutine, range) == 0);\n"
+		"\t}\n"
+		"\tpthread_attr_destroy(&attr);\n"
+		"\tfor (uint64_t cur_range = 0; cur_range < n_ranges; ++cur_range) {\n"
+		"\t\tif (ranges[cur_range].started) {\n"
+		"\t\t\tpthread_join(ranges[cur_range].thread, NULL);\n"
+		"\t\t} else {\n"
+		"\t\t\tGEN_UnitRoutine(ranges + cur_range);\n"
+		"\t\t}\n"
+		"\t}\n\n"
+
+		"\tGEN_Units units = {0};\n"
+		"\tbool      whole = true;\n"
+		"\tfor (uint64_t cur_range = 0; whole && cur_range < n_ranges; ++cur_range) {\n"
+		"\t\twhole = GEN_CollectUnits(&units, ranges + cur_range, cur_range + 1 == n_ranges);\n"
+		"\t}\n"
+		"\tif (whole) {\n"
+		"\t\tGEN_JoinUnits(t, &units, n_body);\n"
+		"\t}\n"
+		"\tfor (uint64_t cur_range = 0; cur_range < n_ranges; ++cur_range) {\n"
+		"\t\tfree(ranges[cur_range].tokens);\n"
+		"\t\tif (whole) {\n"
+		"\t\t\tt->size += ranges[cur_range].tree.size;\n"
+		"\t\t\tGEN_ArenaAdopt(GEN_TreeArena(t), ranges[cur_range].tree.arena);\n"
+		"\t\t} else {\n"
+		"\t\t\tGEN_TreeFree(&ranges[cur_range].tree);\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tfree(units.data);\n"
+		"\tfree(ranges);\n"
+		"\tfree(ends);\n\n"
+
+		"\tif (!whole) {\n"
+		"\t\treturn ParseSequence(t, s, ctx, n_tokens);\n"
+		"\t}\n"
+		"\treturn t;\n"
+		"}\n\n");
+}
+
+/**
+ * @brief Prints call of symbol (chain) which sets (new_ctx):
+ * GEN_TryToken for token or Try_<rule> for rule.
+ */
+static void WriteSymbolCall(FILE *parser_c, Node *chain, const char *tabs)
+{
+	if (chain->token->parser_type == NOT_SPECIAL) {
+		fprintf(parser_c,
+			"%snew_ctx = GEN_TryToken(p, %s, try_ctx);\n",
+			tabs, TranslateTokenType(GetType(chain)));
+
+	} else if (chain->token->parser_type == RULE_NAME_REFERENCE) {
+		fprintf(parser_c,
+			"%snew_ctx = Try_%.*s(p, try_ctx);\n",
+			tabs, NODE_TXT(chain));
+	} else if (chain->token->parser_type == VAR_NAME_REFERENCE) {
+		fprintf(parser_c,
+			"%snew_ctx = GEN_TryToken(p, %.*s, try_ctx);\n",
+			tabs, NODE_TXT(chain));
+	}
+}
+
+/**
+ * @brief Prints one chain in sequence of tokence in line
+ * of YACC-rule line.
+ * 
+ * @param parser_c       Parser's c file.
+ * @param chain          Current node in parser's AST.
+ * @param tabs           Number of tabs to print before each line.
+ * @param cur_child      Index of current child (=line index of current rule).
+ * @param name_of_rule   Name of current rule in parser's AST.
+ * @param is_list        Option is loop of list rule: failed symbol ends the list.
+ * @param after_cut      Chain is after cut: it's failure fails the whole rule.
+ * @param options        Options of generator.
+ */
+static void WriteChain
+	(FILE *parser_c, Node *chain, char *tabs, uint64_t cur_child, char *name_of_rule,
+	bool is_list, bool after_cut, const GeneratorOptions *options)
+{
+	msg(D_FILE_PRINT, M,
+		"Current node in line:%.*s\n", NODE_TXT(chain));
+
+	// Reference at the end of list is next turn of it's loop.
+	if (chain->token->repeat == REPEAT_TAIL) {
+		return;
+	}
+
+	WriteTrace(parser_c, options,
+		"%stab_incr();\n"
+		"%smsg(D_PARSER_WORK, M, \"new chain in option\\n\");\n"
+		"%stab_incr();\n",
+		tabs, tabs, tabs);
+
+	if (chain->token->repeat != REPEAT_STAR) {
+		WriteSymbolCall(parser_c, chain, tabs);
+
+		WriteTrace(parser_c, options,
+			"%stab_decr();\n",
+			tabs);
+
+		fprintf(parser_c,
+			"%sif (memcmp(&new_ctx, &try_ctx, sizeof(GEN_Context)) == 0) {\n",
+			tabs);
+		WriteTrace(parser_c, options,
+			"%s\tmsg(D_PARSER_WORK, M, \"NOT NEEDED OPTION: Try_%s_%lu\\n\");\n"
+			"%s\ttab_decr();\n",
+			tabs, name_of_rule, cur_child + 1, tabs);
+		if (after_cut) {
+			fprintf(parser_c,
+				"%s\tp->cut = true;\n",
+				tabs);
+		}
+		// List is applied with it's complete elements (or fails if there are none).
+		fprintf(parser_c,
+			"%s\tGEN_ParserRollback(p, %s);\n"
+			"%s\treturn %s;\n"
+			"%s}\n"
+			"%stry_ctx = new_ctx;\n",
+			tabs, (is_list)? "end_mark" : "mark",
+			tabs, (is_list)? "end_ctx" : "ctx",
+			tabs, tabs);
+	}
+
+	if (chain->token->repeat == REPEAT_STAR || chain->token->repeat == REPEAT_PLUS) {
+		char loop_tabs[kMaxTabsLen] = "";
+		snprintf(loop_tabs, kMaxTabsLen, "%s\t", tabs);
+
+		fprintf(parser_c,
+			"%s// Symbol is repeated while it's parsed.\n"
+			"%swhile (true) {\n",
+			tabs, tabs);
+		WriteSymbolCall(parser_c, chain, loop_tabs);
+		fprintf(parser_c,
+			"%sif (memcmp(&new_ctx, &try_ctx, sizeof(GEN_Context)) == 0) {\n"
+			"%s\tbreak;\n"
+			"%s}\n"
+			"%stry_ctx = new_ctx;\n",
+			loop_tabs, loop_tabs, loop_tabs, loop_tabs);
+		// Option ends with this loop, so it's applied already.
+		if (chain->children == NULL) {
+			fprintf(parser_c,
+				"%sGEN_LexerMoveMark(p->lexer, try_ctx.cur_token_idx);\n",
+				loop_tabs);
+		}
+		fprintf(parser_c, "%s}\n", tabs);
+
+		if (chain->token->repeat == REPEAT_STAR) {
+			WriteTrace(parser_c, options,
+				"%stab_decr();\n",
+				tabs);
+		}
+	}
+
+	if (chain->token->list_end) {
+		fprintf(parser_c,
+			"%s// List can end after this symbol: it isn't parsed again from it's start.\n"
+			"%send_mark = GEN_ParserMark(p);\n"
+			"%send_ctx  = try_ctx;\n"
+			"%sGEN_LexerMoveMark(p->lexer, end_ctx.cur_token_idx);\n",
+			tabs, tabs, tabs, tabs);
+	}
+
+	WriteTrace(parser_c, options,
+		"%smsg(D_PARSER_WORK, M, \"END chain in option\\n\");\n"
+		"%stab_decr();\n",
+		tabs, tabs);
+	fprintf(parser_c, "\n");
+}
+
+/**
+ * @brief Prints table of operators of rule which is parsed by precedence
+ * climbing: level and associativity of each type of token.
+ */
+static void WriteOperators(FILE *parser_c, const Precedence *precedence, uint64_t rule_idx, const char *name_of_rule)
+{
+	NameTable  *tokenizer_table = precedence->tokenizer_table;
+	const bool *operators       = precedence->operators + rule_idx * tokenizer_table->size;
+	static const char *kAssocNames[] = {"GEN_ASSOC_LEFT", "GEN_ASSOC_RIGHT", "GEN_ASSOC_NONASSOC"};
+
+	fprintf(parser_c,
+		"// Operators of %s: level of precedence (0 if token isn't operator) and associativity.\n"
+		"static const GEN_Operator GEN_%s_operators[%lu] =\n"
+		"{\n",
+		name_of_rule, name_of_rule, NumberOfTokenTypes(tokenizer_table));
+	for (uint64_t cur_token = 0; cur_token < tokenizer_table->size; ++cur_token) {
+		if (operators[cur_token]) {
+			fprintf(parser_c,
+				"\t[%.*s] = {%lu, %s},\n",
+				NODE_TXT(tokenizer_table->names[cur_token]),
+				precedence->levels[cur_token], kAssocNames[precedence->assoc[cur_token]]);
+		}
+	}
+	fprintf(parser_c,
+		"};\n\n");
+}
+
+/**
+ * @brief Prints rule which is parsed by precedence climbing. Operand is parsed
+ * by options of rule, then each operator of level at least (min_level) takes it
+ * as left operand and operand with operators of higher level as right one
+ * (operators of the same level too if operator is %right). Node of rule is made
+ * for each operator, so tree is the same as of options (rule operator rule).
+ * Operand chain is parsed in one pass whatever number of levels is.
+ *
+ * Only whole expression (min_level 1) is memoized. Subtrees aren't reused by
+ * GEN_Reparse: node of right operand could be reused as whole expression.
+ *
+ * @param lib_header     Header of library.
+ * @param parser_c       Parser's c file.
+ * @param first          FIRST sets of parser's rules.
+ * @param fork           Node with operands of rule.
+ * @param rule_idx       Index of rule in parser's table.
+ * @param name_of_rule   Name of current rule.
+ * @param precedence     Precedence of operators.
+ * @param options        Options of generator.
+ */
+static void WriteClimbingRule
+	(FILE *lib_header, FILE *parser_c, const FirstSets *first, Node *fork, uint64_t rule_idx,
+	const char *name_of_rule, const Precedence *precedence, const GeneratorOptions *options)
+{
+	WriteOperators(parser_c, precedence, rule_idx, name_of_rule);
+
+	fprintf(parser_c,
+		"static GEN_Context Try_%s_Climb(GEN_Parser *p, GEN_Context ctx, uint32_t min_level)\n"
+		"{\n"
+		"\tGEN_Context try_ctx = ctx;\n\n",
+		name_of_rule);
+
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\tGEN_MemoEntry *memo = (min_level == 1)? GEN_MemoLookup(p, %s, ctx.cur_token_idx) : NULL;\n"
+			"\tif (memo != NULL) {\n",
+			name_of_rule);
+		WriteTrace(parser_c, options,
+			"\t\tmsg(D_PARSER_WORK, M, \"MEMOIZED Try_%s\\n\");\n",
+			name_of_rule);
+		fprintf(parser_c,
+			"\t\treturn GEN_MemoReplay(p, memo, ctx);\n"
+			"\t}\n\n");
+	}
+
+	fprintf(parser_c,
+		"\tGEN_Context new_ctx = ctx;\n"
+		"\tGEN_Mark    mark    = GEN_RuleMark(p, ctx.cur_token_idx);\n"
+		"\t// Operands and operators are parsed from here so lexer keeps this token.\n"
+		"\tGEN_LexerPushMark(p->lexer, ctx.cur_token_idx);\n"
+		"\tGEN_LexerSeek(p->lexer, ctx.cur_token_idx);\n\n");
+
+	WriteDispatch(parser_c, first, fork, name_of_rule, options);
+
+	fprintf(parser_c, "\tif (memcmp(&new_ctx, &try_ctx, sizeof(GEN_Context)) == 0) {\n");
+	for (uint64_t cur_child = 0; cur_child < fork->children->size; ++cur_child) {
+		if (ChainHasCut(GetChild(fork, cur_child))) {
+			fprintf(parser_c, "\t\tp->cut = false;\n");
+			break;
+		}
+	}
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\t\tif (min_level == 1) {\n"
+			"\t\t\tGEN_MemoStore(p, %s, ctx, ctx, NULL);\n"
+			"\t\t}\n",
+			name_of_rule);
+	}
+	fprintf(parser_c,
+		"\t\tGEN_RuleLeave(p, mark);\n"
+		"\t\tGEN_LexerPopMark(p->lexer);\n");
+	WriteTrace(parser_c, options, "\t\ttab_decr();\n");
+	fprintf(parser_c,
+		"\t\treturn ctx;\n"
+		"\t}\n\n");
+
+	fprintf(parser_c,
+		"\t%sGEN_CommitRule(p, %s, mark);\n"
+		"\t// Operator of %%nonassoc can't take result of operator of it's level.\n"
+		"\tuint32_t nonassoc_level = 0;\n"
+		"\twhile (true) {\n"
+		"\t\t// Rule is applied already: it's operands aren't parsed again.\n"
+		"\t\tGEN_LexerMoveMark(p->lexer, new_ctx.cur_token_idx);\n"
+		"\t\tGEN_LexerSeek(p->lexer, new_ctx.cur_token_idx);\n"
+		"\t\tGEN_TokenType type = GEN_PeekToken(p->lexer, 0)->type;\n"
+		"\t\tif (new_ctx.cur_token_idx >= p->peek_end) {\n"
+		"\t\t\tp->peek_end = new_ctx.cur_token_idx + 1;\n"
+		"\t\t}\n"
+		"\t\tGEN_Operator op = GEN_%s_operators[type];\n"
+		"\t\tif (op.level < min_level || op.level == nonassoc_level) {\n"
+		"\t\t\tbreak;\n"
+		"\t\t}\n\n"
+
+		"\t\t// Node of rule made so far is left operand of operator.\n"
+		"\t\tGEN_Mark    op_mark = GEN_ParserMark(p);\n"
+		"\t\tGEN_Context op_ctx  = GEN_TryToken(p, type, new_ctx);\n"
+		"\t\tGEN_Context right   = Try_%s_Climb(p, op_ctx, (op.assoc == GEN_ASSOC_RIGHT)? op.level : op.level + 1);\n"
+		"\t\tif (memcmp(&right, &op_ctx, sizeof(GEN_Context)) == 0) {\n"
+		"\t\t\tGEN_ParserRollback(p, op_mark);\n"
+		"\t\t\tbreak;\n"
+		"\t\t}\n"
+		"\t\tnew_ctx        = right;\n"
+		"\t\tnonassoc_level = (op.assoc == GEN_ASSOC_NONASSOC)? op.level : 0;\n"
+		"\t\t%sGEN_CommitRule(p, %s, mark);\n"
+		"\t}\n\n",
+		(options->packrat)? "GEN_Event result = " : "", name_of_rule,
+		name_of_rule, name_of_rule,
+		(options->packrat)? "result = " : "", name_of_rule);
+
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\tif (min_level == 1) {\n"
+			"\t\tGEN_MemoStore(p, %s, ctx, new_ctx, &result);\n"
+			"\t}\n",
+			name_of_rule);
+	}
+	fprintf(parser_c,
+		"\tGEN_RuleLeave(p, mark);\n"
+		"\tGEN_LexerPopMark(p->lexer);\n"
+		"\treturn new_ctx;\n"
+		"}\n\n");
+
+	fprintf(lib_header,
+		"GEN_INTERNAL GEN_Context Try_%s(GEN_Parser *p, GEN_Context ctx);\n\n",
+		name_of_rule);
+	fprintf(parser_c,
+		"%sGEN_Context Try_%s%s(GEN_Parser *p, GEN_Context ctx)\n"
+		"{\n"
+		"\treturn Try_%s_Climb(p, ctx, 1);\n"
+		"}\n\n",
+		(options->profile)? "static " : "GEN_INTERNAL ",
+		name_of_rule,
+		(options->profile)? "_Body" : "",
+		name_of_rule);
+}
+
+/**
+ * @brief Prints one parser's command using parser's AST tree.
+ * 
+ * @param lib_header   Header of library.
+ * @param parser_c     Parser's c file.
+ * @param n            Current node in parser's tree
+ * @param first        FIRST sets of parser's rules.
+ * @param precedence   Precedence of operators.
+ * @param options      Options of generator.
+ */
+static void GenerateCommand
+	(FILE *lib_header, FILE *parser_c, Node *n, const FirstSets *first,
+	const Precedence *precedence, const GeneratorOptions *options)
+{
+	assert(lib_header != NULL && "Null parametr\n");
+	assert(n           != NULL && "Null parametr\n");
+	assert(n->children != NULL && "Null parametr\n");
+
+	/* Name of current name
+	Of rule to use it as part of names of variables
+	or names of parser functions.*/
+	char *name_of_rule = GetTxtCopy(n);
+
+	/* To generate more beautiful code
+	Function use tabs and '\n'-symbols*/
+	char tabs[kMaxTabsLen] = "";
+	uint64_t n_tabs = 0;
+
+	Node *fork = GetChild(n, 0);
+
+	for (uint64_t cur_child = 0; cur_child < fork->children->size; ++cur_child) {
+		fprintf(lib_header,
+			"GEN_INTERNAL GEN_Context Try_%s_%ld(GEN_Parser *p, GEN_Context ctx);\n\n",
+			name_of_rule, cur_child + 1);
+		// Firstly we will write all the options of this rule to the parser file.
+		fprintf(parser_c,
+			"%sGEN_Context Try_%s_%ld%s(GEN_Parser *p, GEN_Context ctx)\n{\n",
+			(options->profile)? "static " : "GEN_INTERNAL ",
+			name_of_rule, cur_child + 1,
+			(options->profile)? "_Body" : "");
+
+		tabs[n_tabs++] = '\t';
+
+		WriteTrace(parser_c, options,
+			"%smsg(D_PARSER_WORK, M, \"%s\\n\");\n",
+			tabs, name_of_rule);
+
+		fprintf(parser_c,
+			"%sGEN_Context try_ctx = ctx;\n"
+			"%s// Symbols of option are pending until rule is applied.\n"
+			"%sGEN_Mark    mark    = GEN_ParserMark(p);\n"
+			"%sGEN_Context new_ctx = {0};\n\n",
+			tabs, tabs, tabs, tabs);
+
+		Node *last_chain = GetChild(fork, cur_child);
+		while (last_chain->children != NULL) {
+			last_chain = GetChild(last_chain, 0);
+		}
+		bool is_list = (last_chain->token->repeat == REPEAT_TAIL);
+		if (is_list) {
+			fprintf(parser_c,
+				"%s// Option is repeated, list ends after it's last complete element.\n"
+				"%sGEN_Mark    end_mark = mark;\n"
+				"%sGEN_Context end_ctx  = ctx;\n\n"
+				"%swhile (true) {\n",
+				tabs, tabs, tabs, tabs);
+			tabs[n_tabs++] = '\t';
+		}
+
+		Node *chain     = GetChild(fork, cur_child);
+		bool  after_cut = false;
+		tab_incr();
+		while (chain->children != NULL) {
+			WriteChain(parser_c, chain, tabs, cur_child, name_of_rule, is_list, after_cut, options);
+			after_cut |= chain->token->cut;
+			chain = GetChild(chain, 0);
+		}
+		// 	Write last chain in sequence in particular
+		// line in rule.
+		WriteChain(parser_c, chain, tabs, cur_child, name_of_rule, is_list, after_cut, options);
+
+		tab_decr();
+		msg(D_FILE_PRINT, M,
+					"end of line\n");
+
+		if (is_list) {
+			--n_tabs;
+			tabs[n_tabs] = '\0';
+			fprintf(parser_c, "%s}\n", tabs);
+		} else {
+			WriteTrace(parser_c, options,
+				"%smsg(D_PARSER_WORK, M, \"EXACTLY Try_%s_%lu\\n\");\n",
+				tabs, name_of_rule, cur_child + 1);
+		}
+
+		--n_tabs;
+		tabs[n_tabs] = '\0';
+
+		if (!is_list) {
+			fprintf(parser_c, "\treturn try_ctx;\n");
+		}
+		fprintf(parser_c, "}\n\n");
+
+		if (options->profile) {
+			char *option_name = (char *)calloc(strlen(name_of_rule) + 24, sizeof(char));
+			assert(option_name != NULL && "Null calloc allocation");
+			sprintf(option_name, "%s_%lu", name_of_rule, cur_child + 1);
+			WriteProfileWrapper(parser_c, option_name);
+			free(option_name);
+		}
+	}
+
+	int64_t rule_idx = SearchInTable(n, precedence->parser_table);
+	if (rule_idx != kUndefinedIdx && precedence->climbs[rule_idx]) {
+		WriteClimbingRule(lib_header, parser_c, first, fork, (uint64_t)rule_idx, name_of_rule, precedence, options);
+		if (options->profile) {
+			WriteProfileWrapper(parser_c, name_of_rule);
+		}
+		free(name_of_rule);
+		return;
+	}
+
+	/* Secondly print prefix of parser
+	function that contains local GEN_context - if that function
+	can be applied to the current place in sequence of token
+	this GEN_context will commit it and contain local progress
+	in parsing sequence.*/
+	WritePrefixOfParserFunction(lib_header, parser_c, name_of_rule, options);
+
+	msg(D_PARSER_GENERATING, M,
+		"Current rule has (%lu) options\n",
+		fork->children->size);
+
+	// Only options which can start with current token are tried.
+	WriteDispatch(parser_c, first, fork, name_of_rule, options);
+
+	/* If all rules can't be applied to the sequence that was wrong rule
+	to parse current place in token sequence so we return original contest.*/
+	fprintf(parser_c, "\tif (memcmp(&new_ctx, &try_ctx, sizeof(GEN_Context)) == 0) {\n");
+	for (uint64_t cur_child = 0; cur_child < fork->children->size; ++cur_child) {
+		if (ChainHasCut(GetChild(fork, cur_child))) {
+			fprintf(parser_c, "\t\tp->cut = false;\n");
+			break;
+		}
+	}
+	if (options->packrat) {
+		fprintf(parser_c, "\t\tGEN_MemoStore(p, %s, ctx, ctx, NULL);\n", name_of_rule);
+	}
+	fprintf(parser_c,
+		"\t\tGEN_RuleLeave(p, mark);\n"
+		"\t\tGEN_LexerPopMark(p->lexer);\n");
+	WriteTrace(parser_c, options, "\t\ttab_decr();\n");
+	fprintf(parser_c,
+		"\t\treturn ctx;\n"
+		"\t}\n");
+
+	/* If one rule-option can be applied to the token sequence
+	it's pending symbols become result of this rule.*/
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\n"
+			"\tGEN_Event result = GEN_CommitRule(p, %s, mark);\n"
+			"\tGEN_MemoStore(p, %s, ctx, new_ctx, &result);\n",
+			name_of_rule, name_of_rule);
+	} else {
+		fprintf(parser_c,
+			"\n"
+			"\tGEN_CommitRule(p, %s, mark);\n",
+			name_of_rule);
+	}
+	fprintf(parser_c,
+		"\tGEN_RuleLeave(p, mark);\n"
+		"\tGEN_LexerPopMark(p->lexer);\n"
+		"\treturn new_ctx;\n");
+
+	fprintf(parser_c, "}\n\n");
+
+	if (options->profile) {
+		WriteProfileWrapper(parser_c, name_of_rule);
+	}
+
+	free(name_of_rule);
+}
+
+/**
+ * @brief Prints all the parser's commands recursively.
+ * 
+ * @param lib_header   Header of library.
+ * @param parser_c     Parser's c file.
+ * @param n            Current node in parser's tree.
+ * @param first        FIRST sets of parser's rules.
+ * @param precedence   Precedence of operators.
+ * @param options      Options of generator.
+ */
+static void GenerateCommands
+	(FILE *lib_header, FILE *parser_c, Node *n, const FirstSets *first,
+	const Precedence *precedence, const GeneratorOptions *options)
+{
+	assert(lib_header != NULL && "Null parametr\n");
+	assert(parser_c   != NULL && "Null parametr\n");
+	assert(n          != NULL && "Null parametr\n");
+
+	if (n->token->parser_type == RULE_NAME) {
+		// Check if it's rule root node.
+		msg(D_FILE_PRINT, M,
+			"Found rule-node:\"%.*s\"\n",
+			NODE_TXT(n));
+		//  If that's rule name we will
+		// generate function text and print it
+		// to the parser file.
+		tab_incr();
+		GenerateCommand(lib_header, parser_c, n, first, precedence, options);
+		tab_decr();
+	} else {
+		if (n->children != NULL) {
+			/*If that node is not a rule-root node, maybe it
+			contains rule-node in it's children so we will check
+			nodes one by one.*/
+			for (uint64_t cur_child = 0; cur_child < n->children->size; ++cur_child) {
+				msg(D_FILE_PRINT, M,
+					"This node NOT rule:\"%.*s\"\n",
+					NODE_TXT(n));
+				msg(D_FILE_PRINT, M,
+					"Start to check childs nodes\n");
+				tab_incr();
+				GenerateCommands(lib_header, parser_c, GetChild(n, cur_child), first, precedence, options);
+				tab_decr();
+				msg(D_FILE_PRINT, M,
+					"End of parsing children\n");
+			}
+		}
+	}
+}
+
+/**
+ * @brief Searches all other (not rule-names) in parser's AST
+ * And add's it's parser's type to that node.
+ * Work's recursively.
+ * 
+ * @param n                 Current node in parser's AST.
+ * @param tokenizer_table   Tokenizer's name table.
+ * @param parser_table      Parser's name table
+ */
+static void SearchNamesInBranceParser
+	(Node *n, NameTable *tokenizer_table, NameTable *parser_table)
+{
+	assert(n     != NULL && "Null parametr\n");
+	assert(tokenizer_table != NULL && "Null parametr\n");
+
+	bool is_ref = false;
+	if (GetType(n) == TOKEN_NAME) {
+		if (SearchInTable(n, tokenizer_table) != -1) {
+			n->token->parser_type = VAR_NAME_REFERENCE;
+			is_ref = true;
+		}
+
+		if (!is_ref) {
+			if (GetType(n) == TOKEN_NAME &&
+					n->children != NULL &&
+					GetType(GetChild(n,0)) == TOKEN_COLON) {
+				n->token->parser_type = RULE_NAME;
+			} else {
+				n->token->parser_type = RULE_NAME_REFERENCE;
+			}
+		}
+	}
+
+	if (n->children != NULL) {
+		for (size_t cur_child_idx = 0; cur_child_idx < n->children->size; ++cur_child_idx) {
+			Node *cur_child = GetChild(n, cur_child_idx);
+			tab_incr();
+			SearchNamesInBranceParser(cur_child, tokenizer_table, parser_table);
+			tab_decr();
+			msg(D_NAMETABLE, M,
+				"End this child\n");
+		}
+	}
+}
+
+/**
+ * @brief Finds all names in parser's tree by
+ * searching for situation: current node is node with
+ * type (TOKEN_NAME) and it has only one child: (TOKEN_COLON).
+ */
+static void AddRuleNames(Node *n, NameTable *parser_table)
+{
+	if (GetType(n) == TOKEN_NAME &&
+			n->children != NULL &&
+			GetType(GetChild(n,0)) == TOKEN_COLON) {
+		// Add new rule name in (parser_table).
+		AddName(parser_table, n);
+	}
+
+	// Call this fuction recursively for all children.
+	if (n->children != NULL) {
+		for (size_t cur_child = 0; cur_child < n->children->size; ++cur_child) {
+			AddRuleNames(GetChild(n, cur_child), parser_table);
+		}
+	}
+}
+
+/**
+ * @brief Search all parser's
+ * names and set's all parser's types for two pass. First pass is for searching all
+ * the rule names. It is needed to make recursive descent.
+ * Second pass sets all other parser's types.
+ * 
+ * @param parser_tree       Parser's tree to scan for names
+ * @param tokenizer_table   Tokenizer's tokenizer_table to extract name
+ * and meanings of it's variables.
+ * @return                  Created parser's tokenizer_table
+ */
+NameTable *ScanParserNames(Tree *parser_tree, NameTable *tokenizer_table)
+{
+	assert(parser_tree != NULL && "Null parametr\n");
+	assert(tokenizer_table       != NULL && "Null parametr\n");
+	// Allocate name tokenizer_table for searching familiar names
+	NameTable *parser_table = NameTableCtor();
+
+	AddRuleNames(parser_tree->root, parser_table);
+
+	tab_incr();
+	SearchNamesInBranceParser(parser_tree->root, tokenizer_table, parser_table);
+	tab_decr();
+
+	return parser_table;
+}
+
+/// @returns   true if symbols of options are the same name with the same repetition.
+static bool SameSymbol(Node *first, Node *second)
+{
+	return SameTxt(first, second) &&
+		first->token->repeat == second->token->repeat && first->token->cut == second->token->cut;
+}
+
+/**
+ * @brief Checks that each option of each rule parses at least one token.
+ * Parser treats rule which parsed no tokens as failed one and FIRST sets
+ * don't know tokens after rule, so option which can be empty would lose input.
+ * Rule can be empty only if some rule has option of (symbol*) only: references
+ * to rules are empty only through such option.
+ *
+ * @param parser_table   Parser's table (before lists are folded).
+ * @returns              false if some option can match no tokens.
+ */
+static bool CheckEmptyOptions(NameTable *parser_table)
+{
+	assert(parser_table != NULL && "Null param");
+
+	bool ok = true;
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		Node *rule = parser_table->names[cur_rule];
+		Node *fork = GetChild(rule, 0);
+		for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+			Node *chain = GetChild(fork, cur_option);
+			bool  empty = true;
+			for (; chain != NULL && empty; chain = (chain->children != NULL)? GetChild(chain, 0) : NULL) {
+				empty = (chain->token->repeat == REPEAT_STAR);
+			}
+			if (empty) {
+				printf("Rule (%.*s) has option which can match no tokens: "
+					"option of only (symbol*) should have symbol which is parsed at least once\n",
+					NODE_TXT(rule));
+				ok = false;
+			}
+		}
+	}
+	return ok;
+}
+
+/**
+ * @brief Folds right-recursive lists: rule with options (P rule) and (Q),
+ * where Q is prefix of P, is repetition of P which can end after Q.
+ * Reference to the rule at the end of P becomes loop (REPEAT_TAIL), last
+ * symbol of Q in P is marked (list_end) and option Q is removed. So list is
+ * parsed without recursion and all it's elements are children of one node.
+ * Rule with cut isn't folded: it's recursive call can't end the list after cut.
+ *
+ * @param parser_table   Parser's table.
+ */
+static void FoldListRules(NameTable *parser_table)
+{
+	assert(parser_table != NULL && "Null param");
+
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		Node *rule = parser_table->names[cur_rule];
+		Node *fork = GetChild(rule, 0);
+		if (fork->children->size != 2) {
+			continue;
+		}
+
+		Node *tail         = GetChild(fork, 0);
+		Node *prefix       = GetChild(fork, 1);
+		Node *prefix_end   = NULL;
+		bool  is_prefix    = true;
+		//  Each repetition should parse at least one token,
+		// else loop never ends.
+		bool  has_required = false;
+		bool  has_cut      = false;
+		while (tail->children != NULL) {
+			if (prefix != NULL) {
+				is_prefix  = is_prefix && SameSymbol(tail, prefix);
+				prefix_end = tail;
+				prefix     = (prefix->children != NULL)? GetChild(prefix, 0) : NULL;
+			}
+			has_required |= (tail->token->repeat != REPEAT_STAR);
+			has_cut      |= tail->token->cut;
+			tail = GetChild(tail, 0);
+		}
+
+		if (!is_prefix || prefix != NULL || prefix_end == NULL || !has_required || has_cut ||
+				tail->token->parser_type != RULE_NAME_REFERENCE ||
+				tail->token->repeat != REPEAT_ONCE || !SameTxt(tail, rule)) {
+			continue;
+		}
+
+		msg(D_PARSER_GENERATING, M,
+			"Rule (%.*s) is list\n", NODE_TXT(rule));
+		tail->token->repeat = REPEAT_TAIL;
+		prefix_end->token->list_end = true;
+		fork->children->size = 1;
+	}
+}
+
+/**
+ * @brief Prints the whole parser's file.
+ * 
+ * @param parser_tree       AST tree of parser
+ * @param tokenizer_table   Tokenizer's table.
+ * @param parser_table      Parser's table.
+ * @param lib_header        Header of library.
+ * @param parser_c          Text of Parser_GEN.c.
+ * @param precedence        Precedence of operators.
+ * @param parallel          Parallel unit of grammar.
+ * @param options           Options of generator.
+ */
+static void GenerateParserFile
+	(Tree *parser_tree, NameTable *tokenizer_table, NameTable *parser_table, FILE *lib_header,
+	FILE *parser_c, const Precedence *precedence, const ParallelUnit *parallel, const GeneratorOptions *options)
+{
+	fprintf(parser_c,
+		"#include <../MchlkrpchLogger/logger.h>\n\n"
+		"#include <lib_GEN.h>\n\n"
+		);
+	if (parallel->unit_rule != kUndefinedIdx) {
+		// Workers of ParseSequenceParallel.
+		fprintf(parser_c,
+			"#include <pthread.h>\n\n");
+	}
+
+	// Print parser's state and common commands.
+	WriteParserState(lib_header, parser_c, tokenizer_table, parser_table, options);
+	if (options->profile) {
+		WriteProfile(lib_header, parser_c, parser_table);
+	}
+	WriteObviousCommands(lib_header, parser_c, tokenizer_table, options);
+	WriteParallelParse(lib_header, parser_c, parallel);
+	if (precedence->n_climbing > 0) {
+		fprintf(parser_c,
+			"typedef enum GEN_Assoc\n"
+			"{\n"
+			"\tGEN_ASSOC_LEFT,\n"
+			"\tGEN_ASSOC_RIGHT,\n"
+			"\tGEN_ASSOC_NONASSOC,\n"
+			"} GEN_Assoc;\n\n"
+
+			"// Operator of %%left, %%right or %%nonassoc: higher levels bind tighter.\n"
+			"typedef struct GEN_Operator\n"
+			"{\n"
+			"\tuint32_t  level;\n"
+			"\tGEN_Assoc assoc;\n"
+			"} GEN_Operator;\n\n");
+	}
+
+	// Add all parser's command to (parser_c)-file.
+	tab_incr();
+	FirstSets *first = FirstSetsCtor(tokenizer_table, parser_table);
+	GenerateCommands(lib_header, parser_c, parser_tree->root, first, precedence, options);
+	FirstSetsDtor(first);
+	tab_decr();
+}
+
+// Generation table parser file. -------------------------------------------------------
+
+/**
+ * @returns   Value of token (token_idx) of tokenizer's table in generated
+ * GEN_TokenType. Value 0 is (default_token) of unknown words.
+ */
+static uint64_t TokenColumn(NameTable *tokenizer_table, uint64_t token_idx)
+{
+	uint64_t column = 1;
+	for (uint64_t cur_el = 0; cur_el < token_idx; ++cur_el) {
+		column += !PhonyVariables(tokenizer_table, cur_el);
+	}
+	return column;
+}
+
+/**
+ * @brief Prints symbols of option (rule references and tokens)
+ * walking along it's chains. Symbol+ is printed as symbol and symbol*,
+ * reference at the end of list rule isn't printed: option is loop.
+ *
+ * @param parser_c       Parser's c file.
+ * @param parser_table   Parser's table.
+ * @param chain          First chain of option.
+ * @param list_end       Output: number of symbols after which list
+ * can end or 0 if option isn't loop of list rule.
+ * @param cut            Output: number of symbols after which failure
+ * fails the rule or 0 if option has no cut.
+ * @returns              Number of printed symbols.
+ */
+static uint64_t WriteOptionSymbols
+	(FILE *parser_c, NameTable *parser_table, Node *chain, uint64_t *list_end, uint64_t *cut)
+{
+	uint64_t n_symbols = 0;
+	*list_end = 0;
+	*cut      = 0;
+	for (; chain != NULL; chain = (chain->children != NULL)? GetChild(chain, 0) : NULL) {
+		SymbolRepeat repeat = chain->token->repeat;
+		if (repeat == REPEAT_TAIL) {
+			break;
+		}
+
+		for (int cur_copy = (repeat == REPEAT_PLUS)? 0 : 1; cur_copy < 2; ++cur_copy) {
+			const char *repeated = (cur_copy == 1 && repeat != REPEAT_ONCE)? "true" : "false";
+			int64_t rule_idx = kUndefinedIdx;
+			if (chain->token->parser_type == RULE_NAME_REFERENCE &&
+					(rule_idx = SearchInTable(chain, parser_table)) != kUndefinedIdx) {
+				fprintf(parser_c, "\t{true,  %ld, %s}, // %.*s\n", rule_idx, repeated, NODE_TXT(chain));
+			} else if (chain->token->parser_type == VAR_NAME_REFERENCE) {
+				fprintf(parser_c, "\t{false, %.*s, %s},\n", NODE_TXT(chain), repeated);
+			} else {
+				fprintf(parser_c, "\t{false, %s, %s},\n", TranslateTokenType(GetType(chain)), repeated);
+			}
+			++n_symbols;
+		}
+		if (chain->token->list_end) {
+			*list_end = n_symbols;
+		}
+		if (chain->token->cut && *cut == 0) {
+			*cut = n_symbols;
+		}
+	}
+	return n_symbols;
+}
+
+/**
+ * @brief Prints tables of rules: symbols of all options,
+ * options of all rules and list of rule's types.
+ */
+static void WriteRuleTables(FILE *parser_c, NameTable *parser_table)
+{
+	uint64_t *n_option_symbols = NULL;
+	uint64_t *list_ends        = NULL;
+	uint64_t *cuts             = NULL;
+	uint64_t  n_options = 0;
+
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		n_options += GetChild(parser_table->names[cur_rule], 0)->children->size;
+	}
+	n_option_symbols = (uint64_t *)calloc(n_options + 1, sizeof(uint64_t));
+	list_ends        = (uint64_t *)calloc(n_options + 1, sizeof(uint64_t));
+	cuts             = (uint64_t *)calloc(n_options + 1, sizeof(uint64_t));
+	assert(n_option_symbols != NULL && list_ends != NULL && cuts != NULL && "Null calloc allocation");
+
+	fprintf(parser_c,
+		"static const GEN_TableSymbol GEN_table_symbols[] =\n"
+		"{\n");
+	uint64_t cur_option_idx = 0;
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		Node *fork = GetChild(parser_table->names[cur_rule], 0);
+		for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+			fprintf(parser_c, "\t// %.*s_%lu\n", NODE_TXT(parser_table->names[cur_rule]), cur_option + 1);
+			n_option_symbols[cur_option_idx] =
+				WriteOptionSymbols(parser_c, parser_table, GetChild(fork, cur_option),
+					list_ends + cur_option_idx, cuts + cur_option_idx);
+			++cur_option_idx;
+		}
+	}
+	fprintf(parser_c, "};\n\n");
+
+	fprintf(parser_c,
+		"static const GEN_TableOption GEN_table_options[] =\n"
+		"{\n");
+	uint64_t symbol_idx = 0;
+	for (uint64_t cur_option = 0; cur_option < n_options; ++cur_option) {
+		fprintf(parser_c, "\t{%lu, %lu, %lu, %lu},\n",
+			symbol_idx, n_option_symbols[cur_option], list_ends[cur_option], cuts[cur_option]);
+		symbol_idx += n_option_symbols[cur_option];
+	}
+	fprintf(parser_c, "};\n\n");
+
+	fprintf(parser_c,
+		"static const GEN_TokenType GEN_table_rules[] =\n"
+		"{\n");
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		fprintf(parser_c, "\t%.*s,\n", NODE_TXT(parser_table->names[cur_rule]));
+	}
+	fprintf(parser_c, "};\n\n");
+
+	free(n_option_symbols);
+	free(list_ends);
+	free(cuts);
+}
+
+/**
+ * @brief Prints dispatch table: for each rule and token
+ * index of list of options (in GEN_table_viable) which can start
+ * with this token. Lists are in order of grammar and end with
+ * (kTableNoOption). Rule with one viable option is parsed LL(1)-like,
+ * other options are tried only if previous failed.
+ */
+static void WriteDispatchTables(FILE *parser_c, const FirstSets *first)
+{
+	NameTable *tokenizer_table = first->tokenizer_table;
+	NameTable *parser_table    = first->parser_table;
+	uint64_t   n_columns = TokenColumn(tokenizer_table, tokenizer_table->size);
+
+	uint64_t max_options = 0;
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		uint64_t rule_options = GetChild(parser_table->names[cur_rule], 0)->children->size;
+		max_options = (rule_options > max_options)? rule_options : max_options;
+	}
+
+	// Upper bound: every cell has it's own list.
+	uint64_t  max_viable = parser_table->size * n_columns * (max_options + 1);
+	uint32_t *viable     = (uint32_t *)calloc(max_viable, sizeof(uint32_t));
+	uint64_t *dispatch   = (uint64_t *)calloc(parser_table->size * n_columns, sizeof(uint64_t));
+	uint32_t *list       = (uint32_t *)calloc(max_options + 1, sizeof(uint32_t));
+	assert(viable   != NULL && "Null calloc allocation");
+	assert(dispatch != NULL && "Null calloc allocation");
+	assert(list     != NULL && "Null calloc allocation");
+
+	uint64_t n_viable = 0;
+	uint64_t option_base = 0;
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		Node *fork = GetChild(parser_table->names[cur_rule], 0);
+		uint64_t rule_viable = n_viable;
+
+		for (uint64_t cur_token = 0; cur_token <= tokenizer_table->size; ++cur_token) {
+			// Last pass is for (default_token) column.
+			bool is_default = (cur_token == tokenizer_table->size);
+			if (!is_default && PhonyVariables(tokenizer_table, cur_token)) {
+				continue;
+			}
+
+			uint64_t list_size = 0;
+			for (uint64_t cur_option = 0; cur_option < fork->children->size; ++cur_option) {
+				if (ChainCanStartWith(first, GetChild(fork, cur_option),
+						(is_default)? kUndefinedIdx : (int64_t)cur_token)) {
+					list[list_size++] = (uint32_t)(option_base + cur_option);
+				}
+			}
+			list[list_size++] = UINT32_MAX;
+
+			// Reuse equal list of this rule.
+			uint64_t list_idx = rule_viable;
+			while (list_idx < n_viable &&
+					memcmp(viable + list_idx, list, list_size * sizeof(uint32_t)) != 0) {
+				while (viable[list_idx++] != UINT32_MAX) {}
+			}
+			if (list_idx == n_viable) {
+				memcpy(viable + n_viable, list, list_size * sizeof(uint32_t));
+				n_viable += list_size;
+			}
+			dispatch[cur_rule * n_columns + ((is_default)? 0 : TokenColumn(tokenizer_table, cur_token))] = list_idx;
+		}
+		option_base += fork->children->size;
+	}
+
+	fprintf(parser_c,
+		"static const uint32_t GEN_table_viable[] =\n"
+		"{\n");
+	for (uint64_t cur_viable = 0; cur_viable < n_viable; ++cur_viable) {
+		bool is_list_start = (cur_viable == 0 || viable[cur_viable - 1] == UINT32_MAX);
+		if (viable[cur_viable] == UINT32_MAX) {
+			fprintf(parser_c, "%skTableNoOption,\n", (is_list_start)? "\t" : "");
+		} else {
+			fprintf(parser_c, "%s%u, ", (is_list_start)? "\t" : "", viable[cur_viable]);
+		}
+	}
+	fprintf(parser_c, "};\n\n");
+
+	fprintf(parser_c,
+		"static const uint64_t kTableNColumns = %lu;\n\n"
+		"static const uint32_t GEN_table_dispatch[][%lu] =\n"
+		"{\n",
+		n_columns, n_columns);
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		fprintf(parser_c, "\t// %.*s\n\t{", NODE_TXT(parser_table->names[cur_rule]));
+		for (uint64_t cur_column = 0; cur_column < n_columns; ++cur_column) {
+			fprintf(parser_c, "%s%lu", (cur_column == 0)? "" : ", ", dispatch[cur_rule * n_columns + cur_column]);
+		}
+		fprintf(parser_c, "},\n");
+	}
+	fprintf(parser_c, "};\n\n");
+
+	free(viable);
+	free(dispatch);
+	free(list);
+}
+
+/**
+ * @brief Prints non-recursive driver of table parser. Each frame on
+ * heap-allocated stack is one rule which is being parsed: current option,
+ * next symbol of option and mark of it's pending symbols. Failed option
+ * rolls back it's symbols and next viable option starts from the first
+ * token of rule. Built tree is the same as tree of recursive backend.
+ *
+ * @param parser_c   Parser's c file.
+ * @param options    Options of generator.
+ */
+static void WriteTableDriver(FILE *parser_c, const GeneratorOptions *options)
+{
+	fprintf(parser_c,
+		"typedef struct\n"
+		"{\n"
+		"\tuint32_t rule;\n"
+		"\t// Index of current option in GEN_table_viable.\n"
+		"\tuint32_t viable;\n"
+		"\t// Index of next symbol of current option.\n"
+		"\tuint32_t symbol;\n"
+		"\tuint64_t start_idx;\n"
+		"\tuint64_t cur_idx;\n"
+		"\tGEN_Mark mark;\n"
+		"\t// End of last complete element of list and it's pending symbols.\n"
+		"\tuint64_t end_idx;\n"
+		"\tGEN_Mark end_mark;\n"
+		"} GEN_TableFrame;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_TableFrame *frames;\n"
+		"\tuint64_t        size;\n"
+		"\tuint64_t        capacity;\n"
+		"} GEN_TableStack;\n\n"
+
+		"static void GEN_TableNextOption(GEN_Parser *p, GEN_TableFrame *frame)\n"
+		"{\n"
+		"\t++frame->viable;\n"
+		"\tframe->symbol   = 0;\n"
+		"\tframe->cur_idx  = frame->start_idx;\n"
+		"\tframe->end_idx  = frame->start_idx;\n"
+		"\tframe->end_mark = frame->mark;\n"
+		"\tGEN_ParserRollback(p, frame->mark);\n"
+		"}\n\n"
+
+		"// Option of list starts next element after it's last symbol.\n"
+		"static void GEN_TableNextSymbol(GEN_Parser *p, GEN_TableFrame *frame)\n"
+		"{\n"
+		"\tconst GEN_TableOption *option = GEN_table_options + GEN_table_viable[frame->viable];\n"
+		"\t++frame->symbol;\n"
+		"\tif (option->list_end == 0) {\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\tif (frame->symbol == option->list_end) {\n"
+		"\t\tframe->end_idx  = frame->cur_idx;\n"
+		"\t\tframe->end_mark = GEN_ParserMark(p);\n"
+		"\t\t// List isn't parsed again from it's start. Frame is the top one, so it's mark is.\n"
+		"\t\tGEN_LexerMoveMark(p->lexer, frame->cur_idx);\n"
+		"\t}\n"
+		"\tif (frame->symbol == option->n_symbols) {\n"
+		"\t\tframe->symbol = 0;\n"
+		"\t}\n"
+		"}\n\n"
+
+		"// Current symbol of frame is parsed up to (end_idx), symbol* stays current.\n"
+		"static void GEN_TableMatched(GEN_Parser *p, GEN_TableFrame *frame, uint64_t end_idx)\n"
+		"{\n"
+		"\tconst GEN_TableOption *option = GEN_table_options + GEN_table_viable[frame->viable];\n"
+		"\tframe->cur_idx = end_idx;\n"
+		"\tif (!GEN_table_symbols[option->first_symbol + frame->symbol].repeated) {\n"
+		"\t\tGEN_TableNextSymbol(p, frame);\n"
+		"\t} else if (option->list_end == 0 && frame->symbol + 1 == option->n_symbols) {\n"
+		"\t\t// Option ends with this symbol*, so it's applied already.\n"
+		"\t\tGEN_LexerMoveMark(p->lexer, end_idx);\n"
+		"\t}\n"
+		"}\n\n"
+
+		"// Current symbol of frame failed: symbol* ends, list is applied\n"
+		"// with it's complete elements, after cut rule fails, else next option is tried.\n"
+		"static void GEN_TableFailed(GEN_Parser *p, GEN_TableFrame *frame)\n"
+		"{\n"
+		"\tconst GEN_TableOption *option = GEN_table_options + GEN_table_viable[frame->viable];\n"
+		"\tif (GEN_table_symbols[option->first_symbol + frame->symbol].repeated) {\n"
+		"\t\tGEN_TableNextSymbol(p, frame);\n"
+		"\t} else if (frame->end_idx != frame->start_idx) {\n"
+		"\t\tGEN_ParserRollback(p, frame->end_mark);\n"
+		"\t\tframe->cur_idx = frame->end_idx;\n"
+		"\t\t// List never comes to the end of option by itself.\n"
+		"\t\tframe->symbol  = option->n_symbols;\n"
+		"\t} else if (option->cut != 0 && frame->symbol >= option->cut) {\n"
+		"\t\tGEN_ParserRollback(p, frame->mark);\n"
+		"\t\twhile (GEN_table_viable[frame->viable] != kTableNoOption) {\n"
+		"\t\t\t++frame->viable;\n"
+		"\t\t}\n"
+		"\t} else {\n"
+		"\t\tGEN_TableNextOption(p, frame);\n"
+		"\t}\n"
+		"}\n\n"
+
+		"// Tells caller if rule was applied. Result of rule is already pending.\n"
+		"static void GEN_TableReturn(GEN_Parser *p, GEN_TableStack *stack, bool applied, uint64_t end_idx)\n"
+		"{\n"
+		"\tif (stack->size == 0) {\n"
+		"\t\treturn;\n"
+		"\t}\n\n"
+
+		"\tGEN_TableFrame *caller = stack->frames + stack->size - 1;\n"
+		"\tif (applied) {\n"
+		"\t\tGEN_TableMatched(p, caller, end_idx);\n"
+		"\t} else {\n"
+		"\t\tGEN_TableFailed(p, caller);\n"
+		"\t}\n"
+		"}\n\n");
+
+	fprintf(parser_c,
+		"static void GEN_TableEnter(GEN_Parser *p, GEN_TableStack *stack, uint32_t rule, uint64_t token_idx)\n"
+		"{\n");
+	WriteTrace(parser_c, options,
+		"\tmsg(D_PARSER_WORK, M, \"Enter %%s at token %%lu\\n\", GEN_TranslateTokenType(GEN_table_rules[rule]), token_idx);\n");
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\tGEN_MemoEntry *memo = GEN_MemoLookup(p, GEN_table_rules[rule], token_idx);\n"
+			"\tif (memo != NULL) {\n"
+			"\t\tGEN_Context ctx = {0, token_idx};\n"
+			"\t\tGEN_TableReturn(p, stack, memo->applied, GEN_MemoReplay(p, memo, ctx).cur_token_idx);\n"
+			"\t\treturn;\n"
+			"\t}\n\n");
+	}
+	fprintf(parser_c,
+		"\tif (p->reuse != NULL) {\n"
+		"\t\tGEN_Node *reused = GEN_ReuseLookup(p, GEN_table_rules[rule], token_idx);\n"
+		"\t\tif (reused != NULL) {\n"
+		"\t\t\tGEN_Context ctx = {0, token_idx};\n"
+		"\t\t\tGEN_TableReturn(p, stack, true, GEN_ReuseReplay(p, reused, ctx).cur_token_idx);\n"
+		"\t\t\treturn;\n"
+		"\t\t}\n"
+		"\t}\n\n"
+
+		"\tGEN_Mark mark = GEN_RuleMark(p, token_idx);\n"
+		"\tGEN_LexerSeek(p->lexer, token_idx);\n"
+		"\tGEN_TokenType type = GEN_PeekToken(p->lexer, 0)->type;\n"
+		"\tassert((uint64_t)type < kTableNColumns && \"Lexer returned not a token\");\n\n"
+
+		"\tuint32_t viable = GEN_table_dispatch[rule][type];\n"
+		"\tif (GEN_table_viable[viable] == kTableNoOption) {\n");
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\t\tGEN_Context ctx = {0, token_idx};\n"
+			"\t\tGEN_MemoStore(p, GEN_table_rules[rule], ctx, ctx, NULL);\n");
+	}
+	fprintf(parser_c,
+		"\t\tGEN_RuleLeave(p, mark);\n"
+		"\t\tGEN_TableReturn(p, stack, false, token_idx);\n"
+		"\t\treturn;\n"
+		"\t}\n\n"
+
+		"\tif (stack->size == stack->capacity) {\n"
+		"\t\tstack->capacity <<= 1;\n"
+		"\t\tstack->frames = (GEN_TableFrame *)realloc(stack->frames, stack->capacity * sizeof(GEN_TableFrame));\n"
+		"\t\tassert(stack->frames != NULL && \"Null realloc allocation\");\n"
+		"\t}\n"
+		"\tGEN_TableFrame *frame = stack->frames + stack->size++;\n"
+		"\tframe->rule      = rule;\n"
+		"\tframe->viable    = viable;\n"
+		"\tframe->symbol    = 0;\n"
+		"\tframe->start_idx = token_idx;\n"
+		"\tframe->cur_idx   = token_idx;\n"
+		"\tframe->mark      = mark;\n"
+		"\tframe->end_idx   = token_idx;\n"
+		"\tframe->end_mark  = mark;\n"
+		"\t// Options are tried from here so lexer keeps this token.\n"
+		"\tGEN_LexerPushMark(p->lexer, token_idx);\n"
+		"}\n\n"
+
+		"static void GEN_TableLeave(GEN_Parser *p, GEN_TableStack *stack, bool applied)\n"
+		"{\n"
+		"\tGEN_TableFrame frame = stack->frames[--stack->size];\n"
+		"\tGEN_LexerPopMark(p->lexer);\n");
+	if (options->packrat) {
+		fprintf(parser_c,
+			"\tGEN_Context ctx     = {0, frame.start_idx};\n"
+			"\tGEN_Context new_ctx = {0, (applied)? frame.cur_idx : frame.start_idx};\n"
+			"\tif (applied) {\n"
+			"\t\tGEN_Event result = GEN_CommitRule(p, GEN_table_rules[frame.rule], frame.mark);\n"
+			"\t\tGEN_MemoStore(p, GEN_table_rules[frame.rule], ctx, new_ctx, &result);\n"
+			"\t} else {\n"
+			"\t\tGEN_MemoStore(p, GEN_table_rules[frame.rule], ctx, new_ctx, NULL);\n"
+			"\t}\n");
+	} else {
+		fprintf(parser_c,
+			"\tif (applied) {\n"
+			"\t\tGEN_CommitRule(p, GEN_table_rules[frame.rule], frame.mark);\n"
+			"\t}\n");
+	}
+	fprintf(parser_c,
+		"\tGEN_RuleLeave(p, frame.mark);\n");
+	WriteTrace(parser_c, options,
+		"\tmsg(D_PARSER_WORK, M, \"Leave %%s: %%s\\n\", GEN_TranslateTokenType(GEN_table_rules[frame.rule]), (applied)? \"applied\" : \"failed\");\n");
+	fprintf(parser_c,
+		"\tGEN_TableReturn(p, stack, applied, frame.cur_idx);\n"
+		"}\n\n"
+
+		"GEN_Tree *GEN_RunParser(GEN_Tree *t, GEN_Parser *p, GEN_Context ctx)\n"
+		"{\n"
+		"\tassert(t != NULL && \"Null param\");\n"
+		"\tassert(p != NULL && \"Null param\");\n\n"
+
+		"\tp->tree = t;\n"
+		"\tGEN_TableStack stack = {NULL, 0, kMaxScopeDepth};\n"
+		"\tstack.frames = (GEN_TableFrame *)calloc(stack.capacity, sizeof(GEN_TableFrame));\n"
+		"\tassert(stack.frames != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tGEN_TableEnter(p, &stack, kTableStartRule, ctx.cur_token_idx);\n"
+		"\twhile (stack.size > 0) {\n"
+		"\t\tGEN_TableFrame *frame = stack.frames + stack.size - 1;\n"
+		"\t\tuint32_t option = GEN_table_viable[frame->viable];\n"
+		"\t\tif (option == kTableNoOption) {\n"
+		"\t\t\tGEN_TableLeave(p, &stack, false);\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n\n"
+
+		"\t\tconst GEN_TableOption *cur_option = GEN_table_options + option;\n"
+		"\t\tif (frame->symbol == cur_option->n_symbols) {\n"
+		"\t\t\tGEN_TableLeave(p, &stack, true);\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n\n"
+
+		"\t\tGEN_TableSymbol symbol = GEN_table_symbols[cur_option->first_symbol + frame->symbol];\n"
+		"\t\tif (symbol.is_rule) {\n"
+		"\t\t\t// Stack can be moved: (frame) isn't used after.\n"
+		"\t\t\tGEN_TableEnter(p, &stack, symbol.id, frame->cur_idx);\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n\n"
+
+		"\t\tGEN_LexerSeek(p->lexer, frame->cur_idx);\n"
+		"\t\tGEN_Token *token = GEN_PeekToken(p->lexer, 0);\n"
+		"\t\tif (frame->cur_idx >= p->peek_end) {\n"
+		"\t\t\tp->peek_end = frame->cur_idx + 1;\n"
+		"\t\t}\n"
+		"\t\tif (token->type == (GEN_TokenType)symbol.id) {\n"
+		"\t\t\tGEN_PushToken(p, token);\n"
+		"\t\t\tGEN_TableMatched(p, frame, frame->cur_idx + 1);\n"
+		"\t\t} else {\n"
+		"\t\t\tGEN_TableFailed(p, frame);\n"
+		"\t\t}\n"
+		"\t}\n\n"
+
+		"\tfree(stack.frames);\n"
+		"\tGEN_ParserFinish(p);\n"
+		"\treturn t;\n"
+		"}\n\n");
+}
+
+/**
+ * @brief Prints the whole parser's file of table backend:
+ * tables of rules, dispatch tables and driver.
+ *
+ * @param tokenizer_table   Tokenizer's table.
+ * @param parser_table      Parser's table.
+ * @param lib_header        Header of library.
+ * @param parser_c          Text of Parser_GEN.c.
+ * @param parallel          Parallel unit of grammar.
+ * @param options           Options of generator.
+ */
+static void GenerateTableParserFile
+	(NameTable *tokenizer_table, NameTable *parser_table, FILE *lib_header,
+	FILE *parser_c, const ParallelUnit *parallel, const GeneratorOptions *options)
+{
+	fprintf(parser_c,
+		"#include <../MchlkrpchLogger/logger.h>\n\n"
+		"#include <lib_GEN.h>\n\n"
+		);
+	if (parallel->unit_rule != kUndefinedIdx) {
+		// Workers of ParseSequenceParallel.
+		fprintf(parser_c,
+			"#include <pthread.h>\n\n");
+	}
+
+	int64_t start_rule = kUndefinedIdx;
+	int64_t start      = FindName(tokenizer_table, "start");
+	if (start != kUndefinedIdx) {
+		start_rule = SearchInTable(VariableValue(tokenizer_table->names[start]), parser_table);
+	}
+	assert(start_rule != kUndefinedIdx && "Grammar without %start rule");
+
+	WriteParserState(lib_header, parser_c, tokenizer_table, parser_table, options);
+
+	fprintf(parser_c,
+		"static const uint32_t kTableNoOption  = UINT32_MAX;\n"
+		"static const uint32_t kTableStartRule = %ld;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\t// Symbol is rule (id is index of rule) or token (id is GEN_TokenType).\n"
+		"\tbool     is_rule;\n"
+		"\tuint32_t id;\n"
+		"\t// Symbol is repeated zero or more times (symbol*).\n"
+		"\tbool     repeated;\n"
+		"} GEN_TableSymbol;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tuint32_t first_symbol;\n"
+		"\tuint32_t n_symbols;\n"
+		"\t// Option of list rule is repeated, list can end after (list_end) symbols\n"
+		"\t// of any repetition. 0 if option isn't list.\n"
+		"\tuint32_t list_end;\n"
+		"\t// Failure after (cut) symbols fails the rule. 0 if option has no cut.\n"
+		"\tuint32_t cut;\n"
+		"} GEN_TableOption;\n\n",
+		start_rule);
+
+	FirstSets *first = FirstSetsCtor(tokenizer_table, parser_table);
+	WriteRuleTables(parser_c, parser_table);
+	WriteDispatchTables(parser_c, first);
+	FirstSetsDtor(first);
+
+	WriteTableDriver(parser_c, options);
+	WriteObviousCommands(lib_header, parser_c, tokenizer_table, options);
+	WriteParallelParse(lib_header, parser_c, parallel);
+}
+
+/**
+ * @brief Prints flat tree: nodes are stored in preorder in parallel arrays
+ * and linked by 32-bit indices (first child, next sibling, parent).
+ * Subtree of node (i) is range [i, GEN_FlatSubtreeEnd(i)), so any walk
+ * over tree is sequential pass over arrays.
+ *
+ * @param lib_header   Header file of library.
+ * @param c_file       Tree's c file.
+ */
+static void WriteFlatTree(FILE *lib_header, FILE *c_file)
+{
+	fprintf(lib_header,
+		"static const uint32_t kFlatNoNode       = UINT32_MAX;\n"
+		"static const uint32_t kInitFlatTreeSize = 1024;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tuint32_t        size;\n"
+		"\tuint32_t        capacity;\n"
+		"\tGEN_TokenType  *types;\n"
+		"\t// Text of token or name of rule (not null-terminated).\n"
+		"\tconst char    **txts;\n"
+		"\tuint32_t       *lens;\n"
+		"\tuint32_t       *parents;\n"
+		"\tuint32_t       *first_children;\n"
+		"\tuint32_t       *next_siblings;\n"
+		"} GEN_FlatTree;\n\n"
+
+		"// Adds nodes to flat tree in preorder.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_FlatTree *tree;\n"
+		"\t// Nodes which children are being added and their last children.\n"
+		"\tuint32_t     *open;\n"
+		"\tuint32_t     *last_children;\n"
+		"\tuint32_t      depth;\n"
+		"\tuint32_t      capacity;\n"
+		"} GEN_FlatBuilder;\n\n"
+
+		"GEN_FlatTree *GEN_FlatTreeCtor();\n"
+		"void GEN_FlatTreeDtor(GEN_FlatTree *ft);\n"
+		"void GEN_FlatBuilderCtor(GEN_FlatBuilder *b, GEN_FlatTree *ft);\n"
+		"void GEN_FlatBuilderDtor(GEN_FlatBuilder *b);\n"
+		"uint32_t GEN_FlatOpen(GEN_FlatBuilder *b, GEN_TokenType type, const char *txt, uint64_t len);\n"
+		"void GEN_FlatClose(GEN_FlatBuilder *b);\n"
+		"void GEN_FlatEnter(void *builder, GEN_TokenType rule);\n"
+		"void GEN_FlatLeave(void *builder, GEN_TokenType rule);\n"
+		"void GEN_FlatToken(void *builder, const GEN_Token *token);\n"
+		"GEN_FlatTree *GEN_FlattenTree(const GEN_Tree *t);\n"
+		"uint32_t GEN_FlatSubtreeEnd(const GEN_FlatTree *ft, uint32_t node);\n\n"
+
+		"static inline uint32_t GEN_FlatFirstChild(const GEN_FlatTree *ft, uint32_t node)\n"
+		"{ return ft->first_children[node]; }\n\n"
+
+		"static inline uint32_t GEN_FlatNextSibling(const GEN_FlatTree *ft, uint32_t node)\n"
+		"{ return ft->next_siblings[node]; }\n\n"
+
+		"static inline uint32_t GEN_FlatParent(const GEN_FlatTree *ft, uint32_t node)\n"
+		"{ return ft->parents[node]; }\n\n");
+
+	fprintf(c_file,
+		"\n"
+		"GEN_FlatTree *GEN_FlatTreeCtor()\n"
+		"{\n"
+		"\tGEN_FlatTree *ft = (GEN_FlatTree *)calloc(1, sizeof(GEN_FlatTree));\n"
+		"\tassert(ft != NULL && \"Null calloc allocation\");\n"
+		"\treturn ft;\n"
+		"}\n\n"
+
+		"void GEN_FlatTreeDtor(GEN_FlatTree *ft)\n"
+		"{\n"
+		"\tassert(ft != NULL && \"Null param\");\n"
+		"\tfree(ft->types);\n"
+		"\tfree(ft->txts);\n"
+		"\tfree(ft->lens);\n"
+		"\tfree(ft->parents);\n"
+		"\tfree(ft->first_children);\n"
+		"\tfree(ft->next_siblings);\n"
+		"\tfree(ft);\n"
+		"}\n\n"
+
+		"static void GEN_FlatTreeGrow(GEN_FlatTree *ft)\n"
+		"{\n"
+		"\tassert(ft->capacity < kFlatNoNode / 2 && \"Too many nodes for flat tree\");\n"
+		"\tft->capacity       = (ft->capacity == 0)? kInitFlatTreeSize : ft->capacity << 1;\n"
+		"\tft->types          = (GEN_TokenType *)realloc(ft->types, ft->capacity * sizeof(GEN_TokenType));\n"
+		"\tft->txts           = (const char **)realloc(ft->txts, ft->capacity * sizeof(const char *));\n"
+		"\tft->lens           = (uint32_t *)realloc(ft->lens, ft->capacity * sizeof(uint32_t));\n"
+		"\tft->parents        = (uint32_t *)realloc(ft->parents, ft->capacity * sizeof(uint32_t));\n"
+		"\tft->first_children = (uint32_t *)realloc(ft->first_children, ft->capacity * sizeof(uint32_t));\n"
+		"\tft->next_siblings  = (uint32_t *)realloc(ft->next_siblings, ft->capacity * sizeof(uint32_t));\n"
+		"\tassert(ft->types != NULL && ft->txts != NULL && ft->lens != NULL && \"Null realloc allocation\");\n"
+		"\tassert(ft->parents != NULL && ft->first_children != NULL && ft->next_siblings != NULL && \"Null realloc allocation\");\n"
+		"}\n\n"
+
+		"void GEN_FlatBuilderCtor(GEN_FlatBuilder *b, GEN_FlatTree *ft)\n"
+		"{\n"
+		"\tassert(b  != NULL && \"Null param\");\n"
+		"\tassert(ft != NULL && \"Null param\");\n"
+		"\tb->tree          = ft;\n"
+		"\tb->depth         = 0;\n"
+		"\tb->capacity      = kMaxScopeDepth;\n"
+		"\tb->open          = (uint32_t *)calloc(b->capacity, sizeof(uint32_t));\n"
+		"\tb->last_children = (uint32_t *)calloc(b->capacity, sizeof(uint32_t));\n"
+		"\tassert(b->open != NULL && b->last_children != NULL && \"Null calloc allocation\");\n"
+		"}\n\n"
+
+		"void GEN_FlatBuilderDtor(GEN_FlatBuilder *b)\n"
+		"{\n"
+		"\tassert(b != NULL && \"Null param\");\n"
+		"\tfree(b->open);\n"
+		"\tfree(b->last_children);\n"
+		"}\n\n"
+
+		"// Adds node as the last child of current open node and opens it.\n"
+		"uint32_t GEN_FlatOpen(GEN_FlatBuilder *b, GEN_TokenType type, const char *txt, uint64_t len)\n"
+		"{\n"
+		"\tGEN_FlatTree *ft = b->tree;\n"
+		"\tif (ft->size == ft->capacity) {\n"
+		"\t\tGEN_FlatTreeGrow(ft);\n"
+		"\t}\n"
+		"\tuint32_t node   = ft->size++;\n"
+		"\tuint32_t parent = (b->depth > 0)? b->open[b->depth - 1] : kFlatNoNode;\n"
+		"\tft->types[node]          = type;\n"
+		"\tft->txts[node]           = txt;\n"
+		"\tft->lens[node]           = (uint32_t)len;\n"
+		"\tft->parents[node]        = parent;\n"
+		"\tft->first_children[node] = kFlatNoNode;\n"
+		"\tft->next_siblings[node]  = kFlatNoNode;\n"
+		"\tif (b->depth > 0) {\n"
+		"\t\tuint32_t *last_child = b->last_children + b->depth - 1;\n"
+		"\t\tif (*last_child == kFlatNoNode) {\n"
+		"\t\t\tft->first_children[parent] = node;\n"
+		"\t\t} else {\n"
+		"\t\t\tft->next_siblings[*last_child] = node;\n"
+		"\t\t}\n"
+		"\t\t*last_child = node;\n"
+		"\t}\n\n"
+
+		"\tif (b->depth == b->capacity) {\n"
+		"\t\tb->capacity <<= 1;\n"
+		"\t\tb->open          = (uint32_t *)realloc(b->open, b->capacity * sizeof(uint32_t));\n"
+		"\t\tb->last_children = (uint32_t *)realloc(b->last_children, b->capacity * sizeof(uint32_t));\n"
+		"\t\tassert(b->open != NULL && b->last_children != NULL && \"Null realloc allocation\");\n"
+		"\t}\n"
+		"\tb->open[b->depth]          = node;\n"
+		"\tb->last_children[b->depth] = kFlatNoNode;\n"
+		"\t++b->depth;\n"
+		"\treturn node;\n"
+		"}\n\n"
+
+		"void GEN_FlatClose(GEN_FlatBuilder *b)\n"
+		"{\n"
+		"\tassert(b->depth > 0 && \"No open node\");\n"
+		"\t--b->depth;\n"
+		"}\n\n");
+
+	fprintf(c_file,
+		"// Callbacks of GEN_Handler: parser builds flat tree without GEN_Node's.\n"
+		"void GEN_FlatEnter(void *builder, GEN_TokenType rule)\n"
+		"{\n"
+		"\tconst char *name = GEN_TranslateTokenType(rule);\n"
+		"\tGEN_FlatOpen((GEN_FlatBuilder *)builder, rule, name, strlen(name));\n"
+		"}\n\n"
+
+		"void GEN_FlatLeave(void *builder, GEN_TokenType rule)\n"
+		"{\n"
+		"\t(void)rule;\n"
+		"\tGEN_FlatClose((GEN_FlatBuilder *)builder);\n"
+		"}\n\n"
+
+		"void GEN_FlatToken(void *builder, const GEN_Token *token)\n"
+		"{\n"
+		"\tGEN_FlatOpen((GEN_FlatBuilder *)builder, token->type, token->txt, token->len);\n"
+		"\tGEN_FlatClose((GEN_FlatBuilder *)builder);\n"
+		"}\n\n"
+
+		"GEN_FlatTree *GEN_FlattenTree(const GEN_Tree *t)\n"
+		"{\n"
+		"\tassert(t != NULL && \"Null param\");\n"
+		"\tGEN_FlatTree   *ft = GEN_FlatTreeCtor();\n"
+		"\tGEN_FlatBuilder b  = {0};\n"
+		"\tGEN_FlatBuilderCtor(&b, ft);\n"
+		"\tif (t->root == NULL) {\n"
+		"\t\tGEN_FlatBuilderDtor(&b);\n"
+		"\t\treturn ft;\n"
+		"\t}\n\n"
+
+		"\t// Explicit stack of (node, index of next child): deep trees don't overflow C stack.\n"
+		"\tuint64_t   capacity = kMaxScopeDepth;\n"
+		"\tuint64_t   depth    = 0;\n"
+		"\tGEN_Node **nodes    = (GEN_Node **)calloc(capacity, sizeof(GEN_Node*));\n"
+		"\tuint64_t  *next     = (uint64_t *)calloc(capacity, sizeof(uint64_t));\n"
+		"\tassert(nodes != NULL && next != NULL && \"Null calloc allocation\");\n\n"
+
+		"\tnodes[depth] = t->root;\n"
+		"\tnext[depth++] = 0;\n"
+		"\tGEN_FlatOpen(&b, t->root->token.type, t->root->token.txt, t->root->token.len);\n"
+		"\twhile (depth > 0) {\n"
+		"\t\tGEN_Node *n = nodes[depth - 1];\n"
+		"\t\tif (n->children == NULL || next[depth - 1] == n->children->size) {\n"
+		"\t\t\tGEN_FlatClose(&b);\n"
+		"\t\t\t--depth;\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tGEN_Node *child = GEN_GetChild(n, next[depth - 1]++);\n"
+		"\t\tGEN_FlatOpen(&b, child->token.type, child->token.txt, child->token.len);\n"
+		"\t\tif (depth == capacity) {\n"
+		"\t\t\tcapacity <<= 1;\n"
+		"\t\t\tnodes = (GEN_Node **)realloc(nodes, capacity * sizeof(GEN_Node*));\n"
+		"\t\t\tnext  = (uint64_t *)realloc(next, capacity * sizeof(uint64_t));\n"
+		"\t\t\tassert(nodes != NULL && next != NULL && \"Null realloc allocation\");\n"
+		"\t\t}\n"
+		"\t\tnodes[depth] = child;\n"
+		"\t\tnext[depth++] = 0;\n"
+		"\t}\n\n"
+
+		"\tfree(nodes);\n"
+		"\tfree(next);\n"
+		"\tGEN_FlatBuilderDtor(&b);\n"
+		"\treturn ft;\n"
+		"}\n\n"
+
+		"// Index after the last node of subtree (node).\n"
+		"uint32_t GEN_FlatSubtreeEnd(const GEN_FlatTree *ft, uint32_t node)\n"
+		"{\n"
+		"\twhile (node != kFlatNoNode) {\n"
+		"\t\tif (ft->next_siblings[node] != kFlatNoNode) {\n"
+		"\t\t\treturn ft->next_siblings[node];\n"
+		"\t\t}\n"
+		"\t\tnode = ft->parents[node];\n"
+		"\t}\n"
+		"\treturn ft->size;\n"
+		"}\n");
+}
+
+/**
+ * @brief Prints binary format of flat tree and it's loader.
+ * File is header, table of nodes, table of tokens and pool of texts, all the
+ * tables are aligned to 8 bytes. GEN_MapTree maps file read-only and reads
+ * nodes right from it, nothing is deserialized.
+ *
+ * @param lib_header   Header file of library.
+ * @param c_file       Tree's c file.
+ */
+static void WriteTreeSerialization(FILE *lib_header, FILE *c_file)
+{
+	fprintf(lib_header,
+		"static const char     kBinTreeMagic[4]  = {'R', 'B', 'C', 'T'};\n"
+		"static const uint32_t kBinTreeVersion   = 1;\n"
+		"static const uint32_t kBinTreeByteOrder = 0x01020304;\n"
+		"// Source offset of token which isn't a part of source (names of rules).\n"
+		"static const uint64_t kBinNoSource      = UINT64_MAX;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tchar     magic[4];\n"
+		"\tuint32_t version;\n"
+		"\tuint32_t byte_order;\n"
+		"\tuint32_t n_nodes;\n"
+		"\tuint64_t nodes_offset;\n"
+		"\tuint64_t tokens_offset;\n"
+		"\tuint64_t pool_offset;\n"
+		"\tuint64_t pool_size;\n"
+		"} GEN_BinHeader;\n\n"
+
+		"// Node (i) of file has token (i). Links are indices of nodes or kFlatNoNode.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tuint32_t type;\n"
+		"\tuint32_t parent;\n"
+		"\tuint32_t first_child;\n"
+		"\tuint32_t next_sibling;\n"
+		"} GEN_BinNode;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tuint64_t source_offset;\n"
+		"\tuint32_t pool_offset;\n"
+		"\tuint32_t len;\n"
+		"} GEN_BinToken;\n\n"
+
+		"// Read-only view of mapped file.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tvoid               *data;\n"
+		"\tuint64_t            size;\n"
+		"\tuint32_t            n_nodes;\n"
+		"\tconst GEN_BinNode  *nodes;\n"
+		"\tconst GEN_BinToken *tokens;\n"
+		"\tconst char         *pool;\n"
+		"} GEN_MappedTree;\n\n"
+
+		"bool GEN_WriteTree(const GEN_FlatTree *ft, const char *source, uint64_t source_len, const char *file_name);\n"
+		"GEN_MappedTree *GEN_MapTree(const char *file_name);\n"
+		"void GEN_UnmapTree(GEN_MappedTree *mt);\n\n"
+
+		"static inline const char *GEN_MappedTxt(const GEN_MappedTree *mt, uint32_t node)\n"
+		"{ return mt->pool + mt->tokens[node].pool_offset; }\n\n");
+
+	fprintf(c_file,
+		"\n"
+		"static uint64_t GEN_BinAlign(uint64_t offset)\n"
+		"{ return (offset + 7) & ~(uint64_t)7; }\n\n"
+
+		"/*\n"
+		" * Texts inside of (source) of (source_len) bytes are written with their offsets in it,\n"
+		" * (source) can be NULL. Returns false if file can't be written.\n"
+		" */\n"
+		"bool GEN_WriteTree(const GEN_FlatTree *ft, const char *source, uint64_t source_len, const char *file_name)\n"
+		"{\n"
+		"\tassert(ft        != NULL && \"Null param\");\n"
+		"\tassert(file_name != NULL && \"Null param\");\n\n"
+
+		"\tuint64_t pool_size = 0;\n"
+		"\tfor (uint32_t cur_node = 0; cur_node < ft->size; ++cur_node) {\n"
+		"\t\tpool_size += ft->lens[cur_node];\n"
+		"\t}\n"
+		"\tif (pool_size > UINT32_MAX) {\n"
+		"\t\treturn false;\n"
+		"\t}\n"
+		"\tuint64_t source_size = (source != NULL)? source_len : 0;\n\n"
+
+		"\tGEN_BinHeader header = {{0}, kBinTreeVersion, kBinTreeByteOrder, ft->size, 0, 0, 0, pool_size};\n"
+		"\tmemcpy(header.magic, kBinTreeMagic, sizeof(kBinTreeMagic));\n"
+		"\t// Header, nodes and tokens are multiples of 8 bytes: tables are written without padding.\n"
+		"\theader.nodes_offset  = GEN_BinAlign(sizeof(GEN_BinHeader));\n"
+		"\theader.tokens_offset = GEN_BinAlign(header.nodes_offset + (uint64_t)ft->size * sizeof(GEN_BinNode));\n"
+		"\theader.pool_offset   = GEN_BinAlign(header.tokens_offset + (uint64_t)ft->size * sizeof(GEN_BinToken));\n\n"
+
+		"\tFILE *f = fopen(file_name, \"wb\");\n"
+		"\tif (f == NULL) {\n"
+		"\t\treturn false;\n"
+		"\t}\n"
+		"\tbool ok = (fwrite(&header, sizeof(header), 1, f) == 1);\n"
+		"\tfor (uint32_t cur_node = 0; ok && cur_node < ft->size; ++cur_node) {\n"
+		"\t\tGEN_BinNode node = {(uint32_t)ft->types[cur_node], ft->parents[cur_node],\n"
+		"\t\t\tft->first_children[cur_node], ft->next_siblings[cur_node]};\n"
+		"\t\tok = (fwrite(&node, sizeof(node), 1, f) == 1);\n"
+		"\t}\n"
+		"\tuint32_t pool_offset = 0;\n"
+		"\tfor (uint32_t cur_node = 0; ok && cur_node < ft->size; ++cur_node) {\n"
+		"\t\tconst char  *txt    = ft->txts[cur_node];\n"
+		"\t\tbool         in_src = (source != NULL && txt >= source && txt + ft->lens[cur_node] <= source + source_size);\n"
+		"\t\tGEN_BinToken token = {(in_src)? (uint64_t)(txt - source) : kBinNoSource, pool_offset, ft->lens[cur_node]};\n"
+		"\t\tpool_offset += ft->lens[cur_node];\n"
+		"\t\tok = (fwrite(&token, sizeof(token), 1, f) == 1);\n"
+		"\t}\n"
+		"\tfor (uint32_t cur_node = 0; ok && cur_node < ft->size; ++cur_node) {\n"
+		"\t\tok = (fwrite(ft->txts[cur_node], sizeof(char), ft->lens[cur_node], f) == ft->lens[cur_node]);\n"
+		"\t}\n"
+		"\treturn (fclose(f) == 0) && ok;\n"
+		"}\n\n");
+
+	fprintf(c_file,
+		"/*\n"
+		" * Checks header and bounds of tables, then links of nodes and texts of tokens in one pass:\n"
+		" * children and siblings of node are after it, parent is before it, texts are inside of pool.\n"
+		" * So walks over mapped tree always end inside of it.\n"
+		" */\n"
+		"static bool GEN_CheckMappedTree(const GEN_MappedTree *mt, uint64_t pool_size)\n"
+		"{\n"
+		"\tfor (uint32_t cur_node = 0; cur_node < mt->n_nodes; ++cur_node) {\n"
+		"\t\tconst GEN_BinNode *node = &mt->nodes[cur_node];\n"
+		"\t\tif (node->parent != kFlatNoNode && node->parent >= cur_node) {\n"
+		"\t\t\treturn false;\n"
+		"\t\t}\n"
+		"\t\tif (node->first_child != kFlatNoNode && (node->first_child <= cur_node || node->first_child >= mt->n_nodes ||\n"
+		"\t\t\t\tmt->nodes[node->first_child].parent != cur_node)) {\n"
+		"\t\t\treturn false;\n"
+		"\t\t}\n"
+		"\t\tif (node->next_sibling != kFlatNoNode && (node->next_sibling <= cur_node || node->next_sibling >= mt->n_nodes ||\n"
+		"\t\t\t\tmt->nodes[node->next_sibling].parent != node->parent)) {\n"
+		"\t\t\treturn false;\n"
+		"\t\t}\n"
+		"\t\tif ((uint64_t)mt->tokens[cur_node].pool_offset + mt->tokens[cur_node].len > pool_size) {\n"
+		"\t\t\treturn false;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\treturn true;\n"
+		"}\n\n");
+
+	fprintf(c_file,
+		"/*\n"
+		" * Returns NULL if file can't be mapped, isn't a tree of this version\n"
+		" * or it's tables are out of file or inconsistent (truncated or corrupt file).\n"
+		" */\n"
+		"GEN_MappedTree *GEN_MapTree(const char *file_name)\n"
+		"{\n"
+		"\tassert(file_name != NULL && \"Null param\");\n"
+		"\tint fd = open(file_name, O_RDONLY);\n"
+		"\tif (fd < 0) {\n"
+		"\t\treturn NULL;\n"
+		"\t}\n"
+		"\tstruct stat st = {0};\n"
+		"\tif (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(GEN_BinHeader)) {\n"
+		"\t\tclose(fd);\n"
+		"\t\treturn NULL;\n"
+		"\t}\n"
+		"\tuint64_t size = (uint64_t)st.st_size;\n"
+		"\tvoid    *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);\n"
+		"\tclose(fd);\n"
+		"\tif (data == MAP_FAILED) {\n"
+		"\t\treturn NULL;\n"
+		"\t}\n\n"
+
+		"\tconst GEN_BinHeader *header = (const GEN_BinHeader *)data;\n"
+		"\tuint64_t n_nodes = header->n_nodes;\n"
+		"\tif (memcmp(header->magic, kBinTreeMagic, sizeof(kBinTreeMagic)) != 0 ||\n"
+		"\t\t\theader->version != kBinTreeVersion || header->byte_order != kBinTreeByteOrder ||\n"
+		"\t\t\t// Offsets are compared with size before they are added: sums don't overflow.\n"
+		"\t\t\theader->nodes_offset  %% 8 != 0 || header->nodes_offset  > size ||\n"
+		"\t\t\tn_nodes * sizeof(GEN_BinNode)  > size - header->nodes_offset ||\n"
+		"\t\t\theader->tokens_offset %% 8 != 0 || header->tokens_offset > size ||\n"
+		"\t\t\tn_nodes * sizeof(GEN_BinToken) > size - header->tokens_offset ||\n"
+		"\t\t\theader->pool_offset > size || header->pool_size > size - header->pool_offset) {\n"
+		"\t\tmunmap(data, size);\n"
+		"\t\treturn NULL;\n"
+		"\t}\n\n"
+
+		"\tGEN_MappedTree *mt = (GEN_MappedTree *)calloc(1, sizeof(GEN_MappedTree));\n"
+		"\tassert(mt != NULL && \"Null calloc allocation\");\n"
+		"\tmt->data    = data;\n"
+		"\tmt->size    = size;\n"
+		"\tmt->n_nodes = header->n_nodes;\n"
+		"\tmt->nodes   = (const GEN_BinNode *)((const char *)data + header->nodes_offset);\n"
+		"\tmt->tokens  = (const GEN_BinToken *)((const char *)data + header->tokens_offset);\n"
+		"\tmt->pool    = (const char *)data + header->pool_offset;\n"
+		"\tif (!GEN_CheckMappedTree(mt, header->pool_size)) {\n"
+		"\t\tGEN_UnmapTree(mt);\n"
+		"\t\treturn NULL;\n"
+		"\t}\n"
+		"\treturn mt;\n"
+		"}\n\n"
+
+		"void GEN_UnmapTree(GEN_MappedTree *mt)\n"
+		"{\n"
+		"\tassert(mt != NULL && \"Null param\");\n"
+		"\tmunmap(mt->data, mt->size);\n"
+		"\tfree(mt);\n"
+		"}\n");
+}
+
+/**
+ * @brief Prints exporter of tree: one pass without recursion
+ * writes DOT, JSON Lines or s-expressions to buffered sink of caller.
+ *
+ * @param lib_header   Header file of library.
+ * @param c_file       Text of Tree_GEN.c.
+ */
+static void WriteTreeExport(FILE *lib_header, FILE *c_file)
+{
+	fprintf(lib_header,
+		"typedef enum\n"
+		"{\n"
+		"\tGEN_EXPORT_DOT,\n"
+		"\t// One JSON object per node in preorder.\n"
+		"\tGEN_EXPORT_JSONL,\n"
+		"\tGEN_EXPORT_SEXPR,\n"
+		"} GEN_ExportFormat;\n\n"
+
+		"// Receives buffered output of exporter. Returns false if it can't write.\n"
+		"typedef bool (*GEN_SinkWrite)(void *data, const char *buf, uint64_t len);\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_SinkWrite write;\n"
+		"\tvoid         *data;\n"
+		"} GEN_Sink;\n\n"
+
+		"// Zero options are DOT without limits.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_ExportFormat format;\n"
+		"\t// Nodes deeper than (max_depth) aren't written (root is at depth 0), 0 if no limit.\n"
+		"\tuint32_t         max_depth;\n"
+		"\t// At most (max_nodes) nodes are written, 0 if no limit.\n"
+		"\tuint64_t         max_nodes;\n"
+		"} GEN_ExportOptions;\n\n"
+
+		"GEN_Sink GEN_FileSink(FILE *f);\n"
+		"bool GEN_ExportTree(const GEN_Node *root, GEN_Sink sink, const GEN_ExportOptions *options);\n\n");
+
+	fprintf(c_file,
+		"\n"
+		"// Exporter gives output to sink by blocks of this size.\n"
+		"static const uint64_t kExportBufferSize = 1 << 16;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tconst GEN_Node *node;\n"
+		"\tuint64_t        id;\n"
+		"\tuint64_t        next_child;\n"
+		"\t// Some children aren't written because of limits.\n"
+		"\tbool            limited;\n"
+		"} GEN_ExportFrame;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_Sink                 sink;\n"
+		"\tconst GEN_ExportOptions *options;\n"
+		"\tchar                    *buf;\n"
+		"\tuint64_t                 size;\n"
+		"\t// Sink failed: nothing is written after.\n"
+		"\tbool                     failed;\n"
+		"\tuint64_t                 n_nodes;\n"
+		"} GEN_Exporter;\n\n"
+
+		"static bool GEN_FileWrite(void *data, const char *buf, uint64_t len)\n"
+		"{ return fwrite(buf, sizeof(char), len, (FILE *)data) == len; }\n\n"
+
+		"GEN_Sink GEN_FileSink(FILE *f)\n"
+		"{\n"
+		"\tassert(f != NULL && \"Null param\");\n"
+		"\treturn (GEN_Sink){GEN_FileWrite, f};\n"
+		"}\n\n"
+
+		"static void GEN_ExportFlush(GEN_Exporter *e)\n"
+		"{\n"
+		"\tif (!e->failed && e->size > 0) {\n"
+		"\t\te->failed = !e->sink.write(e->sink.data, e->buf, e->size);\n"
+		"\t}\n"
+		"\te->size = 0;\n"
+		"}\n\n"
+
+		"static void GEN_ExportPut(GEN_Exporter *e, const char *txt, uint64_t len)\n"
+		"{\n"
+		"\tif (e->size + len > kExportBufferSize) {\n"
+		"\t\tGEN_ExportFlush(e);\n"
+		"\t}\n"
+		"\tif (len > kExportBufferSize) {\n"
+		"\t\te->failed = e->failed || !e->sink.write(e->sink.data, txt, len);\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\tmemcpy(e->buf + e->size, txt, len);\n"
+		"\te->size += len;\n"
+		"}\n\n"
+
+		"static void GEN_ExportString(GEN_Exporter *e, const char *txt)\n"
+		"{ GEN_ExportPut(e, txt, strlen(txt)); }\n\n"
+
+		"static void GEN_ExportNumber(GEN_Exporter *e, int64_t number)\n"
+		"{\n"
+		"\tchar digits[24] = \"\";\n"
+		"\tint  len = snprintf(digits, sizeof(digits), \"%%ld\", number);\n"
+		"\tGEN_ExportPut(e, digits, (uint64_t)len);\n"
+		"}\n\n"
+
+		"// Writes text with escaped quote, backslash and control bytes.\n"
+		"static void GEN_ExportEscaped(GEN_Exporter *e, const char *txt, uint64_t len)\n"
+		"{\n"
+		"\tuint64_t start = 0;\n"
+		"\tfor (uint64_t cur_byte = 0; cur_byte < len; ++cur_byte) {\n"
+		"\t\tunsigned char c = (unsigned char)txt[cur_byte];\n"
+		"\t\tif (c != '\"' && c != '\\\\' && c >= 0x20) {\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tGEN_ExportPut(e, txt + start, cur_byte - start);\n"
+		"\t\tstart = cur_byte + 1;\n"
+		"\t\tchar escaped[8] = \"\";\n"
+		"\t\tif (c == '\"' || c == '\\\\') {\n"
+		"\t\t\tsnprintf(escaped, sizeof(escaped), \"\\\\%%c\", c);\n"
+		"\t\t} else if (c == '\\n') {\n"
+		"\t\t\tsnprintf(escaped, sizeof(escaped), \"\\\\n\");\n"
+		"\t\t} else if (e->options->format == GEN_EXPORT_JSONL) {\n"
+		"\t\t\tsnprintf(escaped, sizeof(escaped), \"\\\\u%%04x\", c);\n"
+		"\t\t} else {\n"
+		"\t\t\tsnprintf(escaped, sizeof(escaped), \" \");\n"
+		"\t\t}\n"
+		"\t\tGEN_ExportString(e, escaped);\n"
+		"\t}\n"
+		"\tGEN_ExportPut(e, txt + start, len - start);\n"
+		"}\n\n"
+
+		"static void GEN_ExportQuoted(GEN_Exporter *e, const char *txt, uint64_t len)\n"
+		"{\n"
+		"\tGEN_ExportPut(e, \"\\\"\", 1);\n"
+		"\tGEN_ExportEscaped(e, txt, len);\n"
+		"\tGEN_ExportPut(e, \"\\\"\", 1);\n"
+		"}\n\n");
+
+	fprintf(c_file,
+		"static uint64_t GEN_ExportChildren(const GEN_Node *n)\n"
+		"{ return (n->children != NULL)? n->children->size : 0; }\n\n"
+
+		"// Rule node (name of rule is it's text) or token.\n"
+		"static bool GEN_ExportIsRule(const GEN_Node *n)\n"
+		"{ return (uint32_t)n->token.type >= kNumberOfTokenTypes; }\n\n"
+
+		"static void GEN_ExportOpen(GEN_Exporter *e, const GEN_Node *n, uint64_t id, int64_t parent, uint64_t depth)\n"
+		"{\n"
+		"\tconst char *type_txt = GEN_TranslateTokenType(n->token.type);\n"
+		"\tswitch (e->options->format) {\n"
+		"\t\tcase GEN_EXPORT_DOT: {\n"
+		"\t\t\t// Label is (text) and type of token, rule has only it's name.\n"
+		"\t\t\tGEN_ExportString(e, \"\\tn\");\n"
+		"\t\t\tGEN_ExportNumber(e, (int64_t)id);\n"
+		"\t\t\tGEN_ExportString(e, \" [shape=\\\"\");\n"
+		"\t\t\tGEN_ExportString(e, GEN_CellBordersFormat(n->token.type));\n"
+		"\t\t\tGEN_ExportString(e, \"\\\" color=\\\"\");\n"
+		"\t\t\tGEN_ExportString(e, GEN_CheckIfRuleName(n->token.parser_type));\n"
+		"\t\t\tGEN_ExportString(e, \"\\\" label=\\\"(\");\n"
+		"\t\t\tGEN_ExportEscaped(e, n->token.txt, n->token.len);\n"
+		"\t\t\tGEN_ExportString(e, \")\\\\n\");\n"
+		"\t\t\tif (!GEN_ExportIsRule(n)) {\n"
+		"\t\t\t\tGEN_ExportString(e, type_txt);\n"
+		"\t\t\t}\n"
+		"\t\t\tGEN_ExportString(e, \"\\\"]\\n\");\n"
+		"\t\t\tif (parent >= 0) {\n"
+		"\t\t\t\tGEN_ExportString(e, \"\\tn\");\n"
+		"\t\t\t\tGEN_ExportNumber(e, parent);\n"
+		"\t\t\t\tGEN_ExportString(e, \" -> n\");\n"
+		"\t\t\t\tGEN_ExportNumber(e, (int64_t)id);\n"
+		"\t\t\t\tGEN_ExportString(e, \"\\n\");\n"
+		"\t\t\t}\n"
+		"\t\t\tbreak;\n"
+		"\t\t}\n"
+		"\t\tcase GEN_EXPORT_JSONL: {\n"
+		"\t\t\tGEN_ExportString(e, \"{\\\"id\\\":\");\n"
+		"\t\t\tGEN_ExportNumber(e, (int64_t)id);\n"
+		"\t\t\tGEN_ExportString(e, \",\\\"parent\\\":\");\n"
+		"\t\t\tGEN_ExportNumber(e, parent);\n"
+		"\t\t\tGEN_ExportString(e, \",\\\"depth\\\":\");\n"
+		"\t\t\tGEN_ExportNumber(e, (int64_t)depth);\n"
+		"\t\t\tGEN_ExportString(e, \",\\\"type\\\":\");\n"
+		"\t\t\tGEN_ExportQuoted(e, type_txt, strlen(type_txt));\n"
+		"\t\t\tif (!GEN_ExportIsRule(n)) {\n"
+		"\t\t\t\tGEN_ExportString(e, \",\\\"txt\\\":\");\n"
+		"\t\t\t\tGEN_ExportQuoted(e, n->token.txt, n->token.len);\n"
+		"\t\t\t}\n"
+		"\t\t\tGEN_ExportString(e, \",\\\"offset\\\":\");\n"
+		"\t\t\tGEN_ExportNumber(e, n->offset);\n"
+		"\t\t\tGEN_ExportString(e, \",\\\"n_tokens\\\":\");\n"
+		"\t\t\tGEN_ExportNumber(e, n->n_tokens);\n"
+		"\t\t\tGEN_ExportString(e, \",\\\"n_children\\\":\");\n"
+		"\t\t\tGEN_ExportNumber(e, (int64_t)GEN_ExportChildren(n));\n"
+		"\t\t\tGEN_ExportString(e, \"}\\n\");\n"
+		"\t\t\tbreak;\n"
+		"\t\t}\n"
+		"\t\tcase GEN_EXPORT_SEXPR: {\n"
+		"\t\t\tGEN_ExportString(e, (parent >= 0)? \" (\" : \"(\");\n"
+		"\t\t\tGEN_ExportString(e, type_txt);\n"
+		"\t\t\tif (!GEN_ExportIsRule(n)) {\n"
+		"\t\t\t\tGEN_ExportString(e, \" \");\n"
+		"\t\t\t\tGEN_ExportQuoted(e, n->token.txt, n->token.len);\n"
+		"\t\t\t}\n"
+		"\t\t\tbreak;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"}\n\n");
+
+	fprintf(c_file,
+		"static void GEN_ExportClose(GEN_Exporter *e, const GEN_ExportFrame *frame, bool is_root)\n"
+		"{\n"
+		"\tif (e->options->format != GEN_EXPORT_SEXPR) {\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\tif (frame->limited) {\n"
+		"\t\tGEN_ExportString(e, \" ...\");\n"
+		"\t}\n"
+		"\tGEN_ExportString(e, (is_root)? \")\\n\" : \")\");\n"
+		"}\n\n"
+
+		"/*\n"
+		" * Writes subtree of (root) to (sink) in one pass without recursion.\n"
+		" * Returns false if sink failed.\n"
+		" */\n"
+		"bool GEN_ExportTree(const GEN_Node *root, GEN_Sink sink, const GEN_ExportOptions *options)\n"
+		"{\n"
+		"\tassert(root        != NULL && \"Null param\");\n"
+		"\tassert(sink.write  != NULL && \"Null param\");\n"
+		"\tassert(options     != NULL && \"Null param\");\n\n"
+
+		"\tGEN_Exporter e = {sink, options, NULL, 0, false, 0};\n"
+		"\te.buf = (char *)malloc(kExportBufferSize);\n"
+		"\tassert(e.buf != NULL && \"Null malloc allocation\");\n\n"
+
+		"\tuint64_t         capacity = kMaxScopeDepth;\n"
+		"\tuint64_t         size     = 0;\n"
+		"\tGEN_ExportFrame *stack    = (GEN_ExportFrame *)malloc(capacity * sizeof(GEN_ExportFrame));\n"
+		"\tassert(stack != NULL && \"Null malloc allocation\");\n\n"
+
+		"\tif (options->format == GEN_EXPORT_DOT) {\n"
+		"\t\tGEN_ExportString(&e, \"digraph G{\\n\\tlabel=\\\"AST of file\\\"\\n\\tgraph [dpi=50];\\n\\n\");\n"
+		"\t}\n"
+		"\tGEN_ExportOpen(&e, root, e.n_nodes++, -1, 0);\n"
+		"\tstack[size++] = (GEN_ExportFrame){root, 0, 0, false};\n"
+		"\twhile (size > 0 && !e.failed) {\n"
+		"\t\tGEN_ExportFrame *frame = stack + size - 1;\n"
+		"\t\tif (frame->next_child == GEN_ExportChildren(frame->node)) {\n"
+		"\t\t\tGEN_ExportClose(&e, frame, size == 1);\n"
+		"\t\t\t--size;\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n\n"
+
+		"\t\tconst GEN_Node *child = GEN_GetChild((GEN_Node *)frame->node, frame->next_child++);\n"
+		"\t\tif ((options->max_depth != 0 && size > options->max_depth) ||\n"
+		"\t\t\t\t(options->max_nodes != 0 && e.n_nodes >= options->max_nodes)) {\n"
+		"\t\t\t// The other children are skipped too.\n"
+		"\t\t\tframe->limited    = true;\n"
+		"\t\t\tframe->next_child = GEN_ExportChildren(frame->node);\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n\n"
+
+		"\t\tuint64_t id = e.n_nodes++;\n"
+		"\t\tGEN_ExportOpen(&e, child, id, (int64_t)frame->id, size);\n"
+		"\t\tif (size == capacity) {\n"
+		"\t\t\tcapacity <<= 1;\n"
+		"\t\t\tstack = (GEN_ExportFrame *)realloc(stack, capacity * sizeof(GEN_ExportFrame));\n"
+		"\t\t\tassert(stack != NULL && \"Null realloc allocation\");\n"
+		"\t\t}\n"
+		"\t\tstack[size++] = (GEN_ExportFrame){child, id, 0, false};\n"
+		"\t}\n"
+		"\tif (options->format == GEN_EXPORT_DOT) {\n"
+		"\t\tGEN_ExportString(&e, \"}\\n\");\n"
+		"\t}\n"
+		"\tGEN_ExportFlush(&e);\n\n"
+
+		"\tfree(stack);\n"
+		"\tfree(e.buf);\n"
+		"\treturn !e.failed;\n"
+		"}\n");
+}
+
+
+/**
+ * @brief Prints the whole Tree_GEN.c file and add's it's
+ * commands to (lib_header)-file.
+ * 
+ * @param lib_header   Header file of library.
+ * @param c_file       Text of Tree_GEN.c.
+ */
+static void GenerateTreeFile(FILE *lib_header, FILE *c_file)
+{
+
+	fprintf(lib_header,
+		"#pragma once\n\n"
+		"// Chunk of arena. Chunks are never moved so allocated memory is stable.\n"
+		"typedef struct GEN_ArenaChunk\n"
+		"{\n"
+		"\tstruct GEN_ArenaChunk *next;\n"
+		"\tuint64_t               size;\n"
+		"\tuint64_t               used;\n"
+		"\tchar                   data[];\n"
+		"} GEN_ArenaChunk;\n\n"
+
+		"// Bump allocator of tree: everything is released at once.\n"
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_ArenaChunk *head;\n"
+		"\tGEN_ArenaChunk *current;\n"
+		"} GEN_Arena;\n\n"
+
+		"typedef struct\n"
+		"{\n"
+		"	uint64_t size;\n"
+		"	uint64_t capacity;\n"
+		"	uint64_t element_size;\n"
+		"	void *data;\n"
+		"	GEN_Arena *arena;\n"
+		"} GEN_Array;\n\n"
+
+		"typedef struct GEN_Node\n"
+		"{\n"
+		"\t// Children of particular GEN_node.\n"
+		"\tGEN_Array           *children;\n"
+		"\t// Token of current cell in AST. It points to source text and isn't copied.\n"
+		"\tGEN_Token        token;\n"
+		"\t// Numbered-id for each GEN_node.\n"
+		"\tuint64_t     id;\n"
+		"\t// Parent GEN_node for current one.\n"
+		"\tstruct GEN_Node *parent;\n"
+		"\t// Span in tokens: node starts (offset) tokens after start of parent,\n"
+		"\t// so subtree can be moved (reused by GEN_Reparse) without changes in it.\n"
+		"\tuint32_t     offset;\n"
+		"\tuint32_t     n_tokens;\n"
+		"\t// Tokens parser looked at to build node: span and lookahead after it.\n"
+		"\tuint32_t     n_examined;\n"
+		"\t// bool         rule_name;\n"
+		"\t// Type of GEN_node in parser generating.\n"
+		"} GEN_Node;\n"
+		"typedef struct\n"
+		"{\n"
+		"\tGEN_Node   *root;\n"
+		"\tGEN_Node   *current;\n"
+		"\tsize_t      size;\n"
+		"\tconst char *data;\n"
+		"\t// Memory of all nodes. Sub-trees of parser share it with their parent.\n"
+		"\tGEN_Arena  *arena;\n"
+		"\t// Parser doesn't make nodes of rules with one child and of symbols of %%elide.\n"
+		"\tbool        compress;\n"
+		"} GEN_Tree;\n"
+		"GEN_Arena *GEN_ArenaCtor();\n\n"
+		"void GEN_ArenaDtor(GEN_Arena *arena);\n\n"
+		"void GEN_ArenaReset(GEN_Arena *arena);\n\n"
+		"void *GEN_ArenaAlloc(GEN_Arena *arena, uint64_t size);\n\n"
+		"void GEN_ArenaAdopt(GEN_Arena *arena, GEN_Arena *other);\n\n"
+		"GEN_Arena *GEN_TreeArena(GEN_Tree *t);\n\n"
+		"GEN_Tree GEN_SubTree(GEN_Tree *t);\n\n"
+		"void GEN_TreeReset(GEN_Tree *t);\n\n"
+		"void GEN_TreeFree(GEN_Tree *t);\n\n"
+		"GEN_Node *GEN_NodeCtor(GEN_Tree *t);\n\n"
+		"GEN_Tree *GEN_TreeCtor(GEN_TokenType type);\n\n"
+		"GEN_Node *GEN_AddChild(GEN_Tree *t, GEN_Node *new_child);\n\n"
+		"void GEN_InsertParent(GEN_Tree *t, GEN_Node *n);\n\n"
+		"const char *GEN_CellBordersFormat(GEN_TokenType t);\n\n"
+		"const char *GEN_CheckIfRuleName(GEN_PrsrNdType type);\n\n"
+		"GEN_TokenType GEN_Ttype(GEN_Node *n);\n\n"
+		"void GEN_WriteDot(GEN_Tree *t, FILE *f);\n\n"
+		"bool GEN_DebugTree(GEN_Tree *t, const char *file_name);\n\n"
+		"void GEN_Parent(GEN_Tree *t);\n\n"
+		"GEN_Node *GEN_GetChild(GEN_Node *n, uint64_t idx);\n\n"
+		"void GEN_AppendTree(GEN_Tree *first, GEN_Tree *second);\n\n"
+		"GEN_Node *GEN_CreateNodeByType(GEN_Tree *t, GEN_TokenType type);\n\n"
+		"GEN_Node *GEN_CreateNode(GEN_Tree *t, const GEN_Token *token);\n\n"
+
+		"GEN_Array *GEN_ArrayCtor(GEN_Arena *arena, uint64_t el_sz, uint64_t capacity);\n"
+		"void GEN_ArrayChangeCapacity(GEN_Array *a, uint64_t new_capacity);\n"
+		"void GEN_ArrayAdd(GEN_Array *a, void *new_element);\n"
+		);
+
+	fprintf(lib_header,
+		"void GEN_CompressTree(GEN_Tree *t, GEN_Node *n);\n\n");
+
+	fprintf(c_file,
+		"#include <lib_GEN.h>\n"
+		"#include <assert.h>\n"
+		"#include <fcntl.h>\n"
+		"#include <sys/mman.h>\n"
+		"#include <sys/stat.h>\n"
+		"#include <unistd.h>\n"
+		"#include <MchlkrpchLogger/logger.h>\n\n");
+
+	fprintf(c_file,
+		"static const uint64_t kArenaChunkSize    = 1 << 16;\n"
+		"static const uint64_t kArenaMaxChunkSize = 1 << 24;\n"
+		"static const uint64_t kArenaAlignment    = 16;\n\n"
+
+		"GEN_Arena *GEN_ArenaCtor()\n"
+		"{\n"
+		"\tGEN_Arena *arena = (GEN_Arena *)calloc(1, sizeof(GEN_Arena));\n"
+		"\tassert(arena != NULL && \"Null calloc allocation\");\n"
+		"\treturn arena;\n"
+		"}\n\n"
+
+		"void GEN_ArenaDtor(GEN_Arena *arena)\n"
+		"{\n"
+		"\tassert(arena != NULL && \"Null param\");\n"
+		"\tGEN_ArenaChunk *chunk = arena->head;\n"
+		"\twhile (chunk != NULL) {\n"
+		"\t\tGEN_ArenaChunk *next = chunk->next;\n"
+		"\t\tfree(chunk);\n"
+		"\t\tchunk = next;\n"
+		"\t}\n"
+		"\tfree(arena);\n"
+		"}\n\n"
+
+		"// Keeps chunks to use them again.\n"
+		"void GEN_ArenaReset(GEN_Arena *arena)\n"
+		"{\n"
+		"\tassert(arena != NULL && \"Null param\");\n"
+		"\tfor (GEN_ArenaChunk *chunk = arena->head; chunk != NULL; chunk = chunk->next) {\n"
+		"\t\tchunk->used = 0;\n"
+		"\t}\n"
+		"\tarena->current = arena->head;\n"
+		"}\n\n"
+
+		"void *GEN_ArenaAlloc(GEN_Arena *arena, uint64_t size)\n"
+		"{\n"
+		"\tassert(arena != NULL && \"Null param\");\n"
+		"\twhile (true) {\n"
+		"\t\tGEN_ArenaChunk *chunk = arena->current;\n"
+		"\t\tif (chunk != NULL) {\n"
+		"\t\t\tuintptr_t start = ((uintptr_t)(chunk->data + chunk->used) + kArenaAlignment - 1) & ~(uintptr_t)(kArenaAlignment - 1);\n"
+		"\t\t\tuint64_t  end   = (uint64_t)(start - (uintptr_t)chunk->data) + size;\n"
+		"\t\t\tif (end <= chunk->size) {\n"
+		"\t\t\t\tchunk->used = end;\n"
+		"\t\t\t\tmemset((void *)start, 0, size);\n"
+		"\t\t\t\treturn (void *)start;\n"
+		"\t\t\t}\n"
+		"\t\t\t// Chunk which was kept after reset.\n"
+		"\t\t\tif (chunk->next != NULL) {\n"
+		"\t\t\t\tarena->current = chunk->next;\n"
+		"\t\t\t\tcontinue;\n"
+		"\t\t\t}\n"
+		"\t\t}\n\n"
+
+		"\t\tuint64_t chunk_size = (chunk == NULL)? kArenaChunkSize : chunk->size << 1;\n"
+		"\t\tchunk_size = (chunk_size > kArenaMaxChunkSize)? kArenaMaxChunkSize : chunk_size;\n"
+		"\t\tchunk_size = (chunk_size < size + kArenaAlignment)? size + kArenaAlignment : chunk_size;\n"
+		"\t\tGEN_ArenaChunk *new_chunk = (GEN_ArenaChunk *)malloc(sizeof(GEN_ArenaChunk) + chunk_size);\n"
+		"\t\tassert(new_chunk != NULL && \"Null malloc allocation\");\n"
+		"\t\tnew_chunk->next = NULL;\n"
+		"\t\tnew_chunk->size = chunk_size;\n"
+		"\t\tnew_chunk->used = 0;\n"
+		"\t\tif (chunk == NULL) {\n"
+		"\t\t\tarena->head = new_chunk;\n"
+		"\t\t} else {\n"
+		"\t\t\tchunk->next = new_chunk;\n"
+		"\t\t}\n"
+		"\t\tarena->current = new_chunk;\n"
+		"\t}\n"
+		"}\n\n"
+
+		"// Moves chunks of (other) to the end of (arena) and destroys (other).\n"
+		"void GEN_ArenaAdopt(GEN_Arena *arena, GEN_Arena *other)\n"
+		"{\n"
+		"\tassert(arena != NULL && \"Null param\");\n"
+		"\tif (other == NULL) {\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\tif (arena->head == NULL) {\n"
+		"\t\tarena->head    = other->head;\n"
+		"\t\tarena->current = other->current;\n"
+		"\t} else {\n"
+		"\t\tGEN_ArenaChunk *last = arena->head;\n"
+		"\t\twhile (last->next != NULL) {\n"
+		"\t\t\tlast = last->next;\n"
+		"\t\t}\n"
+		"\t\tlast->next = other->head;\n"
+		"\t}\n"
+		"\tfree(other);\n"
+		"}\n\n"
+
+		"GEN_Arena *GEN_TreeArena(GEN_Tree *t)\n"
+		"{\n"
+		"\tif (t->arena == NULL) {\n"
+		"\t\tt->arena = GEN_ArenaCtor();\n"
+		"\t}\n"
+		"\treturn t->arena;\n"
+		"}\n\n"
+
+		"GEN_Tree GEN_SubTree(GEN_Tree *t)\n"
+		"{\n"
+		"\tGEN_Tree sub_tree = {0};\n"
+		"\tsub_tree.arena = GEN_TreeArena(t);\n"
+		"\treturn sub_tree;\n"
+		"}\n\n"
+
+		"// Releases all nodes, memory is kept for the next tree.\n"
+		"void GEN_TreeReset(GEN_Tree *t)\n"
+		"{\n"
+		"\tassert(t != NULL && \"Null param\");\n"
+		"\tif (t->arena != NULL) {\n"
+		"\t\tGEN_ArenaReset(t->arena);\n"
+		"\t}\n"
+		"\tt->root    = NULL;\n"
+		"\tt->current = NULL;\n"
+		"\tt->size    = 0;\n"
+		"}\n\n"
+
+		"void GEN_TreeFree(GEN_Tree *t)\n"
+		"{\n"
+		"\tassert(t != NULL && \"Null param\");\n"
+		"\tif (t->arena != NULL) {\n"
+		"\t\tGEN_ArenaDtor(t->arena);\n"
+		"\t}\n"
+		"\tt->arena   = NULL;\n"
+		"\tt->root    = NULL;\n"
+		"\tt->current = NULL;\n"
+		"\tt->size    = 0;\n"
+		"}\n\n"
+
+		"GEN_Node *GEN_NodeCtor(GEN_Tree *t)\n"
+		"{\n"
+		"\treturn (GEN_Node *)GEN_ArenaAlloc(GEN_TreeArena(t), sizeof(GEN_Node));\n"
+		"}\n\n"
+
+		"GEN_Tree *GEN_TreeCtor(GEN_TokenType type)\n"
+		"{\n"
+		"\tGEN_Tree *new_tree = (GEN_Tree *)calloc(1, sizeof(GEN_Tree));\n"
+		"\tassert(new_tree != NULL && \"Null calloc allocation\");\n"
+		"\tGEN_AddChild(new_tree, GEN_CreateNodeByType(new_tree, type));\n"
+		"\treturn new_tree;\n"
+		"}\n\n"
+
+		"GEN_Node *GEN_AddChild(GEN_Tree *t, GEN_Node *new_child)\n"
+		"{\n"
+		"\tif (t->current == NULL) {\n"
+		"\t\tt->root    = new_child;\n"
+		"\t\tt->current = t->root;\n"
+		"\t\t} else {\n"
+		"\t\tif (t->current->children == NULL) {\n"
+		"\t\t	t->current->children = GEN_ArrayCtor(GEN_TreeArena(t), sizeof(GEN_Node*), 1);\n"
+		"\t\t}\n"
+		"\t\tGEN_ArrayAdd(t->current->children, new_child);\n"
+		"\t\tGEN_GetChild(t->current, t->current->children->size - 1)->parent = (struct GEN_Node *)t->current;\n"
+		"\t\tt->current = new_child;\n"
+		"\t}\n"
+		"\treturn t->current;\n"
+		"}\n\n"
+		);
+
+	fprintf(c_file,
+		"void GEN_InsertParent(GEN_Tree *t, GEN_Node *n)\n"
+		"{\n"
+		"\tGEN_Node *old_current = t->current;\n"
+		"\tif (t->current->parent != NULL) {\n"
+		"\t\tGEN_Node *parent = t->current->parent;\n"
+		"\t\tmemcpy((GEN_Node **)parent->children->data + parent->children->size - 1, &n, sizeof(GEN_Node*));\n"
+		"\t\tn->parent = parent;\n"
+		"\t}\n"
+		"\tt->current = n;\n"
+		"\tGEN_AddChild(t, old_current);\n"
+		"\told_current->parent = (struct GEN_Node *)n;\n"
+		"\tGEN_Parent(t);\n"
+		"\tif\t(old_current == t->root) {\n"
+		"\t\tt->root = n;\n"
+		"\t}\n"
+		"}\n\n"
+
+		"const char *GEN_CellBordersFormat(GEN_TokenType t)\n"
+		"{\n"
+		"\tswitch (t) {\n"
+		"\t\tdefault: {\n"
+		"\t\t\treturn 	\"rectangle\";\n"
+		"\t\t}\n"
+		"\t}\n"
+		"}\n\n"
+
+		"const char *GEN_CheckIfRuleName(GEN_PrsrNdType type)\n"
+		"{\n"
+		"\tswitch (type) {\n"
+		"\t\tcase            GEN_VAR_NAME: { return \"yellow\"; }\n"
+		"\t\tcase           GEN_RULE_NAME: { return \"cyan\"; }\n"
+		"\t\tcase GEN_RULE_NAME_REFERENCE: { return \"red\"; }\n"
+		"\t\tcase  GEN_VAR_NAME_REFERENCE: { return \"green\"; }\n"
+		"\t\tdefault: {return \"black\"; }\n"
+		"\t}\n"
+		"}\n\n"
+
+		"GEN_TokenType GEN_Ttype(GEN_Node *n)\n"
+		"{ return n->token.type; }\n\n"
+
+		"// Writes graph of tree (t) to caller's file, so trees of different threads don't share it.\n"
+		"void GEN_WriteDot(GEN_Tree *t, FILE *f)\n"
+		"{\n"
+		"\tassert(t != NULL && \"Null param\");\n"
+		"\tassert(f != NULL && \"Null param\");\n"
+		"\tGEN_ExportOptions options = {GEN_EXPORT_DOT, 0, 0};\n"
+		"\tGEN_ExportTree(t->root, GEN_FileSink(f), &options);\n"
+		"}\n\n"
+
+		"// Writes graph to file (file_name) of caller. It isn't rendered: run dot on it if picture is needed.\n"
+		"bool GEN_DebugTree(GEN_Tree *t, const char *file_name)\n"
+		"{\n"
+		"\tassert(t         != NULL && \"Null param\");\n"
+		"\tassert(file_name != NULL && \"Null param\");\n"
+		"\tFILE *f = fopen(file_name, \"w\");\n"
+		"\tif (f == NULL) {\n"
+		"\t\treturn false;\n"
+		"\t}\n"
+		"\tGEN_WriteDot(t, f);\n"
+		"\treturn fclose(f) == 0;\n"
+		"}\n\n"
+		);
+
+	fprintf(c_file,
+		"void GEN_Parent(GEN_Tree *t)\n"
+		"{ t->current = (GEN_Node *)t->current->parent; }\n\n"
+
+		"inline __attribute__((always_inline))\n"
+		"GEN_Node *GEN_GetChild(GEN_Node *n, uint64_t idx)\n"
+		"{ return (*(GEN_Node **)((char *)n->children->data + idx * sizeof(GEN_Node*))); }\n\n"
+
+		"void GEN_AppendTree(GEN_Tree *first, GEN_Tree *second)\n"
+		"{\n"
+		"\tGEN_Node *second_cur = second->current;\n"
+		"\tfor (size_t cur_child = 0; cur_child < second_cur->children->size; ++cur_child) {\n"
+		"\t\tGEN_AddChild(first, GEN_GetChild(second_cur, cur_child));\n"
+		"\t\tGEN_Parent(first);\n"
+		"\t\tGEN_GetChild(first->current, cur_child)->parent = first->current;\n"
+		"\t}\n"
+		"\tsecond->current =  first->current;\n"
+		"}\n\n"
+
+		"GEN_Node *GEN_CreateNodeByType(GEN_Tree *t, GEN_TokenType type)\n"
+		"{\n"
+		"\tGEN_Node *new_node = GEN_NodeCtor(t);\n"
+		"\tnew_node->token.type = type;\n"
+		"\tnew_node->token.txt  = GEN_TranslateTokenType(type);\n"
+		"\tnew_node->token.len  = (uint32_t)strlen(new_node->token.txt);\n"
+		"\tnew_node->id = (uint64_t)new_node;\n"
+		"\t++t->size;\n"
+		"\treturn new_node;\n"
+		"}\n\n"
+
+		"GEN_Node *GEN_CreateNode(GEN_Tree *t, const GEN_Token *token)\n"
+		"{\n"
+		"\tGEN_Node *new_node = GEN_NodeCtor(t);\n"
+		"\tnew_node->token = *token;\n"
+		"\tnew_node->id = ((uint64_t)new_node);\n"
+		"\t++t->size;\n"
+		"\treturn new_node;\n"
+		"}\n\n"
+
+		"GEN_Array *GEN_ArrayCtor(GEN_Arena *arena, uint64_t el_sz, uint64_t capacity)\n"
+		"{\n"
+		"\tGEN_Array *a = (GEN_Array *)GEN_ArenaAlloc(arena, sizeof(GEN_Array));\n"
+		"\ta->size         = 0;\n"
+		"\ta->capacity     = capacity;\n"
+		"\ta->element_size = el_sz;\n"
+		"\ta->arena        = arena;\n"
+		"\ta->data = GEN_ArenaAlloc(arena, el_sz * capacity * sizeof(char));\n"
+		"\treturn a;\n"
+		"}\n\n"
+
+		"// Old data stays in arena: it's released with the whole tree.\n"
+		"void GEN_ArrayChangeCapacity(GEN_Array *a, uint64_t new_capacity)\n"
+		"{\n"
+		"\tassert(a != NULL && \"Null param\");\n"
+		"\tvoid *new_data = GEN_ArenaAlloc(a->arena, a->element_size * new_capacity * sizeof(char));\n"
+		"\tmemcpy(new_data, a->data, a->element_size * ((a->size < new_capacity)? a->size : new_capacity));\n"
+		"\ta->data     = new_data;\n"
+		"\ta->capacity = new_capacity;\n"
+		"}\n\n"
+
+		"void GEN_ArrayAdd(GEN_Array *a, void *new_element)\n"
+		"{\n"
+		"\tif (a->size == a->capacity) {\n"
+		"\t\tGEN_ArrayChangeCapacity(a, a->capacity << 1);\n"
+		"\t}\n"
+		"\tvoid *ptr = (char *)a->data + a->size * a->element_size;\n"
+		"\tmemcpy(ptr, &new_element, a->element_size);\n"
+		"\t++a->size;\n"
+		"}\n\n"
+
+		"// Replaces each node with one child (below n) by this child in one pass, like\n"
+		"// compressed parse (GEN_Tree::compress), but symbols of %%elide stay in tree.\n"
+		"void GEN_CompressTree(GEN_Tree *t, GEN_Node *n)\n"
+		"{\n"
+		"\tassert(t != NULL && \"Null param\");\n"
+		"\tassert(n != NULL && \"Null param\");\n\n"
+
+		"\tuint64_t   capacity = kMaxScopeDepth;\n"
+		"\tuint64_t   size     = 0;\n"
+		"\tGEN_Node **stack    = (GEN_Node **)malloc(capacity * sizeof(GEN_Node *));\n"
+		"\tassert(stack != NULL && \"Null malloc allocation\");\n\n"
+
+		"\tt->current    = n;\n"
+		"\tstack[size++] = n;\n"
+		"\twhile (size > 0) {\n"
+		"\t\tGEN_Node *node = stack[--size];\n"
+		"\t\tif (node->children == NULL) {\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\tfor (uint64_t cur_child = 0; cur_child < node->children->size; ++cur_child) {\n"
+		"\t\t\tGEN_Node *child = GEN_GetChild(node, cur_child);\n"
+		"\t\t\twhile (child->children != NULL && child->children->size == 1) {\n"
+		"\t\t\t\tGEN_Node *grandson = GEN_GetChild(child, 0);\n"
+		"\t\t\t\tgrandson->offset += child->offset;\n"
+		"\t\t\t\tchild = grandson;\n"
+		"\t\t\t}\n"
+		"\t\t\tchild->parent = node;\n"
+		"\t\t\tmemcpy((GEN_Node **)node->children->data + cur_child, &child, sizeof(GEN_Node *));\n\n"
+
+		"\t\t\tif (size == capacity) {\n"
+		"\t\t\t\tcapacity <<= 1;\n"
+		"\t\t\t\tstack = (GEN_Node **)realloc(stack, capacity * sizeof(GEN_Node *));\n"
+		"\t\t\t\tassert(stack != NULL && \"Null realloc allocation\");\n"
+		"\t\t\t}\n"
+		"\t\t\tstack[size++] = child;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tfree(stack);\n"
+		"}\n"
+		);
+
+	WriteFlatTree(lib_header, c_file);
+	WriteTreeSerialization(lib_header, c_file);
+	WriteTreeExport(lib_header, c_file);
+}
+
+// Output of generated files. ----------------------------------------------------------
+
+// Entry points of parser which don't have GEN_ prefix.
+static const char *kParserEntries[] = {"ParseLexer", "ParseSequence", "ParseLexerEvents", "ParseLexerFlat",
+	"ParseSequenceParallel"};
+// Constants of lib_GEN.h: header of each prefix defines them.
+static const char *kHeaderConstants[] = {"kMaxScopeDepth", "kInitSequenceSize", "kInitWindowSize",
+	"kNumberOfTokenTypes", "kNoSymbol", "kFlatNoNode", "kInitFlatTreeSize", "kBinTreeMagic", "kBinTreeVersion",
+	"kBinTreeByteOrder", "kBinNoSource", "kInitMemoSize", "kInitEventsSize"};
+// Type of token which isn't token of grammar, it's in enum of every library.
+static const char *kDefaultTokenName = "default_token";
+
+/// Names which are renamed for prefix of generated files (--prefix).
+typedef struct PrefixNames
+{
+	const char *prefix;
+	// Names of tokens and rules of grammar: they are enumerators of GEN_TokenType.
+	NameTable  *tokenizer_table;
+	NameTable  *parser_table;
+} PrefixNames;
+
+static bool IsNameSymbol(char c)
+{
+	return (c == '_') || ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9');
+}
+
+/// @returns   true if (name) of (len) bytes is one of (n_words) (words).
+static bool IsOneOf(const char *name, size_t len, const char **words, size_t n_words)
+{
+	for (size_t cur_word = 0; cur_word < n_words; ++cur_word) {
+		if (len == strlen(words[cur_word]) && strncmp(name, words[cur_word], len) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// @returns   true if (name) is token or rule of grammar in (table).
+static bool IsGrammarName(NameTable *table, const char *name, size_t len)
+{
+	int64_t idx = table->slots[FindSlot(table, name, len)];
+	return idx != kUndefinedIdx && !PhonyVariables(table, (uint64_t)idx);
+}
+
+/// @returns   true if (name) is enumerator of token, rule or option (<rule>_<n>) of grammar.
+static bool IsGrammarSymbol(const PrefixNames *names, const char *name, size_t len)
+{
+	if (IsGrammarName(names->tokenizer_table, name, len) || IsGrammarName(names->parser_table, name, len)) {
+		return true;
+	}
+	size_t rule_len = len;
+	while (rule_len > 0 && '0' <= name[rule_len - 1] && name[rule_len - 1] <= '9') {
+		--rule_len;
+	}
+	return rule_len > 1 && rule_len < len && name[rule_len - 1] == '_' &&
+		IsGrammarName(names->parser_table, name, rule_len - 1);
+}
+
+/// @returns   true if (name) is Try_<symbol> function of rule or option, maybe with _Climb or _Body.
+static bool IsRuleFunction(const PrefixNames *names, const char *name, size_t len)
+{
+	static const char *kSuffixes[] = {"_Body", "_Climb"};
+	if (len <= 4 || strncmp(name, "Try_", 4) != 0) {
+		return false;
+	}
+	name += 4;
+	len  -= 4;
+	for (size_t cur_suffix = 0; cur_suffix < sizeof(kSuffixes) / sizeof(kSuffixes[0]); ++cur_suffix) {
+		size_t suffix_len = strlen(kSuffixes[cur_suffix]);
+		if (len > suffix_len && strncmp(name + len - suffix_len, kSuffixes[cur_suffix], suffix_len) == 0) {
+			len -= suffix_len;
+			break;
+		}
+	}
+	return IsGrammarSymbol(names, name, len);
+}
+
+/**
+ * @brief Prints (name) renamed for prefix: GEN_<name> is <prefix>_<name>,
+ * lib_GEN is lib_<prefix>. In code names which every library defines are
+ * <prefix>_<name> too: parser's entry points, constants of header, enumerators
+ * of grammar's tokens and rules and their Try_ functions.
+ */
+static void WriteRenamedName(FILE *f, const char *name, size_t len, const PrefixNames *names, bool in_code)
+{
+	if (len >= 4 && strncmp(name, "GEN_", 4) == 0) {
+		fprintf(f, "%s_%.*s", names->prefix, (int)(len - 4), name + 4);
+	} else if (len == 7 && strncmp(name, "lib_GEN", 7) == 0) {
+		fprintf(f, "lib_%s", names->prefix);
+	} else if (in_code && (
+			IsOneOf(name, len, kParserEntries, sizeof(kParserEntries) / sizeof(kParserEntries[0])) ||
+			IsOneOf(name, len, kHeaderConstants, sizeof(kHeaderConstants) / sizeof(kHeaderConstants[0])) ||
+			IsOneOf(name, len, &kDefaultTokenName, 1) ||
+			IsGrammarSymbol(names, name, len) || IsRuleFunction(names, name, len))) {
+		fprintf(f, "%s_%.*s", names->prefix, (int)len, name);
+	} else {
+		fwrite(name, sizeof(char), len, f);
+	}
+}
+
+/// @returns   End of string or character literal which starts at (txt[start]).
+static size_t LiteralEnd(const char *txt, size_t len, size_t start)
+{
+	size_t end = start + 1;
+	while (end < len && txt[end] != txt[start] && txt[end] != '\n') {
+		end += (txt[end] == '\\' && end + 1 < len)? 2 : 1;
+	}
+	return (end < len)? end + 1 : len;
+}
+
+/**
+ * @brief Prints generated text to (f) with names renamed for prefix (WriteRenamedName).
+ * Literals are printed as they are, comments and #include lines have only
+ * GEN_ names renamed: texts of messages and names of grammar in them don't change.
+ *
+ * @param f       Output file.
+ * @param txt     Generated text.
+ * @param len     Length of text.
+ * @param names   Names to rename.
+ */
+static void WriteRenamed(FILE *f, const char *txt, size_t len, const PrefixNames *names)
+{
+	assert(f     != NULL && "Null param");
+	assert(txt   != NULL && "Null param");
+	assert(names != NULL && "Null param");
+
+	if (strcmp(names->prefix, "GEN") == 0) {
+		fwrite(txt, sizeof(char), len, f);
+		return;
+	}
+
+	// End of comment or of #include line: it's names aren't names of code.
+	size_t text_end   = 0;
+	bool   line_start = true;
+	size_t cur_symbol = 0;
+	while (cur_symbol < len) {
+		char c = txt[cur_symbol];
+		if (IsNameSymbol(c)) {
+			size_t end = cur_symbol;
+			while (end < len && IsNameSymbol(txt[end])) {
+				++end;
+			}
+			WriteRenamedName(f, txt + cur_symbol, end - cur_symbol, names, cur_symbol >= text_end);
+			line_start = false;
+			cur_symbol = end;
+			continue;
+		}
+
+		size_t end = cur_symbol + 1;
+		if (cur_symbol >= text_end) {
+			if (c == '"' || c == '\'') {
+				end = LiteralEnd(txt, len, cur_symbol);
+			} else if (c == '/' && end < len && txt[end] == '/') {
+				const char *line_end = memchr(txt + end, '\n', len - end);
+				text_end = (line_end != NULL)? (size_t)(line_end - txt) : len;
+			} else if (c == '/' && end < len && txt[end] == '*') {
+				text_end = end + 1;
+				while (text_end + 1 < len && !(txt[text_end] == '*' && txt[text_end + 1] == '/')) {
+					++text_end;
+				}
+			} else if (c == '#' && line_start && len - cur_symbol > 8 && strncmp(txt + cur_symbol, "#include", 8) == 0) {
+				const char *line_end = memchr(txt + end, '\n', len - end);
+				text_end = (line_end != NULL)? (size_t)(line_end - txt) : len;
+			}
+		}
+		line_start = (c == '\n') || (line_start && (c == ' ' || c == '\t'));
+		fwrite(txt + cur_symbol, sizeof(char), end - cur_symbol, f);
+		cur_symbol = end;
+	}
+}
+
+/**
+ * @returns   true if file (file_name) has text (txt) of (len) bytes.
+ */
+static bool FileHasText(const char *file_name, const char *txt, size_t len)
+{
+	SourceText old = GetSourceText(file_name);
+	if (old.txt == NULL) {
+		return false;
+	}
+	bool same = (old.len == len && memcmp(old.txt, txt, len) == 0);
+	FreeSourceText(&old);
+	return same;
+}
+
+/**
+ * @brief Writes generated texts to (out_dir)/(pattern), where %s of
+ * (pattern) is prefix of names. Renamed text is made in memory and file
+ * is replaced only if it's text is changed, so build of out/ doesn't
+ * recompile unchanged files. New text is written to temporary file
+ * which is renamed to (pattern): file is never half-written.
+ *
+ * @param options    Options of generator.
+ * @param names      Prefix and names to rename.
+ * @param pattern    Name of file, for example "Parser_%s.c".
+ * @param prelude    Text before generated texts or NULL.
+ * @param texts      Generated texts.
+ * @param lens       Lengths of texts.
+ * @param n_texts    Number of texts.
+ * @returns          false if file can't be written.
+ */
+static bool WriteGeneratedFile
+	(const GeneratorOptions *options, const PrefixNames *names, const char *pattern, const char *prelude,
+	char **texts, size_t *lens, size_t n_texts)
+{
+	assert(options != NULL && "Null param");
+	assert(names   != NULL && "Null param");
+	assert(pattern != NULL && "Null param");
+	assert(texts   != NULL && "Null param");
+	assert(lens    != NULL && "Null param");
+
+	const char *prefix  = names->prefix;
+	const char *out_dir = (options->out_dir != NULL)? options->out_dir : "../out";
+
+	char  *txt = NULL;
+	size_t len = 0;
+	FILE  *f   = open_memstream(&txt, &len);
+	assert(f != NULL && "Null open_memstream allocation");
+	if (prelude != NULL) {
+		WriteRenamed(f, prelude, strlen(prelude), names);
+	}
+	for (size_t cur_text = 0; cur_text < n_texts; ++cur_text) {
+		WriteRenamed(f, texts[cur_text], lens[cur_text], names);
+	}
+	fclose(f);
+
+	size_t name_len  = strlen(out_dir) + strlen(pattern) + strlen(prefix) + 2;
+	char  *file_name = (char *)calloc(name_len, sizeof(char));
+	// Temporary file: name of file with pid of generator.
+	char  *tmp_name  = (char *)calloc(name_len + 32, sizeof(char));
+	assert(file_name != NULL && tmp_name != NULL && "Null calloc allocation");
+	sprintf(file_name, "%s/", out_dir);
+	sprintf(file_name + strlen(file_name), pattern, prefix);
+	sprintf(tmp_name, "%s.%ld.tmp", file_name, (long)getpid());
+
+	bool ok = true;
+	if (FileHasText(file_name, txt, len)) {
+		msg(D_PARSER_GENERATING, M,
+			"%s isn't changed\n", file_name);
+	} else {
+		f  = fopen(tmp_name, "w");
+		ok = (f != NULL);
+		if (ok) {
+			fwrite(txt, sizeof(char), len, f);
+			ok = (ferror(f) == 0);
+			ok = (fclose(f) == 0) && ok;
+			ok = ok && rename(tmp_name, file_name) == 0;
+			if (!ok) {
+				remove(tmp_name);
+			}
+		}
+		if (!ok) {
+			printf("Can't write: %s\n", file_name);
+		}
+	}
+
+	free(tmp_name);
+	free(file_name);
+	free(txt);
+	return ok;
+}
+
+/**
+ * @brief Main function to generate
+ * parser's files to parser the program.
+ * 
+ * @param s          Sequence of tokens.
+ * @param n_tokens   Number of tokens in token's sequence
+ * collected from tokenizer of YACC-file.
+ * @param options    Options of generator.
+ * @returns          false if precedence of operators or %parallel_unit is wrong
+ *                   or some file can't be written.
+ */
+bool GenerateFiles(Token *s, uint64_t n_tokens, const GeneratorOptions *options)
+{
+	assert(s       != NULL && "Null param");
+	assert(options != NULL && "Null param");
+
+	// Create trees with fictive root-node.
+	Tree *tokenizer_tree = TreeCtor(TOKENIZER_TREE);
+	Tree *parser_tree    = TreeCtor(PARSER_TREE);
+
+	// Generate tokenizer's and parser's tree.
+	GenerateTrees(parser_tree, tokenizer_tree, s, n_tokens);
 
 	NameTable *tokenizer_table = ScanTokenizerNames(tokenizer_tree);
 	NameTable *parser_table    = ScanParserNames(parser_tree, tokenizer_table);
+	if (!CheckEmptyOptions(parser_table)) {
+		NameTableDtor(parser_table);
+		NameTableDtor(tokenizer_table);
+		return false;
+	}
+	FoldListRules(parser_table);
+	Precedence *precedence     = ScanPrecedence(tokenizer_tree, tokenizer_table, parser_table);
+	if (precedence != NULL && precedence->n_climbing > 0 && options->backend == BACKEND_TABLE) {
+		printf("Precedence of operators needs --backend=recursive\n");
+		PrecedenceDtor(precedence);
+		precedence = NULL;
+	}
+	ParallelUnit *parallel = (precedence != NULL)? ScanParallelUnit(tokenizer_table, parser_table) : NULL;
+	if (precedence == NULL || parallel == NULL) {
+		if (precedence != NULL) {
+			PrecedenceDtor(precedence);
+		}
+		NameTableDtor(parser_table);
+		NameTableDtor(tokenizer_table);
+		return false;
+	}
+
+	//  Files are generated in memory: names are renamed for
+	// prefix and texts are joined only when they are written.
+	enum {kHeaderText, kTokenizerText, kTreeText, kParserText, kNumberOfTexts};
+	char  *texts[kNumberOfTexts] = {0};
+	size_t lens[kNumberOfTexts]  = {0};
+	FILE  *files[kNumberOfTexts] = {0};
+	for (int cur_text = 0; cur_text < kNumberOfTexts; ++cur_text) {
+		files[cur_text] = open_memstream(&texts[cur_text], &lens[cur_text]);
+		assert(files[cur_text] != NULL && "Null open_memstream allocation");
+	}
+	FILE *lib_header = files[kHeaderText];
+
+	//  After tree generation
+	// generator should generate tokenizer file.
+	// it will contain 
+	GenerateTokenizerFile(tokenizer_tree, tokenizer_table, lib_header, files[kTokenizerText], parser_table);
+	GenerateTreeFile(lib_header, files[kTreeText]);
+
+	if (options->backend == BACKEND_TABLE) {
+		GenerateTableParserFile(tokenizer_table, parser_table, lib_header, files[kParserText], parallel, options);
+	} else {
+		GenerateParserFile(parser_tree, tokenizer_table, parser_table, lib_header, files[kParserText],
+			precedence, parallel, options);
+	}
+	DebugTree(parser_tree);
+
+	for (int cur_text = 0; cur_text < kNumberOfTexts; ++cur_text) {
+		fclose(files[cur_text]);
+	}
+
+	PrefixNames names = {(options->prefix != NULL)? options->prefix : "GEN", tokenizer_table, parser_table};
+	bool ok = WriteGeneratedFile(options, &names, "lib_%s.h", NULL, &texts[kHeaderText], &lens[kHeaderText], 1);
+	if (options->amalgamate) {
+		// One translation unit: compiler sees all the helpers at calls of parser.
+		ok = WriteGeneratedFile(options, &names, "lib_%s.c", "#define GEN_INTERNAL static\n\n",
+			&texts[kTokenizerText], &lens[kTokenizerText], 3) && ok;
+	} else {
+		ok = WriteGeneratedFile(options, &names, "Tokenizer_%s.c", NULL, &texts[kTokenizerText], &lens[kTokenizerText], 1) && ok;
+		ok = WriteGeneratedFile(options, &names, "Tree_%s.c",      NULL, &texts[kTreeText],      &lens[kTreeText],      1) && ok;
+		ok = WriteGeneratedFile(options, &names, "Parser_%s.c",    NULL, &texts[kParserText],    &lens[kParserText],    1) && ok;
+	}
 
-	FILE *lib_header = fopen("../out/lib_GEN.h", "w");
+	for (int cur_text = 0; cur_text < kNumberOfTexts; ++cur_text) {
+		free(texts[cur_text]);
+	}
+	ParallelUnitDtor(parallel);
+	PrecedenceDtor(precedence);
+	NameTableDtor(parser_table);
+	NameTableDtor(tokenizer_table);
+	return ok;
+}
+// Synthetic corpus. -------------------------------------------------------------------
 
-	//  After tree generation
-	// generator should generate tokenizer file.
-	// it will contain 
-	GenerateTokenizerFile(tokenizer_tree, tokenizer_table, lib_header, parser_table);
-	GenerateTreeFile(lib_header);
+/// Cost of rule which can't be derived to tokens.
+static const uint64_t kInfiniteCost = UINT64_MAX;
+/// Repetitions of symbol which continues corpus: it's repeated until corpus has it's size.
+static const uint64_t kSpineRepeat  = UINT64_MAX;
 
-	GenerateParserFile(parser_tree, tokenizer_table, lib_header);
-	DebugTree(parser_tree);
+/// Option of rule in synthetic corpus.
+typedef struct CorpusOption
+{
+	// First symbol of option.
+	Node     *chain;
+	uint64_t  weight;
+	// Minimal number of tokens and minimal nesting of rules of option's derivation.
+	uint64_t  tokens;
+	uint64_t  depth;
+	// Symbol which makes corpus longer (spine) or NULL: reference to the rule at the end
+	// of option, repeated symbol or reference to recursive rule.
+	Node     *spine;
+} CorpusOption;
+
+/// Rule of grammar in synthetic corpus.
+typedef struct CorpusRule
+{
+	CorpusOption *options;
+	uint64_t      n_options;
+	// Minimal costs of options.
+	uint64_t      tokens;
+	uint64_t      depth;
+	// Rule can be derived to itself.
+	bool          recursive;
+} CorpusRule;
+
+/// Option of rule which is derived now.
+typedef struct CorpusFrame
+{
+	uint64_t  rule;
+	// Current symbol of option.
+	Node     *symbol;
+	// Spine of option if rule is on spine of corpus or NULL.
+	Node     *spine;
+	// Repetitions of (symbol) which aren't derived yet.
+	uint64_t  left;
+	uint64_t  depth;
+	// Operands of rule parsed by precedence climbing have operator of %nonassoc.
+	bool      nonassoc;
+} CorpusFrame;
+
+/// State of generator of synthetic corpus.
+typedef struct CorpusGenerator
+{
+	const CorpusOptions *options;
+	NameTable  *tokenizer_table;
+	NameTable  *parser_table;
+	Precedence *precedence;
+	CorpusRule *rules;
+	// Automaton of lexer and token type node of each it's rule.
+	LexerDfa   *dfa;
+	Node      **types;
+	size_t      n_lexer_rules;
+	// Lexer's rule of each name of tokenizer's table or (kUndefinedIdx).
+	int64_t    *lexer_rule;
+	// Token with text "EOF" or NULL: it's end of text and isn't written.
+	Node       *eof;
+	// Distances from states of automaton to states which accept lexer's rule, computed at first use.
+	uint64_t  **distance;
+	// Bytes of words of each class of automaton: class_bytes[class_start[class]..class_start[class + 1]).
+	uint8_t     class_bytes[256];
+	size_t     *class_start;
+	bool        white_space[256];
+	// White space which separates tokens by default or -1 if grammar hasn't white space.
+	int         default_white;
+	// Synthesized word.
+	char       *word;
+	uint64_t    random;
+	FILE       *out;
+	uint64_t    bytes;
+	uint64_t    tokens;
+	uint64_t    line_len;
+	// State of automaton after last token.
+	uint32_t    last_state;
+} CorpusGenerator;
+
+/// @returns   Next number of splitmix64 generator.
+static uint64_t CorpusRandom(CorpusGenerator *gen)
+{
+	uint64_t z = (gen->random += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/// @returns   (first + second) or (kInfiniteCost) if it overflows.
+static uint64_t SaturatedAdd(uint64_t first, uint64_t second)
+{
+	return (first > kInfiniteCost - second)? kInfiniteCost : first + second;
+}
+
+/// @returns   Next symbol of option or NULL.
+static Node *NextSymbol(Node *chain)
+{
+	return (chain->children != NULL)? GetChild(chain, 0) : NULL;
+}
+
+/// @returns   true if corpus has size of (--size) or (--tokens).
+static bool CorpusFinished(const CorpusGenerator *gen)
+{
+	return (gen->options->tokens != 0)?
+		gen->tokens >= gen->options->tokens : gen->bytes >= gen->options->size;
+}
+
+/// @returns   true if symbol is reference to rule (rule) at the end of it's option: list continues.
+static bool IsListTail(CorpusGenerator *gen, Node *symbol, uint64_t rule)
+{
+	return symbol->children == NULL && symbol->token->repeat == REPEAT_ONCE &&
+		ChainRule(gen->parser_table, symbol) == (int64_t)rule;
+}
+
+/**
+ * @brief Finds options of rules and checks their symbols: each of them
+ * should be rule or token which lexer can match. Weights of options are 1.
+ *
+ * @returns   false if some symbol is unknown.
+ */
+static bool CollectCorpusRules(CorpusGenerator *gen)
+{
+	NameTable *parser_table = gen->parser_table;
+	gen->rules = (CorpusRule *)calloc(parser_table->size + 1, sizeof(CorpusRule));
+	assert(gen->rules != NULL && "Null calloc allocation");
+
+	for (uint64_t cur_rule = 0; cur_rule < parser_table->size; ++cur_rule) {
+		Node       *fork = GetChild(parser_table->names[cur_rule], 0);
+		CorpusRule *rule = &gen->rules[cur_rule];
+		rule->n_options = (fork->children != NULL)? fork->children->size : 0;
+		rule->options   = (CorpusOption *)calloc(rule->n_options + 1, sizeof(CorpusOption));
+		assert(rule->options != NULL && "Null calloc allocation");
+		rule->tokens = kInfiniteCost;
+		rule->depth  = kInfiniteCost;
+
+		for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+			CorpusOption *option = &rule->options[cur_option];
+			option->chain  = GetChild(fork, cur_option);
+			option->weight = 1;
+			for (Node *chain = option->chain; chain != NULL; chain = NextSymbol(chain)) {
+				if (ChainRule(parser_table, chain) != kUndefinedIdx) {
+					continue;
+				}
+				int64_t token_idx = SearchInTable(chain, gen->tokenizer_table);
+				if (token_idx == kUndefinedIdx || (gen->tokenizer_table->names[token_idx] != gen->eof &&
+						gen->lexer_rule[token_idx] == kUndefinedIdx)) {
+					printf("Rule (%.*s) has unknown symbol: %.*s\n",
+						NODE_TXT(parser_table->names[cur_rule]), NODE_TXT(chain));
+					return false;
+				}
+			}
+		}
+
+		const bool *operators = gen->precedence->operators + cur_rule * gen->tokenizer_table->size;
+		for (uint64_t cur_token = 0; cur_token < gen->tokenizer_table->size; ++cur_token) {
+			if (operators[cur_token] && gen->lexer_rule[cur_token] == kUndefinedIdx) {
+				printf("Rule (%.*s) has unknown operator: %.*s\n",
+					NODE_TXT(parser_table->names[cur_rule]), NODE_TXT(gen->tokenizer_table->names[cur_token]));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Computes minimal number of tokens and minimal nesting of each option
+ * and rule by iterations until nothing changes. Symbols (symbol*) cost nothing,
+ * reference which continues list isn't nested.
+ */
+static void CorpusCosts(CorpusGenerator *gen)
+{
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (uint64_t cur_rule = 0; cur_rule < gen->parser_table->size; ++cur_rule) {
+			CorpusRule *rule = &gen->rules[cur_rule];
+			for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+				CorpusOption *option = &rule->options[cur_option];
+				uint64_t tokens = 0;
+				uint64_t nested = 0;
+				uint64_t depth  = 0;
+				for (Node *chain = option->chain; chain != NULL; chain = NextSymbol(chain)) {
+					if (chain->token->repeat == REPEAT_STAR) {
+						continue;
+					}
+					int64_t symbol_rule = ChainRule(gen->parser_table, chain);
+					if (symbol_rule == kUndefinedIdx) {
+						int64_t token_idx = SearchInTable(chain, gen->tokenizer_table);
+						tokens = SaturatedAdd(tokens, (gen->tokenizer_table->names[token_idx] == gen->eof)? 0 : 1);
+						continue;
+					}
+
+					CorpusRule *symbol = &gen->rules[symbol_rule];
+					tokens = SaturatedAdd(tokens, symbol->tokens);
+					if (IsListTail(gen, chain, cur_rule)) {
+						depth  = (symbol->depth > depth)? symbol->depth : depth;
+					} else {
+						nested = (symbol->depth > nested)? symbol->depth : nested;
+					}
+				}
+				nested = SaturatedAdd(nested, 1);
+				option->tokens = tokens;
+				option->depth  = (nested > depth)? nested : depth;
+
+				if (option->tokens < rule->tokens) {
+					rule->tokens = option->tokens;
+					changed = true;
+				}
+				if (option->depth < rule->depth) {
+					rule->depth = option->depth;
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Finds recursive rules by transitive closure of references
+ * and spine of each option.
+ */
+static void CorpusSpines(CorpusGenerator *gen)
+{
+	uint64_t n_rules = gen->parser_table->size;
+	bool *reach = (bool *)calloc(n_rules * n_rules + 1, sizeof(bool));
+	assert(reach != NULL && "Null calloc allocation");
+
+	for (uint64_t cur_rule = 0; cur_rule < n_rules; ++cur_rule) {
+		CorpusRule *rule = &gen->rules[cur_rule];
+		for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+			for (Node *chain = rule->options[cur_option].chain; chain != NULL; chain = NextSymbol(chain)) {
+				int64_t symbol_rule = ChainRule(gen->parser_table, chain);
+				if (symbol_rule != kUndefinedIdx) {
+					reach[cur_rule * n_rules + (uint64_t)symbol_rule] = true;
+				}
+			}
+		}
+	}
+	for (uint64_t middle = 0; middle < n_rules; ++middle) {
+		for (uint64_t from = 0; from < n_rules; ++from) {
+			if (!reach[from * n_rules + middle]) {
+				continue;
+			}
+			for (uint64_t to = 0; to < n_rules; ++to) {
+				reach[from * n_rules + to] |= reach[middle * n_rules + to];
+			}
+		}
+	}
+
+	for (uint64_t cur_rule = 0; cur_rule < n_rules; ++cur_rule) {
+		gen->rules[cur_rule].recursive = reach[cur_rule * n_rules + cur_rule];
+	}
+	for (uint64_t cur_rule = 0; cur_rule < n_rules; ++cur_rule) {
+		CorpusRule *rule = &gen->rules[cur_rule];
+		for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+			CorpusOption *option    = &rule->options[cur_option];
+			Node         *repeated  = NULL;
+			Node         *recursive = NULL;
+			for (Node *chain = option->chain; chain != NULL; chain = NextSymbol(chain)) {
+				int64_t symbol_rule = ChainRule(gen->parser_table, chain);
+				if (IsListTail(gen, chain, cur_rule)) {
+					option->spine = chain;
+				} else if (repeated == NULL && chain->token->repeat != REPEAT_ONCE) {
+					repeated = chain;
+				} else if (recursive == NULL && symbol_rule != kUndefinedIdx &&
+						gen->rules[symbol_rule].recursive) {
+					recursive = chain;
+				}
+			}
+			if (option->spine == NULL) {
+				option->spine = (repeated != NULL)? repeated : recursive;
+			}
+		}
+	}
+	free(reach);
+}
+
+/**
+ * @brief Reads weights of options: "rule:w1,w2,..." with weight of each option.
+ *
+ * @returns   false if some weight is wrong.
+ */
+static bool ReadCorpusWeights(CorpusGenerator *gen)
+{
+	for (size_t cur_weight = 0; cur_weight < gen->options->n_weights; ++cur_weight) {
+		const char *txt   = gen->options->weights[cur_weight];
+		const char *colon = strchr(txt, ':');
+		if (colon == NULL) {
+			printf("--weight must be rule:w1,w2,...: %s\n", txt);
+			return false;
+		}
+		int64_t rule_idx = gen->parser_table->slots[FindSlot(gen->parser_table, txt, (size_t)(colon - txt))];
+		if (rule_idx == kUndefinedIdx) {
+			printf("--weight of unknown rule: %.*s\n", (int)(colon - txt), txt);
+			return false;
+		}
+
+		CorpusRule *rule    = &gen->rules[rule_idx];
+		const char *cur_sym = colon + 1;
+		for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+			char *end = NULL;
+			rule->options[cur_option].weight = strtoull(cur_sym, &end, 10);
+			bool separated = (cur_option + 1 == rule->n_options)? *end == '\0' : *end == ',';
+			if (end == cur_sym || !isdigit((unsigned char)*cur_sym) || !separated) {
+				printf("--weight of rule (%.*s) must have %lu numbers: %s\n",
+					(int)(colon - txt), txt, rule->n_options, txt);
+				return false;
+			}
+			cur_sym = end + 1;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Groups bytes by classes of automaton. Words are made of printable
+ * bytes, other bytes (except white space) are used only by classes without them.
+ */
+static void CorpusClassBytes(CorpusGenerator *gen)
+{
+	const LexerDfa *dfa = gen->dfa;
+	gen->class_start = (size_t *)calloc(dfa->n_classes + 1, sizeof(size_t));
+	assert(gen->class_start != NULL && "Null calloc allocation");
+
+	size_t n_bytes = 0;
+	for (size_t cur_class = 0; cur_class < dfa->n_classes; ++cur_class) {
+		gen->class_start[cur_class] = n_bytes;
+		for (int printable = 1; printable >= 0 && n_bytes == gen->class_start[cur_class]; --printable) {
+			for (size_t c = 1; c < 256; ++c) {
+				if (dfa->byte_class[c] == cur_class && !gen->white_space[c] &&
+						(isgraph((int)c) != 0) == (printable == 1)) {
+					gen->class_bytes[n_bytes++] = (uint8_t)c;
+				}
+			}
+		}
+	}
+	gen->class_start[dfa->n_classes] = n_bytes;
+}
+
+/**
+ * @returns   Distances from states of automaton to states which accept (lexer_rule)
+ * or (kInfiniteCost) if there is no way. They are computed once for each rule.
+ */
+static const uint64_t *CorpusDistance(CorpusGenerator *gen, size_t lexer_rule)
+{
+	if (gen->distance[lexer_rule] != NULL) {
+		return gen->distance[lexer_rule];
+	}
+
+	const LexerDfa *dfa = gen->dfa;
+	uint64_t *distance = (uint64_t *)calloc(dfa->n_states, sizeof(uint64_t));
+	assert(distance != NULL && "Null calloc allocation");
+	for (size_t state = 0; state < dfa->n_states; ++state) {
+		distance[state] = (dfa->accept[state] == (int64_t)lexer_rule)? 0 : kInfiniteCost;
+	}
+
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (size_t state = 0; state < dfa->n_states; ++state) {
+			for (size_t cur_class = 0; cur_class < dfa->n_classes; ++cur_class) {
+				uint32_t next = dfa->next[state * dfa->n_classes + cur_class];
+				if (next == kLexerDeadState || distance[next] == kInfiniteCost ||
+						gen->class_start[cur_class] == gen->class_start[cur_class + 1] ||
+						distance[next] + 1 >= distance[state]) {
+					continue;
+				}
+				distance[state] = distance[next] + 1;
+				changed = true;
+			}
+		}
+	}
+
+	gen->distance[lexer_rule] = distance;
+	return distance;
+}
+
+/**
+ * @brief Synthesizes word of lexer's rule by random walk on lexer's automaton. Walk goes
+ * only to states from which the rule can be accepted and ends in state which accepts it,
+ * so synthesized name isn't keyword. After random length walk goes by the shortest way.
+ *
+ * @param gen          Generator.
+ * @param lexer_rule   Lexer's rule.
+ * @param state        Output: state of automaton after word.
+ * @returns            Length of word in (gen->word) or 0 if lexer never accepts the rule.
+ */
+static size_t SynthesizeWord(CorpusGenerator *gen, size_t lexer_rule, uint32_t *state)
+{
+	const LexerDfa *dfa      = gen->dfa;
+	const uint64_t *distance = CorpusDistance(gen, lexer_rule);
+
+	uint32_t cur_state = kLexerStartState;
+	uint64_t target    = 1 + CorpusRandom(gen) % kMaxCorpusWordLen;
+	size_t   len       = 0;
+	while (true) {
+		bool accepted = (len > 0 && dfa->accept[cur_state] == (int64_t)lexer_rule);
+		if (accepted && len >= target) {
+			break;
+		}
+
+		// Next byte is chosen by reservoir sampling of classes weighted by their bytes.
+		size_t n_next = 0;
+		size_t chosen = 0;
+		for (size_t cur_class = 0; cur_class < dfa->n_classes; ++cur_class) {
+			uint32_t next = dfa->next[cur_state * dfa->n_classes + cur_class];
+			if (next == kLexerDeadState || distance[next] == kInfiniteCost ||
+					gen->class_start[cur_class] == gen->class_start[cur_class + 1] ||
+					(len >= target && distance[next] >= distance[cur_state])) {
+				continue;
+			}
+			size_t n_bytes = gen->class_start[cur_class + 1] - gen->class_start[cur_class];
+			n_next += n_bytes;
+			if (CorpusRandom(gen) % n_next < n_bytes) {
+				chosen = cur_class;
+			}
+		}
+		if (n_next == 0) {
+			if (accepted) {
+				break;
+			}
+			return 0;
+		}
+
+		size_t n_bytes = gen->class_start[chosen + 1] - gen->class_start[chosen];
+		gen->word[len++] = (char)gen->class_bytes[gen->class_start[chosen] + CorpusRandom(gen) % n_bytes];
+		cur_state = dfa->next[cur_state * dfa->n_classes + chosen];
+	}
+
+	*state = cur_state;
+	return len;
+}
+
+/// @returns   true if automaton in (state) stops at byte (c): token ends before it.
+static bool CorpusTokenEnds(const CorpusGenerator *gen, uint32_t state, unsigned char c)
+{
+	const LexerDfa *dfa = gen->dfa;
+	return dfa->next[state * dfa->n_classes + dfa->byte_class[c]] == kLexerDeadState;
+}
 
-	fclose(lib_header);
-}
\ No newline at end of file
+/**
+ * @returns   White space which ends token in (state) of automaton or -1.
+ * New line is chosen when line is long.
+ */
+static int CorpusSeparator(const CorpusGenerator *gen, uint32_t state)
+{
+	if (gen->line_len >= kCorpusLineLen && gen->white_space['\n'] && CorpusTokenEnds(gen, state, '\n')) {
+		return '\n';
+	}
+	if (gen->white_space[' '] && CorpusTokenEnds(gen, state, ' ')) {
+		return ' ';
+	}
+	for (int c = 0; c < 256; ++c) {
+		if (gen->white_space[c] && CorpusTokenEnds(gen, state, (unsigned char)c)) {
+			return c;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Writes token (token_idx) of tokenizer's table to corpus after white space.
+ * Word is synthesized again if lexer wouldn't end it before white space (or before
+ * next token in grammar without white space).
+ *
+ * @returns   false if token can't be synthesized.
+ */
+static bool WriteCorpusToken(CorpusGenerator *gen, int64_t token_idx)
+{
+	Node *name = gen->tokenizer_table->names[token_idx];
+	if (name == gen->eof) {
+		return true;
+	}
+
+	size_t   lexer_rule = (size_t)gen->lexer_rule[token_idx];
+	size_t   len        = 0;
+	uint32_t state      = kLexerDeadState;
+	for (size_t cur_try = 0; cur_try < kMaxCorpusWordTries; ++cur_try) {
+		len = SynthesizeWord(gen, lexer_rule, &state);
+		if (len == 0) {
+			printf("Token (%.*s) can't be synthesized: lexer never matches it\n", NODE_TXT(name));
+			return false;
+		}
+
+		bool separated = (gen->default_white < 0 || CorpusSeparator(gen, state) >= 0);
+		bool joined    = (gen->default_white >= 0 || gen->tokens == 0 ||
+			CorpusTokenEnds(gen, gen->last_state, (unsigned char)gen->word[0]));
+		if (separated && joined) {
+			break;
+		}
+	}
+
+	if (gen->tokens > 0 && gen->default_white >= 0) {
+		int separator = CorpusSeparator(gen, gen->last_state);
+		separator = (separator < 0)? gen->default_white : separator;
+		fputc(separator, gen->out);
+		++gen->bytes;
+		gen->line_len = (separator == '\n')? 0 : gen->line_len + 1;
+	}
+	fwrite(gen->word, sizeof(char), len, gen->out);
+	gen->bytes      += len;
+	gen->line_len   += len;
+	gen->last_state  = state;
+	++gen->tokens;
+	return true;
+}
+
+/**
+ * @brief Chooses option of rule by weights among options which fit into (--max-depth),
+ * on spine of corpus options which make it longer are preferred.
+ * After corpus has it's size option with the least tokens is chosen.
+ *
+ * @returns   Index of option.
+ */
+static uint64_t ChooseCorpusOption(CorpusGenerator *gen, uint64_t rule_idx, uint64_t depth, bool spine)
+{
+	CorpusRule *rule     = &gen->rules[rule_idx];
+	bool        finished = CorpusFinished(gen);
+	uint64_t    smallest = 0;
+	for (uint64_t cur_option = 1; cur_option < rule->n_options; ++cur_option) {
+		CorpusOption *option = &rule->options[cur_option];
+		CorpusOption *best   = &rule->options[smallest];
+		bool smaller = (finished)?
+			option->tokens < best->tokens || (option->tokens == best->tokens && option->depth < best->depth) :
+			option->depth  < best->depth  || (option->depth  == best->depth  && option->tokens < best->tokens);
+		smallest = (smaller)? cur_option : smallest;
+	}
+	if (finished) {
+		return smallest;
+	}
+
+	bool grow = false;
+	for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+		CorpusOption *option = &rule->options[cur_option];
+		grow |= spine && option->spine != NULL && option->weight > 0 &&
+			SaturatedAdd(depth, option->depth) <= gen->options->max_depth;
+	}
+
+	uint64_t total = 0;
+	for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+		CorpusOption *option = &rule->options[cur_option];
+		if ((!grow || option->spine != NULL) && SaturatedAdd(depth, option->depth) <= gen->options->max_depth) {
+			total = SaturatedAdd(total, option->weight);
+		}
+	}
+	if (total == 0) {
+		return smallest;
+	}
+
+	uint64_t point = CorpusRandom(gen) % total;
+	for (uint64_t cur_option = 0; cur_option < rule->n_options; ++cur_option) {
+		CorpusOption *option = &rule->options[cur_option];
+		if ((!grow || option->spine != NULL) && SaturatedAdd(depth, option->depth) <= gen->options->max_depth) {
+			if (point < option->weight) {
+				return cur_option;
+			}
+			point -= option->weight;
+		}
+	}
+	return smallest;
+}
+
+/**
+ * @returns   Number of repetitions of (symbol) in option of rule at (depth):
+ * random for (symbol*) and (symbol+), spine is repeated until corpus has it's size.
+ */
+static uint64_t CorpusRepetitions(CorpusGenerator *gen, Node *symbol, uint64_t depth, Node *spine)
+{
+	SymbolRepeat repeat = symbol->token->repeat;
+	if (repeat != REPEAT_STAR && repeat != REPEAT_PLUS) {
+		return 1;
+	}
+
+	uint64_t least = (repeat == REPEAT_PLUS)? 1 : 0;
+	if (CorpusFinished(gen)) {
+		return least;
+	}
+	if (symbol == spine) {
+		return kSpineRepeat;
+	}
+	int64_t symbol_rule = ChainRule(gen->parser_table, symbol);
+	if (symbol_rule != kUndefinedIdx &&
+			SaturatedAdd(depth + 1, gen->rules[symbol_rule].depth) > gen->options->max_depth) {
+		return least;
+	}
+
+	uint64_t n_repeats = least;
+	while (CorpusRandom(gen) % 2 == 0) {
+		++n_repeats;
+	}
+	return n_repeats;
+}
+
+/// @brief Starts option of rule of (frame) which is chosen by ChooseCorpusOption.
+static void StartCorpusOption(CorpusGenerator *gen, CorpusFrame *frame, bool spine)
+{
+	CorpusOption *option = &gen->rules[frame->rule].options[ChooseCorpusOption(gen, frame->rule, frame->depth, spine)];
+	frame->symbol = option->chain;
+	frame->spine  = (spine)? option->spine : NULL;
+	frame->left   = CorpusRepetitions(gen, frame->symbol, frame->depth, frame->spine);
+}
+
+/// @brief Pushes frame of rule (rule_idx) with chosen option to (stack).
+static void PushCorpusRule(CorpusGenerator *gen, CorpusFrame **stack, size_t *size, size_t *capacity,
+	uint64_t rule_idx, uint64_t depth, bool spine)
+{
+	if (*size == *capacity) {
+		*capacity *= 2;
+		*stack = (CorpusFrame *)realloc(*stack, *capacity * sizeof(CorpusFrame));
+		assert(*stack != NULL && "Null realloc allocation");
+	}
+
+	CorpusFrame *frame = &(*stack)[(*size)++];
+	frame->rule     = rule_idx;
+	frame->depth    = depth;
+	frame->nonassoc = false;
+	StartCorpusOption(gen, frame, spine);
+}
+
+/**
+ * @brief Continues operands of rule which is parsed by precedence climbing:
+ * random operator and next operand follow operand until corpus has it's size.
+ * Operands of one frame are one chain of operators, so it has at most one
+ * operator of %nonassoc: the second one couldn't take result of the first one.
+ *
+ * @param ok   Set to false if operator can't be written.
+ * @returns    true if frame has next operand.
+ */
+static bool NextCorpusOperand(CorpusGenerator *gen, CorpusFrame *frame, bool *ok)
+{
+	const Precedence *precedence = gen->precedence;
+	if (!precedence->climbs[frame->rule] || CorpusFinished(gen) || CorpusRandom(gen) % 2 != 0) {
+		return false;
+	}
+
+	uint64_t    n_tokens  = gen->tokenizer_table->size;
+	const bool *operators = precedence->operators + frame->rule * n_tokens;
+	uint64_t    n_allowed = 0;
+	for (uint64_t cur_token = 0; cur_token < n_tokens; ++cur_token) {
+		n_allowed += operators[cur_token] && !(frame->nonassoc && precedence->assoc[cur_token] == ASSOC_NONASSOC);
+	}
+	if (n_allowed == 0) {
+		return false;
+	}
+
+	uint64_t point = CorpusRandom(gen) % n_allowed;
+	for (uint64_t cur_token = 0; cur_token < n_tokens; ++cur_token) {
+		if (!operators[cur_token] || (frame->nonassoc && precedence->assoc[cur_token] == ASSOC_NONASSOC)) {
+			continue;
+		}
+		if (point-- == 0) {
+			*ok = WriteCorpusToken(gen, (int64_t)cur_token);
+			frame->nonassoc |= (precedence->assoc[cur_token] == ASSOC_NONASSOC);
+			break;
+		}
+	}
+	StartCorpusOption(gen, frame, false);
+	return true;
+}
+
+/**
+ * @brief Derives program of start rule by stack of frames, so deep nesting
+ * doesn't overflow C stack. Last symbol of option replaces it's frame
+ * unless rule is parsed by precedence climbing.
+ *
+ * @returns   false if some token can't be written.
+ */
+static bool DeriveCorpus(CorpusGenerator *gen, uint64_t start_rule)
+{
+	size_t       size     = 0;
+	size_t       capacity = 64;
+	CorpusFrame *stack    = (CorpusFrame *)calloc(capacity, sizeof(CorpusFrame));
+	assert(stack != NULL && "Null calloc allocation");
+
+	if (gen->rules[start_rule].n_options > 0) {
+		PushCorpusRule(gen, &stack, &size, &capacity, start_rule, 0, true);
+	}
+
+	bool ok = true;
+	while (ok && size > 0) {
+		CorpusFrame *frame = &stack[size - 1];
+		if (frame->left == kSpineRepeat && CorpusFinished(gen)) {
+			frame->left = 0;
+		}
+		if (frame->left == 0) {
+			frame->symbol = NextSymbol(frame->symbol);
+			if (frame->symbol != NULL) {
+				frame->left = CorpusRepetitions(gen, frame->symbol, frame->depth, frame->spine);
+			} else if (!NextCorpusOperand(gen, frame, &ok)) {
+				--size;
+			}
+			continue;
+		}
+		if (frame->left != kSpineRepeat) {
+			--frame->left;
+		}
+
+		Node   *symbol      = frame->symbol;
+		int64_t symbol_rule = ChainRule(gen->parser_table, symbol);
+		if (symbol_rule == kUndefinedIdx) {
+			ok = WriteCorpusToken(gen, SearchInTable(symbol, gen->tokenizer_table));
+			continue;
+		}
+
+		bool     spine = (frame->spine == symbol && symbol->token->repeat == REPEAT_ONCE);
+		// Rule parsed by precedence climbing keeps it's frame for next operand.
+		bool     last  = (frame->left == 0 && symbol->children == NULL && !gen->precedence->climbs[frame->rule]);
+		uint64_t depth = IsListTail(gen, symbol, frame->rule)? frame->depth : frame->depth + 1;
+		if (last) {
+			--size;
+		}
+		if (gen->rules[symbol_rule].n_options > 0) {
+			PushCorpusRule(gen, &stack, &size, &capacity, (uint64_t)symbol_rule, depth, spine);
+		}
+	}
+
+	free(stack);
+	return ok;
+}
+
+/**
+ * @brief Writes random program of grammar to (options->out): derivations of rules
+ * as they are written (lists aren't folded) with synthesized words of regex-expressions.
+ * Program is made longer by it's spine: list of start rule or the first one below it,
+ * other options are chosen by weights, after program has (--size) or (--tokens)
+ * the shortest options end it. Tokens are separated by white space of grammar.
+ *
+ * @param s          Sequence of tokens of YACC-file.
+ * @param n_tokens   Number of tokens in sequence.
+ * @param options    Options of corpus.
+ * @returns          false if grammar can't be derived or file can't be written.
+ */
+bool GenerateCorpus(Token *s, uint64_t n_tokens, const CorpusOptions *options)
+{
+	assert(s       != NULL && "Null param");
+	assert(options != NULL && "Null param");
+
+	Tree *tokenizer_tree = TreeCtor(TOKENIZER_TREE);
+	Tree *parser_tree    = TreeCtor(PARSER_TREE);
+	GenerateTrees(parser_tree, tokenizer_tree, s, n_tokens);
+
+	CorpusGenerator gen = {0};
+	gen.options         = options;
+	gen.random          = options->seed;
+	gen.tokenizer_table = ScanTokenizerNames(tokenizer_tree);
+	gen.parser_table    = ScanParserNames(parser_tree, gen.tokenizer_table);
+	gen.precedence      = ScanPrecedence(tokenizer_tree, gen.tokenizer_table, gen.parser_table);
+	gen.eof             = EofTokenType(gen.tokenizer_table);
+
+	LexerRule *lexer_rules = CollectLexerRules(gen.tokenizer_table, &gen.types, &gen.n_lexer_rules);
+	gen.dfa        = BuildLexerDfa(lexer_rules, gen.n_lexer_rules);
+	gen.lexer_rule = (int64_t *)calloc(gen.tokenizer_table->size + 1, sizeof(int64_t));
+	gen.distance   = (uint64_t **)calloc(gen.n_lexer_rules + 1, sizeof(uint64_t *));
+	gen.word       = (char *)calloc(kMaxCorpusWordLen + gen.dfa->n_states + 1, sizeof(char));
+	assert(gen.lexer_rule != NULL && gen.distance != NULL && gen.word != NULL && "Null calloc allocation");
+	for (size_t cur_el = 0; cur_el < gen.tokenizer_table->size; ++cur_el) {
+		gen.lexer_rule[cur_el] = kUndefinedIdx;
+	}
+	for (size_t cur_rule = 0; cur_rule < gen.n_lexer_rules; ++cur_rule) {
+		gen.lexer_rule[SearchInTable(gen.types[cur_rule], gen.tokenizer_table)] = (int64_t)cur_rule;
+	}
+
+	PhonySymbols(gen.tokenizer_table, "white_space", gen.white_space);
+	gen.default_white = -1;
+	for (int c = 255; c >= 0; --c) {
+		gen.default_white = (gen.white_space[c])? c : gen.default_white;
+	}
+	gen.default_white = (gen.white_space[' '])? ' ' : gen.default_white;
+	CorpusClassBytes(&gen);
+
+	int64_t start_rule = kUndefinedIdx;
+	int64_t start_idx  = FindName(gen.tokenizer_table, "start");
+	if (start_idx == kUndefinedIdx) {
+		printf("Grammar has no %%start rule\n");
+	} else {
+		Node *start = VariableValue(gen.tokenizer_table->names[start_idx]);
+		start_rule  = gen.parser_table->slots[FindSlot(gen.parser_table, GetTxt(start), GetLen(start))];
+		if (start_rule == kUndefinedIdx) {
+			printf("Unknown start rule: %.*s\n", NODE_TXT(start));
+		}
+	}
+
+	bool ok = (start_rule != kUndefinedIdx) && gen.precedence != NULL &&
+		CollectCorpusRules(&gen) && ReadCorpusWeights(&gen);
+	if (ok) {
+		CorpusCosts(&gen);
+		CorpusSpines(&gen);
+		gen.out = fopen(options->out, "w");
+		if (gen.out == NULL) {
+			printf("Can't write: %s\n", options->out);
+			ok = false;
+		}
+	}
+	if (gen.out != NULL) {
+		ok = DeriveCorpus(&gen, (uint64_t)start_rule);
+		fputc('\n', gen.out);
+		bool written = (ferror(gen.out) == 0);
+		written = (fclose(gen.out) == 0) && written;
+		if (!written) {
+			printf("Can't write: %s\n", options->out);
+		}
+		ok = ok && written;
+	}
+	if (ok) {
+		msg(D_PARSER_GENERATING, M,
+			"Corpus %s: %lu bytes, %lu tokens\n", options->out, gen.bytes, gen.tokens);
+	}
+
+	for (size_t cur_rule = 0; cur_rule < gen.n_lexer_rules; ++cur_rule) {
+		free(gen.distance[cur_rule]);
+	}
+	for (uint64_t cur_rule = 0; gen.rules != NULL && cur_rule < gen.parser_table->size; ++cur_rule) {
+		free(gen.rules[cur_rule].options);
+	}
+	free(gen.rules);
+	free(gen.distance);
+	free(gen.lexer_rule);
+	free(gen.class_start);
+	free(gen.word);
+	free(gen.types);
+	free(lexer_rules);
+	LexerDfaDtor(gen.dfa);
+	if (gen.precedence != NULL) {
+		PrecedenceDtor(gen.precedence);
+	}
+	NameTableDtor(gen.parser_table);
+	NameTableDtor(gen.tokenizer_table);
+	return ok;
+}
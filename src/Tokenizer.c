@@ -29,6 +29,20 @@ typedef struct StableWord
   TokenType   type;
 } StableWord;
 
+/**
+ * @brief Growable sequence of tokens which
+ * is filled by tokenizer.
+ */
+typedef struct TokenSequence
+{
+  // Array of tokens.
+  Token    *tokens;
+  // Number of pushed tokens.
+  uint64_t  size;
+  // Number of allocated tokens.
+  uint64_t  capacity;
+} TokenSequence;
+
 #define kEofTokenTxt "EOF"
 static const size_t kEofTokenLength = 3;
 
@@ -43,19 +57,53 @@ static const StableWord stable_words[] =
   {"%",   1, TOKEN_PERCENT},
   {"|",   1, TOKEN_PIPE},
   {";",   1, TOKEN_SEMICOLON},
-  {"\'",  1, TOKEN_SINGLE_QUOTE}
+  {"\'",  1, TOKEN_SINGLE_QUOTE},
+  {"*",   1, TOKEN_STAR},
+  {"+",   1, TOKEN_PLUS},
+  {"!",   1, TOKEN_BANG}
 };
 
-/// @return   Next symbol.
+/// @return   Next symbol or '\0' at the end of text.
 static inline __attribute__((always_inline))
-char PeekNext(char const* const cursor)
-{ return *(cursor + 1); }
+char PeekNext(char const* const cursor, char const* const end)
+{ return (cursor + 1 < end)? *(cursor + 1) : '\0'; }
 
 /// @return   Previous symbol.
 static inline __attribute__((always_inline))
 char PeekPrev(const char* const cursor)
 { return *(cursor - 1); }
 
+/// Classes of symbols in table (sym_classes).
+enum SymClass
+{
+  kWhiteSpaceClass = 1,
+  kSplitClass      = 2,
+};
+
+/// Classes of all the bytes, filled from kWhiteSpace and kSplitSymbols.
+static uint8_t sym_classes[256] = {0};
+/// Index + 1 of one-symbol stable word of each byte (0 if there is no such word).
+static uint8_t sym_words[256] = {0};
+
+/**
+ * @brief Fills tables of symbols, so each symbol is checked by one lookup
+ * instead of search in kWhiteSpace, kSplitSymbols and stable_words.
+ */
+static void InitSymClasses()
+{
+  for (size_t idx = 0; idx < sizeof(stable_words) / sizeof(StableWord); ++idx) {
+    if (stable_words[idx].len == 1) {
+      sym_words[(unsigned char)stable_words[idx].txt[0]] = (uint8_t)(idx + 1);
+    }
+  }
+  for (const char *sym = kWhiteSpace; *sym != '\0'; ++sym) {
+    sym_classes[(unsigned char)*sym] |= kWhiteSpaceClass;
+  }
+  for (const char *sym = kSplitSymbols; *sym != '\0'; ++sym) {
+    sym_classes[(unsigned char)*sym] |= kSplitClass;
+  }
+}
+
 /**
  * @brief Checks if symbol 'c' in kSplitSymbols which
  * contains all the splitter-symbols.
@@ -65,7 +113,7 @@ char PeekPrev(const char* const cursor)
  */
 static inline __attribute__((always_inline))
 bool SplitSym(const char c)
-{ return strchr(kSplitSymbols, c) != NULL; }
+{ return (sym_classes[(unsigned char)c] & kSplitClass) != 0; }
 
 /**
  * @brief Checks if symbol 'c' in kWhiteSpace which
@@ -76,7 +124,7 @@ bool SplitSym(const char c)
  */
 static inline __attribute__((always_inline))
 bool WhitespaceSym(const char c)
-{ return strchr(kWhiteSpace, c) != NULL; }
+{ return (sym_classes[(unsigned char)c] & kWhiteSpaceClass) != 0; }
 
 /**
  * @brief Checks if the symbol is the quote-symbol
@@ -122,6 +170,9 @@ const char *TranslateTokenType(TokenType type)
     case TOKEN_PIPE:              { return "TOKEN_PIPE"; }
     case TOKEN_SEMICOLON:         { return "TOKEN_SEMICOLON"; }
     case TOKEN_SINGLE_QUOTE:      { return "TOKEN_SINGLE_QUOTE"; }
+    case TOKEN_STAR:              { return "TOKEN_STAR"; }
+    case TOKEN_PLUS:              { return "TOKEN_PLUS"; }
+    case TOKEN_BANG:              { return "TOKEN_BANG"; }
     case PARSER_TREE:             { return "PARSER_TREE"; }
     case TOKENIZER_TREE:          { return "TOKENIZER_TREE"; }
 
@@ -135,19 +186,38 @@ const char *TranslateTokenType(TokenType type)
 
 static const size_t kNotFoundIdx = sizeof(stable_words) / sizeof(StableWord) + 1;
 
+/**
+ * @brief Word collected from source text.
+ * It is part of source text, so word isn't copied anywhere.
+ */
+typedef struct Word
+{
+  // Beginning of word in source text.
+  const char *txt;
+  // Number of collected symbols.
+  uint64_t    len;
+} Word;
+
 /**
  * @brief Checks if the cur_word is
  * stable word.
  * 
- * @param cur_word   Word to check.
- * @returns          Token to push in sequence.
+ * @param word   Word to check.
+ * @returns      Index of stable word or (kNotFoundIdx).
  */
-static uint64_t IdentifyType(char *word)
+static uint64_t IdentifyType(const Word *word)
 {
   assert(word != NULL && "nullptr param");
 
+  // All the stable words except EOF are one symbol.
+  if (word->len == 1) {
+    uint8_t idx = sym_words[(unsigned char)word->txt[0]];
+    return (idx > 0)? (uint64_t)(idx - 1) : kNotFoundIdx;
+  }
+
   for (size_t idx = 0; idx < sizeof(stable_words) / sizeof(StableWord); ++idx) {
-    if (strcmp(stable_words[idx].txt, word) == 0) {
+    if (stable_words[idx].len == word->len &&
+        memcmp(stable_words[idx].txt, word->txt, word->len) == 0) {
       return idx;
     }
   }
@@ -156,106 +226,75 @@ static uint64_t IdentifyType(char *word)
 }
 
 /**
- * @brief build token with found index
- * in 'stable_words' array.
+ * @brief build token which refers to the text of 'word'.
  * 
- * @param idx   Found index.
- * @returns     Build token.
+ * @param word   Collected word.
+ * @param type   Type of token.
+ * @returns      Build token.
  */
-static Token CtorTokenByType(uint64_t idx)
+static Token CtorToken(const Word *word, TokenType type)
 {
-  Token token = {0};
-  
-  token.txt = (char *)calloc(kTokenMaxLen, sizeof(char));
-  assert(token.txt != NULL && "Null calloc allocation");
-
-  token.type = stable_words[idx].type;
-  strcpy(token.txt, stable_words[idx].txt);
-
-  return token;
-}
-
-/**
- * @brief build token with const char* data.
- * It's soppose that token wasn't found.
- * 
- * @param txt   token txt to fill.
- * @returns     Build token.
- */
-static Token CtorToken(const char *txt)
-{
-  assert(txt != NULL && "nullptr param");
+  assert(word != NULL && "nullptr param");
 
   Token token = {0};
-  
-  token.txt = (char *)calloc(kTokenMaxLen, sizeof(char));
-  assert(token.txt != NULL && "Null calloc allocation");
 
-  token.type = TOKEN_NAME;
-  strcpy(token.txt, txt);
+  token.type = type;
+  token.txt  = word->txt;
+  token.len  = word->len;
 
   return token;
 }
 
 /**
  * @brief Adds new token 'token' to sequence of tokens 'sequence'
- * and changes sequence's size
+ * and doubles sequence's capacity when it is full.
  * 
- * @param token           Token to add.
- * @param sequence        Sequence to append.
- * @param sequence_size   Current size of sequence of tokens.
+ * @param token      Token to add.
+ * @param sequence   Sequence to append.
  */
-static void PushToken(Token *token, Token *sequence, uint64_t *sequence_size)
+static void PushToken(Token *token, TokenSequence *sequence)
 {
-  assert(token         != NULL && "nullptr param");
-  assert(sequence      != NULL && "nullptr param");
-  assert(sequence_size != NULL && "nullptr param");
+  assert(token    != NULL && "nullptr param");
+  assert(sequence != NULL && "nullptr param");
+
+  if (sequence->size == sequence->capacity) {
+    sequence->capacity <<= 1;
+    sequence->tokens = (Token *)realloc(sequence->tokens, sequence->capacity * sizeof(Token));
+    assert(sequence->tokens != NULL && "Null realloc allocation");
+  }
 
-  sequence[*sequence_size] = *token;
-  ++(*sequence_size);
+  sequence->tokens[sequence->size] = *token;
+  ++sequence->size;
 }
 
 /**
- * @brief Tries to build token from 'cur_word'
+ * @brief Tries to build token from 'word'
  * and add it to token 'sequence'
  * 
- * @param word_sz   Current size of 'cur_word'.
- * @param cur_word        Current collected word.
- * @param sequence        Sequence to append.
- * @param sequence_size   Current size of sequence.
+ * @param word       Current collected word.
+ * @param sequence   Sequence to append.
  */
-static void TryPush
-    (uint64_t *word_sz, char *cur_word, Token *sequence, uint64_t *sequence_size)
+static void TryPush(Word *word, TokenSequence *sequence)
 {
-  assert(word_sz != NULL && "nullptr param");
-  assert(cur_word      != NULL && "nullptr param");
-  assert(sequence      != NULL && "nullptr param");
-  assert(sequence_size != NULL && "nullptr param");
+  assert(word     != NULL && "nullptr param");
+  assert(sequence != NULL && "nullptr param");
 
-  msg(D_TOKENIZER, M, "Try push token\"%s\"\n", cur_word);
+  msg(D_TOKENIZER, M, "Try push token\"%.*s\"\n", (int)word->len, word->txt);
   tab_incr();
-  if (*word_sz > 0) {
-    uint64_t idx = IdentifyType(cur_word);
-
-    Token token = {0};
-    if (idx != kNotFoundIdx) {
-      token = CtorTokenByType(idx);
-    } else {
-      token = CtorToken(cur_word);
-    }
-    msg(D_TOKENIZER, M, "token filled\n");
+  if (word->len > 0) {
+    uint64_t idx = IdentifyType(word);
 
-    PushToken(&token, sequence, sequence_size);
-    *word_sz = 0;
+    Token token = CtorToken(word, (idx != kNotFoundIdx)? stable_words[idx].type : TOKEN_NAME);
+    msg(D_TOKENIZER, M, "token filled\n");
 
-    memset(cur_word, '\0', kTokenMaxLen);
-    msg(D_TOKENIZER, M, "now cur_word:\"%s\"-empty\n", cur_word);
+    PushToken(&token, sequence);
+    word->len = 0;
     
     tab_decr();
-    msg(D_TOKENIZER, M, "Token:\"%s\" - pushed\n", token.txt);
+    msg(D_TOKENIZER, M, "Token:\"%.*s\" - pushed\n", (int)token.len, token.txt);
   } else {
     tab_decr();
-    msg(D_TOKENIZER, M, "Not pushed\n", cur_word);
+    msg(D_TOKENIZER, M, "Not pushed\n");
   }
 }
 
@@ -264,26 +303,27 @@ static void TryPush
  * peek not commentary block.
  * 
  * @param cursor   Pointer to cursor in source text.
+ * @param end      End of source text.
  */
-static void SkipCommentary(char const **cursor)
+static void SkipCommentary(char const **cursor, char const *end)
 {
   ++(*cursor);
 
-  if (**cursor != EOF && **cursor == kCommentSecondSym) {
+  if (*cursor < end && **cursor == kCommentSecondSym) {
     msg(D_TOKENIZER, M,
       "Waiting for long commentary-end symbol\n");
 
-    while (**cursor != kCommentFirstSym || PeekPrev(*cursor) != kCommentSecondSym) {
+    while (*cursor < end && (**cursor != kCommentFirstSym || PeekPrev(*cursor) != kCommentSecondSym)) {
       ++(*cursor);
     }
-
-    ++(*cursor);
-  } else if (**cursor != EOF && **cursor == kCommentFirstSym) {
+  } else if (*cursor < end && **cursor == kCommentFirstSym) {
     msg(D_TOKENIZER, M, "Waiting for small commentary-end symbol\n");
-    while (**cursor != EOF && **cursor != kNewLineSym){
+    while (*cursor < end && **cursor != kNewLineSym){
       ++(*cursor);
     }
+  }
 
+  if (*cursor < end) {
     ++(*cursor);
   }
 
@@ -291,35 +331,39 @@ static void SkipCommentary(char const **cursor)
 }
 
 static inline __attribute__((always_inline))
-void AppendWord(char *word, uint64_t *word_sz, char const **cursor)
+void AppendWord(Word *word, char const **cursor)
 {
-  word[*word_sz] = **cursor;
+  //  Word is always continuous part of source text
+  // so it starts at first appended symbol.
+  if (word->len == 0) {
+    word->txt = *cursor;
+  }
   //  Moves pointer and
   // increase size of word.
-  ++(*word_sz);
+  ++word->len;
   ++(*cursor);
 }
 
 static void CollectQuotedData
-    (char const **cursor, char *word, uint64_t *word_sz, uint64_t *n_tokens, Token *sequence)
+    (char const **cursor, char const *end, Word *word, TokenSequence *sequence)
 {
   bool is_prev_escape_sym = false;
   // Check if previous character was escaped.
-  while ((!QuoteSym(**cursor) || is_prev_escape_sym == true) && **cursor != EOF) {
+  while (*cursor < end && (!QuoteSym(**cursor) || is_prev_escape_sym == true)) {
     // Set next symbol escaped.
-    if (**cursor == kEscapeSym) {
+    if (**cursor == kEscapeSym && *cursor + 1 < end) {
       is_prev_escape_sym = true;
-      AppendWord(word, word_sz, cursor);
+      AppendWord(word, cursor);
     }
 
     if (is_prev_escape_sym == true && PeekPrev(*cursor) == kEscapeSym) {
       is_prev_escape_sym = false;
     }
 
-    AppendWord(word, word_sz, cursor);
+    AppendWord(word, cursor);
   }
 
-  TryPush(word_sz, word, sequence, n_tokens);
+  TryPush(word, sequence);
 }
 
 /**
@@ -335,95 +379,105 @@ static void CollectQuotedData
  * 
  * If it isn't it will be pushed to 'sequence' as name
  * of particular variable.
+ *
+ * Tokens refer to 'txt', so it should live as long as tokens.
  * 
- * @param name   Name of file to tokenize.
- * @returns      sequence of Tokens.
+ * @param txt        Source text to tokenize (it isn't terminated by any symbol).
+ * @param len        Length of source text.
+ * @param n_tokens   Output: number of tokens.
+ * @returns          sequence of Tokens.
  */
-Token *Tokenizer(char const* const txt, uint64_t *n_tokens)
+Token *Tokenizer(char const* const txt, uint64_t len, uint64_t *n_tokens)
 {
   assert(txt      != NULL && "nullptr param");
   assert(n_tokens != NULL && "nullptr param");
 
-  Token *sequence = (Token*)calloc(kInitSequenceSize, sizeof(Token));
-  assert(sequence != NULL && "Null calloc allocation");
+  InitSymClasses();
+
+  TokenSequence sequence = {NULL, 0, kInitSequenceSize};
+  sequence.tokens = (Token*)calloc(sequence.capacity, sizeof(Token));
+  assert(sequence.tokens != NULL && "Null calloc allocation");
 
-  uint64_t word_sz = 0;
-  char word[kTokenMaxLen] = "";
+  Word word = {txt, 0};
 
   //  Pointer to current symbol in source text (txt).
   char const *cursor = txt;
+  char const *end    = txt + len;
 
-  // Read the symbols until we meet EOF.
-  while (*cursor != EOF) {
+  // Read the symbols until the end of text.
+  while (cursor < end) {
     msg(D_TOKENIZER, M, "sym:(%c)\n", *cursor);
     
     //  Skip comment if it is.
-    // (word_sz) > 0 means that it can be divide-symbol.
-    if (CommentSyms(*cursor, PeekNext(cursor)) && word_sz == 0) {
-      SkipCommentary(&cursor);
+    // (word.len) > 0 means that it can be divide-symbol.
+    if (CommentSyms(*cursor, PeekNext(cursor, end)) && word.len == 0) {
+      SkipCommentary(&cursor, end);
       continue;
     }
 
     // If it's whitespace symbol
     if (WhitespaceSym(*cursor)) {
       // Skip All whitespace symbols.
-      while (WhitespaceSym(*cursor) && *cursor != EOF) {
+      while (cursor < end && WhitespaceSym(*cursor)) {
         ++cursor;
       }
 
       // Push collected word.
-      TryPush(&word_sz, word, sequence, n_tokens);
+      TryPush(&word, &sequence);
       continue;
     }
 
     // If it's split symbol
     if (SplitSym(*cursor)) {
       // Push collected word.
-      TryPush(&word_sz, word, sequence, n_tokens);
+      TryPush(&word, &sequence);
 
       // It can be a comment symbol.
-      if (CommentSyms(*cursor, PeekNext(cursor))) {
+      if (CommentSyms(*cursor, PeekNext(cursor, end))) {
         continue;
       }
 
       // It can be a quote symbol.
       if (QuoteSym(*cursor)) {
         // Push Quote.
-        AppendWord(word, &word_sz, &cursor);
-        TryPush(&word_sz, word, sequence, n_tokens);
+        AppendWord(&word, &cursor);
+        TryPush(&word, &sequence);
 
         // Сollect string between quotes.
-        CollectQuotedData(&cursor, word, &word_sz, n_tokens, sequence);
+        CollectQuotedData(&cursor, end, &word, &sequence);
 
-        // Push Quote.
-        AppendWord(word, &word_sz, &cursor);
-        TryPush(&word_sz, word, sequence, n_tokens);
+        // Push Quote (text can end without it).
+        if (cursor < end) {
+          AppendWord(&word, &cursor);
+          TryPush(&word, &sequence);
+        }
         continue;
       }
 
       // Push collected word.
-      TryPush(&word_sz, word, sequence, n_tokens);
+      TryPush(&word, &sequence);
 
       // Push split.
-      AppendWord(word, &word_sz, &cursor);
-      TryPush(&word_sz, word, sequence, n_tokens);
+      AppendWord(&word, &cursor);
+      TryPush(&word, &sequence);
       continue;
     }
 
     // Or we just append current word by new symbol.
-    AppendWord(word, &word_sz, &cursor);
+    AppendWord(&word, &cursor);
   }
 
   //  Push collected word.
-  // Which could be collected before EOF.
-  TryPush(&word_sz, word, sequence, n_tokens);
+  // Which could be collected before the end of text.
+  TryPush(&word, &sequence);
   
-  // Push TOKEN_EOF.
-  word_sz = kEofTokenLength;
-  strcpy(word, kEofTokenTxt);
-  TryPush(&word_sz, word, sequence, n_tokens);
+  //  Push TOKEN_EOF. It isn't part of source text
+  // so it refers to the stable text.
+  Word eof_word = {kEofTokenTxt, kEofTokenLength};
+  TryPush(&eof_word, &sequence);
 
-  return sequence;
+  *n_tokens = sequence.size;
+  return sequence.tokens;
 }
 
 #undef kEofTokenTxt
@@ -17,12 +17,60 @@ TokenType GetType(Node *n)
 { return n->token->type; }
 
 /**
- * @brief Gets Node's txt
- * @param   Text of node.
+ * @brief Gets Node's txt.
+ * Text isn't null-terminated, it's length is (GetLen).
+ * @returns   Text of node.
  */
-char *GetTxt(Node *n)
+const char *GetTxt(Node *n)
 { return n->token->txt; }
 
+/**
+ * @brief Gets length of Node's txt.
+ * @returns   Length of text of node.
+ */
+size_t GetLen(Node *n)
+{ return n->token->len; }
+
+/**
+ * @brief Compares Node's txt with null-terminated string.
+ * @returns   true if texts are equal.
+ */
+bool TxtEqual(Node *n, const char *txt)
+{
+	assert(n   != NULL && "Null param");
+	assert(txt != NULL && "Null param");
+
+	return GetLen(n) == strlen(txt) && memcmp(GetTxt(n), txt, GetLen(n)) == 0;
+}
+
+/**
+ * @brief Compares texts of two nodes.
+ * @returns   true if texts are equal.
+ */
+bool SameTxt(Node *first, Node *second)
+{
+	assert(first  != NULL && "Null param");
+	assert(second != NULL && "Null param");
+
+	return GetLen(first) == GetLen(second) && memcmp(GetTxt(first), GetTxt(second), GetLen(first)) == 0;
+}
+
+/**
+ * @brief Copies Node's txt to new null-terminated string.
+ * @returns   Allocated string, it should be freed.
+ */
+char *GetTxtCopy(Node *n)
+{
+	assert(n != NULL && "Null param");
+
+	char *copy = (char *)calloc(GetLen(n) + 1, sizeof(char));
+	assert(copy != NULL && "Null calloc allocation");
+
+	memcpy(copy, GetTxt(n), GetLen(n));
+
+	return copy;
+}
+
 /**
  * @brief Gets pointer to particular child
  * of node 'n' with index 'idx' in 'n''s array of children.
@@ -96,7 +144,7 @@ static void PrintNode(FILE *f, Node *n)
 			n->id,
 			BorderFmt(GetType(n)),
 			BorderColor(n->token->parser_type),
-			GetTxt(n),
+			NODE_TXT(n),
 			TranslateTokenType(GetType(n)));
 
 	if (n->children != NULL) {
@@ -137,12 +185,24 @@ static void ConnectNode(FILE *f, Node *n)
 
 // Constructors -----------------------------------
 
+/**
+ * @brief Creates node with own token which text
+ * is name of type 'type'.
+ *
+ * @param t      Tree to generate new unique 'id' of new node.
+ * @param type   Type of new node.
+ * @returns      New generated node.
+ */
 Node *CreateNodeByType(Tree *t, TokenType type)
 {
 	Node *new_node = NodeCtor();
 
-	FillEmptyStr(&new_node->token->txt, TranslateTokenType(type));
+	new_node->token = (Token *)calloc(1, sizeof(Token));
+	assert(new_node->token != NULL && "Null calloc allocation");
+
 	new_node->token->type = type;
+	new_node->token->txt  = TranslateTokenType(type);
+	new_node->token->len  = strlen(new_node->token->txt);
 	new_node->id = (uint64_t)new_node;
 
 	++t->size;
@@ -153,20 +213,19 @@ Node *CreateNodeByType(Tree *t, TokenType type)
 /**
  * @brief Creates node with new unique index
  * and adds it to tree 't'.
- * Gathers data from token 'token'.
+ * Node refers to token 'token' without copying,
+ * so token should live as long as tree.
  * Also increments 't->size'
  * 
  * @param t       Tree to generate new unique 'id' of new node.
- * @param token   Token to gather data.
+ * @param token   Token of new node.
  * @returns       New generated node.
  */
 Node *CreateNode(Tree *t, Token *token)
 {
 	Node *new_node = NodeCtor();
 
-	FillEmptyStr(&new_node->token->txt, token->txt);
-
-	new_node->token->type = token->type;
+	new_node->token = token;
 	new_node->id = ((uint64_t)new_node);
 
 	++t->size;
@@ -175,7 +234,7 @@ Node *CreateNode(Tree *t, Token *token)
 }
 
 /**
- * @brief Allocates new node.
+ * @brief Allocates new node without token.
  * @returns   New allocated node.
  */
 Node *NodeCtor()
@@ -183,9 +242,6 @@ Node *NodeCtor()
   Node *n = (Node*)calloc(1, sizeof(Node));
   assert(n != NULL && "Null calloc allocation");
 
-  n->token = (Token *)calloc(1, sizeof(Token));
-  assert(n->token != NULL && "Null calloc allocation");
-
   return n;
 }
 
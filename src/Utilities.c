@@ -1,44 +1,110 @@
+#include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <include/Utilities.h>
 #include <include/RebeccaGenerator.h>
 #include <MchlkrpchLogger/logger.h>
 
+static const size_t kSourceChunkSize = 1 << 16;
+
+/**
+ * @brief Reads the whole file (fd) by chunks.
+ * It's used for pipes and stdin which can't be mapped.
+ *
+ * @param fd    Descriptor to read.
+ * @param len   Output: number of read symbols.
+ * @returns     Allocated text or NULL if read fails.
+ */
+static char *ReadChunks(int fd, uint64_t *len)
+{
+  size_t capacity = kSourceChunkSize;
+  char *txt = (char *)malloc(capacity);
+  assert(txt != NULL && "Null malloc allocation");
+
+  *len = 0;
+  while (true) {
+    if (*len == capacity) {
+      capacity <<= 1;
+      txt = (char *)realloc(txt, capacity);
+      assert(txt != NULL && "Null realloc allocation");
+    }
+    ssize_t n_read = read(fd, txt + *len, capacity - *len);
+    if (n_read < 0) {
+      free(txt);
+      return NULL;
+    }
+    if (n_read == 0) {
+      return txt;
+    }
+    *len += (uint64_t)n_read;
+  }
+}
+
 /**
  * @brief returns source text
- * which is come from FILE with name 'name'.
+ * which is come from FILE with name 'name' ("-" is stdin).
+ * Regular file is mapped read-only, so it isn't copied.
+ * Text isn't terminated by any symbol: tokenizer uses it's length.
  * 
  * @param     name Name of file to read.
- * @returns   source_text char* text of file.
+ * @returns   Source text, (txt) is NULL if file can't be read.
  */
-char *GetSourceText(const char *name)
+SourceText GetSourceText(const char *name)
 {
   assert(name != NULL && "nullptr param");
   
   tab_incr();
 
-  FILE *f = fopen(name, "r");
-  assert(f != NULL && "Open file error");
-
-  fseek(f, 0, SEEK_END);
-  /* Contains number of symbols wihtout EOF-symbol.
-  For example with file "abaEOF" n_symbols = 3.*/
-  size_t n_symbols = ftell(f);
+  SourceText source = {NULL, 0, false};
+  bool is_stdin = (strcmp(name, "-") == 0);
+  int fd = (is_stdin)? STDIN_FILENO : open(name, O_RDONLY);
+  if (fd < 0) {
+    tab_decr();
+    return source;
+  }
+
+  struct stat st = {0};
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      source.txt    = (const char *)data;
+      source.len    = (uint64_t)st.st_size;
+      source.mapped = true;
+    }
+  }
+  if (!source.mapped) {
+    source.txt = ReadChunks(fd, &source.len);
+  }
   msg(D_TOKENIZER, M,
-    "mush be allocated:%zu\n", n_symbols);
-  fseek(f, 0, SEEK_SET);
-
-  char *source_text = (char *)calloc(n_symbols + 1, sizeof(char));
-  fread(source_text, sizeof(char), n_symbols, f);
+    "read %lu symbols (%s)\n", source.len, (source.mapped)? "mapped" : "copied");
 
-  /* Set last character as 'EOF' symbol
-  to terminate tokenizer's work*/
-  source_text[n_symbols] = EOF;
-  
-  fclose(f);
+  if (!is_stdin) {
+    close(fd);
+  }
   tab_decr();
 
-  return source_text;
+  return source;
+}
+
+/**
+ * @brief Releases text of (source).
+ *
+ * @param source   Source which is returned by GetSourceText.
+ */
+void FreeSourceText(SourceText *source)
+{
+  assert(source != NULL && "nullptr param");
+
+  if (source->mapped) {
+    munmap((void *)source->txt, source->len);
+  } else {
+    free((void *)source->txt);
+  }
+  source->txt = NULL;
+  source->len = 0;
 }
 
 /**
@@ -67,23 +133,6 @@ Array *ArrayCtor(uint64_t el_sz)
 }
 
 
-/**
- * @brief fills NULL-buffer with data from 'src'.
- * Firstly allocates memory then copies 'src' string to 'dest'.
- * 
- * @param dest   Destination buffer to fill.
- * @param src    Source buffer.
- */
-void FillEmptyStr(char **dest, const char *src)
-{
-	assert(src  != NULL && "Null param");
-
-	(*dest) = (char *)calloc(kTokenMaxLen, sizeof(char));
-	assert(dest != NULL && "Null calloc allocation");
-
-	strcpy(*dest, src);
-}
-
 /**
  * @brief Changes array's capacity to 'new_capacity'.
  * 